@@ -41,11 +41,19 @@ struct ArrayBase {
     virtual bool isNull() const = 0;
     virtual size_type CopyIn(ArrayBase const& other) = 0;
     virtual size_type CopyOut(ArrayBase& other) const { return other.CopyIn(*this); };
+    /** copy the part of other in box, same as CopyIn(*other.GetSelectionP(box)) without the copy of other */
+    virtual size_type CopyIn(ArrayBase const& other, index_box_type const& box) {
+        return CopyIn(*other.GetSelectionP(box));
+    }
     virtual void Clear() = 0;
     virtual void reset(void*, index_type const* lo, index_type const* hi) = 0;
     virtual void reset(index_box_type const& b) = 0;
 
     virtual std::shared_ptr<ArrayBase> DuplicateArray() const = 0;
+    /** true if the data is a strided block, which can be described by GetShape and isSlowFirst */
+    virtual bool isLinear() const { return true; }
+    /** copy of the array in a strided block, with the same shape and index box */
+    virtual std::shared_ptr<ArrayBase> Linearize() const { return DuplicateArray(); }
     virtual void Shift(index_type const*) = 0;
     virtual void Select(index_type const*, index_type const*) = 0;
 
@@ -119,6 +127,8 @@ class Array : public ArrayBase {
     std::shared_ptr<ArrayBase> DuplicateArray() const override {
         return std::shared_ptr<ArrayBase>(new this_type(*this));
     };
+    bool isLinear() const override { return SFC::is_linear; }
+    std::shared_ptr<ArrayBase> Linearize() const override;
     void alloc();
     void free();
     std::ostream& Print(std::ostream& os, int indent) const override;
@@ -148,6 +158,11 @@ class Array : public ArrayBase {
         if (auto* p = dynamic_cast<this_type*>(&other)) { count = CopyOut(*p); }
         return count;
     };
+    size_type CopyIn(ArrayBase const& other, index_box_type const& box) override {
+        size_type count = 0;
+        if (auto* p = dynamic_cast<this_type const*>(&other)) { count = CopyIn(*p, box); }
+        return count;
+    }
     void reset(index_box_type const& b) override {
         m_data_ = nullptr;
         m_holder_.reset();
@@ -207,11 +222,37 @@ class Array : public ArrayBase {
 
     size_type CopyIn(this_type const& other) {
         alloc();
-        return m_sfc_.Overlap(other.m_sfc_).Foreach([&] __host__ __device__(auto&&... s) {
-            this->Set(other.Get(std::forward<decltype(s)>(s)...), std::forward<decltype(s)>(s)...);
+        value_type* dst = m_data_;
+        value_type const* src = other.m_data_;
+        SFC const& src_sfc = other.m_sfc_;
+        if (src == nullptr) {
+            return m_sfc_.Overlap(other.m_sfc_).ForeachOffset(
+                [=] __host__ __device__(index_type s, auto&&... idx) { dst[s] = s_nan; });
+        }
+        return m_sfc_.Overlap(other.m_sfc_).ForeachOffset([&] __host__ __device__(index_type s, auto&&... idx) {
+            dst[s] = src[src_sfc.hash(std::forward<decltype(idx)>(idx)...)];
         });
     };
     size_type CopyOut(this_type& other) const { return other.CopyIn(*this); };
+    /** copy the part of other in box, rows of a ZSFC are copied as contiguous blocks */
+    size_type CopyIn(this_type const& other, index_box_type const& box) {
+        if (other.m_data_ == nullptr) { return 0; }
+        alloc();
+        return CopyBox_(&m_sfc_, other, box);
+    }
+
+   private:
+    size_type CopyBox_(ZSFC<3> const*, this_type const& other, index_box_type const& box) {
+        auto b = detail::overlap<3>(box, detail::overlap<3>(m_sfc_.GetIndexBox(), other.m_sfc_.GetIndexBox()));
+        return detail::zsfc_copy_box(m_data_, m_sfc_, other.m_data_, other.m_sfc_, &std::get<0>(b)[0],
+                                     &std::get<1>(b)[0]);
+    }
+    template <typename TSFC>
+    size_type CopyBox_(TSFC const*, this_type const& other, index_box_type const& box) {
+        return CopyIn(other.GetSelection(box));
+    }
+
+   public:
 
     void DeepCopy(value_type const* other) {
         alloc();
@@ -220,7 +261,8 @@ class Array : public ArrayBase {
     void FillNaN() override { Fill(s_nan); }
     void Fill(value_type v) {
         alloc();
-        m_sfc_.Foreach([&] __host__ __device__(auto&&... s) { this->Set(v, std::forward<decltype(s)>(s)...); });
+        value_type* dst = m_data_;
+        m_sfc_.ForeachOffset([=] __host__ __device__(index_type s, auto&&... idx) { dst[s] = v; });
     }
     void Clear() override {
         alloc();
@@ -330,6 +372,19 @@ void Array<V, SFC>::alloc() {
     }
 }
 
+template <typename V, typename SFC>
+std::shared_ptr<ArrayBase> Array<V, SFC>::Linearize() const {
+    if (isLinear()) { return DuplicateArray(); }
+    auto res = std::make_shared<Array<V, ZSFC<SFC::ndims>>>(GetShape());
+    res->alloc();
+    if (!isNull()) {
+        m_sfc_.GetSelection(nullptr, nullptr).Foreach([&](auto&&... idx) {
+            res->at(std::forward<decltype(idx)>(idx)...) = at(std::forward<decltype(idx)>(idx)...);
+        });
+    }
+    res->Select(GetIndexBox());
+    return res;
+}
 template <typename V, typename SFC>
 void Array<V, SFC>::free() {
     m_holder_.reset();
@@ -388,15 +443,167 @@ template <typename TOP, typename... V, typename... Args>
 decltype(auto) array_parser(Expression<TOP, V...> const& expr, Args&&... args) {
     return eval_helper_(std::index_sequence_for<V...>(), expr, std::forward<Args>(args)...);
 }
+
+/**
+ * Same as array_parser, but Array operands are accessed through Array::at() without in_box check.
+ * Only valid when idx lies in the overlap of all operands and no operand is null.
+ */
+template <typename V, typename... Args>
+decltype(auto) array_parser_in_box(V const& expr, Args&&... args) {
+    return array_parser(expr, std::forward<Args>(args)...);
+}
+template <typename... V, typename... Args>
+decltype(auto) array_parser_in_box(Array<V...> const& expr, Args&&... args) {
+    return expr.at(std::forward<Args>(args)...);
+}
+template <typename TOP, typename... V, typename... Args>
+decltype(auto) array_parser_in_box(Expression<TOP, V...> const& expr, Args&&... args);
+
+template <size_type... I, typename TExpr, typename... Args>
+decltype(auto) eval_in_box_helper_(std::index_sequence<I...>, TExpr const& expr, Args&&... args) {
+    return expr.m_op_(array_parser_in_box(std::get<I>(expr.m_args_), std::forward<Args>(args)...)...);
+}
+template <typename TOP, typename... V, typename... Args>
+decltype(auto) array_parser_in_box(Expression<TOP, V...> const& expr, Args&&... args) {
+    return eval_in_box_helper_(std::index_sequence_for<V...>(), expr, std::forward<Args>(args)...);
+}
+
+/**
+ * Operand of a lowered expression: the data of an Array and the constant distance between its linear offset and
+ * the linear offset of the destination, i.e.  a(idx) == m_data_[dst.hash(idx) + m_offset_] .
+ */
+template <typename V>
+struct array_stencil_operand {
+    V const* m_data_ = nullptr;
+    index_type m_offset_ = 0;
+};
+/**
+ * Type of the lowered expression: every Array operand is replaced by an array_stencil_operand, the operator tree
+ * and the other operands are kept.
+ */
+template <typename T>
+struct array_lowered {
+    typedef T type;
+};
+template <typename V, typename SFC>
+struct array_lowered<Array<V, SFC>> {
+    typedef array_stencil_operand<V> type;
+};
+template <typename TOP, typename... Args>
+struct array_lowered<Expression<TOP, Args...>> {
+    typedef Expression<TOP, typename array_lowered<std::decay_t<Args>>::type...> type;
+};
+template <typename T>
+using array_lowered_t = typename array_lowered<T>::type;
+
+/**
+ * Lower expr against the destination sfc, once per patch. An Array operand can be lowered if it is not null and
+ * has the same strides as sfc, otherwise *success is set false and the result must not be evaluated.
+ */
+template <typename T, typename TSFC>
+T const& array_lower(T const& expr, TSFC const& sfc, bool* success) {
+    return expr;
+}
+template <typename V, typename SFC, typename TSFC>
+array_stencil_operand<V> array_lower(Array<V, SFC> const& a, TSFC const& sfc, bool* success) {
+    *success = false;
+    return array_stencil_operand<V>{};
+}
+template <typename V, int N>
+array_stencil_operand<V> array_lower(Array<V, ZSFC<N>> const& a, ZSFC<N> const& sfc, bool* success) {
+    array_stencil_operand<V> res;
+    ZSFC<N> const& a_sfc = a.GetSpaceFillingCurve();
+    res.m_data_ = a.get();
+    for (int i = 0; i < N; ++i) {
+        if (a_sfc.m_strides_[i] != sfc.m_strides_[i]) { *success = false; }
+        res.m_offset_ += (sfc.m_shape_min_[i] - a_sfc.m_shape_min_[i]) * sfc.m_strides_[i];
+    }
+    if (res.m_data_ == nullptr) { *success = false; }
+    return res;
+}
+template <typename TOP, typename... Args, typename TSFC>
+array_lowered_t<Expression<TOP, Args...>> array_lower(Expression<TOP, Args...> const& expr, TSFC const& sfc,
+                                                      bool* success);
+template <size_type... I, typename TOP, typename... Args, typename TSFC>
+array_lowered_t<Expression<TOP, Args...>> array_lower_helper_(std::index_sequence<I...>,
+                                                              Expression<TOP, Args...> const& expr,
+                                                              TSFC const& sfc, bool* success) {
+    return array_lowered_t<Expression<TOP, Args...>>(array_lower(std::get<I>(expr.m_args_), sfc, success)...);
+}
+template <typename TOP, typename... Args, typename TSFC>
+array_lowered_t<Expression<TOP, Args...>> array_lower(Expression<TOP, Args...> const& expr, TSFC const& sfc,
+                                                      bool* success) {
+    return array_lower_helper_(std::index_sequence_for<Args...>(), expr, sfc, success);
+}
+
+/**
+ * Evaluate a lowered expression at the point idx, whose linear offset in the destination is s. Array operands are
+ * plain loads at s plus a constant, without hash or in_box test, so the row loop of ForeachOffset vectorizes.
+ */
+template <typename V, typename... Args>
+decltype(auto) array_stencil_parser(V const& expr, index_type s, Args&&... args) {
+    return array_parser(expr, std::forward<Args>(args)...);
+}
+template <typename V, typename... Args>
+V array_stencil_parser(array_stencil_operand<V> const& a, index_type s, Args&&... args) {
+    return a.m_data_[s + a.m_offset_];
+}
+template <typename TOP, typename... V, typename... Args>
+decltype(auto) array_stencil_parser(Expression<TOP, V...> const& expr, index_type s, Args&&... args);
+
+template <size_type... I, typename TExpr, typename... Args>
+decltype(auto) eval_stencil_helper_(std::index_sequence<I...>, TExpr const& expr, index_type s, Args&&... args) {
+    return expr.m_op_(array_stencil_parser(std::get<I>(expr.m_args_), s, std::forward<Args>(args)...)...);
+}
+template <typename TOP, typename... V, typename... Args>
+decltype(auto) array_stencil_parser(Expression<TOP, V...> const& expr, index_type s, Args&&... args) {
+    return eval_stencil_helper_(std::index_sequence_for<V...>(), expr, s, std::forward<Args>(args)...);
+}
+
+template <typename V>
+bool array_has_null(V const& expr) {
+    return false;
+}
+template <typename... V>
+bool array_has_null(Array<V...> const& expr) {
+    return expr.isNull();
+}
+template <typename TOP, typename... V>
+bool array_has_null(Expression<TOP, V...> const& expr);
+template <size_type... I, typename TExpr>
+bool array_has_null_helper_(std::index_sequence<I...>, TExpr const& expr) {
+    return utility::NOr(array_has_null(std::get<I>(expr.m_args_))...);
+}
+template <typename TOP, typename... V>
+bool array_has_null(Expression<TOP, V...> const& expr) {
+    return array_has_null_helper_(std::index_sequence_for<V...>(), expr);
+}
 }  // namespace detail {
 
 template <typename V, typename SFC>
 template <typename RHS>
 void Array<V, SFC>::Assign(RHS const& rhs) {
     alloc();
-    GetSpaceFillingCurve().Overlap(rhs).Foreach([&](auto&&... idx) {
-        this->Set(detail::array_parser(rhs, std::forward<decltype(idx)>(idx)...), std::forward<decltype(idx)>(idx)...);
-    });
+    value_type* dst = m_data_;
+    auto sfc = GetSpaceFillingCurve().Overlap(rhs);
+    if (detail::array_has_null(rhs)) {
+        sfc.ForeachOffset([&](index_type s, auto&&... idx) {
+            dst[s] = detail::array_parser(rhs, std::forward<decltype(idx)>(idx)...);
+        });
+        return;
+    }
+    // every Array operand covers the overlapped box, so the in_box check is skipped
+    bool lowered = true;
+    auto stencil = detail::array_lower(rhs, sfc, &lowered);
+    if (lowered) {
+        sfc.ForeachOffset([&](index_type s, auto&&... idx) {
+            dst[s] = detail::array_stencil_parser(stencil, s, std::forward<decltype(idx)>(idx)...);
+        });
+    } else {
+        sfc.ForeachOffset([&](index_type s, auto&&... idx) {
+            dst[s] = detail::array_parser_in_box(rhs, std::forward<decltype(idx)>(idx)...);
+        });
+    }
 };
 
 template <typename... TL>
@@ -0,0 +1,193 @@
+//
+// Fused evaluation of the components of an Array assignment on tiles of the lhs.
+//
+
+#ifndef SIMPLA_FUSEDASSIGN_H
+#define SIMPLA_FUSEDASSIGN_H
+
+#include "simpla/SIMPLA_config.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Array.h"
+#include "ExpressionTemplate.h"
+#include "sfc/z_sfc.h"
+
+namespace simpla {
+/**
+ * @brief  access of an Array operand: data pointer and origin of its shape. Two accesses of the same data with
+ *          different origin are shifted against each other.
+ */
+struct FusedAccess {
+    void const* data = nullptr;
+    nTuple<index_type, 3> origin{0, 0, 0};
+};
+/**
+ * @brief  one component of an assignment  lhs = rhs : the lhs Array, the Array operands of rhs and the evaluation
+ *          of rhs on a sub-box of the lhs. The body is called inside a parallel region, so it must be serial.
+ */
+struct FusedKernel {
+    index_box_type box;
+    FusedAccess dst;
+    std::vector<FusedAccess> src;
+    std::function<void(index_type const* lo, index_type const* hi)> body;
+};
+
+namespace detail {
+template <typename V, typename SFC>
+FusedAccess fused_access(Array<V, SFC> const& a) {
+    FusedAccess res;
+    index_type hi[3];
+    res.data = a.pointer();
+    a.GetShape(&res.origin[0], hi);
+    return res;
+}
+inline bool is_shifted(FusedAccess const& a, FusedAccess const& b) {
+    return a.data != nullptr && a.data == b.data &&
+           (a.origin[0] != b.origin[0] || a.origin[1] != b.origin[1] || a.origin[2] != b.origin[2]);
+}
+
+template <typename T>
+void collect_fused_access(std::vector<FusedAccess>& res, T const& expr) {}
+template <typename V, typename SFC>
+void collect_fused_access(std::vector<FusedAccess>& res, Array<V, SFC> const& a) {
+    res.push_back(fused_access(a));
+}
+template <typename TOP, typename... Args>
+void collect_fused_access(std::vector<FusedAccess>& res, Expression<TOP, Args...> const& expr);
+template <size_type... I, typename TExpr>
+void collect_fused_access_helper_(std::index_sequence<I...>, std::vector<FusedAccess>& res, TExpr const& expr) {
+    int dummy[] = {(collect_fused_access(res, std::get<I>(expr.m_args_)), 0)..., 0};
+    (void)dummy;
+}
+template <typename TOP, typename... Args>
+void collect_fused_access(std::vector<FusedAccess>& res, Expression<TOP, Args...> const& expr) {
+    collect_fused_access_helper_(std::index_sequence_for<Args...>(), res, expr);
+}
+}  // namespace detail
+
+/**
+ * @brief the kernel of  lhs = rhs  on the part of range covered by lhs, same as Array::Assign. Out of box operands
+ *        read NaN, as in array_parser.
+ */
+template <typename V, typename RHS>
+FusedKernel MakeFusedKernel(Array<V, ZSFC<3>>& lhs, RHS const& rhs, index_box_type const& range) {
+    FusedKernel res;
+    lhs.alloc();
+    ZSFC<3> sfc = lhs.GetSpaceFillingCurve();
+    res.box = detail::overlap<3>(range, sfc.GetIndexBox());
+    res.dst = detail::fused_access(lhs);
+    detail::collect_fused_access(res.src, rhs);
+
+    index_box_type inner = detail::overlap<3>(res.box, detail::overlap<3>(rhs));
+    bool has_null = detail::array_has_null(rhs);
+    V* dst = lhs.get();
+    // the kernel is stored in std::function, which moves it around; keep the expression behind a shared_ptr
+    auto expr = std::make_shared<RHS>(rhs);
+    bool lowered = !has_null;
+    auto stencil = std::make_shared<detail::array_lowered_t<RHS>>(detail::array_lower(rhs, sfc, &lowered));
+    res.body = [=](index_type const* lo, index_type const* hi) {
+        bool in_box = !has_null;
+        for (int n = 0; in_box && n < 3; ++n) {
+            in_box = std::get<0>(inner)[n] <= lo[n] && hi[n] <= std::get<1>(inner)[n];
+        }
+        if (in_box && lowered) {
+            detail::zsfc_foreach_box(std::true_type(), sfc, lo, hi,
+                                     [&](index_type s, index_type i, index_type j, index_type k) {
+                                         dst[s] = detail::array_stencil_parser(*stencil, s, i, j, k);
+                                     });
+        } else if (in_box) {
+            detail::zsfc_foreach_box(std::true_type(), sfc, lo, hi,
+                                     [&](index_type s, index_type i, index_type j, index_type k) {
+                                         dst[s] = detail::array_parser_in_box(*expr, i, j, k);
+                                     });
+        } else {
+            detail::zsfc_foreach_box(std::false_type(), sfc, lo, hi,
+                                     [&](index_type s, index_type i, index_type j, index_type k) {
+                                         dst[s] = detail::array_parser(*expr, i, j, k);
+                                     });
+        }
+    };
+    return res;
+}
+
+/**
+ * @brief  Fused traversal of a sequence of assignments.
+ *
+ *  Statements are pushed in program order, each as the kernels of its components. Kernels of a group are
+ *  evaluated tile by tile in one parallel sweep, so one tile of every operand is loaded once for the whole group.
+ *  Inside a tile, statements keep their order, so an unshifted read of a value written by an earlier statement is
+ *  safe. A shifted read (stencil) of an Array written in the same group needs the neighbour tiles to be finished,
+ *  in that case the group is flushed before the statement is pushed.
+ */
+class FusedAssign {
+   public:
+    FusedAssign() = default;
+    ~FusedAssign() = default;
+    FusedAssign(FusedAssign const&) = delete;
+    FusedAssign& operator=(FusedAssign const&) = delete;
+
+    void Push(std::vector<FusedKernel> const& statement) {
+        if (Depend(statement)) { Flush(); }
+        m_kernels_.insert(m_kernels_.end(), statement.begin(), statement.end());
+    }
+    bool Depend(std::vector<FusedKernel> const& statement) const {
+        for (auto const& k : m_kernels_)
+            for (auto const& s : statement) {
+                for (auto const& r : s.src) {
+                    if (detail::is_shifted(k.dst, r)) { return true; }
+                }
+                for (auto const& r : k.src) {
+                    if (detail::is_shifted(s.dst, r)) { return true; }
+                }
+            }
+        return false;
+    }
+    void Flush();
+    /** number of sweeps executed by Flush */
+    size_type GetNumberOfSweeps() const { return m_num_of_sweeps_; }
+
+   private:
+    std::vector<FusedKernel> m_kernels_;
+    size_type m_num_of_sweeps_ = 0;
+};
+
+inline void FusedAssign::Flush() {
+    if (m_kernels_.empty()) { return; }
+    index_box_type box = m_kernels_.front().box;
+    for (auto const& k : m_kernels_)
+        for (int n = 0; n < 3; ++n) {
+            std::get<0>(box)[n] = std::min(std::get<0>(box)[n], std::get<0>(k.box)[n]);
+            std::get<1>(box)[n] = std::max(std::get<1>(box)[n], std::get<1>(k.box)[n]);
+        }
+    ZSFC<3> sfc(box);
+    index_type const* b = sfc.m_index_min_;
+    index_type const* e = sfc.m_index_max_;
+    index_type t[3];
+    for (int n = 0; n < 3; ++n) { t[n] = sfc.m_tile_shape_[n] > 0 ? sfc.m_tile_shape_[n] : e[n] - b[n]; }
+
+    auto const& kernels = m_kernels_;
+#pragma omp parallel for collapse(3) schedule(static)
+    for (index_type I = b[0]; I < e[0]; I += t[0])
+        for (index_type J = b[1]; J < e[1]; J += t[1])
+            for (index_type K = b[2]; K < e[2]; K += t[2]) {
+                index_type tile_lo[3] = {I, J, K};
+                index_type tile_hi[3] = {std::min(I + t[0], e[0]), std::min(J + t[1], e[1]), std::min(K + t[2], e[2])};
+                for (auto const& k : kernels) {
+                    index_type lo[3], hi[3];
+                    bool empty = false;
+                    for (int n = 0; n < 3; ++n) {
+                        lo[n] = std::max(tile_lo[n], std::get<0>(k.box)[n]);
+                        hi[n] = std::min(tile_hi[n], std::get<1>(k.box)[n]);
+                        empty = empty || lo[n] >= hi[n];
+                    }
+                    if (!empty) { k.body(lo, hi); }
+                }
+            }
+    m_kernels_.clear();
+    ++m_num_of_sweeps_;
+}
+}  // namespace simpla
+
+#endif  // SIMPLA_FUSEDASSIGN_H
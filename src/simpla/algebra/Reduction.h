@@ -0,0 +1,124 @@
+//
+// Parallel Sum / Max / Min / Norm2 / Dot of Array expressions over a range.
+//
+
+#ifndef SIMPLA_REDUCTION_H
+#define SIMPLA_REDUCTION_H
+
+#include "simpla/SIMPLA_config.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Array.h"
+#include "ExpressionTemplate.h"
+#include "sfc/z_sfc.h"
+
+namespace simpla {
+namespace detail {
+struct reduce_sum {
+    Real operator()(Real a, Real b) const { return a + b; }
+};
+struct reduce_max {
+    Real operator()(Real a, Real b) const { return std::max(a, b); }
+};
+struct reduce_min {
+    Real operator()(Real a, Real b) const { return std::min(a, b); }
+};
+struct reduce_value {
+    template <typename T>
+    Real operator()(T const& v) const {
+        return static_cast<Real>(v);
+    }
+};
+struct reduce_square {
+    template <typename T>
+    Real operator()(T const& v) const {
+        return static_cast<Real>(v * v);
+    }
+};
+
+/**
+ * fold  res = op(res, map(expr(idx)))  over the points of range where every Array operand of expr is defined, in one
+ * tiled sweep, see ZSFC::ReduceOffset. expr is evaluated as in Array::Assign: lowered to plain loads if its operands
+ * share the strides of range, by array_parser (NaN out of box) if one of them is null.
+ */
+template <typename TOp, typename TMap, typename TExpr>
+Real array_reduce(ZSFC<3> const& range, Real init, TOp const& op, TMap const& map, TExpr const& expr) {
+    // unlike ZSFC::Overlap, the selection of range is kept
+    ZSFC<3> sfc = range;
+    sfc.Select(overlap<3>(range.GetIndexBox(), overlap<3>(expr)));
+    if (array_has_null(expr)) {
+        return sfc.ReduceOffset(init, op, [&](index_type s, index_type i, index_type j, index_type k) {
+            return map(array_parser(expr, i, j, k));
+        });
+    }
+    bool lowered = true;
+    auto stencil = array_lower(expr, sfc, &lowered);
+    if (lowered) {
+        return sfc.ReduceOffset(init, op, [&](index_type s, index_type i, index_type j, index_type k) {
+            return map(array_stencil_parser(stencil, s, i, j, k));
+        });
+    }
+    return sfc.ReduceOffset(init, op, [&](index_type s, index_type i, index_type j, index_type k) {
+        return map(array_parser_in_box(expr, i, j, k));
+    });
+}
+}  // namespace detail
+
+/**
+ * @addtogroup algebra
+ *  Sum, Max, Min, Norm2 and Dot of an Array, or of an expression of Arrays on the points of range where all of its
+ *  Array operands are defined. Each is one sweep over the data, shared by the threads (OpenMP) tile by tile, and
+ *  its result does not depend on the number of threads. They are local to one patch, see Domain::Sum for fields
+ *  and Scenario::Sum for the reductions over the patches and the ranks.
+ *  @{
+ */
+template <typename TExpr>
+Real Sum(ZSFC<3> const& range, TExpr const& expr) {
+    return detail::array_reduce(range, 0, detail::reduce_sum(), detail::reduce_value(), expr);
+}
+template <typename TExpr>
+Real Max(ZSFC<3> const& range, TExpr const& expr) {
+    return detail::array_reduce(range, -std::numeric_limits<Real>::infinity(), detail::reduce_max(),
+                                detail::reduce_value(), expr);
+}
+template <typename TExpr>
+Real Min(ZSFC<3> const& range, TExpr const& expr) {
+    return detail::array_reduce(range, std::numeric_limits<Real>::infinity(), detail::reduce_min(),
+                                detail::reduce_value(), expr);
+}
+/** sqrt(Sum(expr*expr)), the square is taken in the sweep */
+template <typename TExpr>
+Real Norm2(ZSFC<3> const& range, TExpr const& expr) {
+    return std::sqrt(detail::array_reduce(range, 0, detail::reduce_sum(), detail::reduce_square(), expr));
+}
+/** Sum(lhs*rhs) */
+template <typename TL, typename TR>
+Real Dot(ZSFC<3> const& range, TL const& lhs, TR const& rhs) {
+    return Sum(range, Expression<tags::multiplication, TL, TR>(lhs, rhs));
+}
+
+template <typename V>
+Real Sum(Array<V, ZSFC<3>> const& a) {
+    return Sum(a.GetSpaceFillingCurve(), a);
+}
+template <typename V>
+Real Max(Array<V, ZSFC<3>> const& a) {
+    return Max(a.GetSpaceFillingCurve(), a);
+}
+template <typename V>
+Real Min(Array<V, ZSFC<3>> const& a) {
+    return Min(a.GetSpaceFillingCurve(), a);
+}
+template <typename V>
+Real Norm2(Array<V, ZSFC<3>> const& a) {
+    return Norm2(a.GetSpaceFillingCurve(), a);
+}
+template <typename V, typename U>
+Real Dot(Array<V, ZSFC<3>> const& lhs, Array<U, ZSFC<3>> const& rhs) {
+    return Dot(lhs.GetSpaceFillingCurve(), lhs, rhs);
+}
+/** @} */
+}  // namespace simpla
+#endif  // SIMPLA_REDUCTION_H
@@ -6,5 +6,6 @@
 #define SIMPLA_SFC_H
 
 #include "sfc/hilbert_sfc.h"
+#include "sfc/morton_sfc.h"
 #include "sfc/z_sfc.h"
 #endif  // SIMPLA_SFC_H
@@ -0,0 +1,150 @@
+//
+// Array of a separable function a * f0[i] * f1[j] * f2[k], stored as its 1D factors.
+//
+
+#ifndef SIMPLA_SEPARABLEARRAY_H
+#define SIMPLA_SEPARABLEARRAY_H
+
+#include "simpla/SIMPLA_config.h"
+
+#include <memory>
+#include "nTuple.h"
+#include "simpla/utilities/Log.h"
+
+namespace simpla {
+/**
+ * @brief  read only 3D array of a separable function  v(i,j,k) = a * f0[i] * f1[j] * f2[k] , stored as three 1D
+ *         factors on an index box. It is a leaf of Array expressions, evaluated inline by operator()(i,j,k), so a
+ *         metric of an orthogonal chart costs three loads of short, cache resident arrays instead of one full 3D
+ *         array per point.
+ *
+ *  Copies share the factors. Shift follows Array::Shift: the shifted array at idx is the original at idx - offset.
+ */
+template <typename V>
+class SeparableArray {
+    typedef SeparableArray<V> this_type;
+
+   public:
+    typedef V value_type;
+
+    SeparableArray() = default;
+    ~SeparableArray() = default;
+    SeparableArray(this_type const&) = default;
+    SeparableArray(this_type&&) noexcept = default;
+    this_type& operator=(this_type const&) = default;
+    this_type& operator=(this_type&&) noexcept = default;
+
+    explicit SeparableArray(index_box_type const& b) { reset(b); }
+
+    void reset(index_box_type const& b) {
+        size_type num = 0;
+        for (int n = 0; n < 3; ++n) {
+            m_lo_[n] = std::get<0>(b)[n];
+            m_hi_[n] = std::get<1>(b)[n];
+            num += static_cast<size_type>(m_hi_[n] - m_lo_[n]);
+        }
+        m_holder_ = std::shared_ptr<V>(new V[num], std::default_delete<V[]>());
+        V* p = m_holder_.get();
+        for (int n = 0; n < 3; ++n) {
+            m_factor_[n] = p;
+            p += m_hi_[n] - m_lo_[n];
+        }
+        Fill(1);
+    }
+    bool empty() const { return m_holder_ == nullptr; }
+    index_box_type GetIndexBox() const {
+        return index_box_type{{m_lo_[0] + m_shift_[0], m_lo_[1] + m_shift_[1], m_lo_[2] + m_shift_[2]},
+                              {m_hi_[0] + m_shift_[0], m_hi_[1] + m_shift_[1], m_hi_[2] + m_shift_[2]}};
+    }
+    void Fill(V const& v) {
+        for (int n = 0; n < 3; ++n) {
+            for (index_type s = 0, e = m_hi_[n] - m_lo_[n]; s < e; ++s) { m_factor_[n][s] = v; }
+        }
+        m_scale_ = 1;
+    }
+    /** 1D factor along axis n, f[idx] for m_lo_[n] <= idx < m_hi_[n] */
+    V& factor(int n, index_type idx) { return m_factor_[n][idx - m_lo_[n]]; }
+    V const& factor(int n, index_type idx) const { return m_factor_[n][idx - m_lo_[n]]; }
+
+    /**
+     * Factorize fun(i,j,k) on the index box from its values on the three axis lines through the first point ref of
+     * the box, where fun(ref) != 0:   v(i,j,k) = v(i,r1,r2) * v(r0,j,r2) * v(r0,r1,k) / v(r0,r1,r2)^2 .
+     * Exact for a separable fun. If fun vanishes on the whole box, so does the result.
+     */
+    template <typename TFun>
+    void Factorize(TFun const& fun) {
+        index_type ref[3] = {m_lo_[0], m_lo_[1], m_lo_[2]};
+        V v0 = fun(ref[0], ref[1], ref[2]);
+        for (index_type i = m_lo_[0]; v0 == 0 && i < m_hi_[0]; ++i) {
+            for (index_type j = m_lo_[1]; v0 == 0 && j < m_hi_[1]; ++j) {
+                for (index_type k = m_lo_[2]; v0 == 0 && k < m_hi_[2]; ++k) {
+                    v0 = fun(i, j, k);
+                    ref[0] = i;
+                    ref[1] = j;
+                    ref[2] = k;
+                }
+            }
+        }
+        if (v0 == 0) {
+            Fill(0);
+            return;
+        }
+        for (index_type i = m_lo_[0]; i < m_hi_[0]; ++i) { factor(0, i) = fun(i, ref[1], ref[2]); }
+        for (index_type j = m_lo_[1]; j < m_hi_[1]; ++j) { factor(1, j) = fun(ref[0], j, ref[2]) / v0; }
+        for (index_type k = m_lo_[2]; k < m_hi_[2]; ++k) { factor(2, k) = fun(ref[0], ref[1], k) / v0; }
+        m_scale_ = 1;
+    }
+    /** element-wise  1/v , zero where v is zero */
+    this_type Inverse() const {
+        this_type res(index_box_type{m_lo_, m_hi_});
+        for (int n = 0; n < 3; ++n) {
+            for (index_type s = 0, e = m_hi_[n] - m_lo_[n]; s < e; ++s) {
+                res.m_factor_[n][s] = m_factor_[n][s] == 0 ? 0 : 1 / m_factor_[n][s];
+            }
+        }
+        res.m_shift_ = m_shift_;
+        res.m_scale_ = m_scale_ == 0 ? 0 : 1 / m_scale_;
+        return res;
+    }
+
+    void Shift(index_type const* offset) {
+        for (int n = 0; n < 3; ++n) { m_shift_[n] += offset[n]; }
+    }
+    void Shift(nTuple<index_type, 3> const& offset) { Shift(&offset[0]); }
+    template <typename... Args>
+    this_type GetShift(Args&&... args) const {
+        this_type res(*this);
+        res.Shift(std::forward<Args>(args)...);
+        return res;
+    }
+
+    bool in_box(index_type i, index_type j, index_type k) const {
+        return m_holder_ != nullptr && m_lo_[0] + m_shift_[0] <= i && i < m_hi_[0] + m_shift_[0] &&
+               m_lo_[1] + m_shift_[1] <= j && j < m_hi_[1] + m_shift_[1] && m_lo_[2] + m_shift_[2] <= k &&
+               k < m_hi_[2] + m_shift_[2];
+    }
+
+    this_type operator-() const {
+        this_type res(*this);
+        res.m_scale_ = -m_scale_;
+        return res;
+    }
+
+    /** (i,j,k) must be inside GetIndexBox(), checked in debug builds */
+    __host__ __device__ V operator()(index_type i, index_type j, index_type k) const {
+        ASSERT(in_box(i, j, k));
+        return m_scale_ * m_factor_[0][i - m_shift_[0] - m_lo_[0]] * m_factor_[1][j - m_shift_[1] - m_lo_[1]] *
+               m_factor_[2][k - m_shift_[2] - m_lo_[2]];
+    }
+
+   private:
+    std::shared_ptr<V> m_holder_ = nullptr;
+    V* m_factor_[3] = {nullptr, nullptr, nullptr};
+    nTuple<index_type, 3> m_lo_{0, 0, 0};
+    nTuple<index_type, 3> m_hi_{0, 0, 0};
+    nTuple<index_type, 3> m_shift_{0, 0, 0};
+    V m_scale_ = 1;
+};
+
+}  // namespace simpla {
+#endif  // SIMPLA_SEPARABLEARRAY_H
@@ -0,0 +1,333 @@
+//
+// Bricked Morton (Z-order) space filling curve.
+//
+
+#ifndef SIMPLA_MORTON_SFC_H
+#define SIMPLA_MORTON_SFC_H
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <tuple>
+#include <vector>
+#include "simpla/SIMPLA_config.h"
+#include "simpla/algebra/nTuple.h"
+#include "z_sfc.h"
+
+#ifndef SP_ARRAY_BRICK_BITS
+#define SP_ARRAY_BRICK_BITS 2
+#endif
+
+namespace simpla {
+/**
+ * @brief Bricked Morton (Z-order) space filling curve.
+ *
+ *  The shape box is cut into bricks of (2^BRICK_BITS)^NDIMS points. Points in a brick are stored contiguously
+ *  (row-major in the brick), and bricks are stored in Morton order of the brick coordinates. The Morton codes are
+ *  ranked once, so that non power-of-two shapes do not leave holes in the storage.
+ *
+ *  The data is not a strided block, Array<V, MortonSFC<N>>::Linearize() converts it before it is written by HDF5/XDMF.
+ */
+template <int NDIMS, int BRICK_BITS = SP_ARRAY_BRICK_BITS>
+class MortonSFC {
+    typedef MortonSFC<NDIMS, BRICK_BITS> this_type;
+
+   public:
+    static constexpr int ndims = NDIMS;
+    static constexpr bool is_linear = false;
+    static constexpr index_type BRICK_WIDTH = 1L << BRICK_BITS;
+    static constexpr index_type BRICK_MASK = BRICK_WIDTH - 1;
+    static constexpr index_type BRICK_SIZE = 1L << (BRICK_BITS * NDIMS);
+
+    index_type m_index_min_[NDIMS] = {0};
+    index_type m_index_max_[NDIMS] = {0};
+    index_type m_shape_min_[NDIMS] = {0};
+    index_type m_shape_max_[NDIMS] = {0};
+    index_type m_brick_dims_[NDIMS] = {0};
+    /** rank of the Morton code of brick, indexed by the row-major brick number */
+    std::shared_ptr<const std::vector<index_type>> m_brick_rank_ = nullptr;
+
+    MortonSFC() = default;
+    ~MortonSFC() = default;
+    MortonSFC(this_type const& other) = default;
+    MortonSFC(this_type&& other) noexcept = default;
+    this_type& operator=(this_type const& other) = default;
+    this_type& operator=(this_type&& other) noexcept = default;
+
+    MortonSFC(index_type const* lo, index_type const* hi) {
+        index_type nbricks = 1;
+        for (int i = 0; i < NDIMS; ++i) {
+            m_index_min_[i] = lo[i];
+            m_index_max_[i] = hi[i];
+            m_shape_min_[i] = lo[i];
+            m_shape_max_[i] = hi[i];
+            m_brick_dims_[i] = std::max<index_type>(0, (hi[i] - lo[i] + BRICK_MASK) >> BRICK_BITS);
+            nbricks *= m_brick_dims_[i];
+        }
+        if (nbricks > 0) { m_brick_rank_ = make_brick_rank(m_brick_dims_); }
+    }
+
+    explicit MortonSFC(std::tuple<nTuple<index_type, NDIMS>, nTuple<index_type, NDIMS>> const& d)
+        : MortonSFC(&std::get<0>(d)[0], &std::get<1>(d)[0]) {}
+
+    MortonSFC(std::initializer_list<index_type> const& extents) {
+        index_type lo[NDIMS];
+        index_type hi[NDIMS];
+        for (int i = 0; i < NDIMS; ++i) { lo[i] = 0; }
+        int count = 0;
+        for (auto const& v : extents) {
+            hi[count] = v;
+            ++count;
+        }
+        reset(lo, hi);
+    }
+    MortonSFC(std::initializer_list<std::initializer_list<index_type>> const& extents) {
+        index_type lo[NDIMS];
+        index_type hi[NDIMS];
+        int count = 0;
+        for (auto const& v : *extents.begin()) {
+            lo[count] = v;
+            ++count;
+        }
+        count = 0;
+        for (auto const& v : *(extents.begin() + 1)) {
+            hi[count] = v;
+            ++count;
+        }
+        reset(lo, hi);
+    }
+
+    void swap(this_type& other) {
+        for (int i = 0; i < NDIMS; ++i) {
+            std::swap(m_index_min_[i], other.m_index_min_[i]);
+            std::swap(m_index_max_[i], other.m_index_max_[i]);
+            std::swap(m_shape_min_[i], other.m_shape_min_[i]);
+            std::swap(m_shape_max_[i], other.m_shape_max_[i]);
+            std::swap(m_brick_dims_[i], other.m_brick_dims_[i]);
+        }
+        std::swap(m_brick_rank_, other.m_brick_rank_);
+    }
+
+    template <int M>
+    void reset(std::tuple<nTuple<index_type, M>, nTuple<index_type, M>> const& b) {
+        reset(&std::get<0>(b)[0], &std::get<1>(b)[0], M);
+    }
+    void reset(index_type const* lo = nullptr, index_type const* hi = nullptr, int num_dims = NDIMS) {
+        if (lo == nullptr || hi == nullptr) {
+            this_type().swap(*this);
+        } else {
+            this_type(lo, hi).swap(*this);
+        }
+    }
+
+    static std::shared_ptr<const std::vector<index_type>> make_brick_rank(index_type const* dims) {
+        index_type num = 1;
+        for (int i = 0; i < NDIMS; ++i) { num *= dims[i]; }
+
+        std::vector<std::pair<index_type, index_type>> codes(static_cast<size_type>(num));
+        for (index_type n = 0; n < num; ++n) {
+            index_type b[NDIMS];
+            for (index_type i = NDIMS - 1, r = n; i >= 0; --i) {
+                b[i] = r % dims[i];
+                r /= dims[i];
+            }
+            index_type code = 0;
+            for (int bit = 0; bit < 20; ++bit) {
+                for (int i = 0; i < NDIMS; ++i) { code |= ((b[i] >> bit) & 1L) << (bit * NDIMS + NDIMS - 1 - i); }
+            }
+            codes[n] = std::make_pair(code, n);
+        }
+        std::sort(codes.begin(), codes.end());
+        auto res = std::make_shared<std::vector<index_type>>(static_cast<size_type>(num));
+        for (index_type r = 0; r < num; ++r) { (*res)[codes[r].second] = r; }
+        return res;
+    }
+
+    bool isSlowFirst() const { return true; };
+    size_type GetNDIMS() const { return static_cast<size_type>(ndims); }
+    size_type GetIndexBox(index_type* lo, index_type* hi) const {
+        for (int i = 0; i < ndims; ++i) {
+            if (lo != nullptr) { lo[i] = m_index_min_[i]; }
+            if (hi != nullptr) { hi[i] = m_index_max_[i]; }
+        }
+        return static_cast<size_type>(ndims);
+    }
+    size_type GetShape(index_type* lo, index_type* hi) const {
+        for (int i = 0; i < ndims; ++i) {
+            if (lo != nullptr) { lo[i] = m_shape_min_[i]; }
+            if (hi != nullptr) { hi[i] = m_shape_max_[i]; }
+        }
+        return static_cast<size_type>(ndims);
+    }
+    auto GetIndexBox() const {
+        std::tuple<nTuple<index_type, NDIMS>, nTuple<index_type, NDIMS>> res;
+        GetIndexBox(&std::get<0>(res)[0], &std::get<1>(res)[0]);
+        return res;
+    }
+    auto GetShape() const {
+        std::tuple<nTuple<index_type, NDIMS>, nTuple<index_type, NDIMS>> res;
+        GetShape(&std::get<0>(res)[0], &std::get<1>(res)[0]);
+        return res;
+    }
+    size_type size() const {
+        index_type res = 1;
+        for (int i = 0; i < ndims; ++i) { res *= m_index_max_[i] - m_index_min_[i]; }
+        return res > 0 ? static_cast<size_type>(res) : 0;
+    }
+    /** size of storage, including the padding of bricks on the upper boundary */
+    size_type shape_size() const { return m_brick_rank_ == nullptr ? 0 : m_brick_rank_->size() * BRICK_SIZE; }
+
+    void Select(index_type const* lo, index_type const* hi) {
+        for (int i = 0; i < NDIMS; ++i) {
+            m_index_min_[i] = (lo == nullptr) ? m_shape_min_[i] : std::max(lo[i], m_shape_min_[i]);
+            m_index_max_[i] = (hi == nullptr) ? m_shape_max_[i] : std::min(hi[i], m_shape_max_[i]);
+        }
+    }
+    void Select(std::tuple<nTuple<index_type, NDIMS>, nTuple<index_type, NDIMS>> const& b) {
+        Select(&std::get<0>(b)[0], &std::get<1>(b)[0]);
+    }
+    void Shift(index_type const* offset) {
+        for (int i = 0; i < ndims; ++i) {
+            m_index_min_[i] += offset[i];
+            m_index_max_[i] += offset[i];
+            m_shape_min_[i] += offset[i];
+            m_shape_max_[i] += offset[i];
+        }
+    }
+    void Shift(std::initializer_list<index_type> const& idx) {
+        std::vector<index_type> s;
+        for (auto const& v : idx) { s.push_back(v); }
+        for (auto i = s.size(); i < ndims; ++i) { s.push_back(0); }
+        Shift(&s[0]);
+    }
+    void Shift(nTuple<index_type, NDIMS> const& offset) { Shift(&offset[0]); }
+
+    template <typename... Args>
+    this_type GetShift(Args&&... args) const {
+        this_type res(*this);
+        res.Shift(std::forward<Args>(args)...);
+        return res;
+    }
+    template <typename... Args>
+    this_type GetSelection(Args&&... args) const {
+        this_type res(*this);
+        res.Select(std::forward<Args>(args)...);
+        return res;
+    }
+
+    __host__ __device__ index_type hash(index_type const* s) const {
+        index_type brick = 0;
+        index_type local = 0;
+        for (int i = 0; i < NDIMS; ++i) {
+            index_type x = s[i] - m_shape_min_[i];
+            brick = brick * m_brick_dims_[i] + (x >> BRICK_BITS);
+            local = (local << BRICK_BITS) | (x & BRICK_MASK);
+        }
+        return (*m_brick_rank_)[brick] * BRICK_SIZE + local;
+    }
+    __host__ __device__ bool in_box(index_type const* s) const {
+        bool res = true;
+        for (int i = 0; i < NDIMS; ++i) { res = res && s[i] >= m_shape_min_[i] && s[i] < m_shape_max_[i]; }
+        return res;
+    }
+    template <typename... Args>
+    __host__ __device__ index_type hash(index_type i0, Args&&... args) const {
+        index_type s[NDIMS] = {i0, static_cast<index_type>(args)...};
+        return hash(s);
+    }
+    template <typename... Args>
+    __host__ __device__ bool in_box(index_type i0, Args&&... args) const {
+        index_type s[NDIMS] = {i0, static_cast<index_type>(args)...};
+        return in_box(s);
+    }
+    __host__ __device__ index_type hash(nTuple<index_type, NDIMS> const& idx) const { return hash(&idx[0]); }
+    __host__ __device__ bool in_box(nTuple<index_type, NDIMS> const& idx) const { return in_box(&idx[0]); }
+
+    this_type Overlap(std::nullptr_t) const { return *this; }
+    template <typename RHS>
+    this_type Overlap(RHS const& rhs) const {
+        this_type res(*this);
+        res.Select(detail::overlap<NDIMS>(GetShape(), rhs));
+        return res;
+    };
+    /** the index box of rhs clipped to the shape of this, so that a copy from rhs reads only its defined points */
+    this_type Overlap(this_type const& rhs) const {
+        this_type res(*this);
+        res.Select(detail::overlap<NDIMS>(GetShape(), rhs.GetIndexBox()));
+        return res;
+    }
+
+    /**
+     * Traverse the index box brick by brick, call fun(idx...) at each point. Only NDIMS == 3 is implemented.
+     */
+    template <typename TFun>
+    size_type Foreach(const TFun& fun) const;
+    /**
+     * Same traversal as Foreach, call fun(s, idx...) where s is the offset of idx in the storage. Points of one
+     * row in a brick are contiguous and the row loop is marked `omp simd`.
+     */
+    template <typename TFun>
+    size_type ForeachOffset(const TFun& fun) const;
+};
+template <int NDIMS, int BRICK_BITS>
+constexpr index_type MortonSFC<NDIMS, BRICK_BITS>::BRICK_WIDTH;
+template <int NDIMS, int BRICK_BITS>
+constexpr index_type MortonSFC<NDIMS, BRICK_BITS>::BRICK_MASK;
+template <int NDIMS, int BRICK_BITS>
+constexpr index_type MortonSFC<NDIMS, BRICK_BITS>::BRICK_SIZE;
+
+namespace detail {
+template <typename TSIMD, int BRICK_BITS, typename TFun>
+void morton_foreach_brick(TSIMD simd, MortonSFC<3, BRICK_BITS> const& sfc, TFun const& fun) {
+    typedef MortonSFC<3, BRICK_BITS> sfc_type;
+    index_type const* o = sfc.m_shape_min_;
+    index_type const* lo = sfc.m_index_min_;
+    index_type const* hi = sfc.m_index_max_;
+    index_type const* nb = sfc.m_brick_dims_;
+    index_type const* rank = &(*sfc.m_brick_rank_)[0];
+
+    index_type bib = (lo[0] - o[0]) >> BRICK_BITS, bie = ((hi[0] - o[0] - 1) >> BRICK_BITS) + 1;
+    index_type bjb = (lo[1] - o[1]) >> BRICK_BITS, bje = ((hi[1] - o[1] - 1) >> BRICK_BITS) + 1;
+    index_type bkb = (lo[2] - o[2]) >> BRICK_BITS, bke = ((hi[2] - o[2] - 1) >> BRICK_BITS) + 1;
+
+#pragma omp parallel for collapse(3) schedule(static)
+    for (index_type bi = bib; bi < bie; ++bi)
+        for (index_type bj = bjb; bj < bje; ++bj)
+            for (index_type bk = bkb; bk < bke; ++bk) {
+                index_type I = o[0] + (bi << BRICK_BITS);
+                index_type J = o[1] + (bj << BRICK_BITS);
+                index_type K = o[2] + (bk << BRICK_BITS);
+                index_type i0 = std::max(I, lo[0]), i1 = std::min(I + sfc_type::BRICK_WIDTH, hi[0]);
+                index_type j0 = std::max(J, lo[1]), j1 = std::min(J + sfc_type::BRICK_WIDTH, hi[1]);
+                index_type k0 = std::max(K, lo[2]), k1 = std::min(K + sfc_type::BRICK_WIDTH, hi[2]);
+                index_type base = rank[(bi * nb[1] + bj) * nb[2] + bk] * sfc_type::BRICK_SIZE;
+                for (index_type i = i0; i < i1; ++i)
+                    for (index_type j = j0; j < j1; ++j) {
+                        index_type s0 = base + ((((i - I) << BRICK_BITS) + (j - J)) << BRICK_BITS) - K;
+                        zsfc_row(simd, k0, k1, [&](index_type k) { fun(s0 + k, i, j, k); });
+                    }
+            }
+}
+}  // namespace detail
+
+template <int NDIMS, int BRICK_BITS>
+template <typename TFun>
+size_type MortonSFC<NDIMS, BRICK_BITS>::Foreach(const TFun& fun) const {
+    static_assert(NDIMS == 3, "MortonSFC::Foreach is only implemented for NDIMS == 3");
+    auto count = size();
+    if (count == 0) { return count; }
+    detail::morton_foreach_brick(std::false_type(), *this,
+                                 [&](index_type s, index_type i, index_type j, index_type k) { fun(i, j, k); });
+    return count;
+}
+template <int NDIMS, int BRICK_BITS>
+template <typename TFun>
+size_type MortonSFC<NDIMS, BRICK_BITS>::ForeachOffset(const TFun& fun) const {
+    static_assert(NDIMS == 3, "MortonSFC::ForeachOffset is only implemented for NDIMS == 3");
+    auto count = size();
+    if (count == 0) { return count; }
+    detail::morton_foreach_brick(std::true_type(), *this, fun);
+    return count;
+}
+}  // namespace simpla
+#endif  // SIMPLA_MORTON_SFC_H
@@ -12,23 +12,31 @@
 #include <limits>
 #include <tuple>
 #include <utility>
+#include <vector>
 #include "simpla/SIMPLA_config.h"
 #include "simpla/algebra/EntityId.h"
 #include "simpla/algebra/nTuple.ext.h"
 #include "simpla/algebra/nTuple.h"
 #include "simpla/utilities/memory.h"
 
+#ifndef SP_ARRAY_TILE_SIZE
+#define SP_ARRAY_TILE_SIZE 8
+#endif
+
 namespace simpla {
 enum enumArrayOrder { SLOW_FIRST = 0, FAST_FIRST = 1 };
 
 template <typename V, typename SFC>
 struct Array;
+template <typename V>
+class SeparableArray;
 template <int NDIMS>
 class ZSFC {
     typedef ZSFC<NDIMS> this_type;
 
    public:
     static constexpr int ndims = NDIMS;
+    static constexpr bool is_linear = true;
     enum enumArrayOrder m_array_order_ = SLOW_FIRST;
 
     index_type m_index_min_[NDIMS] = {0};
@@ -36,6 +44,8 @@ class ZSFC {
     index_type m_shape_min_[NDIMS] = {0};
     index_type m_shape_max_[NDIMS] = {1};
     index_type m_strides_[NDIMS] = {1};
+    /** tile shape of traversal, 0 means the whole extent along that direction */
+    index_type m_tile_shape_[NDIMS] = {0};
 
     ZSFC() = default;
     ~ZSFC() = default;
@@ -47,6 +57,7 @@ class ZSFC {
             m_shape_min_[i] = other.m_shape_min_[i];
             m_shape_max_[i] = other.m_shape_max_[i];
             m_strides_[i] = other.m_strides_[i];
+            m_tile_shape_[i] = other.m_tile_shape_[i];
         }
     }
     ZSFC(this_type&& other) noexcept : m_array_order_(other.m_array_order_) {
@@ -56,6 +67,7 @@ class ZSFC {
             m_shape_min_[i] = other.m_shape_min_[i];
             m_shape_max_[i] = other.m_shape_max_[i];
             m_strides_[i] = other.m_strides_[i];
+            m_tile_shape_[i] = other.m_tile_shape_[i];
         }
     }
 
@@ -67,7 +79,10 @@ class ZSFC {
             m_shape_min_[i] = lo[i];
             m_shape_max_[i] = hi[i];
             m_strides_[i] = 1;
+            m_tile_shape_[i] = SP_ARRAY_TILE_SIZE;
         }
+        // the unit-stride direction is not tiled, so that the innermost loop is as long as possible
+        m_tile_shape_[m_array_order_ == FAST_FIRST ? 0 : NDIMS - 1] = 0;
 
         if (m_array_order_ == FAST_FIRST) {
             m_strides_[0] = 1;
@@ -133,6 +148,7 @@ class ZSFC {
             std::swap(m_shape_min_[i], other.m_shape_min_[i]);
             std::swap(m_shape_max_[i], other.m_shape_max_[i]);
             std::swap(m_strides_[i], other.m_strides_[i]);
+            std::swap(m_tile_shape_[i], other.m_tile_shape_[i]);
         }
     }
 
@@ -144,6 +160,14 @@ class ZSFC {
         this_type(lo, hi, m_array_order_).swap(*this);
     }
     bool isSlowFirst() const { return m_array_order_ == SLOW_FIRST; };
+    void SetTileShape(index_type const* tile) {
+        for (int i = 0; i < NDIMS; ++i) { m_tile_shape_[i] = (tile == nullptr) ? 0 : std::max<index_type>(tile[i], 0); }
+    }
+    void SetTileShape(nTuple<index_type, NDIMS> const& tile) { SetTileShape(&tile[0]); }
+    size_type GetTileShape(index_type* tile) const {
+        for (int i = 0; i < ndims; ++i) { tile[i] = m_tile_shape_[i]; }
+        return static_cast<size_type>(ndims);
+    }
     size_type GetNDIMS() const { return static_cast<size_type>(ndims); }
     size_type GetIndexBox(index_type* lo, index_type* hi) const {
         for (int i = 0; i < ndims; ++i) {
@@ -250,8 +274,25 @@ class ZSFC {
     this_type Overlap(RHS const& rhs) const;
     this_type Overlap(this_type const& rhs) const;
 
+    /**
+     * Traverse the index box tile by tile, call fun(idx...) at each point.
+     */
     template <typename TFun>
     size_type Foreach(const TFun& fun) const;
+    /**
+     * Same traversal as Foreach, call fun(s, idx...) where s is the linear offset of idx in this SFC.
+     * The innermost loop runs along the unit-stride direction and is marked `omp simd`, so fun must be an
+     * element-wise kernel without dependence between points.
+     */
+    template <typename TFun>
+    size_type ForeachOffset(const TFun& fun) const;
+    /**
+     * Same traversal as ForeachOffset, fold  res = op(res, fun(s, idx...))  from init, which must be the identity of
+     * op. Every tile is folded by one thread, the partial results are combined in the order of the tiles, so the
+     * result does not depend on the number of threads.
+     */
+    template <typename T, typename TOp, typename TFun>
+    T ReduceOffset(T init, const TOp& op, const TFun& fun) const;
 };
 
 namespace detail {
@@ -307,10 +348,14 @@ std::tuple<nTuple<index_type, N>, nTuple<index_type, N>> overlap(T const&) {
     return res;
 }
 
-template <int N, typename U>
-std::tuple<nTuple<index_type, N>, nTuple<index_type, N>> overlap(Array<U, ZSFC<N>> const& a) {
+template <int N, typename U, typename SFC>
+std::tuple<nTuple<index_type, N>, nTuple<index_type, N>> overlap(Array<U, SFC> const& a) {
     return a.GetSpaceFillingCurve().GetIndexBox();
 }
+template <int N, typename U>
+std::tuple<nTuple<index_type, N>, nTuple<index_type, N>> overlap(SeparableArray<U> const& a) {
+    return a.GetIndexBox();
+}
 template <int N, int M>
 std::tuple<nTuple<index_type, N>, nTuple<index_type, N>> overlap(
     std::tuple<nTuple<index_type, N>, nTuple<index_type, N>> const& a) {
@@ -360,6 +405,37 @@ ZSFC<NDIMS> ZSFC<NDIMS>::Overlap(this_type const& rhs) const {
     return res;
 }
 
+namespace detail {
+/**
+ *  Serial copy of the sub-box [lo,hi) from src to dst, which must lie in both index boxes. If both have the same order
+ *  and a unit stride, a row along the unit-stride direction is one contiguous block, copied by std::copy.
+ */
+template <typename V>
+size_type zsfc_copy_box(V* dst, ZSFC<3> const& dst_sfc, V const* src, ZSFC<3> const& src_sfc, index_type const* lo,
+                        index_type const* hi) {
+    for (int n = 0; n < 3; ++n) {
+        if (hi[n] <= lo[n]) { return 0; }
+    }
+    int u = dst_sfc.m_array_order_ == SLOW_FIRST ? 2 : 0;
+    int w = 2 - u;
+    index_type idx[3];
+    if (dst_sfc.m_array_order_ == src_sfc.m_array_order_ && dst_sfc.m_strides_[u] == 1 &&
+        src_sfc.m_strides_[u] == 1) {
+        idx[u] = lo[u];
+        for (idx[w] = lo[w]; idx[w] < hi[w]; ++idx[w])
+            for (idx[1] = lo[1]; idx[1] < hi[1]; ++idx[1]) {
+                V const* first = src + src_sfc.hash(idx);
+                std::copy(first, first + (hi[u] - lo[u]), dst + dst_sfc.hash(idx));
+            }
+    } else {
+        for (idx[w] = lo[w]; idx[w] < hi[w]; ++idx[w])
+            for (idx[1] = lo[1]; idx[1] < hi[1]; ++idx[1])
+                for (idx[u] = lo[u]; idx[u] < hi[u]; ++idx[u]) { dst[dst_sfc.hash(idx)] = src[src_sfc.hash(idx)]; }
+    }
+    return static_cast<size_type>((hi[0] - lo[0]) * (hi[1] - lo[1]) * (hi[2] - lo[2]));
+}
+}  // namespace detail
+
 // template <>
 // template <typename LHS, typename RHS>
 // size_type ZSFC<3>::Copy(LHS& dst, RHS const& src) const {
@@ -398,33 +474,147 @@ __global__ void foreach_device(nTuple<index_type, 3> min, nTuple<index_type, 3>
 };
 
 #endif
+#ifndef __CUDA__
+namespace detail {
+template <typename TBody>
+void zsfc_row(std::false_type, index_type xb, index_type xe, TBody const& body) {
+    for (index_type x = xb; x < xe; ++x) { body(x); }
+}
+template <typename TBody>
+void zsfc_row(std::true_type, index_type xb, index_type xe, TBody const& body) {
+#pragma omp simd
+    for (index_type x = xb; x < xe; ++x) { body(x); }
+}
+/**
+ *  Serial traversal of the sub-box [lo,hi) of sfc, row by row along the unit-stride direction. The offset of the
+ *  first point of a row is computed once, so the offset of the point x in a row is  s0 + x.
+ */
+template <typename TSIMD, typename TFun>
+void zsfc_foreach_box(TSIMD simd, ZSFC<3> const& sfc, index_type const* lo, index_type const* hi, TFun const& fun) {
+    index_type const* o = sfc.m_shape_min_;
+    index_type const* d = sfc.m_strides_;
+    if (sfc.m_array_order_ == SLOW_FIRST) {
+        for (index_type i = lo[0]; i < hi[0]; ++i)
+            for (index_type j = lo[1]; j < hi[1]; ++j) {
+                index_type s0 = (i - o[0]) * d[0] + (j - o[1]) * d[1] - o[2];
+                zsfc_row(simd, lo[2], hi[2], [&](index_type k) { fun(s0 + k, i, j, k); });
+            }
+    } else {
+        for (index_type k = lo[2]; k < hi[2]; ++k)
+            for (index_type j = lo[1]; j < hi[1]; ++j) {
+                index_type s0 = (k - o[2]) * d[2] + (j - o[1]) * d[1] - o[0];
+                zsfc_row(simd, lo[0], hi[0], [&](index_type i) { fun(s0 + i, i, j, k); });
+            }
+    }
+}
+/**
+ *  Tiled traversal of a 3D index box: tiles are distributed over threads by a collapsed parallel loop, points in
+ *  one tile are visited by zsfc_foreach_box.
+ */
+template <typename TSIMD, typename TFun>
+void zsfc_foreach_tiled(TSIMD simd, ZSFC<3> const& sfc, TFun const& fun) {
+    index_type ib = sfc.m_index_min_[0];
+    index_type ie = sfc.m_index_max_[0];
+    index_type jb = sfc.m_index_min_[1];
+    index_type je = sfc.m_index_max_[1];
+    index_type kb = sfc.m_index_min_[2];
+    index_type ke = sfc.m_index_max_[2];
+    index_type ti = sfc.m_tile_shape_[0] > 0 ? sfc.m_tile_shape_[0] : ie - ib;
+    index_type tj = sfc.m_tile_shape_[1] > 0 ? sfc.m_tile_shape_[1] : je - jb;
+    index_type tk = sfc.m_tile_shape_[2] > 0 ? sfc.m_tile_shape_[2] : ke - kb;
+
+    if (sfc.m_array_order_ == SLOW_FIRST) {
+#pragma omp parallel for collapse(3) schedule(static)
+        for (index_type I = ib; I < ie; I += ti)
+            for (index_type J = jb; J < je; J += tj)
+                for (index_type K = kb; K < ke; K += tk) {
+                    index_type lo[3] = {I, J, K};
+                    index_type hi[3] = {std::min(I + ti, ie), std::min(J + tj, je), std::min(K + tk, ke)};
+                    zsfc_foreach_box(simd, sfc, lo, hi, fun);
+                }
+    } else {
+#pragma omp parallel for collapse(3) schedule(static)
+        for (index_type K = kb; K < ke; K += tk)
+            for (index_type J = jb; J < je; J += tj)
+                for (index_type I = ib; I < ie; I += ti) {
+                    index_type lo[3] = {I, J, K};
+                    index_type hi[3] = {std::min(I + ti, ie), std::min(J + tj, je), std::min(K + tk, ke)};
+                    zsfc_foreach_box(simd, sfc, lo, hi, fun);
+                }
+    }
+}
+/**
+ *  Tiled fold of a 3D index box, see ZSFC::ReduceOffset. The partial result of the tile t is kept in partial[t], so
+ *  the tiles are folded by a parallel loop without a critical section.
+ */
+template <typename T, typename TOp, typename TFun>
+T zsfc_reduce_tiled(ZSFC<3> const& sfc, T init, TOp const& op, TFun const& fun) {
+    index_type b[3], e[3], t[3], n[3];
+    for (int d = 0; d < 3; ++d) {
+        b[d] = sfc.m_index_min_[d];
+        e[d] = sfc.m_index_max_[d];
+        t[d] = sfc.m_tile_shape_[d] > 0 ? sfc.m_tile_shape_[d] : std::max<index_type>(e[d] - b[d], 1);
+        n[d] = std::max<index_type>((e[d] - b[d] + t[d] - 1) / t[d], 0);
+    }
+    // the tiles are numbered with the unit-stride direction fastest, as zsfc_foreach_tiled visits them
+    int d0 = sfc.m_array_order_ == SLOW_FIRST ? 0 : 2;
+    int d2 = 2 - d0;
+    std::vector<T> partial(static_cast<size_type>(n[0] * n[1] * n[2]), init);
+    index_type num = static_cast<index_type>(partial.size());
+#pragma omp parallel for schedule(static)
+    for (index_type s = 0; s < num; ++s) {
+        index_type tile[3];
+        tile[d2] = s % n[d2];
+        tile[1] = (s / n[d2]) % n[1];
+        tile[d0] = s / (n[d2] * n[1]);
+        index_type lo[3], hi[3];
+        for (int d = 0; d < 3; ++d) {
+            lo[d] = b[d] + tile[d] * t[d];
+            hi[d] = std::min(lo[d] + t[d], e[d]);
+        }
+        T res = init;
+        zsfc_foreach_box(std::false_type(), sfc, lo, hi, [&](index_type s0, index_type i, index_type j, index_type k) {
+            res = op(res, fun(s0, i, j, k));
+        });
+        partial[s] = res;
+    }
+    T res = init;
+    for (auto const& v : partial) { res = op(res, v); }
+    return res;
+}
+}  // namespace detail
+
+template <>
+template <typename T, typename TOp, typename TFun>
+T ZSFC<3>::ReduceOffset(T init, const TOp& op, const TFun& fun) const {
+    if (size() == 0) { return init; }
+    return detail::zsfc_reduce_tiled(*this, init, op, fun);
+}
 template <>
 template <typename TFun>
 size_type ZSFC<3>::Foreach(const TFun& fun) const {
     auto count = size();
     if (count == 0) { return count; }
-    index_type ib = m_index_min_[0];
-    index_type ie = m_index_max_[0];
-    index_type jb = m_index_min_[1];
-    index_type je = m_index_max_[1];
-    index_type kb = m_index_min_[2];
-    index_type ke = m_index_max_[2];
-    count = static_cast<size_type>((ke - kb) * (je - jb) * (ie - ib));
-#ifndef __CUDA__
-    if (m_array_order_ == SLOW_FIRST) {
-#pragma omp parallel for
-        for (index_type k = kb; k < ke; ++k)
-            for (index_type j = jb; j < je; ++j)
-                for (index_type i = ib; i < ie; ++i) { fun(i, j, k); }
-
-    } else {
-#pragma omp parallel for
-        for (index_type i = ib; i < ie; ++i)
-            for (index_type j = jb; j < je; ++j)
-                for (index_type k = kb; k < ke; ++k) { fun(i, j, k); }
-    }
+    detail::zsfc_foreach_tiled(std::false_type(), *this,
+                               [&](index_type s, index_type i, index_type j, index_type k) { fun(i, j, k); });
+    return count;
+}
+template <>
+template <typename TFun>
+size_type ZSFC<3>::ForeachOffset(const TFun& fun) const {
+    auto count = size();
+    if (count == 0) { return count; }
+    detail::zsfc_foreach_tiled(std::true_type(), *this, fun);
+    return count;
+}
 #else
 
+template <>
+template <typename TFun>
+size_type ZSFC<3>::Foreach(const TFun& fun) const {
+    auto count = size();
+    if (count == 0) { return count; }
+
     dim3 threadsPerBlock{4, 4, 4};
 
     dim3 numBlocks{static_cast<uint>(m_index_max_[0] - m_index_min_[0] + threadsPerBlock.x) / threadsPerBlock.x,
@@ -433,9 +623,14 @@ size_type ZSFC<3>::Foreach(const TFun& fun) const {
 
     SP_CALL_DEVICE_KERNEL(foreach_device, numBlocks, threadsPerBlock, m_index_min_, m_index_max_, fun);
 
-#endif
     return count;
 }
+template <>
+template <typename TFun>
+size_type ZSFC<3>::ForeachOffset(const TFun& fun) const {
+    return Foreach([=] __device__(index_type i, index_type j, index_type k) { fun(hash(i, j, k), i, j, k); });
+}
+#endif
 
 }  // namespace simpla
 #endif  // SIMPLA_Z_SFC_H
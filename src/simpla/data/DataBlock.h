@@ -6,6 +6,7 @@
 #define SIMPLA_DATABLOCK_H
 #include "simpla/SIMPLA_config.h"
 
+#include <cstring>
 #include "DataEntity.h"
 #include "simpla/algebra/Array.h"
 namespace simpla {
@@ -44,6 +45,15 @@ struct DataBlock : public DataEntity, public Array<V> {
     void const *GetPointer() const override { return Array<V>::get(); }
 
     void Clear() override { array_type::Clear(); };
+    /** copy of the whole array, ghost cells included, into a block of the memory pool */
+    std::shared_ptr<DataEntity> Copy() const override {
+        auto res = New(array_type::GetSpaceFillingCurve());
+        if (array_type::get() != nullptr) {
+            res->alloc();
+            std::memcpy(res->get(), array_type::get(), array_type::GetSpaceFillingCurve().shape_size() * sizeof(V));
+        }
+        return res;
+    }
 
     //    size_type CopyIn(DataBlock const &other, index_type const *lo, index_type const *hi) override {
     //        size_type count = 0;
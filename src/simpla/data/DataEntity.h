@@ -28,7 +28,8 @@ struct DataEntity : public std::enable_shared_from_this<DataEntity> {
     virtual ~DataEntity() = default;
 
     static std::shared_ptr<DataEntity> New() { return std::shared_ptr<DataEntity>(new DataEntity); }
-    std::shared_ptr<DataEntity> Copy() const { return nullptr; }
+    /** deep copy, nullptr if the entity is not copied (it is shared) */
+    virtual std::shared_ptr<DataEntity> Copy() const { return nullptr; }
     virtual std::type_info const& value_type_info() const { return typeid(void); };
     virtual size_type value_alignof() const { return 0; };
     virtual size_type value_sizeof() const { return 0; };
@@ -44,6 +45,14 @@ struct DataEntity : public std::enable_shared_from_this<DataEntity> {
     virtual void* GetPointer() { return nullptr; }
     virtual void const* GetPointer() const { return nullptr; }
 
+    /**
+     * append the content to buf, e.g. to move it to another process, an entity which can be packed is created by
+     * Factory<DataEntity> with the key FancyTypeName() before Unpack. @return false if it can not be packed
+     */
+    virtual bool Pack(std::string* buf) const { return false; }
+    /** restore the content written by Pack, @return the position after it */
+    virtual char const* Unpack(char const* p) { return p; }
+
     virtual bool equal(DataEntity const& other) const { return false; }
     bool operator==(DataEntity const& other) { return equal(other); }
 
@@ -33,6 +33,10 @@ struct DataEntryHDF5 : public DataEntry {
     std::shared_ptr<DataEntry> CreateNode(eNodeType e_type) const override;
     size_type size() const override;
     size_type Set(std::string const& uri, std::shared_ptr<const DataEntry> const& v) override;
+    //! DataEntry::Set(tree) passes non-const children, written like the const ones
+    size_type Set(std::string const& uri, std::shared_ptr<DataEntry> const& v) override {
+        return Set(uri, std::shared_ptr<const DataEntry>(v));
+    }
     size_type Set(index_type s, std::shared_ptr<const DataEntry> const& v) override;
 
     size_type Add(std::string const& uri, std::shared_ptr<const DataEntry> const& v) override;
@@ -0,0 +1,367 @@
+//
+// Checkpoint in one HDF5 file shared by all processes.
+//
+#include <simpla/parallel/MPIComm.h>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+#include "simpla/algebra/EntityId.h"
+#include "../DataBlock.h"
+#include "../DataEntry.h"
+#include "DataEntryMemory.h"
+#include "HDF5Common.h"
+#if defined(MPI_FOUND) && defined(H5_HAVE_PARALLEL)
+#include <mpi.h>
+#define SP_HDF5_PARALLEL
+#endif
+
+namespace simpla {
+namespace data {
+/**
+ * @brief checkpoint in one HDF5 file shared by all processes.
+ *
+ *  The tree is built in memory and written on Flush, which must be called by every process:
+ *
+ *      /               attribute "Time"
+ *      /Atlas/Patches  [num of patches, 7] : GUID, LowIndex, HighIndex , ordered by rank
+ *      /Attributes/<name> [nx, ny, nz, num of sub] on the bounding box of all patches, attributes "LowIndex", "IFORM"
+ *
+ *  A component which lies on the nodes along an axis has one more point at the upper boundary along that axis, e.g.
+ *  the x-edges along y and z. The dataset covers the upper points of all its components, the points a component
+ *  does not have are left to the fill value.
+ *
+ *  An attribute with "Compression" is chunked by the largest patch and deflated, patches which are all zero are
+ *  not written.
+ *
+ *  Every process writes the index box of its patches as hyperslabs, ghost cells are not written. With parallel HDF5
+ *  the file is opened through MPI-IO, the metadata operations and H5Dwrite are collective, patches are written in
+ *  rounds of one patch per process. Otherwise the processes take turns on the file with serial HDF5.
+ */
+struct DataEntryHDF5Shared : public DataEntryMemory {
+    SP_DATA_ENTITY_HEAD(DataEntryMemory, DataEntryHDF5Shared, ph5)
+
+    int Connect(std::string const &authority, std::string const &path, std::string const &query,
+                std::string const &fragment) override;
+    int Disconnect() override;
+    int Flush() override;
+    bool isValid() const override { return !m_filename_.empty(); }
+
+    std::string m_filename_;
+};
+SP_REGISTER_CREATOR(DataEntry, DataEntryHDF5Shared);
+
+DataEntryHDF5Shared::DataEntryHDF5Shared(DataEntry::eNodeType etype) : DataEntryMemory(etype) {}
+DataEntryHDF5Shared::DataEntryHDF5Shared(DataEntryHDF5Shared const &other) = default;
+DataEntryHDF5Shared::~DataEntryHDF5Shared() = default;
+
+int DataEntryHDF5Shared::Connect(std::string const &authority, std::string const &path, std::string const &query,
+                                 std::string const &fragment) {
+    auto pos = path.rfind('.');
+    m_filename_ = ((pos != std::string::npos) ? path.substr(0, pos) : path) + ".h5";
+    return SP_SUCCESS;
+}
+int DataEntryHDF5Shared::Disconnect() { return SP_SUCCESS; }
+
+namespace detail {
+struct h5_patch_s {
+    index_type guid;
+    index_box_type box;
+    std::shared_ptr<const DataEntry> attrs;
+};
+struct h5_attr_s {
+    std::string value_type;
+    int iform = NODE;
+    int num_of_sub = 1;
+    int compression = 0;
+};
+static std::type_info const &h5_value_type(std::string const &name) {
+    static std::type_info const *types[] = {&typeid(double),       &typeid(float),         &typeid(int),
+                                            &typeid(long),         &typeid(unsigned int),  &typeid(unsigned long),
+                                            &typeid(long long),    &typeid(unsigned long long)};
+    for (auto const *t : types) {
+        if (name == t->name()) { return *t; }
+    }
+    RUNTIME_ERROR << "Unsupported value type [" << name << "]" << std::endl;
+    return typeid(double);
+}
+/** upper index of component n, one more along the axes on which it lies on the nodes, see EntityIdCoder */
+static index_tuple h5_upper(index_tuple const &hi, int iform, int num_of_sub, int n) {
+    int tag = 0b111;
+    if (iform == NODE) {
+        tag = 0b000;
+    } else if (iform == EDGE || iform == FACE) {
+        tag = EntityIdCoder::m_sub_index_to_id_[iform][n / std::max(num_of_sub / 3, 1)];
+    }
+    index_tuple res = hi;
+    for (int i = 0; i < 3; ++i) {
+        if ((tag & (1 << i)) == 0) { res[i] += 1; }
+    }
+    return res;
+}
+static std::shared_ptr<const ArrayBase> h5_component(std::shared_ptr<const DataEntry> const &data, int n) {
+    std::shared_ptr<const ArrayBase> res = nullptr;
+    if (data == nullptr) {
+    } else if (data->type() == DataEntry::DN_ARRAY) {
+        res = std::dynamic_pointer_cast<const ArrayBase>(data->GetEntity(n));
+    } else if (n == 0) {
+        res = std::dynamic_pointer_cast<const ArrayBase>(data->GetEntity());
+    }
+    if (res != nullptr && !res->isLinear()) { res = res->Linearize(); }
+    return res;
+}
+/**
+ * select the part of the component in box on the memory and file space, @return false if nothing is selected.
+ * If skip_zero, a part which is all zero is not selected, it is left to the fill value of the chunked dataset.
+ */
+static bool h5_select(ArrayBase const &array, index_box_type box, index_tuple const &g_lo, int n, hid_t m_space,
+                      hid_t f_space, bool skip_zero) {
+    index_type lo[3], hi[3], outer_lo[3], outer_hi[3];
+    array.GetIndexBox(lo, hi);
+    array.GetShape(outer_lo, outer_hi);
+    if (!array.isSlowFirst()) { UNIMPLEMENTED; }
+    hsize_t m_dims[3], m_start[3], f_start[4], count[4], one[4] = {1, 1, 1, 1};
+    bool success = true;
+    for (int i = 0; i < 3; ++i) {
+        m_dims[i] = static_cast<hsize_t>(outer_hi[i] - outer_lo[i]);
+        lo[i] = std::max(lo[i], std::get<0>(box)[i]);
+        hi[i] = std::min(hi[i], std::get<1>(box)[i]);
+        success = success && hi[i] > lo[i];
+        m_start[i] = static_cast<hsize_t>(lo[i] - outer_lo[i]);
+        f_start[i] = static_cast<hsize_t>(lo[i] - g_lo[i]);
+        count[i] = static_cast<hsize_t>(hi[i] - lo[i]);
+    }
+    f_start[3] = static_cast<hsize_t>(n);
+    count[3] = 1;
+    if (success && skip_zero) {
+        hid_t d_type = H5NumberType(array.value_type_info());
+        success = !HDF5IsZero(array.pointer(), H5Tget_size(d_type), 3, m_dims, m_start, count);
+    }
+    if (success) {
+        H5_ERROR(H5Sselect_hyperslab(m_space, H5S_SELECT_SET, m_start, one, count, one));
+        H5_ERROR(H5Sselect_hyperslab(f_space, H5S_SELECT_SET, f_start, one, count, one));
+    } else {
+        H5_ERROR(H5Sselect_none(m_space));
+        H5_ERROR(H5Sselect_none(f_space));
+    }
+    return success;
+}
+}  // namespace detail
+
+int DataEntryHDF5Shared::Flush() {
+    if (!isValid()) { return SP_FAILED; }
+    std::vector<detail::h5_patch_s> patches;
+    std::map<std::string, detail::h5_attr_s> attrs;
+
+    index_tuple g_lo{std::numeric_limits<index_type>::max(), std::numeric_limits<index_type>::max(),
+                     std::numeric_limits<index_type>::max()};
+    index_tuple g_hi{std::numeric_limits<index_type>::min(), std::numeric_limits<index_type>::min(),
+                     std::numeric_limits<index_type>::min()};
+    index_tuple chunk{0, 0, 0};
+    std::ostringstream os;
+    if (auto atlas_patches = this->Get("Atlas/Patches")) {
+        atlas_patches->Foreach([&](std::string const &k, std::shared_ptr<const DataEntry> const &patch) {
+            auto mblk = patch->Get("MeshBlock");
+            detail::h5_patch_s p;
+            p.guid = static_cast<index_type>(mblk->GetValue<id_type>("GUID"));
+            p.box = index_box_type{mblk->GetValue<index_tuple>("LowIndex"), mblk->GetValue<index_tuple>("HighIndex")};
+            p.attrs = patch->Get("Attributes");
+            for (int i = 0; i < 3; ++i) {
+                g_lo[i] = std::min(g_lo[i], std::get<0>(p.box)[i]);
+                g_hi[i] = std::max(g_hi[i], std::get<1>(p.box)[i]);
+            }
+            if (p.attrs != nullptr) {
+                p.attrs->Foreach([&](std::string const &s, std::shared_ptr<const DataEntry> const &d) {
+                    auto data = d->Get("_DATA_");
+                    if (auto array = detail::h5_component(data, 0)) {
+                        os << s << " " << array->value_type_info().name() << " " << d->GetValue<int>("IFORM", NODE)
+                           << " " << (data->type() == DataEntry::DN_ARRAY ? data->size() : 1) << " "
+                           << d->GetValue<int>("Compression", 0) << std::endl;
+                    }
+                    return 1;
+                });
+            }
+            for (int i = 0; i < 3; ++i) {
+                chunk[i] = std::max(chunk[i], std::get<1>(p.box)[i] - std::get<0>(p.box)[i]);
+            }
+            patches.push_back(p);
+            return 1;
+        });
+    }
+    // all processes agree on the bounding box and on the catalogue of attributes, sorted by name
+    GLOBAL_COMM.all_reduce_min(&g_lo[0], 3);
+    GLOBAL_COMM.all_reduce_max(&g_hi[0], 3);
+    // compressed datasets are chunked by the largest patch
+    GLOBAL_COMM.all_reduce_max(&chunk[0], 3);
+    {
+        std::istringstream is(parallel::gather_string(os.str(), -1));
+        std::string name;
+        detail::h5_attr_s desc;
+        while (is >> name >> desc.value_type >> desc.iform >> desc.num_of_sub >> desc.compression) {
+            attrs.emplace(name, desc);
+        }
+    }
+    size_type num_of_patches = 0;
+    auto offset = GLOBAL_COMM.exclusive_scan(patches.size(), &num_of_patches);
+    if (num_of_patches == 0) { return SP_SUCCESS; }
+
+    hid_t dxpl = H5P_DEFAULT;
+    index_type num_of_rounds = static_cast<index_type>(patches.size());
+
+    auto write = [&](hid_t file, bool do_create) {
+        hid_t root = H5Gopen(file, "/", H5P_DEFAULT);
+        if (do_create) {
+            if (auto time = this->Get("Time")) { HDF5SetEntity(root, "Time", time->GetEntity()); }
+            H5Gclose(HDF5CreateOrOpenGroup(root, "Atlas"));
+            H5Gclose(HDF5CreateOrOpenGroup(root, "Attributes"));
+        }
+        {
+            hsize_t dims[2] = {num_of_patches, 7};
+            hid_t f_space = H5Screate_simple(2, dims, nullptr);
+            hid_t dset;
+            if (do_create) {
+                H5_ERROR(dset = H5Dcreate(root, "Atlas/Patches", H5T_NATIVE_INT64, f_space, H5P_DEFAULT,
+                                          H5P_DEFAULT, H5P_DEFAULT));
+            } else {
+                H5_ERROR(dset = H5Dopen(root, "Atlas/Patches", H5P_DEFAULT));
+            }
+            std::vector<index_type> table;
+            for (auto const &p : patches) {
+                table.push_back(p.guid);
+                for (int i = 0; i < 3; ++i) { table.push_back(std::get<0>(p.box)[i]); }
+                for (int i = 0; i < 3; ++i) { table.push_back(std::get<1>(p.box)[i]); }
+            }
+            hsize_t start[2] = {offset, 0}, count[2] = {patches.size(), 7};
+            hid_t m_space = H5Screate_simple(2, count, nullptr);
+            if (patches.empty()) {
+                H5_ERROR(H5Sselect_none(m_space));
+                H5_ERROR(H5Sselect_none(f_space));
+            } else {
+                H5_ERROR(H5Sselect_hyperslab(f_space, H5S_SELECT_SET, start, nullptr, count, nullptr));
+            }
+            H5_ERROR(H5Dwrite(dset, H5T_NATIVE_INT64, m_space, f_space, dxpl, table.empty() ? nullptr : &table[0]));
+            H5Sclose(m_space);
+            H5Sclose(f_space);
+            H5Dclose(dset);
+        }
+        hid_t grp = H5Gopen(root, "Attributes", H5P_DEFAULT);
+        for (auto const &item : attrs) {
+            auto const &desc = item.second;
+            index_tuple hi = g_hi;
+            for (int n = 0; n < desc.num_of_sub; ++n) {
+                auto c_hi = detail::h5_upper(g_hi, desc.iform, desc.num_of_sub, n);
+                for (int i = 0; i < 3; ++i) { hi[i] = std::max(hi[i], c_hi[i]); }
+            }
+            hsize_t dims[4];
+            for (int i = 0; i < 3; ++i) { dims[i] = static_cast<hsize_t>(hi[i] - g_lo[i]); }
+            dims[3] = static_cast<hsize_t>(desc.num_of_sub);
+            hid_t f_space = H5Screate_simple(4, dims, nullptr);
+            hid_t d_type = H5NumberType(detail::h5_value_type(desc.value_type));
+            hid_t dcpl = H5P_DEFAULT;
+            if (desc.compression > 0) {
+                auto cfg = DataEntry::New(DataEntry::DN_TABLE);
+                cfg->SetValue("Compression", desc.compression);
+                cfg->SetValue("Chunk", chunk);
+                hsize_t c_dims[4];
+                dcpl = HDF5DatasetCreateProperty(d_type, 4, dims, cfg, c_dims);
+            }
+            hid_t dset;
+            if (do_create) {
+                H5_ERROR(dset = H5Dcreate(grp, item.first.c_str(), d_type, f_space, H5P_DEFAULT, dcpl, H5P_DEFAULT));
+                hsize_t three = 3;
+                hid_t a_space = H5Screate_simple(1, &three, nullptr);
+                hid_t aid = H5Acreate(dset, "LowIndex", H5T_NATIVE_INT64, a_space, H5P_DEFAULT, H5P_DEFAULT);
+                H5_ERROR(H5Awrite(aid, H5T_NATIVE_INT64, &g_lo[0]));
+                H5Aclose(aid);
+                H5Sclose(a_space);
+                a_space = H5Screate(H5S_SCALAR);
+                aid = H5Acreate(dset, "IFORM", H5T_NATIVE_INT, a_space, H5P_DEFAULT, H5P_DEFAULT);
+                H5_ERROR(H5Awrite(aid, H5T_NATIVE_INT, &desc.iform));
+                H5Aclose(aid);
+                H5Sclose(a_space);
+            } else {
+                H5_ERROR(dset = H5Dopen(grp, item.first.c_str(), H5P_DEFAULT));
+            }
+            for (index_type r = 0; r < num_of_rounds; ++r) {
+                std::shared_ptr<const DataEntry> data = nullptr;
+                index_box_type box;
+                if (r < static_cast<index_type>(patches.size())) {
+                    box = patches[r].box;
+                    if (patches[r].attrs != nullptr) {
+                        if (auto d = patches[r].attrs->Get(item.first)) { data = d->Get("_DATA_"); }
+                    }
+                }
+                for (int n = 0; n < desc.num_of_sub; ++n) {
+                    auto array = detail::h5_component(data, n);
+                    // a patch at the upper boundary also writes the upper points of the component
+                    auto c_box = box;
+                    auto c_hi = detail::h5_upper(g_hi, desc.iform, desc.num_of_sub, n);
+                    for (int i = 0; i < 3; ++i) {
+                        if (std::get<1>(c_box)[i] == g_hi[i]) { std::get<1>(c_box)[i] = c_hi[i]; }
+                    }
+                    hsize_t m_dims[3] = {1, 1, 1};
+                    if (array != nullptr) {
+                        index_type outer_lo[3], outer_hi[3];
+                        array->GetShape(outer_lo, outer_hi);
+                        for (int i = 0; i < 3; ++i) { m_dims[i] = static_cast<hsize_t>(outer_hi[i] - outer_lo[i]); }
+                    }
+                    hid_t m_space = H5Screate_simple(3, m_dims, nullptr);
+                    if (array != nullptr) {
+                        detail::h5_select(*array, c_box, g_lo, n, m_space, f_space, dcpl != H5P_DEFAULT);
+                    } else {
+                        H5_ERROR(H5Sselect_none(m_space));
+                        H5_ERROR(H5Sselect_none(f_space));
+                    }
+                    H5_ERROR(H5Dwrite(dset, d_type, m_space, f_space, dxpl,
+                                      array == nullptr ? nullptr : array->pointer()));
+                    H5Sclose(m_space);
+                }
+            }
+            if (dcpl != H5P_DEFAULT) { H5Pclose(dcpl); }
+            H5Sclose(f_space);
+            H5Dclose(dset);
+        }
+        H5Gclose(grp);
+        H5Gclose(root);
+    };
+
+    VERBOSE << std::setw(20) << "Write HDF5 : " << m_filename_ << " [" << num_of_patches << " patches]" << std::endl;
+#ifdef SP_HDF5_PARALLEL
+    {
+        // collective metadata and transfer, every process writes the same number of rounds
+        index_type n = num_of_rounds;
+        GLOBAL_COMM.all_reduce_max(&n, 1);
+        num_of_rounds = n;
+        hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+        H5_ERROR(H5Pset_fapl_mpio(fapl, MPI_COMM_WORLD, MPI_INFO_NULL));
+        H5_ERROR(H5Pset_all_coll_metadata_ops(fapl, true));
+        H5_ERROR(H5Pset_coll_metadata_write(fapl, true));
+        dxpl = H5Pcreate(H5P_DATASET_XFER);
+        H5_ERROR(H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE));
+        hid_t file;
+        H5_ERROR(file = H5Fcreate(m_filename_.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, fapl));
+        write(file, true);
+        H5Fclose(file);
+        H5Pclose(dxpl);
+        H5Pclose(fapl);
+    }
+#else
+    for (int r = 0, re = GLOBAL_COMM.size(); r < re; ++r) {
+        if (r == GLOBAL_COMM.rank()) {
+            hid_t file;
+            if (r == 0) {
+                H5_ERROR(file = H5Fcreate(m_filename_.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT));
+            } else {
+                H5_ERROR(file = H5Fopen(m_filename_.c_str(), H5F_ACC_RDWR, H5P_DEFAULT));
+            }
+            write(file, r == 0);
+            H5Fclose(file);
+        }
+        GLOBAL_COMM.barrier();
+    }
+#endif
+    return SP_SUCCESS;
+}
+
+}  // namespace data{
+}  // namespace simpla{
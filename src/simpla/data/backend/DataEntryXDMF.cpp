@@ -23,7 +23,8 @@ struct DataEntryXDMF : public DataEntryMemory {
     bool isValid() const override { return !m_prefix_.empty(); }
 
     void WriteDataItem(std::string const &url, std::string const &key, const index_box_type &idx_box,
-                       std::shared_ptr<const data::DataEntry> const &data, int indent);
+                       std::shared_ptr<const data::DataEntry> const &data, int indent,
+                       std::shared_ptr<const data::DataEntry> const &cfg = nullptr);
     void WriteAttribute(std::string const &url, std::string const &key, const index_box_type &idx_box,
                         std::shared_ptr<const data::DataEntry> const &attr, int indent);
     void WriteParticle(std::string const &url, std::string const &key, const index_box_type &idx_box,
@@ -94,8 +95,8 @@ std::string XDMFNumberType(std::type_info const &t_info) {
 }
 std::ostream &XDMFWriteArray(std::ostream &os, hid_t g_id, std::string const &prefix, std::string const &key,
                              index_type const *lo, index_type const *hi, std::shared_ptr<const ArrayBase> const &array,
-                             int indent) {
-    HDF5WriteArray(g_id, key, array);
+                             int indent, std::shared_ptr<const DataEntry> const &cfg = nullptr) {
+    HDF5WriteArray(g_id, key, array, cfg);
     auto ndims = array->GetNDIMS();
     index_type m_lo[ndims];
     index_type m_hi[ndims];
@@ -131,12 +132,13 @@ std::ostream &XDMFWriteArray(std::ostream &os, hid_t g_id, std::string const &pr
     return os;
 }
 void DataEntryXDMF::WriteDataItem(std::string const &url, std::string const &key, const index_box_type &idx_box,
-                                  std::shared_ptr<const data::DataEntry> const &data, int indent) {
+                                  std::shared_ptr<const data::DataEntry> const &data, int indent,
+                                  std::shared_ptr<const data::DataEntry> const &cfg) {
     auto g_id = H5GroupTryOpen(m_h5_root_, url);
     if (data == nullptr) {
     } else if (auto array = std::dynamic_pointer_cast<const ArrayBase>(data->GetEntity())) {
         XDMFWriteArray(*m_os_, g_id, m_h5_prefix_ + ":" + url, key, &std::get<0>(idx_box)[0], &std::get<1>(idx_box)[0],
-                       array, indent + 1);
+                       array, indent + 1, cfg);
     } else if (data->type() == data::DataEntry::DN_ARRAY) {
         auto dof = static_cast<int>(data->size());
 
@@ -158,7 +160,7 @@ void DataEntryXDMF::WriteDataItem(std::string const &url, std::string const &key
                 prefix += "/";
                 prefix += key;
                 XDMFWriteArray(*m_os_, subg_id, prefix, std::to_string(i), &std::get<0>(idx_box)[0],
-                               &std::get<1>(idx_box)[0], array, indent + 2);
+                               &std::get<1>(idx_box)[0], array, indent + 2, cfg);
             }
         }
         *m_os_ << std::setw(indent + 1) << " "
@@ -211,7 +213,7 @@ void DataEntryXDMF::WriteAttribute(std::string const &url, std::string const &ke
            << "IFORM=\"" << iform << "\" "                               //
            << ">" << std::endl;
 
-    WriteDataItem(url, key, std::make_tuple(lo, hi), attr->Get("_DATA_"), indent + 1);
+    WriteDataItem(url, key, std::make_tuple(lo, hi), attr->Get("_DATA_"), indent + 1, attr);
 
     *m_os_ << std::setw(indent) << " "
            << "</Attribute>" << std::endl;
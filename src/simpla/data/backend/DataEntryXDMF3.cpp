@@ -96,7 +96,8 @@ void DataEntryXDMF3::WriteDataItem(std::string const &url, std::string const &ke
 
     auto g_id = H5GroupTryOpen(m_h5_root_, url);
 
-    if (auto array = std::dynamic_pointer_cast<ArrayBase>(data->GetEntity())) {
+    if (auto array_ = std::dynamic_pointer_cast<ArrayBase>(data->GetEntity())) {
+        auto array = array_->isLinear() ? array_ : array_->Linearize();
         number_type = XDMFNumberType(array->value_type_info());
         fndims = 3;
         dof = 1;
@@ -169,7 +170,8 @@ void DataEntryXDMF3::WriteDataItem(std::string const &url, std::string const &ke
             H5_ERROR(H5Sclose(f_space));
         }
         for (int i = 0; i < dof; ++i) {
-            if (auto array = std::dynamic_pointer_cast<ArrayBase>(data->GetEntity(i))) {
+            if (auto array_ = std::dynamic_pointer_cast<ArrayBase>(data->GetEntity(i))) {
+                auto array = array_->isLinear() ? array_ : array_->Linearize();
                 ASSERT(array->pointer() != nullptr);
 
                 index_type t_lo[SP_ARRAY_MAX_NDIMS], t_hi[SP_ARRAY_MAX_NDIMS];
@@ -2,7 +2,9 @@
 // Created by salmon on 17-9-24.
 //
 #include "HDF5Common.h"
+#include <algorithm>
 #include <string>
+#include <vector>
 namespace simpla {
 namespace data {
 
@@ -177,7 +179,105 @@ std::shared_ptr<DataEntity> HDF5GetEntity(hid_t obj_id, bool is_attribute) {
     return res;
 }
 
-void HDF5WriteArray(hid_t g_id, std::string const& key, std::shared_ptr<const ArrayBase> const& data) {
+hid_t HDF5DatasetCreateProperty(hid_t d_type, int ndims, hsize_t const* dims,
+                                std::shared_ptr<const DataEntry> const& cfg, hsize_t* chunk, bool slow_first) {
+    for (int i = 0; i < ndims; ++i) { chunk[i] = dims[i]; }
+    if (cfg == nullptr) { return H5P_DEFAULT; }
+    auto level = cfg->GetValue<int>("Compression", 0);
+    bool is_chunked = level > 0;
+    if (cfg->Get("Chunk") != nullptr) {
+        auto c = cfg->GetValue<index_tuple>("Chunk");
+        for (int i = 0; i < ndims; ++i) {
+            // dims of a fast first array are reversed, as in HDF5WriteArray
+            int n = slow_first ? i : ndims - 1 - i;
+            chunk[i] = n >= 3 ? 1 : (c[n] > 0 ? std::min(dims[i], static_cast<hsize_t>(c[n])) : dims[i]);
+        }
+        is_chunked = true;
+    }
+    if (!is_chunked) { return H5P_DEFAULT; }
+    for (int i = 0; i < ndims; ++i) { chunk[i] = std::max(chunk[i], static_cast<hsize_t>(1)); }
+
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5_ERROR(H5Pset_chunk(dcpl, ndims, chunk));
+    if (level > 0) {
+        if (cfg->GetValue<bool>("Shuffle", true)) { H5_ERROR(H5Pset_shuffle(dcpl)); }
+        H5_ERROR(H5Pset_deflate(dcpl, static_cast<unsigned>(std::min(level, 9))));
+    }
+    // chunks which are never written are read back as zero
+    std::vector<char> zero(H5Tget_size(d_type), 0);
+    H5_ERROR(H5Pset_fill_value(dcpl, d_type, &zero[0]));
+    H5_ERROR(H5Pset_fill_time(dcpl, H5D_FILL_TIME_IFSET));
+    return dcpl;
+}
+bool HDF5IsZero(void const* data, size_type elem_size, int ndims, hsize_t const* dims, hsize_t const* start,
+                hsize_t const* count) {
+    if (data == nullptr) { return true; }
+    hsize_t idx[ndims];
+    for (int i = 0; i < ndims; ++i) {
+        if (count[i] == 0) { return true; }
+        idx[i] = start[i];
+    }
+    auto const* p = reinterpret_cast<unsigned char const*>(data);
+    size_type row = count[ndims - 1] * elem_size;
+    while (true) {
+        size_type s = 0;
+        for (int i = 0; i < ndims; ++i) { s = s * dims[i] + idx[i]; }
+        auto const* q = p + s * elem_size;
+        for (size_type n = 0; n < row; ++n) {
+            if (q[n] != 0) { return false; }
+        }
+        int i = ndims - 2;
+        for (; i >= 0; --i) {
+            if (++idx[i] < start[i] + count[i]) { break; }
+            idx[i] = start[i];
+        }
+        if (i < 0) { break; }
+    }
+    return true;
+}
+size_type HDF5WriteChunks(hid_t dset, hid_t d_type, int ndims, hsize_t const* m_dims, hsize_t const* m_start,
+                          hsize_t const* f_start, hsize_t const* count, hsize_t const* chunk, void const* data) {
+    size_type res = 0;
+    auto elem_size = H5Tget_size(d_type);
+    hsize_t first[ndims], idx[ndims], t_start[ndims], t_count[ndims], t_m_start[ndims];
+    for (int i = 0; i < ndims; ++i) {
+        if (count[i] == 0) { return res; }
+        first[i] = f_start[i] / chunk[i] * chunk[i];
+        idx[i] = first[i];
+    }
+    hid_t m_space = H5Screate_simple(ndims, m_dims, nullptr);
+    hid_t f_space = H5Dget_space(dset);
+    while (true) {
+        for (int i = 0; i < ndims; ++i) {
+            t_start[i] = std::max(idx[i], f_start[i]);
+            t_count[i] = std::min(idx[i] + chunk[i], f_start[i] + count[i]) - t_start[i];
+            t_m_start[i] = m_start[i] + t_start[i] - f_start[i];
+        }
+        if (!HDF5IsZero(data, elem_size, ndims, m_dims, t_m_start, t_count)) {
+            H5_ERROR(H5Sselect_hyperslab(m_space, H5S_SELECT_SET, t_m_start, nullptr, t_count, nullptr));
+            H5_ERROR(H5Sselect_hyperslab(f_space, H5S_SELECT_SET, t_start, nullptr, t_count, nullptr));
+            H5_ERROR(H5Dwrite(dset, d_type, m_space, f_space, H5P_DEFAULT, data));
+            ++res;
+        }
+        int i = ndims - 1;
+        for (; i >= 0; --i) {
+            idx[i] += chunk[i];
+            if (idx[i] < f_start[i] + count[i]) { break; }
+            idx[i] = first[i];
+        }
+        if (i < 0) { break; }
+    }
+    H5_ERROR(H5Sclose(m_space));
+    H5_ERROR(H5Sclose(f_space));
+    return res;
+}
+
+void HDF5WriteArray(hid_t g_id, std::string const& key, std::shared_ptr<const ArrayBase> const& data,
+                    std::shared_ptr<const DataEntry> const& cfg) {
+    if (!data->isLinear()) {
+        HDF5WriteArray(g_id, key, data->Linearize(), cfg);
+        return;
+    }
     bool is_exist = H5Lexists(g_id, key.c_str(), H5P_DEFAULT) != 0;
     //            H5Oexists_by_name(loc_id, key.c_str(), H5P_DEFAULT) != 0;
     H5O_info_t g_info;
@@ -220,19 +320,28 @@ void HDF5WriteArray(hid_t g_id, std::string const& key, std::shared_ptr<const Ar
             m_block[ndims - 1 - i] = static_cast<hsize_t>(1);
         }
     }
-    hid_t m_space = H5Screate_simple(ndims, &m_shape[0], nullptr);
-    H5_ERROR(H5Sselect_hyperslab(m_space, H5S_SELECT_SET, &m_start[0], &m_stride[0], &m_count[0], &m_block[0]));
+    hid_t d_type = GetHDF5DataType(data->value_type_info());
+    hsize_t chunk[ndims];
+    hid_t dcpl = HDF5DatasetCreateProperty(d_type, ndims, m_count, cfg, chunk, data->isSlowFirst());
     hid_t f_space = H5Screate_simple(ndims, &m_count[0], nullptr);
     hid_t dset;
-    hid_t d_type = GetHDF5DataType(data->value_type_info());
-    H5_ERROR(dset = H5Dcreate(g_id, key.c_str(), d_type, f_space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT));
-    H5_ERROR(H5Dwrite(dset, d_type, m_space, f_space, H5P_DEFAULT, data->pointer()));
-
+    H5_ERROR(dset = H5Dcreate(g_id, key.c_str(), d_type, f_space, H5P_DEFAULT, dcpl, H5P_DEFAULT));
+    if (dcpl == H5P_DEFAULT) {
+        hid_t m_space = H5Screate_simple(ndims, &m_shape[0], nullptr);
+        H5_ERROR(H5Sselect_hyperslab(m_space, H5S_SELECT_SET, &m_start[0], &m_stride[0], &m_count[0], &m_block[0]));
+        H5_ERROR(H5Dwrite(dset, d_type, m_space, f_space, H5P_DEFAULT, data->pointer()));
+        H5_ERROR(H5Sclose(m_space));
+    } else {
+        hsize_t f_start[ndims];
+        for (int i = 0; i < ndims; ++i) { f_start[i] = 0; }
+        HDF5WriteChunks(dset, d_type, ndims, m_shape, m_start, f_start, m_count, chunk, data->pointer());
+        H5_ERROR(H5Pclose(dcpl));
+    }
     H5_ERROR(H5Dclose(dset));
-    if (m_space != H5S_ALL) H5_ERROR(H5Sclose(m_space));
-    if (f_space != H5S_ALL) H5_ERROR(H5Sclose(f_space));
+    H5_ERROR(H5Sclose(f_space));
 }
-size_type HDF5SetEntity(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntity> const& entity) {
+size_type HDF5SetEntity(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntity> const& entity,
+                        std::shared_ptr<const DataEntry> const& cfg) {
     ASSERT(g_id > 0);
 
     size_type count = 0;
@@ -323,50 +432,9 @@ size_type HDF5SetEntity(hid_t g_id, std::string const& key, std::shared_ptr<cons
         H5_ERROR(H5Sclose(d_space));
 
         ++count;
-    } else if (auto p = std::dynamic_pointer_cast<const ArrayBase>(entity)) {
-        if (auto data = p->pointer()) {
-            bool is_exist = H5Lexists(g_id, key.c_str(), H5P_DEFAULT) != 0;
-            //            H5Oexists_by_name(loc_id, key.c_str(), H5P_DEFAULT) != 0;
-            H5O_info_t g_info;
-            if (is_exist) { H5_ERROR(H5Oget_info_by_name(g_id, key.c_str(), &g_info, H5P_DEFAULT)); }
-
-            if (is_exist && g_info.type != H5O_TYPE_DATASET) {
-                H5Ldelete(g_id, key.c_str(), H5P_DEFAULT);
-                is_exist = false;
-            }
-            static constexpr int ndims = 3;  // p->GetNDIMS();
-
-            index_type inner_lower[ndims];
-            index_type inner_upper[ndims];
-            index_type outer_lower[ndims];
-            index_type outer_upper[ndims];
-
-            p->GetIndexBox(inner_lower, inner_upper);
-            p->GetIndexBox(outer_lower, outer_upper);
-
-            hsize_t m_shape[ndims];
-            hsize_t m_start[ndims];
-            hsize_t m_count[ndims];
-            hsize_t m_stride[ndims];
-            hsize_t m_block[ndims];
-            for (int i = 0; i < ndims; ++i) {
-                m_shape[i] = static_cast<hsize_t>(outer_upper[i] - outer_lower[i]);
-                m_start[i] = static_cast<hsize_t>(inner_lower[i] - outer_lower[i]);
-                m_count[i] = static_cast<hsize_t>(inner_upper[i] - inner_lower[i]);
-                m_stride[i] = static_cast<hsize_t>(1);
-                m_block[i] = static_cast<hsize_t>(1);
-            }
-            hid_t m_space = H5Screate_simple(ndims, &m_shape[0], nullptr);
-            H5_ERROR(H5Sselect_hyperslab(m_space, H5S_SELECT_SET, &m_start[0], &m_stride[0], &m_count[0], &m_block[0]));
-            hid_t f_space = H5Screate_simple(ndims, &m_count[0], nullptr);
-            hid_t dset;
-            hid_t d_type = GetHDF5DataType(p->value_type_info());
-            H5_ERROR(dset = H5Dcreate(g_id, key.c_str(), d_type, f_space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT));
-            H5_ERROR(H5Dwrite(dset, d_type, m_space, f_space, H5P_DEFAULT, data));
-
-            H5_ERROR(H5Dclose(dset));
-            if (m_space != H5S_ALL) H5_ERROR(H5Sclose(m_space));
-            if (f_space != H5S_ALL) H5_ERROR(H5Sclose(f_space));
+    } else if (auto array = std::dynamic_pointer_cast<const ArrayBase>(entity)) {
+        if (array->pointer() != nullptr) {
+            HDF5WriteArray(g_id, key, array, cfg);
             ++count;
         }
     }
@@ -405,7 +473,8 @@ hid_t HDF5CreateOrOpenGroup(hid_t grp, std::string const& key) {
     }
     return res;
 }
-size_type HDF5Set(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntry> node) {
+size_type HDF5Set(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntry> node,
+                  std::shared_ptr<const DataEntry> const& cfg) {
     if (node == nullptr) { return 0; }
 
     size_type count = 0;
@@ -413,27 +482,31 @@ size_type HDF5Set(hid_t g_id, std::string const& key, std::shared_ptr<const Data
         case DataEntry::DN_ARRAY:
         case DataEntry::DN_TABLE: {
             hid_t sub_gid = HDF5CreateOrOpenGroup(g_id, key);
-            node->Foreach([&](std::string k, auto const& n) { count += HDF5Set(sub_gid, k, n); });
+            // the description of an attribute holds the compression of its arrays
+            auto sub_cfg = node->Get("Compression") != nullptr ? node : cfg;
+            node->Foreach([&](std::string k, auto const& n) { count += HDF5Set(sub_gid, k, n, sub_cfg); });
         } break;
         case DataEntry::DN_ENTITY:
-            count = HDF5SetEntity(g_id, key, node->GetEntity());
+            count = HDF5SetEntity(g_id, key, node->GetEntity(), cfg);
             break;
         default:
             break;
     }
     return count;
 }
-size_type HDF5Add(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntry> node) {
+size_type HDF5Add(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntry> node,
+                  std::shared_ptr<const DataEntry> const& cfg) {
     if (node == nullptr) { return 0; }
     size_type count = 0;
     switch (node->type()) {
         case DataEntry::DN_ARRAY:
         case DataEntry::DN_TABLE: {
             hid_t sub_gid = HDF5CreateOrOpenGroup(g_id, key);
-            node->Foreach([&](std::string k, auto const& n) { count += HDF5Set(sub_gid, k, n); });
+            auto sub_cfg = node->Get("Compression") != nullptr ? node : cfg;
+            node->Foreach([&](std::string k, auto const& n) { count += HDF5Set(sub_gid, k, n, sub_cfg); });
         } break;
         case DataEntry::DN_ENTITY:
-            count = HDF5SetEntity(g_id, key, node->GetEntity());
+            count = HDF5SetEntity(g_id, key, node->GetEntity(), cfg);
             break;
         default:
             break;
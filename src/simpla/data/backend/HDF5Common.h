@@ -107,12 +107,40 @@ std::shared_ptr<DataEntity> HDF5GetEntityT(hid_t attr_id, hid_t d_type, hid_t d_
     return res;
 }
 std::shared_ptr<DataEntity> HDF5GetEntity(hid_t obj_id, bool is_attribute);
-size_type HDF5SetEntity(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntity> const& entity);
+/**
+ *  The datasets of arrays are chunked and compressed as asked by cfg, usually the description of the attribute:
+ *      "Compression"   deflate level 0-9, default 0
+ *      "Shuffle"       shuffle filter before deflate, default true
+ *      "Chunk"         chunk shape of the three index dimensions, default the whole array, i.e. one chunk per patch.
+ *                      Trailing dimensions (components) are chunked one by one.
+ */
+size_type HDF5SetEntity(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntity> const& entity,
+                        std::shared_ptr<const DataEntry> const& cfg = nullptr);
 hid_t HDF5CreateOrOpenGroup(hid_t grp, std::string const& key);
 hid_t H5GroupTryOpen(hid_t grp, std::string const& key);
-size_type HDF5Set(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntry> node);
-size_type HDF5Add(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntry> node);
-void HDF5WriteArray(hid_t g_id, std::string const& key, std::shared_ptr<const ArrayBase> const& data);
+size_type HDF5Set(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntry> node,
+                  std::shared_ptr<const DataEntry> const& cfg = nullptr);
+size_type HDF5Add(hid_t g_id, std::string const& key, std::shared_ptr<const DataEntry> node,
+                  std::shared_ptr<const DataEntry> const& cfg = nullptr);
+void HDF5WriteArray(hid_t g_id, std::string const& key, std::shared_ptr<const ArrayBase> const& data,
+                    std::shared_ptr<const DataEntry> const& cfg = nullptr);
+/**
+ * creation property of a dataset of shape dims as asked by cfg, the chunk shape is returned in chunk.
+ * "Chunk" is in the order of the array index, dims is reversed from it if the array is not slow_first.
+ * @return H5P_DEFAULT if cfg asks for neither chunks nor compression
+ */
+hid_t HDF5DatasetCreateProperty(hid_t d_type, int ndims, hsize_t const* dims,
+                                std::shared_ptr<const DataEntry> const& cfg, hsize_t* chunk, bool slow_first = true);
+/** true if all bytes of the block [start, start + count) in the memory of shape dims are zero */
+bool HDF5IsZero(void const* data, size_type elem_size, int ndims, hsize_t const* dims, hsize_t const* start,
+                hsize_t const* count);
+/**
+ * write the block [m_start, m_start + count) in the memory of shape m_dims to [f_start, f_start + count) of the
+ * dataset one chunk at a time. Chunks which are all zero are not written, they are not allocated in the file and are
+ * read back as the fill value. @return number of chunks written
+ */
+size_type HDF5WriteChunks(hid_t dset, hid_t d_type, int ndims, hsize_t const* m_dims, hsize_t const* m_start,
+                          hsize_t const* f_start, hsize_t const* count, hsize_t const* chunk, void const* data);
 }
 }
 
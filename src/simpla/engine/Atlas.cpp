@@ -3,10 +3,16 @@
  *  Created by salmon on 16-5-23.
  */
 #include <mpi.h>
+#include <simpla/data/DataBlock.h>
 #include <simpla/geometry/BoxUtilities.h>
 #include <simpla/geometry/Chart.h>
 #include <simpla/parallel/MPIComm.h>
 #include <simpla/parallel/MPIUpdater.h>
+#include <simpla/parallel/SFCPartition.h>
+#include <simpla/utilities/Factory.h>
+#include <algorithm>
+#include <cstring>
+#include <typeindex>
 #include "simpla/SIMPLA_config.h"
 
 #include "simpla/geometry/Chart.h"
@@ -33,7 +39,245 @@ struct Atlas::pimpl_s {
 
     index_tuple m_ghost_width_{3, 3, 3};
     index_tuple m_period_{1, 1, 1};
+
+    //! the updater and its buffers are kept while the attributes and boxes are not changed
+    std::shared_ptr<parallel::MPIUpdater> m_updater_ = nullptr;
+    std::vector<std::tuple<std::string, std::type_info const *, int>> m_sync_attrs_;
+    index_box_type m_sync_box_{{0, 0, 0}, {0, 0, 0}};
+    index_box_type m_sync_halo_box_{{0, 0, 0}, {0, 0, 0}};
+
+    /**
+     * one edge of the adjacency graph of the patches on one level: data in box is copied from the patch src to the
+     * halo of the patch dst. Boxes of the patches are disjoint, so the edges write disjoint parts of the halo.
+     */
+    struct sync_edge_s {
+        id_type src;
+        id_type dst;
+        int level;
+        index_box_type box;
+    };
+    std::vector<sync_edge_s> m_sync_edges_;
+    //! the graph is rebuilt when a patch is added or deleted
+    bool m_sync_edges_is_valid_ = false;
+
+    void BuildSyncEdges(index_tuple const &halo);
+
+    //! tiles of the cost weighted decomposition, (i * ny + j) * nz + k, empty for the cartesian decomposition
+    std::vector<index_type> m_tile_bounds_[3];
+    std::vector<index_box_type> m_tiles_;
+    std::vector<int> m_tile_owner_;
+    std::function<Real(index_box_type const &)> m_cost_function_ = nullptr;
+
+    index_type TileIndex(index_type i, index_type j, index_type k) const {
+        return (i * (m_tile_bounds_[1].size() - 1) + j) * (m_tile_bounds_[2].size() - 1) + k;
+    }
+    //! position of the tile containing idx along axis n
+    index_type TileOf(index_type idx, int n) const;
+    void SetLocalIndexBox(index_box_type const &b, geometry::Chart const &chart);
+    void SetLocalTiles(geometry::Chart const &chart);
+    void AddSyncRegions(parallel::MPIUpdater &updater, index_tuple const &halo) const;
+    void Migrate(std::vector<int> const &owner);
 };
+namespace detail {
+template <typename T>
+void atlas_pack(std::string *buf, T const &v) {
+    buf->append(reinterpret_cast<char const *>(&v), sizeof(T));
+}
+template <typename T>
+T atlas_unpack(char const *&p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return v;
+}
+/** type code, index box and the values of the array in a compact layout */
+template <typename V>
+bool atlas_pack_array(data::DataEntity const *entity, int code, std::string *buf) {
+    auto const *blk = dynamic_cast<data::DataBlock<V> const *>(entity);
+    if (blk == nullptr || blk->get() == nullptr) { return false; }
+    index_box_type b = blk->GetSpaceFillingCurve().GetIndexBox();
+    auto compact = data::DataBlock<V>::New(b);
+    compact->alloc();
+    static_cast<Array<V> &>(*compact).CopyIn(static_cast<Array<V> const &>(*blk));
+    atlas_pack(buf, code);
+    atlas_pack(buf, std::get<0>(b));
+    atlas_pack(buf, std::get<1>(b));
+    buf->append(reinterpret_cast<char const *>(compact->get()),
+                compact->GetSpaceFillingCurve().shape_size() * sizeof(V));
+    return true;
+}
+template <typename V>
+std::shared_ptr<data::DataEntity> atlas_unpack_array(char const *&p) {
+    index_box_type b;
+    std::get<0>(b) = atlas_unpack<index_tuple>(p);
+    std::get<1>(b) = atlas_unpack<index_tuple>(p);
+    auto res = data::DataBlock<V>::New(b);
+    res->alloc();
+    auto num = res->GetSpaceFillingCurve().shape_size() * sizeof(V);
+    std::memcpy(res->get(), p, num);
+    p += num;
+    return res;
+}
+/** arrays, entities which can pack themselves (e.g. ParticleData) by their type name, nothing else */
+static void atlas_pack_entity(data::DataEntity const *entity, std::string *buf) {
+    if (entity == nullptr) {
+        atlas_pack(buf, 0);
+    } else if (atlas_pack_array<float>(entity, 1, buf) || atlas_pack_array<double>(entity, 2, buf) ||
+               atlas_pack_array<int>(entity, 3, buf) || atlas_pack_array<long>(entity, 4, buf) ||
+               atlas_pack_array<unsigned int>(entity, 5, buf) || atlas_pack_array<unsigned long>(entity, 6, buf)) {
+    } else {
+        auto name = entity->FancyTypeName();
+        atlas_pack(buf, 7);
+        atlas_pack(buf, static_cast<int>(name.size()));
+        buf->append(name);
+        if (!entity->Pack(buf)) {
+            RUNTIME_ERROR << "Can not migrate the data entity [" << name << "] of a patch!" << std::endl;
+        }
+    }
+}
+static std::shared_ptr<data::DataEntity> atlas_unpack_entity(char const *&p) {
+    std::shared_ptr<data::DataEntity> res = nullptr;
+    switch (atlas_unpack<int>(p)) {
+        case 1:
+            res = atlas_unpack_array<float>(p);
+            break;
+        case 2:
+            res = atlas_unpack_array<double>(p);
+            break;
+        case 3:
+            res = atlas_unpack_array<int>(p);
+            break;
+        case 4:
+            res = atlas_unpack_array<long>(p);
+            break;
+        case 5:
+            res = atlas_unpack_array<unsigned int>(p);
+            break;
+        case 6:
+            res = atlas_unpack_array<unsigned long>(p);
+            break;
+        case 7: {
+            auto len = atlas_unpack<int>(p);
+            std::string name(p, static_cast<size_type>(len));
+            p += len;
+            res = Factory<data::DataEntity>::Create(name);
+            p = res->Unpack(p);
+            break;
+        }
+        default:
+            break;
+    }
+    return res;
+}
+/**
+ * the index box and level of the patch, and every data block as it is bound by AttributeT: its IFORM and the
+ * entity or the array of entities in _DATA_
+ */
+static void atlas_pack_patch(Patch const &patch, std::string *buf) {
+    auto b = patch.GetIndexBox();
+    atlas_pack(buf, std::get<0>(b));
+    atlas_pack(buf, std::get<1>(b));
+    atlas_pack(buf, patch.GetMeshBlock()->GetLevel());
+    atlas_pack(buf, static_cast<int>(patch.GetAllDataBlocks().size()));
+    for (auto const &item : patch.GetAllDataBlocks()) {
+        atlas_pack(buf, static_cast<int>(item.first.size()));
+        buf->append(item.first);
+        auto node = item.second;
+        // the block of a particle species is the entity itself, not a table with IFORM and _DATA_
+        bool is_entity = node != nullptr && node->type() == data::DataEntry::DN_ENTITY;
+        atlas_pack(buf, node == nullptr || is_entity ? 0 : node->GetValue<int>("IFORM", 0));
+        auto d = node == nullptr || is_entity ? nullptr : node->Get("_DATA_");
+        // -2 the block is one entity, -1 no data, 0 one entity, n an array of n entities
+        int num = -1;
+        if (is_entity) {
+            num = -2;
+        } else if (d != nullptr && d->type() == data::DataEntry::DN_ENTITY) {
+            num = 0;
+        } else if (d != nullptr && d->type() == data::DataEntry::DN_ARRAY && d->size() > 0) {
+            num = static_cast<int>(d->size());
+        }
+        atlas_pack(buf, num);
+        if (num == -2) { atlas_pack_entity(node->GetEntity().get(), buf); }
+        if (num == 0) { atlas_pack_entity(d->GetEntity().get(), buf); }
+        for (int n = 0; n < num; ++n) { atlas_pack_entity(d->Get(n)->GetEntity().get(), buf); }
+    }
+}
+static std::shared_ptr<Patch> atlas_unpack_patch(char const *&p) {
+    index_box_type b;
+    std::get<0>(b) = atlas_unpack<index_tuple>(p);
+    std::get<1>(b) = atlas_unpack<index_tuple>(p);
+    auto level = atlas_unpack<int>(p);
+    auto res = Patch::New(MeshBlock::New(b, level));
+    for (int n = 0, ne = atlas_unpack<int>(p); n < ne; ++n) {
+        auto len = atlas_unpack<int>(p);
+        std::string key(p, static_cast<size_type>(len));
+        p += len;
+        auto node = data::DataEntry::New(data::DataEntry::DN_TABLE);
+        node->SetValue<int>("IFORM", atlas_unpack<int>(p));
+        auto num = atlas_unpack<int>(p);
+        if (num == -2) {
+            node = data::DataEntry::New(atlas_unpack_entity(p));
+        } else if (num == 0) {
+            node->Set("_DATA_", data::DataEntry::New(atlas_unpack_entity(p)));
+        } else if (num > 0) {
+            auto d = data::DataEntry::New(data::DataEntry::DN_ARRAY);
+            for (int i = 0; i < num; ++i) { d->Add(data::DataEntry::New(atlas_unpack_entity(p))); }
+            node->Set("_DATA_", d);
+        }
+        res->SetDataBlock(key, node);
+    }
+    return res;
+}
+}  // namespace detail
+
+/**
+ *  Patches are put into the buckets of a spatial hash, whose bucket size is larger than a patch plus its halo. Two
+ *  patches which touch each other are in the same or adjacent buckets, so only 27 buckets are searched per patch.
+ */
+void Atlas::pimpl_s::BuildSyncEdges(index_tuple const &halo) {
+    m_sync_edges_.clear();
+    // the node of a patch lies on the upper face of its box, so the halo is one wider
+    index_tuple gw = halo + 1;
+    index_tuple bucket{1, 1, 1};
+    for (auto const &item : m_patches_) {
+        auto b = item.second->GetIndexBox();
+        for (int n = 0; n < 3; ++n) { bucket[n] = std::max(bucket[n], std::get<1>(b)[n] - std::get<0>(b)[n] + gw[n]); }
+    }
+    auto bucket_of = [&](index_type const *idx, int n) {
+        return idx[n] >= 0 ? idx[n] / bucket[n] : (idx[n] + 1) / bucket[n] - 1;
+    };
+    std::map<std::tuple<index_type, index_type, index_type>, std::vector<std::shared_ptr<Patch>>> buckets;
+    for (auto const &item : m_patches_) {
+        auto b = item.second->GetIndexBox();
+        index_type const *lo = &std::get<0>(b)[0];
+        buckets[std::make_tuple(bucket_of(lo, 0), bucket_of(lo, 1), bucket_of(lo, 2))].push_back(item.second);
+    }
+    for (auto const &item : m_patches_) {
+        auto const &dst = item.second;
+        auto dst_box = dst->GetIndexBox();
+        auto halo_box = geometry::Expand(dst_box, gw);
+        int level = dst->GetMeshBlock() == nullptr ? 0 : dst->GetMeshBlock()->GetLevel();
+        index_type const *lo = &std::get<0>(dst_box)[0];
+        index_type I = bucket_of(lo, 0), J = bucket_of(lo, 1), K = bucket_of(lo, 2);
+        for (index_type i = I - 1; i <= I + 1; ++i)
+            for (index_type j = J - 1; j <= J + 1; ++j)
+                for (index_type k = K - 1; k <= K + 1; ++k) {
+                    auto it = buckets.find(std::make_tuple(i, j, k));
+                    if (it == buckets.end()) { continue; }
+                    for (auto const &src : it->second) {
+                        if (src == dst || src->GetMeshBlock() == nullptr ||
+                            src->GetMeshBlock()->GetLevel() != level) {
+                            continue;
+                        }
+                        auto box = geometry::Overlap(src->GetIndexBox(), halo_box);
+                        if (!geometry::isIllCondition(box)) {
+                            m_sync_edges_.push_back(sync_edge_s{src->GetGUID(), dst->GetGUID(), level, box});
+                        }
+                    }
+                }
+    }
+    m_sync_edges_is_valid_ = true;
+}
 
 Atlas::Atlas() : m_pimpl_(new pimpl_s) {
     SetMaxLevel(2);
@@ -66,6 +310,7 @@ void Atlas::Deserialize(std::shared_ptr<const data::DataEntry> const &tdb) {
     blocks->Foreach([&](std::string const &key, std::shared_ptr<const data::DataEntry> const &patch) {
         auto res = m_pimpl_->m_patches_.emplace(std::stoi(key), Patch::New(patch));
     });
+    m_pimpl_->m_sync_edges_is_valid_ = false;
     DoSetUp();
     Click();
 };
@@ -116,21 +361,267 @@ void Atlas::DoSetUp() {
 
     m_pimpl_->m_global_index_box_ = GetChart()->GetIndexBox(m_pimpl_->m_global_box_);
     Decompose();
-    m_pimpl_->m_local_box_ = GetChart()->GetBoxUVW(m_pimpl_->m_local_index_box_);
-    m_pimpl_->m_halo_box_ = m_pimpl_->m_local_index_box_;
+    base_type::DoSetUp();
+}
+void Atlas::pimpl_s::SetLocalIndexBox(index_box_type const &b, geometry::Chart const &chart) {
+    m_local_index_box_ = b;
+    m_local_box_ = chart.GetBoxUVW(m_local_index_box_);
+    m_halo_box_ = m_local_index_box_;
     for (int i = 0; i < 3; ++i) {
-        if (m_pimpl_->m_period_[i] == 0) {  // if it is not a period dimension then fix dx change bounding box
-            std::get<0>(m_pimpl_->m_halo_box_)[i] -= m_pimpl_->m_ghost_width_[i];
-            std::get<1>(m_pimpl_->m_halo_box_)[i] += m_pimpl_->m_ghost_width_[i];
+        if (m_period_[i] == 0) {  // if it is not a period dimension then fix dx change bounding box
+            std::get<0>(m_halo_box_)[i] -= m_ghost_width_[i];
+            std::get<1>(m_halo_box_)[i] += m_ghost_width_[i];
         }
     }
-    base_type::DoSetUp();
 }
 
-void Atlas::DoUpdate() { base_type::DoUpdate(); }
+void Atlas::DoUpdate() {
+    // rebuild the schedule of SyncGlobal if the index box is changed
+    if (m_pimpl_->m_updater_ != nullptr) { SetSyncAttributes(m_pimpl_->m_sync_attrs_); }
+    base_type::DoUpdate();
+}
 
-void Atlas::Decompose(index_tuple const &) { UNIMPLEMENTED; }
+index_type Atlas::pimpl_s::TileOf(index_type idx, int n) const {
+    auto const &bounds = m_tile_bounds_[n];
+    auto res = static_cast<index_type>(std::upper_bound(bounds.begin(), bounds.end(), idx) - bounds.begin()) - 1;
+    return std::min(std::max(res, index_type(0)), static_cast<index_type>(bounds.size()) - 2);
+}
+//! the local index box is the bounding box of the local tiles, a process without tiles has an empty box
+void Atlas::pimpl_s::SetLocalTiles(geometry::Chart const &chart) {
+    int rank = GLOBAL_COMM.rank();
+    index_box_type b{std::get<0>(m_global_index_box_), std::get<0>(m_global_index_box_)};
+    bool is_empty = true;
+    for (size_type t = 0; t < m_tiles_.size(); ++t) {
+        if (m_tile_owner_[t] != rank) { continue; }
+        for (int n = 0; n < 3; ++n) {
+            std::get<0>(b)[n] = is_empty ? std::get<0>(m_tiles_[t])[n]
+                                         : std::min(std::get<0>(b)[n], std::get<0>(m_tiles_[t])[n]);
+            std::get<1>(b)[n] = is_empty ? std::get<1>(m_tiles_[t])[n]
+                                         : std::max(std::get<1>(b)[n], std::get<1>(m_tiles_[t])[n]);
+        }
+        is_empty = false;
+    }
+    SetLocalIndexBox(b, chart);
+    m_sync_edges_is_valid_ = false;
+}
+/**
+ *  The halo of a local tile t is received from the owner of every neighbour tile s, shifted by the period if the
+ *  neighbour is across a periodic boundary. Both processes walk the tiles and the neighbours in the same order, so
+ *  the regions of a pair of processes are added in the same order on both sides. Neighbours which are local and
+ *  not shifted are copied by SyncLocal.
+ */
+void Atlas::pimpl_s::AddSyncRegions(parallel::MPIUpdater &updater, index_tuple const &halo) const {
+    int rank = GLOBAL_COMM.rank();
+    // the node of a patch lies on the upper face of its box, so the halo is one wider
+    index_tuple gw = halo + 1;
+    index_tuple num, length;
+    for (int n = 0; n < 3; ++n) {
+        num[n] = static_cast<index_type>(m_tile_bounds_[n].size()) - 1;
+        length[n] = std::get<1>(m_global_index_box_)[n] - std::get<0>(m_global_index_box_)[n];
+    }
+    index_tuple idx, disp, s, shift;
+    for (idx[0] = 0; idx[0] < num[0]; ++idx[0])
+        for (idx[1] = 0; idx[1] < num[1]; ++idx[1])
+            for (idx[2] = 0; idx[2] < num[2]; ++idx[2]) {
+                int t_owner = m_tile_owner_[TileIndex(idx[0], idx[1], idx[2])];
+                auto halo_box = geometry::Expand(m_tiles_[TileIndex(idx[0], idx[1], idx[2])], gw);
+                for (disp[0] = -1; disp[0] <= 1; ++disp[0])
+                    for (disp[1] = -1; disp[1] <= 1; ++disp[1])
+                        for (disp[2] = -1; disp[2] <= 1; ++disp[2]) {
+                            bool is_valid = true, is_shifted = false;
+                            for (int n = 0; n < 3; ++n) {
+                                s[n] = idx[n] + disp[n];
+                                shift[n] = 0;
+                                if (s[n] < 0 || s[n] >= num[n]) {
+                                    is_valid = is_valid && m_period_[n] != 0;
+                                    shift[n] = s[n] < 0 ? -length[n] : length[n];
+                                    s[n] = s[n] < 0 ? s[n] + num[n] : s[n] - num[n];
+                                    is_shifted = true;
+                                }
+                            }
+                            if (!is_valid || (disp[0] == 0 && disp[1] == 0 && disp[2] == 0)) { continue; }
+                            auto s_id = TileIndex(s[0], s[1], s[2]);
+                            int s_owner = m_tile_owner_[s_id];
+                            if ((t_owner != rank && s_owner != rank) ||
+                                (t_owner == rank && s_owner == rank && !is_shifted)) {
+                                continue;
+                            }
+                            auto src = m_tiles_[s_id];
+                            std::get<0>(src) += shift;
+                            std::get<1>(src) += shift;
+                            auto region = geometry::Overlap(src, halo_box);
+                            if (geometry::isIllCondition(region)) { continue; }
+                            if (t_owner == rank) { updater.AddRecvRegion(s_owner, region); }
+                            if (s_owner == rank) {
+                                std::get<0>(region) -= shift;
+                                std::get<1>(region) -= shift;
+                                updater.AddSendRegion(t_owner, region);
+                            }
+                        }
+            }
+}
+/**
+ *  Patches are moved in two rounds of messages between the old and the new owners of the tiles, which every process
+ *  knows: the lengths of the messages, then the packed patches.
+ */
+void Atlas::pimpl_s::Migrate(std::vector<int> const &owner) {
+    int rank = GLOBAL_COMM.rank();
+    static constexpr int MIGRATE_TAG = 0x7000;
+    std::map<int, std::string> send_buffers;
+    std::map<int, std::string> recv_buffers;
+    std::map<int, unsigned long> send_sizes, recv_sizes;
+    for (size_type t = 0; t < m_tiles_.size(); ++t) {
+        if (m_tile_owner_[t] == rank && owner[t] != rank) { send_buffers[owner[t]]; }
+        if (m_tile_owner_[t] != rank && owner[t] == rank) { recv_sizes[m_tile_owner_[t]] = 0; }
+    }
+    for (auto it = m_patches_.begin(); it != m_patches_.end();) {
+        auto const &lo = std::get<0>(it->second->GetIndexBox());
+        int dest = owner[TileIndex(TileOf(lo[0], 0), TileOf(lo[1], 1), TileOf(lo[2], 2))];
+        if (dest != rank) {
+            detail::atlas_pack_patch(*it->second, &send_buffers[dest]);
+            it = m_patches_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    auto char_type = std::type_index(typeid(char)).hash_code();
+    auto size_type_hash = std::type_index(typeid(unsigned long)).hash_code();
+    std::vector<int> requests;
+    for (auto &item : recv_sizes) {
+        requests.push_back(GLOBAL_COMM.IRecv(&item.second, 1, size_type_hash, item.first, MIGRATE_TAG));
+    }
+    for (auto const &item : send_buffers) {
+        send_sizes[item.first] = item.second.size();
+        requests.push_back(GLOBAL_COMM.ISend(&send_sizes[item.first], 1, size_type_hash, item.first, MIGRATE_TAG));
+    }
+    GLOBAL_COMM.WaitAll(static_cast<int>(requests.size()), requests.empty() ? nullptr : &requests[0]);
+    requests.clear();
+    for (auto const &item : recv_sizes) {
+        if (item.second == 0) { continue; }
+        auto &buf = recv_buffers[item.first];
+        buf.resize(item.second);
+        requests.push_back(GLOBAL_COMM.IRecv(&buf[0], static_cast<int>(item.second), char_type, item.first,
+                                             MIGRATE_TAG + 1));
+    }
+    for (auto const &item : send_buffers) {
+        if (item.second.empty()) { continue; }
+        requests.push_back(GLOBAL_COMM.ISend(item.second.data(), static_cast<int>(item.second.size()), char_type,
+                                             item.first, MIGRATE_TAG + 1));
+    }
+    GLOBAL_COMM.WaitAll(static_cast<int>(requests.size()), requests.empty() ? nullptr : &requests[0]);
+    for (auto const &item : recv_buffers) {
+        char const *p = item.second.data();
+        while (p < item.second.data() + item.second.size()) {
+            auto patch = detail::atlas_unpack_patch(p);
+            m_patches_.emplace(patch->GetGUID(), patch);
+        }
+    }
+    m_tile_owner_ = owner;
+}
+
+void Atlas::SetCostFunction(std::function<Real(index_box_type const &)> const &fun) {
+    m_pimpl_->m_cost_function_ = fun;
+}
+void Atlas::Decompose(index_tuple const &dims) {
+    SetNumberOfTiles(dims);
+    auto const &g_lo = std::get<0>(m_pimpl_->m_global_index_box_);
+    auto const &g_hi = std::get<1>(m_pimpl_->m_global_index_box_);
+    index_tuple gw = GetHaloWidth() + 1;
+    for (int n = 0; n < 3; ++n) {
+        // a tile is not thinner than the halo, so that the halo of a tile only meets its neighbours
+        index_type length = g_hi[n] - g_lo[n];
+        index_type num = std::max(index_type(1), std::min(static_cast<index_type>(dims[n]), length / gw[n]));
+        m_pimpl_->m_tile_bounds_[n].resize(static_cast<size_type>(num + 1));
+        for (index_type i = 0; i <= num; ++i) { m_pimpl_->m_tile_bounds_[n][i] = g_lo[n] + length * i / num; }
+    }
+    auto &tiles = m_pimpl_->m_tiles_;
+    tiles.clear();
+    std::vector<Real> costs;
+    for (size_type i = 0; i + 1 < m_pimpl_->m_tile_bounds_[0].size(); ++i)
+        for (size_type j = 0; j + 1 < m_pimpl_->m_tile_bounds_[1].size(); ++j)
+            for (size_type k = 0; k + 1 < m_pimpl_->m_tile_bounds_[2].size(); ++k) {
+                index_box_type b{{m_pimpl_->m_tile_bounds_[0][i], m_pimpl_->m_tile_bounds_[1][j],
+                                  m_pimpl_->m_tile_bounds_[2][k]},
+                                 {m_pimpl_->m_tile_bounds_[0][i + 1], m_pimpl_->m_tile_bounds_[1][j + 1],
+                                  m_pimpl_->m_tile_bounds_[2][k + 1]}};
+                tiles.push_back(b);
+                costs.push_back(m_pimpl_->m_cost_function_ != nullptr
+                                    ? m_pimpl_->m_cost_function_(b)
+                                    : static_cast<Real>((std::get<1>(b)[0] - std::get<0>(b)[0]) *
+                                                        (std::get<1>(b)[1] - std::get<0>(b)[1]) *
+                                                        (std::get<1>(b)[2] - std::get<0>(b)[2])));
+            }
+    m_pimpl_->m_tile_owner_ = parallel::PartitionMorton(tiles, costs, GLOBAL_COMM.size());
+    m_pimpl_->SetLocalTiles(*GetChart());
+    VERBOSE << "Decompose: " << tiles.size() << " tiles , estimated imbalance "
+            << parallel::PartitionImbalance(m_pimpl_->m_tile_owner_, costs, GLOBAL_COMM.size()) << std::endl;
+    // the schedule of the halo exchange depends on the owners of the tiles
+    if (m_pimpl_->m_updater_ != nullptr) {
+        auto attrs = m_pimpl_->m_sync_attrs_;
+        if (m_pimpl_->m_updater_->isPending()) { m_pimpl_->m_updater_->End(); }
+        m_pimpl_->m_updater_.reset();
+        SetSyncAttributes(attrs);
+    }
+}
+bool Atlas::Rebalance(std::map<id_type, Real> const &patch_costs, Real threshold) {
+    auto &tiles = m_pimpl_->m_tiles_;
+    if (tiles.empty() || GLOBAL_COMM.size() <= 1) { return false; }
+    std::vector<Real> costs(tiles.size(), 0);
+    for (auto const &item : m_pimpl_->m_patches_) {
+        auto it = patch_costs.find(item.first);
+        if (it == patch_costs.end()) { continue; }
+        auto const &lo = std::get<0>(item.second->GetIndexBox());
+        costs[m_pimpl_->TileIndex(m_pimpl_->TileOf(lo[0], 0), m_pimpl_->TileOf(lo[1], 1),
+                                  m_pimpl_->TileOf(lo[2], 2))] += it->second;
+    }
+    GLOBAL_COMM.all_reduce_sum(&costs[0], static_cast<int>(costs.size()));
+    Real total = 0;
+    for (auto c : costs) { total += c; }
+    auto imbalance = parallel::PartitionImbalance(m_pimpl_->m_tile_owner_, costs, GLOBAL_COMM.size());
+    if (total <= 0 || imbalance <= threshold) { return false; }
+    auto owner = parallel::PartitionMorton(tiles, costs, GLOBAL_COMM.size());
+    if (owner == m_pimpl_->m_tile_owner_) { return false; }
+    auto attrs = m_pimpl_->m_sync_attrs_;
+    if (m_pimpl_->m_updater_ != nullptr && m_pimpl_->m_updater_->isPending()) { m_pimpl_->m_updater_->End(); }
+    m_pimpl_->Migrate(owner);
+    m_pimpl_->SetLocalTiles(*GetChart());
+    VERBOSE << "Rebalance: imbalance " << imbalance << " -> "
+            << parallel::PartitionImbalance(owner, costs, GLOBAL_COMM.size()) << " , " << m_pimpl_->m_patches_.size()
+            << " local patches" << std::endl;
+    if (m_pimpl_->m_updater_ != nullptr) {
+        m_pimpl_->m_updater_.reset();
+        SetSyncAttributes(attrs);
+    }
+    return true;
+}
+bool Atlas::CheckHaloIsLocal(index_box_type const &b) const {
+    // the node of a patch lies on the upper face of its box, so the halo is one wider, as in BuildSyncEdges
+    index_tuple gw = GetHaloWidth() + 1;
+    auto halo_box = geometry::Expand(b, gw);
+    auto const &lo = std::get<0>(halo_box);
+    auto const &hi = std::get<1>(halo_box);
+    auto const &bounding_box = m_pimpl_->m_tiles_.empty() ? GetBoundingIndexBox() : m_pimpl_->m_global_index_box_;
+    bool res = true;
+    for (int n = 0; n < 3; ++n) {
+        res = res && lo[n] >= std::get<0>(bounding_box)[n] && hi[n] <= std::get<1>(bounding_box)[n];
+    }
+    if (!res || m_pimpl_->m_tiles_.empty()) { return res; }
+    int rank = GLOBAL_COMM.rank();
+    for (auto i = m_pimpl_->TileOf(lo[0], 0), ie = m_pimpl_->TileOf(hi[0] - 1, 0); i <= ie; ++i)
+        for (auto j = m_pimpl_->TileOf(lo[1], 1), je = m_pimpl_->TileOf(hi[1] - 1, 1); j <= je; ++j)
+            for (auto k = m_pimpl_->TileOf(lo[2], 2), ke = m_pimpl_->TileOf(hi[2] - 1, 2); k <= ke; ++k) {
+                res = res && m_pimpl_->m_tile_owner_[m_pimpl_->TileIndex(i, j, k)] == rank;
+            }
+    return res;
+}
 void Atlas::Decompose() {
+    auto dims = GetNumberOfTiles();
+    if (dims[0] > 0 && dims[1] > 0 && dims[2] > 0) {
+        Decompose(dims);
+        return;
+    }
+    m_pimpl_->m_tiles_.clear();
+    m_pimpl_->m_tile_owner_.clear();
     m_pimpl_->m_local_index_box_ = m_pimpl_->m_global_index_box_;
 
 #ifdef MPI_FOUND
@@ -155,14 +646,24 @@ void Atlas::Decompose() {
     }
 
 #endif
+    m_pimpl_->SetLocalIndexBox(m_pimpl_->m_local_index_box_, *GetChart());
     //    NewPatch(MeshBlock::New(m_pimpl_->m_local_index_box_, 0, 0));
 }
 
 void Atlas::DoTearDown() { m_pimpl_->m_chart_.reset(); };
 
 std::shared_ptr<Patch> Atlas::AddPatch(index_box_type const &idx_box, int level) {
-    auto b = geometry::Overlap(m_pimpl_->m_local_index_box_, idx_box);
-    return geometry::isIllCondition(b) ? nullptr : SetPatch(Patch::New(MeshBlock::New(b, level)));
+    if (m_pimpl_->m_tiles_.empty()) {
+        auto b = geometry::Overlap(m_pimpl_->m_local_index_box_, idx_box);
+        return geometry::isIllCondition(b) ? nullptr : SetPatch(Patch::New(MeshBlock::New(b, level)));
+    }
+    std::shared_ptr<Patch> res = nullptr;
+    for (size_type t = 0; t < m_pimpl_->m_tiles_.size(); ++t) {
+        if (m_pimpl_->m_tile_owner_[t] != GLOBAL_COMM.rank()) { continue; }
+        auto b = geometry::Overlap(m_pimpl_->m_tiles_[t], idx_box);
+        if (!geometry::isIllCondition(b)) { res = SetPatch(Patch::New(MeshBlock::New(b, level))); }
+    }
+    return res;
 }
 std::shared_ptr<Patch> Atlas::AddPatch(box_type const &box, int level) {
     point_type lo, hi;
@@ -174,14 +675,21 @@ std::shared_ptr<Patch> Atlas::AddPatch(box_type const &box, int level) {
 std::shared_ptr<Patch> Atlas::SetPatch(std::shared_ptr<Patch> const &p) {
     if (p == nullptr) { return nullptr; }
     auto res = m_pimpl_->m_patches_.emplace(p->GetGUID(), p);
-    if (!res.second) { res.first->second->Push(p); }
+    if (!res.second) {
+        res.first->second->Push(p);
+    } else {
+        m_pimpl_->m_sync_edges_is_valid_ = false;
+    }
     return res.first->second;
 }
 std::shared_ptr<Patch> Atlas::GetPatch(id_type gid) const {
     auto it = m_pimpl_->m_patches_.find(gid);
     return it == m_pimpl_->m_patches_.end() ? nullptr : it->second;
 }
-size_type Atlas::DeletePatch(id_type id) { return m_pimpl_->m_patches_.erase(id); }
+size_type Atlas::DeletePatch(id_type id) {
+    m_pimpl_->m_sync_edges_is_valid_ = false;
+    return m_pimpl_->m_patches_.erase(id);
+}
 
 int Atlas::Foreach(std::function<void(std::shared_ptr<Patch> const &)> const &fun) {
     int count = 0;
@@ -193,77 +701,119 @@ int Atlas::Foreach(std::function<void(std::shared_ptr<Patch> const &)> const &fu
 };
 
 void Atlas::SyncGlobal(std::string const &key, std::type_info const &t_info, int num_of_sub, int level) {
-    std::shared_ptr<parallel::MPIUpdater> updater = nullptr;
-    if (t_info == typeid(float)) {
-        updater = parallel::MPIUpdater::New<float>();
-    } else if (t_info == typeid(double)) {
-        updater = parallel::MPIUpdater::New<double>();
-    } else if (t_info == typeid(int)) {
-        updater = parallel::MPIUpdater::New<int>();
-    } else if (t_info == typeid(long)) {
-        updater = parallel::MPIUpdater::New<long>();
-    } else if (t_info == typeid(unsigned int)) {
-        updater = parallel::MPIUpdater::New<unsigned int>();
-    } else if (t_info == typeid(unsigned long)) {
-        updater = parallel::MPIUpdater::New<unsigned long>();
-    } else {
-        UNIMPLEMENTED;
-    }
+    SyncGlobalBegin({std::make_tuple(key, &t_info, num_of_sub)}, level);
+    SyncGlobalEnd(level);
+}
+void Atlas::SetSyncAttributes(std::vector<std::tuple<std::string, std::type_info const *, int>> const &attrs) {
     auto idx_box = GetBoundingIndexBox();
     auto halo_box = GetBoundingHaloIndexBox();
-    for (int dir = 0; dir < 3; ++dir) {
-        updater->SetIndexBox(idx_box);
-        updater->SetHaloIndexBox(halo_box);
-        updater->SetDirection(dir);
-        updater->SetUp();
-        for (int d = 0; d < num_of_sub; ++d) {
-            updater->Clear();
+    auto &updater = m_pimpl_->m_updater_;
+    auto same_box = [](index_box_type const &a, index_box_type const &b) {
+        bool res = true;
+        for (int i = 0; i < 3; ++i) {
+            res = res && std::get<0>(a)[i] == std::get<0>(b)[i] && std::get<1>(a)[i] == std::get<1>(b)[i];
+        }
+        return res;
+    };
+    if (updater != nullptr && attrs == m_pimpl_->m_sync_attrs_ && same_box(idx_box, m_pimpl_->m_sync_box_) &&
+        same_box(halo_box, m_pimpl_->m_sync_halo_box_)) {
+        return;
+    }
+    if (updater != nullptr && updater->isPending()) { updater->End(); }
+    updater = parallel::MPIUpdater::New();
+    updater->SetIndexBox(idx_box);
+    updater->SetHaloIndexBox(halo_box);
+    for (auto const &attr : attrs) {
+        for (int d = 0; d < std::get<2>(attr); ++d) { updater->AddVariable(*std::get<1>(attr)); }
+    }
+    if (!m_pimpl_->m_tiles_.empty()) { m_pimpl_->AddSyncRegions(*updater, GetHaloWidth()); }
+    updater->SetUp();
+    m_pimpl_->m_sync_attrs_ = attrs;
+    m_pimpl_->m_sync_box_ = idx_box;
+    m_pimpl_->m_sync_halo_box_ = halo_box;
+}
+std::vector<std::tuple<std::string, std::type_info const *, int>> const &Atlas::GetSyncAttributes() const {
+    return m_pimpl_->m_sync_attrs_;
+}
+void Atlas::SyncGlobalBegin(std::vector<std::tuple<std::string, std::type_info const *, int>> const &attrs,
+                            int level) {
+    SetSyncAttributes(attrs);
+    SyncGlobalBegin(level);
+}
+void Atlas::SyncGlobalBegin(int level) {
+    auto &updater = m_pimpl_->m_updater_;
+    if (updater == nullptr) { return; }
+    if (updater->isPending()) { SyncGlobalEnd(level); }
+    int v = 0;
+    for (auto const &attr : m_pimpl_->m_sync_attrs_) {
+        for (int d = 0; d < std::get<2>(attr); ++d, ++v) {
             for (auto &item : m_pimpl_->m_patches_) {
-                if (auto patch = item.second->GetDataBlock(key)) {
+                if (auto patch = item.second->GetDataBlock(std::get<0>(attr))) {
                     if (auto blk = patch->Get("_DATA_"))
                         if (auto data = std::dynamic_pointer_cast<ArrayBase>(blk->GetEntity(d))) {
-                            updater->Push(*data);
+                            updater->Push(v, *data);
                         };
                 }
             }
-            updater->SendRecv();
+        }
+    }
+    updater->Begin();
+}
+void Atlas::SyncGlobalEnd(int level) {
+    auto &updater = m_pimpl_->m_updater_;
+    if (updater == nullptr || !updater->isPending()) { return; }
+    updater->End();
+    int v = 0;
+    for (auto const &attr : m_pimpl_->m_sync_attrs_) {
+        for (int d = 0; d < std::get<2>(attr); ++d, ++v) {
             for (auto &item : m_pimpl_->m_patches_) {
-                if (auto patch = item.second->GetDataBlock(key)) {
+                if (auto patch = item.second->GetDataBlock(std::get<0>(attr))) {
                     if (auto blk = patch->Get("_DATA_"))
                         if (auto data = std::dynamic_pointer_cast<ArrayBase>(blk->GetEntity(d))) {
-                            updater->Pop(*data);
+                            updater->Pop(v, *data);
                         }
                 };
             }
         }
-        updater->TearDown();
     }
 }
 void Atlas::SyncLocal(int level) {
-    for (auto ia = m_pimpl_->m_patches_.begin(), ie = m_pimpl_->m_patches_.end(); ia != ie; ++ia) {
-        auto ib = ia;
-        ++ib;
-        for (; ib != ie; ++ib) {
-            auto box_a = ia->second->GetIndexBox();
-            auto box_b = ib->second->GetIndexBox();
-            if (geometry::isAdjoining(box_a, box_b, GetHaloWidth())) {
-                for (auto const &item : ia->second->GetAllDataBlocks()) {
-                    auto a_blk = item.second->Get("_DATA_");
-                    if (auto attr_b = ib->second->GetDataBlock(item.first)) {
-                        auto b_blk = attr_b->Get("_DATA_");
-                        for (int d = 0; d < a_blk->size(); ++d) {
-                            auto array_a = std::dynamic_pointer_cast<ArrayBase>(a_blk->GetEntity(d));
-                            auto array_b = std::dynamic_pointer_cast<ArrayBase>(b_blk->GetEntity(d));
-                            if (array_a != nullptr && array_b != nullptr) {
-                                array_b->CopyIn(*array_a->GetSelectionP(box_a));
-                                array_a->CopyIn(*array_b->GetSelectionP(box_b));
-                            }
-                        }
-                    }
+    if (!m_pimpl_->m_sync_edges_is_valid_) { m_pimpl_->BuildSyncEdges(GetHaloWidth()); }
+    // the arrays of a patch are looked up once, not once per edge
+    std::map<id_type, std::map<std::string, std::vector<std::shared_ptr<ArrayBase>>>> arrays;
+    for (auto const &item : m_pimpl_->m_patches_) {
+        auto const &patch = item.second;
+        if (patch->GetMeshBlock() == nullptr || patch->GetMeshBlock()->GetLevel() != level) { continue; }
+        auto &res = arrays[item.first];
+        for (auto const &attr : patch->GetAllDataBlocks()) {
+            auto blk = attr.second == nullptr ? nullptr : attr.second->Get("_DATA_");
+            if (blk == nullptr) { continue; }
+            auto &v = res[attr.first];
+            for (int d = 0; d < blk->size(); ++d) {
+                v.push_back(std::dynamic_pointer_cast<ArrayBase>(blk->GetEntity(d)));
+            }
+        }
+    }
+    // copy list of this level: destination, source and box
+    std::vector<std::tuple<ArrayBase *, ArrayBase const *, index_box_type const *>> copies;
+    for (auto const &edge : m_pimpl_->m_sync_edges_) {
+        if (edge.level != level) { continue; }
+        auto src = arrays.find(edge.src);
+        auto dst = arrays.find(edge.dst);
+        if (src == arrays.end() || dst == arrays.end()) { continue; }
+        for (auto const &attr : src->second) {
+            auto it = dst->second.find(attr.first);
+            if (it == dst->second.end()) { continue; }
+            for (size_type d = 0, n = std::min(attr.second.size(), it->second.size()); d < n; ++d) {
+                if (attr.second[d] != nullptr && it->second[d] != nullptr) {
+                    copies.emplace_back(it->second[d].get(), attr.second[d].get(), &edge.box);
                 }
             }
-        };
-    };
+        }
+    }
+    auto num = static_cast<int>(copies.size());
+#pragma omp parallel for schedule(dynamic)
+    for (int n = 0; n < num; ++n) { std::get<0>(copies[n])->CopyIn(*std::get<1>(copies[n]), *std::get<2>(copies[n])); }
 }
 
 // int Atlas::GetNumOfLevel() const { return m_pimpl_->(); }
@@ -9,7 +9,13 @@
 
 #include "simpla/SIMPLA_config.h"
 
+#include <functional>
+#include <map>
+#include <string>
+#include <tuple>
 #include <type_traits>
+#include <typeinfo>
+#include <vector>
 
 #include "simpla/algebra/nTuple.ext.h"
 #include "simpla/algebra/nTuple.h"
@@ -128,15 +134,36 @@ class Atlas : public EngineObject {
     SP_PROPERTY(index_tuple, SmallestPatchDimensions) = {4, 4, 4};
     SP_PROPERTY(index_tuple, PeriodicDimensions) = {1, 1, 1};
     SP_PROPERTY(index_box_type, CoarsestIndexBox) = {{0, 0, 0}, {1, 1, 1}};
-
-    void Decompose(index_tuple const &);
+    //! number of tiles along each axis of the cost weighted decomposition, 0 is the cartesian decomposition
+    SP_PROPERTY(index_tuple, NumberOfTiles) = {0, 0, 0};
+
+    /**
+     * Cost weighted decomposition: the global index box is cut into dims tiles, which are no thinner than the halo,
+     * the tiles are ordered along a Morton curve and the curve is cut into pieces of equal cost, one per process.
+     * The local index box is the bounding box of the tiles of this process. Patches are added inside these tiles, see
+     * AddPatch, and the halo is exchanged through explicit regions of the MPIUpdater.
+     */
+    void Decompose(index_tuple const &dims);
+    /** the cost weighted decomposition if NumberOfTiles is set, else the box is sliced over the MPI topology */
     void Decompose();
+    /** estimated cost of a tile, the default is the number of cells */
+    void SetCostFunction(std::function<Real(index_box_type const &)> const &);
+    /**
+     * repartition the tiles by the measured costs of the local patches, e.g. the time of their last advance, if the
+     * imbalance (max / mean cost of the processes) is larger than threshold. Patches of the tiles which change their
+     * owner are migrated with their data. Collective.
+     * @return true if the tiles are repartitioned
+     */
+    bool Rebalance(std::map<id_type, Real> const &patch_costs, Real threshold = 1.1);
+    /** true if the box and its halo are covered by this process, i.e. it is updated without a halo exchange */
+    bool CheckHaloIsLocal(index_box_type const &b) const;
     template <typename... Args>
     std::shared_ptr<Patch> NewPatch(Args &&... args) {
         return SetPatch(Patch::New(std::forward<Args>(args)...));
     }
 
     std::shared_ptr<Patch> AddPatch(box_type const &b, int level = 0);
+    /** in the cost weighted decomposition the box is cut by the local tiles, the last of the patches is returned */
     std::shared_ptr<Patch> AddPatch(index_box_type const &idx_box, int level = 0);
 
     std::shared_ptr<Patch> SetPatch(std::shared_ptr<Patch> const &);
@@ -145,6 +172,20 @@ class Atlas : public EngineObject {
 
     void SyncLocal(int level);
     void SyncGlobal(std::string const &key, std::type_info const &t_info, int num_of_sub, int level);
+    /**
+     * set the attributes {key, value type, number of components} exchanged by SyncGlobalBegin, and build the schedule
+     * of the exchange: neighbours, message layout and buffers. The list must be the same on every process. The
+     * schedule is kept until the list or the index box is changed.
+     */
+    void SetSyncAttributes(std::vector<std::tuple<std::string, std::type_info const *, int>> const &attrs);
+    std::vector<std::tuple<std::string, std::type_info const *, int>> const &GetSyncAttributes() const;
+    /**
+     * exchange the halo of the sync attributes with the neighbour processes, in one message per neighbour.
+     * SyncGlobalBegin posts the messages, SyncGlobalEnd waits for them and copies the halo to the patches.
+     */
+    void SyncGlobalBegin(int level);
+    void SyncGlobalBegin(std::vector<std::tuple<std::string, std::type_info const *, int>> const &attrs, int level);
+    void SyncGlobalEnd(int level);
 
    private:
     struct pimpl_s;
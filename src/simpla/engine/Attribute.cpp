@@ -3,7 +3,9 @@
 //
 
 #include "Attribute.h"
+#include <algorithm>
 #include <set>
+#include <stdexcept>
 #include <typeindex>
 #include "Domain.h"
 #include "MeshBlock.h"
@@ -13,6 +15,11 @@ namespace engine {
 struct AttributeGroup::pimpl_s {
     std::set<Attribute *> m_attributes_;
     bool m_is_initiazlied_ = false;
+    //! attributes bound to the data blocks of the current patch, the capacity is kept between patches
+    std::vector<std::pair<Attribute *, std::shared_ptr<data::DataEntry>>> m_bound_;
+    std::shared_ptr<ScratchArena> m_scratch_ = std::make_shared<ScratchArena>();
+    //! bytes of the scratch arena in use at Bind
+    size_t m_scratch_mark_ = 0;
 };
 AttributeGroup::AttributeGroup() : m_pimpl_(new pimpl_s){};
 
@@ -67,6 +74,41 @@ std::shared_ptr<Patch> AttributeGroup::Pop() const {
     m_pimpl_->m_is_initiazlied_ = false;
     return res;
 }
+void AttributeGroup::Bind(const std::shared_ptr<Patch> &p) {
+    if (p == nullptr) { return; }
+    m_pimpl_->m_is_initiazlied_ = true;
+    m_pimpl_->m_bound_.clear();
+    m_pimpl_->m_scratch_mark_ = m_pimpl_->m_scratch_->GetBytesInUse();
+    for (auto &item : m_pimpl_->m_attributes_) {
+        if (auto blk = p->GetDataBlock(item->GetName())) {
+            if (item->Bind(blk)) {
+                m_pimpl_->m_bound_.emplace_back(item, std::move(blk));
+            } else {
+                item->Push(blk);
+            }
+        } else {
+            m_pimpl_->m_is_initiazlied_ = false;
+        }
+    }
+}
+void AttributeGroup::Unbind(const std::shared_ptr<Patch> &p) {
+    auto &bound = m_pimpl_->m_bound_;
+    for (auto &item : bound) { item.first->Unbind(item.second); }
+    // attributes which were not bound, e.g. created by the initial condition, are handed over once by Pop
+    for (auto &item : m_pimpl_->m_attributes_) {
+        if (p == nullptr || item->isNull() ||
+            std::any_of(bound.begin(), bound.end(), [&](auto const &b) { return b.first == item; })) {
+            continue;
+        }
+        p->SetDataBlock(item->GetName(), item->Pop());
+    }
+    bound.clear();
+    m_pimpl_->m_is_initiazlied_ = false;
+    if (m_pimpl_->m_scratch_->GetBytesInUse() > m_pimpl_->m_scratch_mark_) {
+        throw std::runtime_error(FILE_LINE_STAMP_STRING + "Scratch attributes outlive the patch they are created on!");
+    }
+}
+std::shared_ptr<ScratchArena> AttributeGroup::GetScratchArena() const { return m_pimpl_->m_scratch_; }
 void AttributeGroup::Attach(Attribute *p) {
     if (p != nullptr) { m_pimpl_->m_attributes_.insert(p); }
 }
@@ -12,6 +12,7 @@
 #include "simpla/algebra/ExpressionTemplate.h"
 #include "simpla/data/Data.h"
 #include "simpla/utilities/SPDefines.h"
+#include "simpla/utilities/ScratchArena.h"
 #include "simpla/utilities/type_traits.h"
 
 namespace simpla {
@@ -68,7 +69,23 @@ class AttributeGroup {
 
     virtual void Push(const std::shared_ptr<Patch> &);
     virtual std::shared_ptr<Patch> Pop() const;
+    /**
+     * rebind the attributes to the arrays of the patch by swapping their storage, no DataEntry is created and nothing
+     * is allocated or copied. Until Unbind the patch holds the previous (empty) storage of the attributes, attributes
+     * which can not be bound fall back to Push/Pop.
+     * Binds of groups sharing an attribute (the E and B of the domains of a scenario) must not be nested: while one
+     * group is bound the patch holds its empty storage, so a second group would get that instead of the data. Unbind
+     * the first group before the next one is bound.
+     */
+    virtual void Bind(const std::shared_ptr<Patch> &);
+    virtual void Unbind(const std::shared_ptr<Patch> &);
     virtual bool IsInitialized() const;
+    /**
+     * arena of the scratch ("SCRATCH") attributes of the bound patch. It is kept between patches, so the temporaries
+     * of every patch reuse the same memory, but a temporary must not outlive its patch: Unbind throws if the memory
+     * taken from the arena since Bind is not released.
+     */
+    std::shared_ptr<ScratchArena> GetScratchArena() const;
 
     std::set<Attribute *> &GetAttributes();
     std::set<Attribute *> const &GetAttributes() const;
@@ -115,10 +132,11 @@ struct Attribute : public data::Configurable, public data::Serializable {
     Attribute(this_type &&other) = delete;       // { UNIMPLEMENTED; };
     std::shared_ptr<Attribute> New(std::shared_ptr<simpla::data::DataEntry> const &cfg);
 
+    /** a scratch ("SCRATCH") attribute is a temporary of its host, it is not registered to the host */
     template <typename THost, typename... Args>
     explicit Attribute(THost host, Args &&... args) : Attribute() {
-        Register(host);
         SetProperties(std::forward<Args>(args)...);
+        if (!CheckProperty("SCRATCH")) { Register(host); }
     };
 
     virtual std::shared_ptr<Attribute> Copy() const = 0;
@@ -143,6 +161,10 @@ struct Attribute : public data::Configurable, public data::Serializable {
 
     virtual void Push(const std::shared_ptr<data::DataEntry> &) = 0;
     virtual std::shared_ptr<data::DataEntry> Pop() = 0;
+    /** swap the storage with the arrays of the data entry, @return false if nothing is bound */
+    virtual bool Bind(const std::shared_ptr<data::DataEntry> &) { return false; }
+    /** swap the storage back, the entry must be the one passed to Bind */
+    virtual void Unbind(const std::shared_ptr<data::DataEntry> &) {}
 
     virtual void Clear() = 0;
 
@@ -206,6 +228,8 @@ struct AttributeT : public Attribute, public attribute_traits<V, IFORM, DOF...>:
 
     void Push(const std::shared_ptr<data::DataEntry> &) override;
     std::shared_ptr<data::DataEntry> Pop() override;
+    bool Bind(const std::shared_ptr<data::DataEntry> &) override;
+    void Unbind(const std::shared_ptr<data::DataEntry> &) override;
 
     std::shared_ptr<Attribute> Copy() const override {
         std::shared_ptr<this_type> res(new this_type);
@@ -343,6 +367,24 @@ size_type push_data(nTuple<Array<U>, N0, N...> &v, std::shared_ptr<data::DataEnt
     return count;
 }
 
+template <typename U>
+size_type swap_data(Array<U> &dest, std::shared_ptr<data::DataEntry> const &src) {
+    size_type count = 0;
+    if (src == nullptr) {
+    } else if (auto p = dynamic_cast<Array<U> *>(src->GetEntity().get())) {
+        p->swap(dest);
+        count = 1;
+    }
+    return count;
+}
+
+template <typename U, int N0, int... N>
+size_type swap_data(nTuple<Array<U>, N0, N...> &v, std::shared_ptr<data::DataEntry> const &src) {
+    size_type count = 0;
+    for (int i = 0; i < N0; ++i) { count += swap_data(v[i], src == nullptr ? nullptr : src->Get(i)); }
+    return count;
+}
+
 template <typename U>
 bool is_null(Array<U> const &d) {
     return d.Array<U>::isNull();
@@ -435,6 +477,21 @@ std::shared_ptr<data::DataEntry> AttributeT<V, IFORM, DOF...>::Pop() {
     return res;
 };
 
+template <typename V, int IFORM, int... DOF>
+bool AttributeT<V, IFORM, DOF...>::Bind(const std::shared_ptr<data::DataEntry> &d) {
+    auto src = d == nullptr ? nullptr : d->Get("_DATA_");
+    if (src == nullptr) { return false; }
+    if (detail::swap_data(*this, src) == static_cast<size_type>(GetNumOfSub())) { return true; }
+    // some components are missing, undo the swap and let Push copy what is there
+    detail::swap_data(*this, src);
+    return false;
+};
+
+template <typename V, int IFORM, int... DOF>
+void AttributeT<V, IFORM, DOF...>::Unbind(const std::shared_ptr<data::DataEntry> &d) {
+    if (d != nullptr) { detail::swap_data(*this, d->Get("_DATA_")); }
+};
+
 namespace detail {
 
 template <size_type I0, typename RHS, typename... Args>
@@ -501,6 +558,11 @@ void Assign(TRange const &range, Array<V...> &lhs, RHS const &rhs) {
         lhs.Set(try_invoke<0>(rhs, std::forward<decltype(idx)>(idx)...), std::forward<decltype(idx)>(idx)...);
     });
 };
+//! scalar forms (NODE, CELL), e.g. the result of diverge, are evaluated point by point as the components of a vector
+template <typename TRange, typename... V, typename... RHS>
+void Assign(TRange const &range, Array<V...> &lhs, Expression<RHS...> const &rhs) {
+    Assign_<0>(range, lhs, rhs);
+};
 
 template <typename TRange, typename LHS, typename RHS>
 void Assign(TRange const &, std::index_sequence<>, LHS &lhs, RHS const &rhs){};
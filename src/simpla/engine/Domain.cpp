@@ -13,6 +13,8 @@
 #include <simpla/geometry/GeoObject.h>
 #include <simpla/geometry/Solid.h>
 
+#include "simpla/utilities/Profiler.h"
+
 #include "Attribute.h"
 #include "Domain.h"
 namespace simpla {
@@ -44,7 +46,10 @@ std::shared_ptr<const geometry::Chart> DomainBase::GetChart() const { return m_c
 void DomainBase::SetBoundary(std::shared_ptr<const geometry::GeoObject> const& g) { m_boundary_ = g; }
 std::shared_ptr<const geometry::GeoObject> DomainBase::GetBoundary() const { return m_boundary_; }
 
-void DomainBase::SetMeshBlock(std::shared_ptr<const MeshBlock> const& blk) { m_mesh_block_ = blk; };
+void DomainBase::SetMeshBlock(std::shared_ptr<const MeshBlock> const& blk) {
+    m_mesh_block_ = blk;
+    OnSetMeshBlock(this);
+};
 std::shared_ptr<const MeshBlock> DomainBase::GetMeshBlock() const { return m_mesh_block_; }
 box_type DomainBase::GetBlockBox() const { return GetChart()->GetBoxUVW(GetMeshBlock()->GetIndexBox()); }
 void DomainBase::Push(const std::shared_ptr<Patch>& p) {
@@ -56,6 +61,10 @@ std::shared_ptr<Patch> DomainBase::Pop() const {
     res->SetMeshBlock(GetMeshBlock());
     return res;
 }
+void DomainBase::Bind(const std::shared_ptr<Patch>& p) {
+    SetMeshBlock(p->GetMeshBlock());
+    AttributeGroup::Bind(p);
+}
 
 // box_type DomainBase::GetBoundingBox() const {
 //    return GetBoundary() != nullptr
@@ -90,6 +99,7 @@ void DomainBase::InitialCondition(Real time_now) {
     VERBOSE << " [ " << std::left << std::setw(20) << GetName() << " ] "
             << "Domain::InitialCondition( time_now =" << time_now << ")"
             << " :  " << std::setw(10) << GetMeshBlock()->GetGUID() << GetMeshBlock()->GetIndexBox();
+    SP_PROFILE_SCOPE("InitialCondition", GetName(), GetMeshBlock()->GetGUID());
     PreInitialCondition(this, time_now);
     DoInitialCondition(time_now);
     PostInitialCondition(this, time_now);
@@ -101,6 +111,7 @@ void DomainBase::BoundaryCondition(Real time_now, Real dt) {
     VERBOSE << " [ " << std::left << std::setw(20) << GetName() << " ] "
             << "Domain::BoundaryCondition( time_now=" << time_now << " , dt=" << dt << ")"
             << " :  " << std::setw(10) << GetMeshBlock()->GetGUID() << GetMeshBlock()->GetIndexBox();
+    SP_PROFILE_SCOPE("BoundaryCondition", GetName(), GetMeshBlock()->GetGUID());
     PreBoundaryCondition(this, time_now, dt);
     DoBoundaryCondition(time_now, dt);
     PostBoundaryCondition(this, time_now, dt);
@@ -112,16 +123,43 @@ void DomainBase::ComputeFluxes(Real time_now, Real time_dt) {
     VERBOSE << " [ " << std::left << std::setw(20) << GetName() << " ] "
             << "Domain::ComputeFluxes(time_now=" << time_now << " , time_dt=" << time_dt << ")"
             << " :  " << std::setw(10) << GetMeshBlock()->GetGUID() << GetMeshBlock()->GetIndexBox();
+    SP_PROFILE_SCOPE("ComputeFluxes", GetName(), GetMeshBlock()->GetGUID());
     PreComputeFluxes(this, time_now, time_dt);
     DoComputeFluxes(time_now, time_dt);
     PostComputeFluxes(this, time_now, time_dt);
 }
 Real DomainBase::ComputeStableDtOnPatch(Real time_now, Real time_dt) const {
-    if (!isModified() || !CheckBlockInBoundary()) { return time_dt; }
+    if (!CheckBlockInBoundary()) { return time_dt; }
     VERBOSE << " [ " << std::left << std::setw(20) << GetName() << " ] "
             << "Domain::ComputeStableDtOnPatch( time_now=" << time_now << " , time_dt=" << time_dt << ")"
             << " :  " << std::setw(10) << GetMeshBlock()->GetGUID() << GetMeshBlock()->GetIndexBox();
-    return time_dt;
+    return std::min(time_dt, DoComputeStableDt(time_now));
+}
+Real DomainBase::GetMinCellWidth() const {
+    auto guid = GetMeshBlock()->GetGUID();
+    auto it = m_min_cell_width_.find(guid);
+    if (it != m_min_cell_width_.end()) { return it->second; }
+
+    auto chart = GetChart();
+    index_tuple lo, hi;
+    std::tie(lo, hi) = GetMeshBlock()->GetIndexBox();
+    Real res = std::numeric_limits<Real>::infinity();
+    for (index_type i = lo[0]; i < hi[0]; ++i)
+        for (index_type j = lo[1]; j < hi[1]; ++j)
+            for (index_type k = lo[2]; k < hi[2]; ++k) {
+                auto x0 = chart->local_coordinates(0b0, i, j, k);
+                Real s = 0;
+                for (int w = 0; w < 3; ++w) {
+                    if (hi[w] - lo[w] <= 1) { continue; }
+                    auto dl = chart->length(x0, chart->local_coordinates(0b0, i + (w == 0 ? 1 : 0),
+                                                                         j + (w == 1 ? 1 : 0), k + (w == 2 ? 1 : 0)),
+                                            w);
+                    if (dl != 0) { s += 1.0 / (dl * dl); }
+                }
+                if (s > 0) { res = std::min(res, 1.0 / std::sqrt(s)); }
+            }
+    m_min_cell_width_.emplace(guid, res);
+    return res;
 }
 
 void DomainBase::Advance(Real time_now, Real time_dt) {
@@ -130,6 +168,7 @@ void DomainBase::Advance(Real time_now, Real time_dt) {
     VERBOSE << " [ " << std::left << std::setw(20) << GetName() << " ] "
             << "Domain::Advance(time_now=" << time_now << " , dt=" << time_dt << ")"
             << " :  " << std::setw(10) << GetMeshBlock()->GetGUID() << GetMeshBlock()->GetIndexBox();
+    SP_PROFILE_SCOPE("Advance", GetName(), GetMeshBlock()->GetGUID());
     PreAdvance(this, time_now, time_dt);
     DoAdvance(time_now, time_dt);
     PostAdvance(this, time_now, time_dt);
@@ -141,6 +180,7 @@ void DomainBase::TagRefinementCells(Real time_now) {
             << "Domain::TagRefinementCells(time_now=" << time_now << ")"
             << " :  " << std::setw(10) << GetMeshBlock()->GetGUID() << GetMeshBlock()->GetIndexBox();
 
+    SP_PROFILE_SCOPE("TagRefinementCells", GetName(), GetMeshBlock()->GetGUID());
     PreTagRefinementCells(this, time_now);
     //    TagRefinementRange(GetRange(GetName() + "_BOUNDARY_3"));
     DoTagRefinementCells(time_now);
@@ -8,12 +8,17 @@
 #include "simpla/SIMPLA_config.h"
 
 #include <simpla/geometry/CutCell.h>
+#include <limits>
+#include <map>
 #include <memory>
 
 #include "simpla/algebra/Array.h"
+#include "simpla/algebra/FusedAssign.h"
+#include "simpla/algebra/Reduction.h"
 #include "simpla/algebra/nTuple.h"
 #include "simpla/data/Data.h"
 #include "simpla/geometry/Chart.h"
+#include "simpla/utilities/ScratchArena.h"
 #include "simpla/utilities/Signal.h"
 
 #include "Attribute.h"
@@ -33,16 +38,21 @@ class DomainBase : public EngineObject, public AttributeGroup {
     std::shared_ptr<const geometry::Chart> m_chart_ = nullptr;
     std::shared_ptr<const geometry::GeoObject> m_boundary_ = nullptr;
     std::shared_ptr<const MeshBlock> m_mesh_block_ = nullptr;
+    //! GetMinCellWidth of the patches bound so far, the chart does not change
+    mutable std::map<id_type, Real> m_min_cell_width_;
 
    public:
     void Push(const std::shared_ptr<Patch> &) override;
     std::shared_ptr<Patch> Pop() const override;
+    void Bind(const std::shared_ptr<Patch> &) override;
     bool IsInitialized() const override;
 
     void SetChart(std::shared_ptr<const geometry::Chart> const &c);
     virtual std::shared_ptr<const geometry::Chart> GetChart() const;
 
+    /** Push and Bind set the mesh block of the patch, then emit OnSetMeshBlock, e.g. to rebuild a metric */
     void SetMeshBlock(const std::shared_ptr<const MeshBlock> &blk);
+    design_pattern::Signal<void(DomainBase *)> OnSetMeshBlock;
     virtual std::shared_ptr<const MeshBlock> GetMeshBlock() const;
     box_type GetBlockBox() const;
 
@@ -80,7 +90,16 @@ class DomainBase : public EngineObject, public AttributeGroup {
     virtual void DoComputeFluxes(Real time_now, Real dt) {}
     design_pattern::Signal<void(DomainBase *, Real, Real)> PostComputeFluxes;
     void ComputeFluxes(Real time_now, Real time_dt);
+    /** largest stable time step of the bound patch, infinity if it is not limited by this domain */
+    virtual Real DoComputeStableDt(Real time_now) const { return std::numeric_limits<Real>::infinity(); }
+    /** min(time_dt, DoComputeStableDt(time_now)) */
     Real ComputeStableDtOnPatch(Real time_now, Real time_dt) const;
+    /**
+     * min over the cells of the bound patch of  (sum_w 1/dl_w^2)^(-1/2) , where dl_w is the length of the cell edge
+     * along w, e.g. the light crossing time is GetMinCellWidth()/c. Directions of one cell and edges of zero length
+     * (the axis of csCylindrical) are skipped.
+     */
+    Real GetMinCellWidth() const;
 
     design_pattern::Signal<void(DomainBase *, Real, Real)> PreAdvance;
     virtual void DoAdvance(Real time_now, Real dt) {}
@@ -109,6 +128,35 @@ class Domain : public DomainBase, public Policies<Domain<TChart, Policies...>>..
     template <typename V, int IFORM, int... DOF, typename TR>
     void Fill(AttributeT<V, IFORM, DOF...> &lhs, TR const &rhs) const;
 
+    /**
+     * Evaluate a sequence of assignments in as few sweeps as their dependencies allow, e.g.
+     *      Fuse(assign(X, X + dX), assign(B, B - dX));
+     * is one sweep, while a stencil on a field written earlier in the sequence starts a new sweep. see FusedAssign
+     */
+    template <typename... Args>
+    void Fuse(Args const &... args) const;
+
+    /**
+     * Sum, Max and Min over the bound patch of the components of rhs, a scalar valued field or an expression of
+     * fields, in one sweep per component, see Reduction.h. An entity is counted by the patch of the cell at its lower
+     * corner, so no entity is counted twice in an atlas. Integrate weights every entity with its volume (FVM), e.g.
+     * Integrate(E, E) / 2 is the electric energy in the patch. Local to the patch, see Scenario::Sum.
+     */
+    template <typename TR>
+    Real Sum(TR const &rhs) const;
+    template <typename TR>
+    Real Max(TR const &rhs) const;
+    template <typename TR>
+    Real Min(TR const &rhs) const;
+    /** Sum(lhs * rhs) */
+    template <typename TL, typename TR>
+    Real Dot(TL const &lhs, TR const &rhs) const;
+    template <typename TR>
+    Real Integrate(TR const &rhs) const;
+    /** Integrate(lhs * rhs) */
+    template <typename TL, typename TR>
+    Real Integrate(TL const &lhs, TR const &rhs) const;
+
     template <typename U, int IFORM, int... DOF>
     void InitializeAttribute(AttributeT<U, IFORM, DOF...> *attr) const;
 
@@ -210,38 +258,53 @@ void Domain<TChart, Policies...>::DoAdvance(Real time_now, Real dt) {}
 // void Domain<TChart, Policies...>::DoTagRefinementCells(Real time_now) {}
 
 namespace detail {
+/**
+ * scratch arrays take their memory from the arena of the domain (see AttributeGroup::GetScratchArena), and are not
+ * initialized, scratch is null for the other arrays
+ */
 template <typename U, typename SFC>
-void InitializeArray_(Array<U, SFC> &v, SFC const &sfc) {
-    Array<U, SFC>(sfc).swap(v);
-    v.alloc();
+void InitializeArray_(Array<U, SFC> &v, SFC const &sfc, std::shared_ptr<ScratchArena> const &scratch) {
+    if (scratch != nullptr) {
+        std::shared_ptr<U> const d = scratch->MakeShared<U>(sfc.shape_size());
+        Array<U, SFC>(d, sfc).swap(v);
+    } else {
+        Array<U, SFC>(sfc).swap(v);
+        v.alloc();
+    }
 }
 template <typename U, int N0, int... N, typename SFC>
-void InitializeArray_(nTuple<simpla::Array<U, SFC>, N0, N...> &v, SFC const &sfc) {
-    for (int i = 0; i < N0; ++i) { InitializeArray_(v[i], sfc); }
+void InitializeArray_(nTuple<simpla::Array<U, SFC>, N0, N...> &v, SFC const &sfc,
+                      std::shared_ptr<ScratchArena> const &scratch) {
+    for (int i = 0; i < N0; ++i) { InitializeArray_(v[i], sfc, scratch); }
 }
 template <typename TArray, typename THost>
-void InitializeArray(std::integral_constant<int, NODE>, THost const *host, TArray &v) {
-    InitializeArray_(v, host->GetSpaceFillingCurve(0b000));
+void InitializeArray(std::integral_constant<int, NODE>, THost const *host, TArray &v,
+                     std::shared_ptr<ScratchArena> const &scratch) {
+    InitializeArray_(v, host->GetSpaceFillingCurve(0b000), scratch);
 }
 template <typename TArray, typename THost>
-void InitializeArray(std::integral_constant<int, CELL>, THost const *host, TArray &v) {
-    InitializeArray_(v, host->GetSpaceFillingCurve(0b000));
+void InitializeArray(std::integral_constant<int, CELL>, THost const *host, TArray &v,
+                     std::shared_ptr<ScratchArena> const &scratch) {
+    InitializeArray_(v, host->GetSpaceFillingCurve(0b000), scratch);
 }
 template <typename TArray, typename THost>
-void InitializeArray(std::integral_constant<int, EDGE>, THost const *host, TArray &v) {
-    InitializeArray_(v[0], host->GetSpaceFillingCurve(0b001));
-    InitializeArray_(v[1], host->GetSpaceFillingCurve(0b010));
-    InitializeArray_(v[2], host->GetSpaceFillingCurve(0b100));
+void InitializeArray(std::integral_constant<int, EDGE>, THost const *host, TArray &v,
+                     std::shared_ptr<ScratchArena> const &scratch) {
+    InitializeArray_(v[0], host->GetSpaceFillingCurve(0b001), scratch);
+    InitializeArray_(v[1], host->GetSpaceFillingCurve(0b010), scratch);
+    InitializeArray_(v[2], host->GetSpaceFillingCurve(0b100), scratch);
 }
 template <typename TArray, typename THost>
-void InitializeArray(std::integral_constant<int, FACE>, THost const *host, TArray &v) {
-    InitializeArray_(v[0], host->GetSpaceFillingCurve(0b110));
-    InitializeArray_(v[1], host->GetSpaceFillingCurve(0b101));
-    InitializeArray_(v[2], host->GetSpaceFillingCurve(0b011));
+void InitializeArray(std::integral_constant<int, FACE>, THost const *host, TArray &v,
+                     std::shared_ptr<ScratchArena> const &scratch) {
+    InitializeArray_(v[0], host->GetSpaceFillingCurve(0b110), scratch);
+    InitializeArray_(v[1], host->GetSpaceFillingCurve(0b101), scratch);
+    InitializeArray_(v[2], host->GetSpaceFillingCurve(0b011), scratch);
 }
 
 template <int IFORM, typename TArray, typename THost>
-void InitializeArray(std::integral_constant<int, IFORM>, THost const *host, TArray &v) {
+void InitializeArray(std::integral_constant<int, IFORM>, THost const *host, TArray &v,
+                     std::shared_ptr<ScratchArena> const &scratch) {
     UNIMPLEMENTED;
 }
 
@@ -357,18 +420,166 @@ template <typename THost, typename V, int... DOF, typename... U>
 void DomainAssign(THost *self, AttributeT<V, CELL, DOF...> &lhs, Expression<U...> const &rhs) {
     lhs.Assign(self->template Calculate<0>(rhs), self->GetSpaceFillingCurve(0b111));
 };
+
+template <int I, typename THost, typename... U>
+decltype(auto) DomainComponent(std::false_type, THost const *self, Expression<U...> const &rhs) {
+    return self->template Calculate<I>(rhs);
+}
+template <int I, typename THost, typename V, int IFORM, int... DOF>
+decltype(auto) DomainComponent(std::false_type, THost const *self, AttributeT<V, IFORM, DOF...> const &rhs) {
+    return simpla::traits::nt_get_r<I>(dynamic_cast<typename AttributeT<V, IFORM, DOF...>::data_type const &>(rhs));
+}
+//! component times the volume of its entity
+template <int I, typename THost, typename TR>
+decltype(auto) DomainComponent(std::true_type, THost const *self, TR const &rhs) {
+    return self->template CalculateV<I>(rhs);
+}
+/** fold of the components I... of rhs, see Domain::Sum */
+template <typename TWeighted, typename THost, typename TR, typename TOp, typename TMap, int... I>
+Real DomainReduce(TWeighted weighted, THost const *self, std::integer_sequence<int, I...>, TR const &rhs, Real init,
+                  TOp const &op, TMap const &map) {
+    static const int IFORM = simpla::traits::iform<TR>::value;
+    auto box = self->GetMeshBlock()->GetIndexBox();
+    Real res[] = {init, ::simpla::detail::array_reduce(
+                            self->GetSpaceFillingCurve(EntityIdCoder::m_sub_index_to_id_[IFORM][I]).GetSelection(box),
+                            init, op, map, DomainComponent<I>(weighted, self, rhs))...};
+    Real r = init;
+    for (auto v : res) { r = op(r, v); }
+    return r;
+}
+template <typename TWeighted, typename THost, typename TR, typename TOp>
+Real DomainReduce(TWeighted weighted, THost const *self, TR const &rhs, Real init, TOp const &op) {
+    static const int IFORM = simpla::traits::iform<TR>::value;
+    typedef std::conditional_t<(IFORM == NODE || IFORM == CELL), std::integer_sequence<int, 0>,
+                               std::integer_sequence<int, 0, 1, 2>>
+        components;
+    return DomainReduce(weighted, self, components(), rhs, init, op, ::simpla::detail::reduce_value());
+}
+
+template <typename LHS, typename RHS>
+struct DeferredAssign {
+    LHS &lhs;
+    RHS const &rhs;
+};
+
+template <typename THost, typename U, typename RHS>
+bool FusedKernels(THost const *self, std::integral_constant<int, NODE>, Array<U> &lhs, RHS const &rhs,
+                  std::vector<FusedKernel> &res) {
+    res.push_back(
+        MakeFusedKernel(lhs, self->template Calculate<0>(rhs), self->GetSpaceFillingCurve(0b000).GetIndexBox()));
+    return true;
+}
+template <typename THost, typename U, typename RHS>
+bool FusedKernels(THost const *self, std::integral_constant<int, CELL>, Array<U> &lhs, RHS const &rhs,
+                  std::vector<FusedKernel> &res) {
+    res.push_back(
+        MakeFusedKernel(lhs, self->template Calculate<0>(rhs), self->GetSpaceFillingCurve(0b111).GetIndexBox()));
+    return true;
+}
+template <typename THost, typename U, typename RHS>
+bool FusedKernels(THost const *self, std::integral_constant<int, EDGE>, nTuple<Array<U>, 3> &lhs, RHS const &rhs,
+                  std::vector<FusedKernel> &res) {
+    res.push_back(
+        MakeFusedKernel(lhs[0], self->template Calculate<0>(rhs), self->GetSpaceFillingCurve(0b001).GetIndexBox()));
+    res.push_back(
+        MakeFusedKernel(lhs[1], self->template Calculate<1>(rhs), self->GetSpaceFillingCurve(0b010).GetIndexBox()));
+    res.push_back(
+        MakeFusedKernel(lhs[2], self->template Calculate<2>(rhs), self->GetSpaceFillingCurve(0b100).GetIndexBox()));
+    return true;
+}
+template <typename THost, typename U, typename RHS>
+bool FusedKernels(THost const *self, std::integral_constant<int, FACE>, nTuple<Array<U>, 3> &lhs, RHS const &rhs,
+                  std::vector<FusedKernel> &res) {
+    res.push_back(
+        MakeFusedKernel(lhs[0], self->template Calculate<0>(rhs), self->GetSpaceFillingCurve(0b110).GetIndexBox()));
+    res.push_back(
+        MakeFusedKernel(lhs[1], self->template Calculate<1>(rhs), self->GetSpaceFillingCurve(0b101).GetIndexBox()));
+    res.push_back(
+        MakeFusedKernel(lhs[2], self->template Calculate<2>(rhs), self->GetSpaceFillingCurve(0b011).GetIndexBox()));
+    return true;
+}
+/** fields with extra DOF  are not fused */
+template <typename THost, int IFORM, typename TData, typename RHS>
+bool FusedKernels(THost const *self, std::integral_constant<int, IFORM>, TData &lhs, RHS const &rhs,
+                  std::vector<FusedKernel> &res) {
+    return false;
+}
+
+template <typename THost, typename LHS, typename RHS>
+void DomainFuse(THost const *self, FusedAssign &loop, LHS &lhs, RHS const &rhs) {
+    loop.Flush();
+    lhs = rhs;
+}
+template <typename THost, typename LHS, typename... U>
+void DomainFuse(THost const *self, FusedAssign &loop, LHS &lhs, Expression<U...> const &rhs) {
+    lhs.Update();
+    std::vector<FusedKernel> kernels;
+    if (FusedKernels(self, std::integral_constant<int, traits::iform<LHS>::value>(),
+                     dynamic_cast<typename LHS::data_type &>(lhs), rhs, kernels)) {
+        loop.Push(kernels);
+    } else {
+        loop.Flush();
+        lhs = rhs;
+    }
+}
 }  // namespace detail {
 
+template <typename LHS, typename RHS>
+detail::DeferredAssign<LHS, RHS> assign(LHS &lhs, RHS const &rhs) {
+    return detail::DeferredAssign<LHS, RHS>{lhs, rhs};
+}
+
 template <typename TChart, template <typename> class... Policies>
 template <typename U, int IFORM, int... DOF>
 void Domain<TChart, Policies...>::InitializeAttribute(AttributeT<U, IFORM, DOF...> *attr) const {
-    detail::InitializeArray(std::integral_constant<int, IFORM>(), this, *attr);
+    detail::InitializeArray(std::integral_constant<int, IFORM>(), this, *attr,
+                            attr->CheckProperty("SCRATCH") ? GetScratchArena() : nullptr);
 };
 template <typename TM, template <typename> class... Policies>
 template <typename V, int IFORM, int... DOF, typename RHS>
 void Domain<TM, Policies...>::Fill(AttributeT<V, IFORM, DOF...> &lhs, RHS const &rhs) const {
     detail::DomainAssign(this, lhs, rhs);
 };
+template <typename TM, template <typename> class... Policies>
+template <typename... Args>
+void Domain<TM, Policies...>::Fuse(Args const &... args) const {
+    FusedAssign loop;
+    int dummy[] = {(detail::DomainFuse(this, loop, args.lhs, args.rhs), 0)..., 0};
+    (void)dummy;
+    loop.Flush();
+};
+template <typename TM, template <typename> class... Policies>
+template <typename TR>
+Real Domain<TM, Policies...>::Sum(TR const &rhs) const {
+    return detail::DomainReduce(std::false_type(), this, rhs, 0, ::simpla::detail::reduce_sum());
+};
+template <typename TM, template <typename> class... Policies>
+template <typename TR>
+Real Domain<TM, Policies...>::Max(TR const &rhs) const {
+    return detail::DomainReduce(std::false_type(), this, rhs, -std::numeric_limits<Real>::infinity(),
+                                ::simpla::detail::reduce_max());
+};
+template <typename TM, template <typename> class... Policies>
+template <typename TR>
+Real Domain<TM, Policies...>::Min(TR const &rhs) const {
+    return detail::DomainReduce(std::false_type(), this, rhs, std::numeric_limits<Real>::infinity(),
+                                ::simpla::detail::reduce_min());
+};
+template <typename TM, template <typename> class... Policies>
+template <typename TL, typename TR>
+Real Domain<TM, Policies...>::Dot(TL const &lhs, TR const &rhs) const {
+    return Sum(Expression<tags::multiplication, TL, TR>(lhs, rhs));
+};
+template <typename TM, template <typename> class... Policies>
+template <typename TR>
+Real Domain<TM, Policies...>::Integrate(TR const &rhs) const {
+    return detail::DomainReduce(std::true_type(), this, rhs, 0, ::simpla::detail::reduce_sum());
+};
+template <typename TM, template <typename> class... Policies>
+template <typename TL, typename TR>
+Real Domain<TM, Policies...>::Integrate(TL const &lhs, TR const &rhs) const {
+    return Integrate(Expression<tags::multiplication, TL, TR>(lhs, rhs));
+};
 }  // namespace engine
 }  // namespace simpla
 #endif  // SIMPLA_DOMAINBASE_H
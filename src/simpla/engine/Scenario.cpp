@@ -9,8 +9,18 @@
 #include <simpla/geometry/GeoEngine.h>
 #include <simpla/parallel/MPIComm.h>
 #include <simpla/parallel/Parallel.h>
+#include <simpla/utilities/Profiler.h>
+#include <simpla/utilities/ScratchArena.h>
+#include <simpla/utilities/memory.h>
 #include <simpla/utilities/type_cast.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <limits>
+#include <mutex>
+#include <thread>
 
 #include "Atlas.h"
 #include "Domain.h"
@@ -23,11 +33,115 @@ struct Scenario::pimpl_s {
     std::map<std::string, std::shared_ptr<Attribute>> m_attrs_;
     std::map<std::string, std::shared_ptr<DomainBase>> m_domains_;
     size_type m_step_counter_ = 0;
+
+    //! background checkpoint writer, CheckPoint hands it snapshots of the data blocks
+    std::thread m_writer_;
+    int m_writer_comm_ = -1;
+    std::mutex m_writer_mutex_;
+    std::condition_variable m_writer_cv_;
+    //! checkpoints not yet written, the front one is being written
+    std::deque<std::pair<std::string, std::shared_ptr<data::DataEntry>>> m_pending_;
+    bool m_writer_stop_ = false;
+    std::exception_ptr m_writer_error_ = nullptr;
+    //! time of the writes, time the main thread spent in CheckPoint, and the part of it waiting for the writer
+    Real m_write_time_ = 0;
+    Real m_exposed_time_ = 0;
+    Real m_wait_time_ = 0;
+    size_type m_num_of_check_points_ = 0;
+    bool m_async_warned_ = false;
+
+    static void Write(std::string const &uri, std::shared_ptr<data::DataEntry> const &tree);
+    void WriterLoop();
+    void StartWriter();
+    void StopWriter();
+    /** block until at most num checkpoints are pending, and rethrow the error of the writer */
+    void WaitPending(size_type num);
 };
+void Scenario::pimpl_s::Write(std::string const &uri, std::shared_ptr<data::DataEntry> const &tree) {
+    auto dump = data::DataEntry::New(uri);
+    dump->Set(tree);
+    dump->Flush();
+}
+void Scenario::pimpl_s::WriterLoop() {
+    GLOBAL_COMM.UseThreadComm(m_writer_comm_);
+    std::unique_lock<std::mutex> lock(m_writer_mutex_);
+    while (true) {
+        m_writer_cv_.wait(lock, [&] { return m_writer_stop_ || !m_pending_.empty(); });
+        if (m_pending_.empty()) { break; }
+        auto item = m_pending_.front();
+        lock.unlock();
+        auto t0 = std::chrono::steady_clock::now();
+        std::exception_ptr error = nullptr;
+        try {
+            SP_PROFILE_SCOPE("CheckPointWrite");
+            Write(item.first, item.second);
+        } catch (...) { error = std::current_exception(); }
+        item.second.reset();
+        lock.lock();
+        m_write_time_ += std::chrono::duration<Real>(std::chrono::steady_clock::now() - t0).count();
+        if (error != nullptr && m_writer_error_ == nullptr) { m_writer_error_ = error; }
+        m_pending_.pop_front();
+        m_writer_cv_.notify_all();
+    }
+}
+void Scenario::pimpl_s::StartWriter() {
+    if (m_writer_.joinable()) { return; }
+    // the writer calls the collectives of the backends on its own communicator
+    if (m_writer_comm_ < 0) { m_writer_comm_ = GLOBAL_COMM.CreateThreadComm(); }
+    m_writer_stop_ = false;
+    m_writer_ = std::thread([this] { WriterLoop(); });
+}
+void Scenario::pimpl_s::StopWriter() {
+    if (!m_writer_.joinable()) { return; }
+    {
+        std::lock_guard<std::mutex> lock(m_writer_mutex_);
+        m_writer_stop_ = true;
+    }
+    m_writer_cv_.notify_all();
+    m_writer_.join();
+}
+void Scenario::pimpl_s::WaitPending(size_type num) {
+    std::unique_lock<std::mutex> lock(m_writer_mutex_);
+    m_writer_cv_.wait(lock, [&] { return m_pending_.size() <= num; });
+    if (m_writer_error_ != nullptr) {
+        auto error = m_writer_error_;
+        m_writer_error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+/**
+ * copy of the data block of an attribute, the arrays are copied into blocks of the memory pool (which are reused by
+ * the next checkpoint once this one is written), light data is shared
+ */
+static std::shared_ptr<data::DataEntry> SnapshotDataBlock(std::shared_ptr<const data::DataEntry> const &node) {
+    std::shared_ptr<data::DataEntry> res = nullptr;
+    switch (node->type()) {
+        case data::DataEntry::DN_ENTITY: {
+            auto entity = std::const_pointer_cast<data::DataEntity>(node->GetEntity());
+            auto copy = entity == nullptr ? nullptr : entity->Copy();
+            res = data::DataEntry::New(copy != nullptr ? copy : entity);
+            break;
+        }
+        case data::DataEntry::DN_ARRAY:
+            res = data::DataEntry::New(data::DataEntry::DN_ARRAY);
+            for (size_type i = 0, ie = node->size(); i < ie; ++i) { res->Add(SnapshotDataBlock(node->Get(i))); }
+            break;
+        case data::DataEntry::DN_TABLE:
+            res = data::DataEntry::New(data::DataEntry::DN_TABLE);
+            node->Foreach([&](std::string const &k, std::shared_ptr<const data::DataEntry> const &v) {
+                res->Set(k, SnapshotDataBlock(v));
+            });
+            break;
+        default:
+            res = node->Copy();
+    }
+    return res;
+}
 
 Scenario::Scenario() : m_pimpl_(new pimpl_s) { m_pimpl_->m_atlas_ = Atlas::New(); }
 Scenario::~Scenario() {
     Finalize();
+    m_pimpl_->StopWriter();
     delete m_pimpl_;
 }
 
@@ -68,11 +182,33 @@ void Scenario::Deserialize(std::shared_ptr<const data::DataEntry> const &cfg) {
 }
 
 void Scenario::CheckPoint(size_type step_num) const {
+    SP_PROFILE_SCOPE("CheckPoint");
+    auto t0 = std::chrono::steady_clock::now();
     std::ostringstream os;
     os << GetProperty<std::string>("CheckPointFilePrefix", GetName()) << std::setfill('0') << std::setw(8)
        << GetStepNumber() << "." << GetProperty<std::string>("CheckPointFileSuffix", "xdmf");
+    // the background writer needs MPI_THREAD_MULTIPLE, as the backends gather over the processes, so it is on by
+    // default only if MPI was initialized for it
+    bool can_async = GLOBAL_COMM.size() <= 1 || GLOBAL_COMM.is_thread_multiple();
+    bool async = GetProperty<bool>("CheckPointAsync", can_async);
+    if (async && !can_async) {
+        if (!m_pimpl_->m_async_warned_) {
+            WARNING << "CheckPointAsync needs \"--checkpoint_async\" on the command line, checkpoints are written "
+                       "synchronously!"
+                    << std::endl;
+            m_pimpl_->m_async_warned_ = true;
+        }
+        async = false;
+    }
+    if (async) {
+        // back pressure: at most CheckPointMaxPending checkpoints wait for the writer, two for double buffering
+        auto max_pending = std::max(GetProperty<size_type>("CheckPointMaxPending", 2), static_cast<size_type>(1));
+        auto t1 = std::chrono::steady_clock::now();
+        m_pimpl_->WaitPending(max_pending - 1);
+        m_pimpl_->m_wait_time_ += std::chrono::duration<Real>(std::chrono::steady_clock::now() - t1).count();
+    }
 
-    auto dump = data::DataEntry::New(os.str());
+    auto dump = data::DataEntry::New(data::DataEntry::DN_TABLE);
     //    dump->Set("Atlas", GetAtlas()->Serialize());
     dump->Set("Atlas/Chart", GetAtlas()->GetChart()->Serialize());
     auto patches = dump->CreateNode("Atlas/Patches", data::DataEntry::DN_TABLE);
@@ -81,15 +217,50 @@ void Scenario::CheckPoint(size_type step_num) const {
         d_patch->Set("MeshBlock", patch->GetMeshBlock()->Serialize());
         auto d_attrs = d_patch->CreateNode("Attributes", data::DataEntry::DN_TABLE);
         for (auto const &attr : m_pimpl_->m_attrs_) {
-            auto check_point = attr.second->GetProperty<size_type>("CheckPoint", 0);
-            if (check_point != 0 && step_num % check_point == 0) {
-                if (auto data_blk = patch->GetDataBlock(attr.first)) { d_attrs->Set(attr.first, data_blk); }
+            auto check_point = attr.second->GetProperty<int>("CheckPoint", 0);
+            if (check_point > 0 && step_num % check_point == 0) {
+                if (auto data_blk = patch->GetDataBlock(attr.first)) {
+                    // the solver goes on while the writer runs, so it is given a copy of the arrays
+                    auto d = SnapshotDataBlock(data_blk);
+                    // per attribute deflate level, e.g. PML fields which are mostly zero
+                    auto level = attr.second->GetProperty<int>("Compression", 0);
+                    if (level > 0) { d->SetValue("Compression", level); }
+                    d_attrs->Set(attr.first, d);
+                }
             }
         }
 
     });
     dump->SetValue<Real>("Time", GetTime());
-    dump->Flush();
+
+    if (async) {
+        m_pimpl_->StartWriter();
+        {
+            std::lock_guard<std::mutex> lock(m_pimpl_->m_writer_mutex_);
+            m_pimpl_->m_pending_.emplace_back(os.str(), dump);
+        }
+        m_pimpl_->m_writer_cv_.notify_all();
+    } else {
+        auto t1 = std::chrono::steady_clock::now();
+        pimpl_s::Write(os.str(), dump);
+        m_pimpl_->m_write_time_ += std::chrono::duration<Real>(std::chrono::steady_clock::now() - t1).count();
+        m_pimpl_->m_wait_time_ += std::chrono::duration<Real>(std::chrono::steady_clock::now() - t1).count();
+    }
+    ++m_pimpl_->m_num_of_check_points_;
+    m_pimpl_->m_exposed_time_ += std::chrono::duration<Real>(std::chrono::steady_clock::now() - t0).count();
+}
+void Scenario::WaitCheckPoint() const {
+    SP_PROFILE_SCOPE("WaitCheckPoint");
+    auto t0 = std::chrono::steady_clock::now();
+    m_pimpl_->WaitPending(0);
+    auto dt = std::chrono::duration<Real>(std::chrono::steady_clock::now() - t0).count();
+    m_pimpl_->m_wait_time_ += dt;
+    m_pimpl_->m_exposed_time_ += dt;
+    if (m_pimpl_->m_num_of_check_points_ > 0) {
+        VERBOSE << "CheckPoint: " << m_pimpl_->m_num_of_check_points_ << " , I/O [ write " << m_pimpl_->m_write_time_
+                << " s, hidden " << std::max(m_pimpl_->m_write_time_ - m_pimpl_->m_wait_time_, 0.0) << " s, exposed "
+                << m_pimpl_->m_exposed_time_ << " s (waiting " << m_pimpl_->m_wait_time_ << " s) ]" << std::endl;
+    }
 }
 
 void Scenario::Dump() const {
@@ -125,41 +296,18 @@ std::shared_ptr<Attribute> Scenario::GetAttribute(std::string const &key) const
 }
 
 void Scenario::Synchronize(int level) {
+    SynchronizeBegin(level);
+    SynchronizeEnd(level);
+}
+void Scenario::SynchronizeBegin(int level) {
     ASSERT(level == 0)
-
+    SP_PROFILE_SCOPE("SynchronizeBegin");
     m_pimpl_->m_atlas_->SyncLocal(level);
-
-    if (GLOBAL_COMM.size() > 1) {
-        GLOBAL_COMM.barrier();
-
-        if (GLOBAL_COMM.rank() == 0) {
-            for (auto &item : m_pimpl_->m_attrs_) {
-                if (item.second->CheckProperty("LOCAL")) { continue; }
-                parallel::bcast_string(item.first);
-                m_pimpl_->m_atlas_->SyncGlobal(item.first, item.second->value_type_info(), item.second->GetNumOfSub(),
-                                               level);
-            };
-            parallel::bcast_string("");
-        } else {
-            while (1) {
-                auto key = parallel::bcast_string();
-                if (key.empty()) { break; }
-                auto attr = m_pimpl_->m_attrs_.find(key);
-                if (attr == m_pimpl_->m_attrs_.end() || attr->second->CheckProperty("LOCAL")) {
-                    RUNTIME_ERROR << "Can not sync local/null attribute \"" << key << "\".";
-                }
-                m_pimpl_->m_atlas_->SyncGlobal(attr->first, attr->second->value_type_info(),
-                                               attr->second->GetNumOfSub(), level);
-            }
-        }
-        GLOBAL_COMM.barrier();
-    } else {
-        for (auto &item : m_pimpl_->m_attrs_) {
-            if (item.second->CheckProperty("LOCAL")) { continue; }
-            m_pimpl_->m_atlas_->SyncGlobal(item.first, item.second->value_type_info(), item.second->GetNumOfSub(),
-                                           level);
-        };
-    }
+    m_pimpl_->m_atlas_->SyncGlobalBegin(level);
+}
+void Scenario::SynchronizeEnd(int level) {
+    SP_PROFILE_SCOPE("SynchronizeEnd");
+    m_pimpl_->m_atlas_->SyncGlobalEnd(level);
 }
 void Scenario::NextStep() { ++m_pimpl_->m_step_counter_; }
 void Scenario::SetStepNumber(size_type s) { m_pimpl_->m_step_counter_ = s; }
@@ -171,6 +319,19 @@ void Scenario::DoInitialize() {}
 void Scenario::DoFinalize() {}
 void Scenario::DoSetUp() {
     ASSERT(m_pimpl_->m_atlas_ != nullptr);
+    // a tile which does not meet the boundary of any domain is skipped by TimeIntegrator::Advance
+    auto vacuum_cost = GetProperty<Real>("VacuumCost", 0.1);
+    auto *pimpl = m_pimpl_;
+    m_pimpl_->m_atlas_->SetCostFunction([=](index_box_type const &b) {
+        Real res = static_cast<Real>((std::get<1>(b)[0] - std::get<0>(b)[0]) * (std::get<1>(b)[1] - std::get<0>(b)[1]) *
+                                     (std::get<1>(b)[2] - std::get<0>(b)[2]));
+        auto box = pimpl->m_atlas_->GetChart()->GetCoordinateBox(b);
+        for (auto const &item : pimpl->m_domains_) {
+            auto boundary = item.second == nullptr ? nullptr : item.second->GetBoundary();
+            if (boundary != nullptr && boundary->CheckIntersection(box, SP_GEO_DEFAULT_TOLERANCE)) { return res; }
+        }
+        return res * vacuum_cost;
+    });
     m_pimpl_->m_atlas_->SetUp();
     for (auto &item : m_pimpl_->m_domains_) {
         if (item.second != nullptr) {
@@ -182,13 +343,57 @@ void Scenario::DoSetUp() {
             }
         }
     }
+    SetUpSynchronize();
     base_type::DoSetUp();
 }
+/**
+ * agree on the non-LOCAL attributes exchanged between processes, in the order of rank 0, and build the schedule of
+ * the exchange once. Synchronize then only executes the schedule.
+ */
+void Scenario::SetUpSynchronize() {
+    std::vector<std::tuple<std::string, std::type_info const *, int>> attrs;
+    auto add_attr = [&](std::shared_ptr<Attribute> const &attr, std::string const &key) {
+        attrs.emplace_back(key, &attr->value_type_info(), attr->GetNumOfSub());
+    };
+    if (GLOBAL_COMM.size() > 1) {
+        if (GLOBAL_COMM.rank() == 0) {
+            for (auto &item : m_pimpl_->m_attrs_) {
+                if (item.second->CheckProperty("LOCAL")) { continue; }
+                parallel::bcast_string(item.first);
+                add_attr(item.second, item.first);
+            };
+            parallel::bcast_string("");
+        } else {
+            while (1) {
+                auto key = parallel::bcast_string();
+                if (key.empty()) { break; }
+                auto attr = m_pimpl_->m_attrs_.find(key);
+                if (attr == m_pimpl_->m_attrs_.end() || attr->second->CheckProperty("LOCAL")) {
+                    RUNTIME_ERROR << "Can not sync local/null attribute \"" << key << "\".";
+                }
+                add_attr(attr->second, attr->first);
+            }
+        }
+    } else {
+        for (auto &item : m_pimpl_->m_attrs_) {
+            if (item.second->CheckProperty("LOCAL")) { continue; }
+            add_attr(item.second, item.first);
+        };
+    }
+    m_pimpl_->m_atlas_->SetSyncAttributes(attrs);
+}
 void Scenario::DoUpdate() {
     m_pimpl_->m_atlas_->Update();
     base_type::DoUpdate();
 }
 void Scenario::DoTearDown() {
+    WaitCheckPoint();
+    m_pimpl_->StopWriter();
+    VERBOSE << "Scratch memory: peak " << ScratchArena::GetTotalPeakBytes() << " bytes, in use "
+            << ScratchArena::GetTotalBytesInUse() << " bytes" << std::endl;
+    VERBOSE << "Memory pool: hits " << MemoryPool::instance().GetNumberOfHits() << ", misses "
+            << MemoryPool::instance().GetNumberOfMisses() << ", held " << MemoryPool::instance().GetBytesHeld()
+            << " bytes, peak in use " << MemoryPool::instance().GetPeakBytesInUse() << " bytes" << std::endl;
     for (auto &item : m_pimpl_->m_domains_) { item.second->TearDown(); }
     m_pimpl_->m_atlas_->TearDown();
     base_type::DoTearDown();
@@ -228,6 +433,41 @@ std::shared_ptr<DomainBase> Scenario::NewDomain(std::string const &s_type, std::
 };
 std::map<std::string, std::shared_ptr<DomainBase>> &Scenario::GetDomains() { return m_pimpl_->m_domains_; };
 std::map<std::string, std::shared_ptr<DomainBase>> const &Scenario::GetDomains() const { return m_pimpl_->m_domains_; }
+namespace detail {
+template <typename TOp>
+Real scenario_fold(Scenario *self, std::string const &name, std::function<Real(DomainBase *)> const &fun, Real init,
+                   TOp const &op) {
+    SP_PROFILE_SCOPE("Reduce", name);
+    auto domain = self->GetDomain(name);
+    if (domain == nullptr) { RUNTIME_ERROR << "Domain \"" << name << "\" is not defined." << std::endl; }
+    self->Update();
+    Real res = init;
+    self->GetAtlas()->Foreach([&](std::shared_ptr<Patch> const &patch) {
+        if (patch == nullptr) { return; }
+        domain->Bind(patch);
+        if (domain->CheckBlockInBoundary()) { res = op(res, fun(domain.get())); }
+        domain->Unbind(patch);
+    });
+    return res;
+}
+}  // namespace detail
+Real Scenario::Sum(std::string const &name, std::function<Real(DomainBase *)> const &fun) {
+    Real res = detail::scenario_fold(this, name, fun, 0, [](Real a, Real b) { return a + b; });
+    GLOBAL_COMM.all_reduce_sum(&res, 1);
+    return res;
+}
+Real Scenario::Max(std::string const &name, std::function<Real(DomainBase *)> const &fun) {
+    Real res = detail::scenario_fold(this, name, fun, -std::numeric_limits<Real>::infinity(),
+                                     [](Real a, Real b) { return std::max(a, b); });
+    GLOBAL_COMM.all_reduce_max(&res, 1);
+    return res;
+}
+Real Scenario::Min(std::string const &name, std::function<Real(DomainBase *)> const &fun) {
+    Real res = detail::scenario_fold(this, name, fun, std::numeric_limits<Real>::infinity(),
+                                     [](Real a, Real b) { return std::min(a, b); });
+    GLOBAL_COMM.all_reduce_min(&res, 1);
+    return res;
+}
 void Scenario::TagRefinementCells(Real time_now) {
     for (auto &d : m_pimpl_->m_domains_) { d.second->TagRefinementCells(time_now); }
 }
@@ -5,6 +5,7 @@
 #ifndef SIMPLA_SCENARIO_H
 #define SIMPLA_SCENARIO_H
 
+#include <functional>
 #include "Attribute.h"
 #include "EngineObject.h"
 #include "simpla/geometry/GeoObject.h"
@@ -22,10 +23,24 @@ class Scenario : public EngineObject {
 
     virtual void TagRefinementCells(Real time_now);
     virtual void Synchronize(int level);
+    /** sync between local patches, and post the halo exchange between processes, which SynchronizeEnd finishes */
+    void SynchronizeBegin(int level);
+    void SynchronizeEnd(int level);
+    /** agree on the attributes exchanged by Synchronize and build its schedule, called by DoSetUp */
+    void SetUpSynchronize();
     virtual void NextStep();
     virtual void Run();
     virtual bool Done() const;
+    /**
+     * write the attributes with property "CheckPoint" = n, every n steps. If "CheckPointAsync" is set, the data blocks
+     * are copied and written by a background thread while the next steps go on; CheckPoint blocks when
+     * "CheckPointMaxPending" (default 2) checkpoints are not yet written. With more than one process the writer needs
+     * MPI_THREAD_MULTIPLE, i.e. "--checkpoint_async" on the command line, which is also the default of
+     * "CheckPointAsync"; without it the write is synchronous, with a warning if "CheckPointAsync" is set.
+     */
     virtual void CheckPoint(size_type step_num) const;
+    /** block until the pending checkpoints are written, and report the I/O time hidden behind the computation */
+    void WaitCheckPoint() const;
     virtual void Dump() const;
 
     void DoInitialize() override;
@@ -61,6 +76,19 @@ class Scenario : public EngineObject {
 
     std::map<std::string, std::shared_ptr<DomainBase>> &GetDomains();
     std::map<std::string, std::shared_ptr<DomainBase>> const &GetDomains() const;
+    /**
+     * sum / max / min over the patches of the atlas and over the ranks of fun(domain), where domain is the domain
+     * named name bound to the patch, e.g. the electric energy of the field E of the domain "EM"
+     *      Sum("EM", [](DomainBase *d) {
+     *          auto em = static_cast<EMDomain *>(d);
+     *          return em->Integrate(em->E, em->E) / 2;
+     *      });
+     * and the L2 norm of E is std::sqrt(Sum(..., Dot(E, E))). Patches out of the boundary of the domain are skipped,
+     * patches are folded in the order of the atlas. Collective.
+     */
+    Real Sum(std::string const &name, std::function<Real(DomainBase *)> const &fun);
+    Real Max(std::string const &name, std::function<Real(DomainBase *)> const &fun);
+    Real Min(std::string const &name, std::function<Real(DomainBase *)> const &fun);
 
     size_type DeletePatch(id_type);
     id_type SetPatch(id_type id, const std::shared_ptr<Patch> &p);
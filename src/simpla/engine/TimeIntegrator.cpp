@@ -2,25 +2,161 @@
 // Created by salmon on 17-9-5.
 //
 #include "TimeIntegrator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <sstream>
 #include "Atlas.h"
 #include "Domain.h"
 #include "simpla/data/DataEntry.h"
+#include "simpla/parallel/MPIComm.h"
+#include "simpla/parallel/ProfileReport.h"
+#include "simpla/utilities/Profiler.h"
 namespace simpla {
 namespace engine {
 
-TimeIntegrator::TimeIntegrator() = default;
-TimeIntegrator::~TimeIntegrator() = default;
+struct TimeIntegrator::pimpl_s {
+    //! views of the domains which are not used by a running task, the domains of the scenario are the first view
+    std::vector<domain_views_type> m_views_;
+    int m_num_of_views_ = 0;
+    std::mutex m_views_mutex_;
+    std::map<id_type, PatchCost> m_costs_;
+    //! "AdaptiveTimeStep", min of the stable time steps of the patches swept since the last ComputeStableDtOnPatch
+    bool m_adaptive_dt_ = false;
+    Real m_stable_dt_ = std::numeric_limits<Real>::infinity();
+    std::mutex m_stable_dt_mutex_;
+    void StableDt(Real dt);
+
+    domain_views_type AcquireViews(domain_views_type const &domains);
+    void ReleaseViews(domain_views_type &&views);
+};
+TimeIntegrator::domain_views_type TimeIntegrator::pimpl_s::AcquireViews(domain_views_type const &domains) {
+    std::lock_guard<std::mutex> lock(m_views_mutex_);
+    domain_views_type res;
+    if (m_num_of_views_ == 0) {
+        res = domains;
+    } else if (!m_views_.empty()) {
+        res = std::move(m_views_.back());
+        m_views_.pop_back();
+        return res;
+    } else {
+        for (auto const &item : domains) {
+            auto view = DomainBase::Create(item.second->Serialize());
+            view->SetChart(item.second->GetChart());
+            view->SetUp();
+            res.emplace(item.first, view);
+        }
+    }
+    ++m_num_of_views_;
+    return res;
+}
+void TimeIntegrator::pimpl_s::StableDt(Real dt) {
+    std::lock_guard<std::mutex> lock(m_stable_dt_mutex_);
+    m_stable_dt_ = std::min(m_stable_dt_, dt);
+}
+void TimeIntegrator::pimpl_s::ReleaseViews(domain_views_type &&views) {
+    std::lock_guard<std::mutex> lock(m_views_mutex_);
+    m_views_.push_back(std::move(views));
+}
+
+TimeIntegrator::TimeIntegrator() : m_pimpl_(new pimpl_s) {}
+TimeIntegrator::~TimeIntegrator() { delete m_pimpl_; }
+
+std::map<id_type, TimeIntegrator::PatchCost> const &TimeIntegrator::GetPatchCosts() const {
+    return m_pimpl_->m_costs_;
+}
+void TimeIntegrator::ForeachPatch(std::vector<std::shared_ptr<Patch>> const &patches,
+                                  std::function<bool(domain_views_type &, std::shared_ptr<Patch> const &)> const &fun) {
+    auto &costs = m_pimpl_->m_costs_;
+    std::vector<std::pair<Real, size_type>> order;
+    std::vector<PatchCost> res(patches.size());
+    std::vector<Real> measured(patches.size(), 0);
+    Real measured_time = 0, measured_cells = 0;
+    for (size_type n = 0; n < patches.size(); ++n) {
+        auto b = patches[n]->GetIndexBox();
+        res[n].num_of_cells = static_cast<size_type>((std::get<1>(b)[0] - std::get<0>(b)[0]) *
+                                                     (std::get<1>(b)[1] - std::get<0>(b)[1]) *
+                                                     (std::get<1>(b)[2] - std::get<0>(b)[2]));
+        auto it = costs.find(patches[n]->GetGUID());
+        if (it != costs.end()) {
+            res[n].cross_boundary = it->second.cross_boundary;
+            measured[n] = it->second.time;
+        }
+        if (measured[n] > 0) {
+            measured_time += measured[n];
+            measured_cells += res[n].num_of_cells;
+        }
+    }
+    // a patch which is not advanced yet is estimated by its cells, at the mean time per cell of the measured patches
+    Real time_per_cell = measured_cells > 0 ? measured_time / measured_cells : 1;
+    for (size_type n = 0; n < patches.size(); ++n) {
+        order.emplace_back(measured[n] > 0 ? measured[n]
+                                           : time_per_cell * res[n].num_of_cells * (res[n].cross_boundary ? 2 : 1),
+                           n);
+    }
+    // the most expensive patches first, so that the cheap ones fill the gaps at the end
+    std::sort(order.begin(), order.end(), [](auto const &a, auto const &b) { return a.first > b.first; });
+
+    std::exception_ptr error = nullptr;
+    std::mutex error_mutex;
+    // a task may run on any thread, so its timer is nested in the timer of the caller explicitly
+    auto profile_parent = Profiler::Global().IsEnabled() ? Profiler::Global().GetPath() : std::string("");
+#pragma omp parallel
+#pragma omp single
+    for (auto const &item : order) {
+        auto n = item.second;
+#pragma omp task firstprivate(n)
+        {
+            SP_PROFILE_SCOPE("Patch", "", patches[n]->GetGUID(), profile_parent);
+            auto views = m_pimpl_->AcquireViews(GetDomains());
+            auto t0 = std::chrono::steady_clock::now();
+            try {
+                res[n].cross_boundary = fun(views, patches[n]);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (error == nullptr) { error = std::current_exception(); }
+            }
+            res[n].time = std::chrono::duration<Real>(std::chrono::steady_clock::now() - t0).count();
+            m_pimpl_->ReleaseViews(std::move(views));
+        }
+    }
+    if (error != nullptr) { std::rethrow_exception(error); }
+
+    Real max_time = 0, sum_time = 0;
+    for (size_type n = 0; n < patches.size(); ++n) {
+        costs[patches[n]->GetGUID()] = res[n];
+        max_time = std::max(max_time, res[n].time);
+        sum_time += res[n].time;
+    }
+    if (!patches.empty()) {
+        VERBOSE << "Patches: " << patches.size() << " , time [ total " << sum_time << " s, max " << max_time
+                << " s, max/mean " << max_time * patches.size() / std::max(sum_time, 1.0e-12) << " ]" << std::endl;
+    }
+}
 
 void TimeIntegrator::InitialCondition(Real time_now) {
+    SP_PROFILE_SCOPE("InitialCondition");
     Update();
+    std::vector<std::shared_ptr<Patch>> patches;
     GetAtlas()->Foreach([&](std::shared_ptr<Patch> const &patch) {
-        if (patch == nullptr) { return; }
-        for (auto &item : GetDomains()) {
-            item.second->Push(patch->Pop());
+        if (patch != nullptr) { patches.push_back(patch); }
+    });
+    auto adaptive_dt = m_pimpl_->m_adaptive_dt_;
+    ForeachPatch(patches, [&](domain_views_type &views, std::shared_ptr<Patch> const &patch) {
+        bool cross_boundary = false;
+        Real dt = std::numeric_limits<Real>::infinity();
+        for (auto &item : views) {
+            item.second->Bind(patch);
             item.second->InitialCondition(time_now);
-            patch->Push(item.second->Pop());
+            cross_boundary = cross_boundary || item.second->CheckBlockCrossBoundary();
+            if (adaptive_dt) { dt = item.second->ComputeStableDtOnPatch(time_now, dt); }
+            item.second->Unbind(patch);
         }
-
+        if (adaptive_dt) { m_pimpl_->StableDt(dt); }
+        return cross_boundary;
     });
 }
 void TimeIntegrator::BoundaryCondition(Real time_now, Real dt) {
@@ -31,27 +167,57 @@ void TimeIntegrator::ComputeFluxes(Real time_now, Real dt) {
     //    for (auto &d : GetDomains()) { d.second->ComputeFluxes(time_now, dt); }
 }
 Real TimeIntegrator::ComputeStableDtOnPatch(Real time_now, Real time_dt) {
-    //    for (auto &d : GetDomains()) { time_dt = std::min(time_dt, d.second->ComputeStableDtOnPatch(time_now,
-    //    time_dt)); }
-    return time_dt;
+    SP_PROFILE_SCOPE("StableDt");
+    Real dt = m_pimpl_->m_stable_dt_;
+    m_pimpl_->m_stable_dt_ = std::numeric_limits<Real>::infinity();
+    GLOBAL_COMM.all_reduce_min(&dt, 1);
+    dt = std::isfinite(dt) ? std::min(dt * GetCFL(), time_dt * GetProperty<Real>("MaxTimeStepGrowth", 1.1)) : time_dt;
+    // the last step ends at TimeEnd
+    if (GetTimeEnd() > time_now) { dt = std::min(dt, GetTimeEnd() - time_now); }
+    return dt;
 }
 
 void TimeIntegrator::Advance(Real time_now, Real time_dt) {
+    SP_PROFILE_SCOPE("Advance");
     Update();
-    GetAtlas()->Foreach([&](std::shared_ptr<Patch> const &patch) {
-        if (patch == nullptr) { return; }
-
-        for (auto &item : GetDomains()) {
-            item.second->Push(patch->Pop());
-
+    // the stable time step of the next step is taken from the advanced patch while it is bound. Domains may share
+    // attributes (E, B), so each domain is unbound before the next one is bound, see AttributeGroup::Bind
+    auto adaptive_dt = m_pimpl_->m_adaptive_dt_;
+    auto advance = [&](domain_views_type &views, std::shared_ptr<Patch> const &patch) {
+        bool cross_boundary = false;
+        Real dt = std::numeric_limits<Real>::infinity();
+        for (auto &item : views) {
+            item.second->Bind(patch);
             if (item.second->CheckBlockInBoundary()) {
                 if (!item.second->IsInitialized()) { item.second->InitialCondition(time_now); }
                 item.second->Advance(time_now, time_dt);
-                if (item.second->CheckBlockCrossBoundary()) { item.second->BoundaryCondition(time_now, time_dt); }
+                if (item.second->CheckBlockCrossBoundary()) {
+                    cross_boundary = true;
+                    item.second->BoundaryCondition(time_now, time_dt);
+                }
             }
-            patch->Push(item.second->Pop());
+            if (adaptive_dt) { dt = item.second->ComputeStableDtOnPatch(time_now + time_dt, dt); }
+            item.second->Unbind(patch);
         }
+        if (adaptive_dt) { m_pimpl_->StableDt(dt); }
+        return cross_boundary;
+    };
+    // the halo of an inner patch is covered by local patches, it is advanced while the halo exchange posted by
+    // SynchronizeBegin is in flight
+    std::vector<std::shared_ptr<Patch>> inner, outer;
+    auto atlas = GetAtlas();
+    atlas->Foreach([&](std::shared_ptr<Patch> const &patch) {
+        if (patch != nullptr) { (atlas->CheckHaloIsLocal(patch->GetIndexBox()) ? inner : outer).push_back(patch); }
     });
+    {
+        SP_PROFILE_SCOPE("Inner");
+        ForeachPatch(inner, advance);
+    }
+    SynchronizeEnd(0);
+    {
+        SP_PROFILE_SCOPE("Outer");
+        ForeachPatch(outer, advance);
+    }
 }
 void TimeIntegrator::DoSetUp() {
     //    SetStepNumber(backend()->GetValue<size_type>("Step", GetStepNumber()));
@@ -62,31 +228,77 @@ void TimeIntegrator::DoSetUp() {
     //        backend()->GetValue<size_type>("MaxStep", static_cast<size_type>((GetTimeEnd() - GetTimeNow()) /
     //        GetTimeStep())));
     //
+    // with "AdaptiveTimeStep" this is only the first time step, the run ends at TimeEnd whatever MaxStep is
     SetTimeStep((GetTimeEnd() - GetTimeNow()) / GetMaxStep());
     base_type::DoSetUp();
+    m_pimpl_->m_views_.clear();
+    m_pimpl_->m_num_of_views_ = 0;
+    m_pimpl_->m_adaptive_dt_ = GetProperty<bool>("AdaptiveTimeStep", false);
+    // "ProfileTrace" is the path of the Chrome trace file, tracing implies profiling
+    auto trace = !GetProperty<std::string>("ProfileTrace", "").empty();
+    Profiler::Global().SetEnable(GetProperty<bool>("Profile", false) || trace);
+    Profiler::Global().SetTrace(trace);
+}
+void TimeIntegrator::DoTearDown() {
+    for (auto &views : m_pimpl_->m_views_) {
+        for (auto &item : views) {
+            if (GetDomain(item.first) != item.second) { item.second->TearDown(); }
+        }
+    }
+    m_pimpl_->m_views_.clear();
+    m_pimpl_->m_num_of_views_ = 0;
+    base_type::DoTearDown();
+}
+void TimeIntegrator::Rebalance(Real threshold) {
+    SP_PROFILE_SCOPE("Rebalance");
+    SynchronizeEnd(0);
+    std::map<id_type, Real> costs;
+    for (auto const &item : m_pimpl_->m_costs_) { costs[item.first] = item.second.time; }
+    // migrated patches get new ids, their costs are measured again
+    if (GetAtlas()->Rebalance(costs, threshold)) { m_pimpl_->m_costs_.clear(); }
 }
-void TimeIntegrator::DoTearDown() { base_type::DoTearDown(); }
 void TimeIntegrator::Run() {
     InitialCondition(GetTimeNow());
     Synchronize(0);
     CheckPoint(GetStepNumber());
 
+    auto rebalance_interval = GetProperty<size_type>("RebalanceInterval", 0);
+    auto rebalance_threshold = GetProperty<Real>("RebalanceThreshold", 1.1);
+    // the configured TimeStep is the first time step, later ones are not larger than the growth limit allows
+    auto adaptive_dt = m_pimpl_->m_adaptive_dt_;
+    if (adaptive_dt) { SetTimeStep(std::min(GetTimeStep(), ComputeStableDtOnPatch(GetTimeNow(), GetTimeStep()))); }
     while (!Done()) {
-        VERBOSE << " [ TIME :" << std::setw(5) << GetTimeNow() << "   ] ";
+        SP_PROFILE_SCOPE("Step");
+        VERBOSE << " [ TIME :" << std::setw(5) << GetTimeNow() << " , dt :" << GetTimeStep() << "   ] ";
         Advance(GetTimeNow(), GetTimeStep());
-        Synchronize(0);
+        SynchronizeBegin(0);
         NextStep();
+        if (adaptive_dt) { SetTimeStep(ComputeStableDtOnPatch(GetTimeNow(), GetTimeStep())); }
         CheckPoint(GetStepNumber());
+        if (rebalance_interval > 0 && GetStepNumber() % rebalance_interval == 0) { Rebalance(rebalance_threshold); }
     }
+    SynchronizeEnd(0);
+    WaitCheckPoint();
+    ReportProfile();
 
     //    Dump();
 }
+void TimeIntegrator::ReportProfile() const {
+    if (!Profiler::Global().IsEnabled()) { return; }
+    std::ostringstream os;
+    parallel::ReportProfile(os);
+    if (GLOBAL_COMM.rank() == 0) { INFORM << "Profile:" << std::endl << os.str(); }
+    auto trace = GetProperty<std::string>("ProfileTrace", "");
+    if (!trace.empty()) { parallel::WriteProfileTrace(trace); }
+}
 void TimeIntegrator::NextStep() {
     m_TimeNow_ += m_TimeStep_;
     base_type::NextStep();
 }
 
 void TimeIntegrator::Synchronize(int level) { base_type::Synchronize(level); }
-bool TimeIntegrator::Done() const { return GetTimeNow() >= GetTimeEnd() || GetStepNumber() >= GetMaxStep(); }
+bool TimeIntegrator::Done() const {
+    return GetTimeNow() >= GetTimeEnd() || (!m_pimpl_->m_adaptive_dt_ && GetStepNumber() >= GetMaxStep());
+}
 }
 }
\ No newline at end of file
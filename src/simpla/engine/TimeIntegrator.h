@@ -5,9 +5,19 @@
 #ifndef SIMPLA_TIMEINTEGRATOR_H
 #define SIMPLA_TIMEINTEGRATOR_H
 
+#include <functional>
+#include <map>
+#include <vector>
 #include "Scenario.h"
 namespace simpla {
 namespace engine {
+/**
+ *  Patches are advanced as tasks of a thread pool. A task pushes its patch into a set of domain views, which are
+ *  domains created from the configuration of the domains of the scenario, so that patches are advanced at the same
+ *  time. Patches are started from the most expensive one, the cost is the time of its last advance, or, if it is not
+ *  advanced yet, its number of cells times the mean time per cell of the advanced patches, doubled if the patch
+ *  crosses a boundary.
+ */
 class TimeIntegrator : public Scenario {
     SP_ENABLE_NEW_HEAD(Scenario, TimeIntegrator);
 
@@ -15,6 +25,14 @@ class TimeIntegrator : public Scenario {
     virtual void InitialCondition(Real time_now);
     virtual void BoundaryCondition(Real time_now, Real dt);
     virtual void ComputeFluxes(Real time_now, Real time_dt);
+    /**
+     * time step of the next step: CFL times the stable time step of the patches swept by the last InitialCondition or
+     * Advance (min over patches, threads and ranks, see DomainBase::DoComputeStableDt), no larger than
+     * "MaxTimeStepGrowth" * time_dt, or time_dt if no domain limits the time step; in both cases no larger than the
+     * time left to TimeEnd.
+     * Stable time steps are only taken if "AdaptiveTimeStep" is set, then Run applies it after every step and goes on
+     * until TimeEnd, (TimeEnd - TimeNow) / MaxStep is only the first time step. Collective.
+     */
     virtual Real ComputeStableDtOnPatch(Real time_now, Real time_dt);
     virtual void Advance(Real time_now, Real dt);
 
@@ -27,12 +45,42 @@ class TimeIntegrator : public Scenario {
     bool Done() const override;
 
     SP_PROPERTY(size_type, MaxStep);
-    SP_PROPERTY(Real, CFL);
+    SP_PROPERTY(Real, CFL) = 0.9;
     SP_PROPERTY(Real, TimeNow);
     SP_PROPERTY(Real, TimeEnd);
     SP_PROPERTY(Real, TimeStep);
 
     Real GetTime() const override { return GetTimeNow(); };
+
+    struct PatchCost {
+        size_type num_of_cells = 0;
+        bool cross_boundary = false;
+        //! time of the last advance, in seconds
+        Real time = 0;
+    };
+    std::map<id_type, PatchCost> const &GetPatchCosts() const;
+    /**
+     * repartition the tiles of the atlas by the measured time of the patches if the imbalance is larger than
+     * threshold, see Atlas::Rebalance. Run calls it every "RebalanceInterval" steps (0 = never), the threshold is
+     * "RebalanceThreshold".
+     */
+    void Rebalance(Real threshold);
+    /**
+     * if "Profile" or "ProfileTrace" is set, the phases of Run (steps, advance of inner and outer patches, patches,
+     * domains, halo exchange, checkpoints) are timed by Profiler::Global(). Run ends with a table of the timers over
+     * the ranks, and writes the Chrome trace of all ranks to "ProfileTrace" if it is set. Collective.
+     */
+    void ReportProfile() const;
+
+   protected:
+    typedef std::map<std::string, std::shared_ptr<DomainBase>> domain_views_type;
+    /** call fun(views, patch) for every patch in a task, fun returns true if the patch crosses a boundary */
+    void ForeachPatch(std::vector<std::shared_ptr<Patch>> const &patches,
+                      std::function<bool(domain_views_type &, std::shared_ptr<Patch> const &)> const &fun);
+
+   private:
+    struct pimpl_s;
+    pimpl_s *m_pimpl_ = nullptr;
 };
 }  // namespace engine
 }  // namespace simpla
@@ -8,6 +8,7 @@
 #include "simpla/SIMPLA_config.h"
 
 #include <simpla/algebra/Algebra.h>
+#include <simpla/algebra/SeparableArray.h>
 #include <simpla/data/Data.h>
 #include <simpla/engine/Attribute.h>
 #include <simpla/parallel/MPIComm.h>
@@ -19,39 +20,50 @@ namespace mesh {
 using namespace simpla::data;
 /**
  * Axis are perpendicular
+ *
+ * The chart is orthogonal and separable (csCartesian, csCylindrical ...), so every volume is a product of three 1D
+ * factors, one per axis. The metric is kept as SeparableArray, 3 x (N+8) values per component instead of N^3, and
+ * evaluated inline in the FVM stencils. It is rebuilt from the chart whenever a different MeshBlock is set.
  */
 template <typename THost>
 struct RectMesh : public StructuredMesh {
     SP_DOMAIN_POLICY_HEAD(RectMesh);
 
     void InitialCondition(Real time_now);
-    void BoundaryCondition(Real time_now, Real time_dt);
+    void SetUpMetric();
 
     engine::AttributeT<Real, NODE, 3> m_coordinates_{m_host_, "Name"_ = "_COORDINATES_", "COORDINATES"_, "LOCAL"_};
     //     engine:: AttributeT< Real, NODE > m_vertices_{m_domain_, "Name"_ = "m_vertices_","LOCAL"_};
 
-    engine::AttributeT<Real, NODE> m_node_volume_{m_host_, "Name"_ = "m_node_volume_", "LOCAL"_};
-    engine::AttributeT<Real, NODE> m_node_inv_volume_{m_host_, "Name"_ = "m_node_inv_volume_", "LOCAL"_};
-    engine::AttributeT<Real, NODE> m_node_dual_volume_{m_host_, "Name"_ = "m_node_dual_volume_", "LOCAL"_};
-    engine::AttributeT<Real, NODE> m_node_inv_dual_volume_{m_host_, "Name"_ = "m_node_inv_dual_volume_", "LOCAL"_};
-    engine::AttributeT<Real, CELL> m_cell_volume_{m_host_, "Name"_ = "m_cell_volume_", "LOCAL"_};
-    engine::AttributeT<Real, CELL> m_cell_inv_volume_{m_host_, "Name"_ = "m_cell_inv_volume_", "LOCAL"_};
-    engine::AttributeT<Real, CELL> m_cell_dual_volume_{m_host_, "Name"_ = "m_cell_dual_volume_", "LOCAL"_};
-    engine::AttributeT<Real, CELL> m_cell_inv_dual_volume_{m_host_, "Name"_ = "m_cell_inv_dual_volume_", "LOCAL"_};
-    engine::AttributeT<Real, EDGE> m_edge_volume_{m_host_, "Name"_ = "m_edge_volume_", "LOCAL"_};
-    engine::AttributeT<Real, EDGE> m_edge_inv_volume_{m_host_, "Name"_ = "m_edge_inv_volume_", "LOCAL"_};
-    engine::AttributeT<Real, EDGE> m_edge_dual_volume_{m_host_, "Name"_ = "m_edge_dual_volume_", "LOCAL"_};
-    engine::AttributeT<Real, EDGE> m_edge_inv_dual_volume_{m_host_, "Name"_ = "m_edge_inv_dual_volume_", "LOCAL"_};
-    engine::AttributeT<Real, FACE> m_face_volume_{m_host_, "Name"_ = "m_face_volume_", "LOCAL"_};
-    engine::AttributeT<Real, FACE> m_face_inv_volume_{m_host_, "Name"_ = "m_face_inv_volume_", "LOCAL"_};
-    engine::AttributeT<Real, FACE> m_face_dual_volume_{m_host_, "Name"_ = "m_face_dual_volume_", "LOCAL"_};
-    engine::AttributeT<Real, FACE> m_face_inv_dual_volume_{m_host_, "Name"_ = "m_face_inv_dual_volume_", "LOCAL"_};
+    SeparableArray<Real> m_node_volume_;
+    SeparableArray<Real> m_node_inv_volume_;
+    SeparableArray<Real> m_node_dual_volume_;
+    SeparableArray<Real> m_node_inv_dual_volume_;
+    SeparableArray<Real> m_cell_volume_;
+    SeparableArray<Real> m_cell_inv_volume_;
+    SeparableArray<Real> m_cell_dual_volume_;
+    SeparableArray<Real> m_cell_inv_dual_volume_;
+    nTuple<SeparableArray<Real>, 3> m_edge_volume_;
+    nTuple<SeparableArray<Real>, 3> m_edge_inv_volume_;
+    nTuple<SeparableArray<Real>, 3> m_edge_dual_volume_;
+    nTuple<SeparableArray<Real>, 3> m_edge_inv_dual_volume_;
+    nTuple<SeparableArray<Real>, 3> m_face_volume_;
+    nTuple<SeparableArray<Real>, 3> m_face_inv_volume_;
+    nTuple<SeparableArray<Real>, 3> m_face_dual_volume_;
+    nTuple<SeparableArray<Real>, 3> m_face_inv_dual_volume_;
+
+   private:
+    id_type m_metric_guid_ = static_cast<id_type>(-1);
 };
 template <typename THost>
 RectMesh<THost>::RectMesh(THost* h) : m_host_(h) {
     h->PreInitialCondition.Connect([=](engine::DomainBase* self, Real time_now) {
         if (auto* p = dynamic_cast<RectMesh<THost>*>(self)) { p->InitialCondition(time_now); }
     });
+    // Push and Bind, so the metric read by Integrate, GetLaplacianDiagonal ... is the one of the bound patch
+    h->OnSetMeshBlock.Connect([=](engine::DomainBase* self) {
+        if (auto* p = dynamic_cast<RectMesh<THost>*>(self)) { p->SetUpMetric(); }
+    });
     h->OnSerialize.Connect([=](engine::DomainBase const* self, std::shared_ptr<simpla::data::DataEntry>& tdb) {
         if (auto const* p = dynamic_cast<RectMesh<THost> const*>(self)) { tdb->Set(p->Serialize()); }
     });
@@ -72,26 +84,14 @@ void RectMesh<THost>::InitialCondition(Real time_now) {
     auto chart = this->GetChart();
     m_host_->InitializeAttribute(&m_coordinates_);
     //    m_vertices_ = [&](point_type const& x) { return (x); };
-    m_host_->InitializeAttribute(&m_node_volume_);
-    m_host_->InitializeAttribute(&m_node_inv_volume_);
-    m_host_->InitializeAttribute(&m_node_dual_volume_);
-    m_host_->InitializeAttribute(&m_node_inv_dual_volume_);
-
-    m_host_->InitializeAttribute(&m_cell_volume_);
-    m_host_->InitializeAttribute(&m_cell_inv_volume_);
-    m_host_->InitializeAttribute(&m_cell_dual_volume_);
-    m_host_->InitializeAttribute(&m_cell_inv_dual_volume_);
-
-    m_host_->InitializeAttribute(&m_edge_volume_);
-    m_host_->InitializeAttribute(&m_edge_inv_volume_);
-    m_host_->InitializeAttribute(&m_edge_dual_volume_);
-    m_host_->InitializeAttribute(&m_edge_inv_dual_volume_);
-
-    m_host_->InitializeAttribute(&m_face_volume_);
-    m_host_->InitializeAttribute(&m_face_inv_volume_);
-    m_host_->InitializeAttribute(&m_face_dual_volume_);
-    m_host_->InitializeAttribute(&m_face_inv_dual_volume_);
-
+    m_coordinates_ = [&](index_type x, index_type y, index_type z) { return chart->global_coordinates(0b0, x, y, z); };
+    SetUpMetric();
+}
+template <typename THost>
+void RectMesh<THost>::SetUpMetric() {
+    if (GetMeshBlock() == nullptr || GetChart() == nullptr || GetMeshBlock()->GetGUID() == m_metric_guid_) { return; }
+    m_metric_guid_ = GetMeshBlock()->GetGUID();
+    auto chart = this->GetChart();
     /**
      *\verbatim
      *                ^y (dl)
@@ -112,78 +112,60 @@ void RectMesh<THost>::InitialCondition(Real time_now) {
      *
      *\endverbatim
      */
+    // the ghost cells of attributes and one more for the shifted operands of a stencil
+    auto b = GetSpaceFillingCurve(0b000, index_tuple{4, 4, 4}).GetIndexBox();
+
+    m_node_volume_.reset(b);
+    m_node_inv_volume_.reset(b);
+    m_node_dual_volume_.reset(b);
+    m_node_dual_volume_.Factorize([&](index_type x, index_type y, index_type z) -> Real {
+        return chart->volume(chart->local_coordinates(0b111, x - 1, y - 1, z - 1),
+                             chart->local_coordinates(0b111, x, y, z));
+    });
+    m_node_inv_dual_volume_ = m_node_dual_volume_.Inverse();
 
-    m_coordinates_ = [&](index_type x, index_type y, index_type z) { return chart->global_coordinates(0b0, x, y, z); };
-//
-//    m_node_volume_ = 1.0;
-//    m_node_inv_volume_ = 1.0;
-//    m_node_dual_volume_ = [&](index_type x, index_type y, index_type z) -> Real {
-//        return chart->volume(chart->local_coordinates(0b111, x - 1, y - 1, z - 1),
-//                             chart->local_coordinates(0b111, x, y, z));
-//    };
-//    m_node_inv_dual_volume_ = 1.0 / m_node_dual_volume_;
-//
-//    m_cell_volume_ = [&](index_type x, index_type y, index_type z) -> Real {
-//        return chart->volume(chart->local_coordinates(0b0, x, y, z),
-//                             chart->local_coordinates(0b0, x + 1, y + 1, z + 1));
-//    };
-//    m_cell_inv_volume_ = 1.0 / m_cell_volume_;
-//    m_cell_dual_volume_ = 1.0;
-//    m_cell_inv_dual_volume_ = 1.0;
-//
-//    m_edge_volume_ = [&](int w, index_type x, index_type y, index_type z) -> Real {
-//        return chart->length(
-//            chart->local_coordinates(0b0, x, y, z),
-//            chart->local_coordinates(0b0, x + (w == 0 ? 1 : 0), y + (w == 1 ? 1 : 0), z + (w == 2 ? 1 : 0)), w);
-//    };
-//    m_edge_inv_volume_ = 1.0 / m_edge_volume_;
-//
-//    m_edge_dual_volume_ = [&](int w, index_type x, index_type y, index_type z) -> Real {
-//        return chart->area(
-//            chart->local_coordinates(0b111, x - (w != 0 ? 1 : 0), y - (w != 1 ? 1 : 0), z - (w != 2 ? 1 : 0)),
-//            chart->local_coordinates(0b111, x, y, z), w);
-//    };
-//    m_edge_inv_dual_volume_ = 1.0 / m_edge_dual_volume_;
-//
-//    m_face_volume_ = [&](int w, index_type x, index_type y, index_type z) -> Real {
-//        return chart->area(
-//            chart->local_coordinates(0b0, x, y, z),
-//            chart->local_coordinates(0b0, x + (w != 0 ? 1 : 0), y + (w != 1 ? 1 : 0), z + (w != 2 ? 1 : 0)), w);
-//
-//    };
-//    m_face_inv_volume_ = 1.0 / m_face_volume_;
-//
-//    m_face_dual_volume_ = [&](int w, index_type x, index_type y, index_type z) -> Real {
-//        return chart->length(
-//            chart->local_coordinates(0b111, x - (w == 0 ? 1 : 0), y - (w == 1 ? 1 : 0), z - (w == 2 ? 1 : 0)),
-//            chart->local_coordinates(0b111, x, y, z), w);
-//    };
-//    m_face_inv_dual_volume_ = 1.0 / m_face_dual_volume_;
+    m_cell_volume_.reset(b);
+    m_cell_volume_.Factorize([&](index_type x, index_type y, index_type z) -> Real {
+        return chart->volume(chart->local_coordinates(0b0, x, y, z),
+                             chart->local_coordinates(0b0, x + 1, y + 1, z + 1));
+    });
+    m_cell_inv_volume_ = m_cell_volume_.Inverse();
+    m_cell_dual_volume_.reset(b);
+    m_cell_inv_dual_volume_.reset(b);
+
+    for (int w = 0; w < 3; ++w) {
+        index_type dw[3] = {w == 0 ? 1 : 0, w == 1 ? 1 : 0, w == 2 ? 1 : 0};
+
+        m_edge_volume_[w].reset(b);
+        m_edge_volume_[w].Factorize([&](index_type x, index_type y, index_type z) -> Real {
+            return chart->length(chart->local_coordinates(0b0, x, y, z),
+                                 chart->local_coordinates(0b0, x + dw[0], y + dw[1], z + dw[2]), w);
+        });
+        m_edge_inv_volume_[w] = m_edge_volume_[w].Inverse();
+
+        m_edge_dual_volume_[w].reset(b);
+        m_edge_dual_volume_[w].Factorize([&](index_type x, index_type y, index_type z) -> Real {
+            return chart->area(chart->local_coordinates(0b111, x - 1 + dw[0], y - 1 + dw[1], z - 1 + dw[2]),
+                               chart->local_coordinates(0b111, x, y, z), w);
+        });
+        m_edge_inv_dual_volume_[w] = m_edge_dual_volume_[w].Inverse();
+
+        m_face_volume_[w].reset(b);
+        m_face_volume_[w].Factorize([&](index_type x, index_type y, index_type z) -> Real {
+            return chart->area(chart->local_coordinates(0b0, x, y, z),
+                               chart->local_coordinates(0b0, x + 1 - dw[0], y + 1 - dw[1], z + 1 - dw[2]), w);
+        });
+        m_face_inv_volume_[w] = m_face_volume_[w].Inverse();
+
+        m_face_dual_volume_[w].reset(b);
+        m_face_dual_volume_[w].Factorize([&](index_type x, index_type y, index_type z) -> Real {
+            return chart->length(chart->local_coordinates(0b111, x - dw[0], y - dw[1], z - dw[2]),
+                                 chart->local_coordinates(0b111, x, y, z), w);
+        });
+        m_face_inv_dual_volume_[w] = m_face_dual_volume_[w].Inverse();
+    }
 };
 
-template <typename THost>
-void RectMesh<THost>::BoundaryCondition(Real time_now, Real time_dt) {
-    m_host_->FillRange(m_node_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_node_dual_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_node_inv_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_node_inv_dual_volume_, 0, "PATCH_BOUNDARY_");
-
-    m_host_->FillRange(m_edge_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_edge_dual_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_edge_inv_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_edge_inv_dual_volume_, 0, "PATCH_BOUNDARY_");
-
-    m_host_->FillRange(m_face_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_face_dual_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_face_inv_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_face_inv_dual_volume_, 0, "PATCH_BOUNDARY_");
-
-    m_host_->FillRange(m_cell_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_cell_dual_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_cell_inv_volume_, 0, "PATCH_BOUNDARY_");
-    m_host_->FillRange(m_cell_inv_dual_volume_, 0, "PATCH_BOUNDARY_");
-}
-
 }  // namespace mesh {
 }  // namespace simpla {
 #endif  // SIMPLA_RECTMESH_H
@@ -0,0 +1,398 @@
+/**
+ *  @file Krylov.h
+ *  Preconditioned CG, BiCGStab and GMRES on the arrays of a patch.
+ */
+
+#ifndef SIMPLA_KRYLOV_H
+#define SIMPLA_KRYLOV_H
+
+#include "simpla/SIMPLA_config.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <type_traits>
+#include <vector>
+#include "simpla/algebra/Array.h"
+#include "simpla/algebra/EntityId.h"
+#include "simpla/algebra/nTuple.h"
+#include "simpla/algebra/sfc/z_sfc.h"
+#include "simpla/utilities/Log.h"
+
+namespace simpla {
+
+/**@ingroup numeric*/
+namespace linear_solver {
+namespace detail {
+//! optional vector argument, not deduced so that it may be nullptr
+template <typename TVec>
+using krylov_ptr = typename std::remove_reference<TVec>::type const *;
+template <typename V>
+int krylov_size(Array<V, ZSFC<3>> const &) {
+    return 1;
+}
+template <typename V, int N>
+int krylov_size(nTuple<Array<V, ZSFC<3>>, N> const &) {
+    return N;
+}
+template <typename V>
+Array<V, ZSFC<3>> const &krylov_component(Array<V, ZSFC<3>> const &v, int n) {
+    return v;
+}
+template <typename V, int N>
+Array<V, ZSFC<3>> const &krylov_component(nTuple<Array<V, ZSFC<3>>, N> const &v, int n) {
+    return v[n];
+}
+/** data of a at the linear offset 0 of range, so that a(idx) == res[range.hash(idx)] */
+template <typename V>
+V const *krylov_data(Array<V, ZSFC<3>> const &a, ZSFC<3> const &range) {
+    ZSFC<3> const &sfc = a.GetSpaceFillingCurve();
+    index_type offset = 0;
+    for (int i = 0; i < 3; ++i) {
+        if (sfc.m_strides_[i] != range.m_strides_[i]) {
+            RUNTIME_ERROR << "The vectors of a Krylov solver must have the shape of its range." << std::endl;
+        }
+        offset += (range.m_shape_min_[i] - sfc.m_shape_min_[i]) * range.m_strides_[i];
+    }
+    if (a.get() == nullptr) { RUNTIME_ERROR << "The vectors of a Krylov solver must be allocated." << std::endl; }
+    return a.get() + offset;
+}
+}  // namespace detail
+
+/**
+ * Vector operations of the Krylov solvers. A vector is an Array, an nTuple of Arrays or a field (a form of the
+ * current patch), its components are swept over their owned range, so that the ghost entities of a patch are not
+ * counted twice. An update of a vector and the dot products of its result are one sweep, the dot products of a sweep
+ * are summed over the ranks by one call of the reduce hook.
+ */
+class KrylovSpace {
+   public:
+    KrylovSpace() = default;
+    ~KrylovSpace() = default;
+
+    /** owned range of component n, the index box of the component if it is not set */
+    void SetRange(int n, ZSFC<3> const &range) {
+        if (m_range_.size() <= static_cast<size_t>(n)) { m_range_.resize(static_cast<size_t>(n + 1)); }
+        m_range_[n] = range;
+    }
+    /** owned ranges of the forms IFORM of the patch bound to domain, the cells of its mesh block */
+    template <typename THost>
+    void SetUp(THost const *domain, int IFORM) {
+        auto box = domain->GetMeshBlock()->GetIndexBox();
+        int num = (IFORM == NODE || IFORM == CELL) ? 1 : 3;
+        m_range_.clear();
+        for (int n = 0; n < num; ++n) {
+            // same SFC as the arrays of the form, see Domain::InitializeAttribute
+            int tag = IFORM == CELL ? 0b000 : EntityIdCoder::m_sub_index_to_id_[IFORM][n];
+            SetRange(n, domain->GetSpaceFillingCurve(tag).GetSelection(box));
+        }
+    }
+    /** sum of v[0,n) over the ranks, e.g. GLOBAL_COMM.all_reduce_sum, the dot products are local if it is not set */
+    void SetReduce(std::function<void(Real *, int)> const &f) { m_reduce_ = f; }
+
+    /** (x,y), and *xz = (x,z) in the same sweep if z is given */
+    template <typename TVec>
+    Real Dot(TVec const &x, TVec const &y, detail::krylov_ptr<TVec> z = nullptr, Real *xz = nullptr) const {
+        nTuple<Real, 2> res{0, 0};
+        for (int n = 0, ne = detail::krylov_size(x); n < ne; ++n) {
+            auto range = GetRange(n, x);
+            Real const *px = detail::krylov_data(detail::krylov_component(x, n), range);
+            Real const *py = detail::krylov_data(detail::krylov_component(y, n), range);
+            Real const *pz = z == nullptr ? nullptr : detail::krylov_data(detail::krylov_component(*z, n), range);
+            auto r = Sweep(range, [&](index_type s) {
+                return nTuple<Real, 2>{px[s] * py[s], pz == nullptr ? 0 : px[s] * pz[s]};
+            });
+            res[0] += r[0];
+            res[1] += r[1];
+        }
+        Reduce(&res[0], z == nullptr ? 1 : 2);
+        if (xz != nullptr) { *xz = res[1]; }
+        return res[0];
+    }
+    /** y = a*x + c*w + b*y , y is not read if b is zero */
+    template <typename TVec>
+    void Update(TVec &y, Real a, TVec const &x, Real b, detail::krylov_ptr<TVec> w = nullptr, Real c = 0) const {
+        Update_(y, a, x, b, w, c, nullptr);
+    }
+    /** Update(y, a, x, b, w, c), returns (y,y), and *yz = (y,z) if z is given, in the same sweep */
+    template <typename TVec>
+    Real UpdateDot(TVec &y, Real a, TVec const &x, Real b, detail::krylov_ptr<TVec> w = nullptr, Real c = 0,
+                   detail::krylov_ptr<TVec> z = nullptr, Real *yz = nullptr) const {
+        nTuple<Real, 2> res = Update_(y, a, x, b, w, c, z == nullptr ? &y : z);
+        Reduce(&res[0], z == nullptr ? 1 : 2);
+        if (yz != nullptr) { *yz = res[1]; }
+        return res[0];
+    }
+    /** y = x / d , returns (x,y) */
+    template <typename TVec>
+    Real Divide(TVec &y, TVec const &x, TVec const &d) const {
+        Real res = 0;
+        for (int n = 0, ne = detail::krylov_size(x); n < ne; ++n) {
+            auto range = GetRange(n, x);
+            Real *py = const_cast<Real *>(detail::krylov_data(detail::krylov_component(y, n), range));
+            Real const *px = detail::krylov_data(detail::krylov_component(x, n), range);
+            Real const *pd = detail::krylov_data(detail::krylov_component(d, n), range);
+            res += Sweep(range, [&](index_type s) {
+                py[s] = px[s] / pd[s];
+                return nTuple<Real, 2>{px[s] * py[s], 0};
+            })[0];
+        }
+        Reduce(&res, 1);
+        return res;
+    }
+    /** v = 0 on the whole arrays, ghost entities included, they are allocated if they are not */
+    template <typename TVec>
+    void Clear(TVec &v) const {
+        for (int n = 0, ne = detail::krylov_size(v); n < ne; ++n) {
+            const_cast<Array<Real, ZSFC<3>> &>(detail::krylov_component(v, n)).Clear();
+        }
+    }
+
+   private:
+    std::vector<ZSFC<3>> m_range_;
+    std::function<void(Real *, int)> m_reduce_ = nullptr;
+
+    template <typename TVec>
+    ZSFC<3> GetRange(int n, TVec const &v) const {
+        return static_cast<size_t>(n) < m_range_.size() ? m_range_[n]
+                                                         : detail::krylov_component(v, n).GetSpaceFillingCurve();
+    }
+    void Reduce(Real *v, int num) const {
+        if (m_reduce_) { m_reduce_(v, num); }
+    }
+    template <typename TFun>
+    static nTuple<Real, 2> Sweep(ZSFC<3> const &range, TFun const &fun) {
+        return range.ReduceOffset(nTuple<Real, 2>{0, 0},
+                                  [](nTuple<Real, 2> const &l, nTuple<Real, 2> const &r) {
+                                      return nTuple<Real, 2>{l[0] + r[0], l[1] + r[1]};
+                                  },
+                                  [&](index_type s, index_type i, index_type j, index_type k) { return fun(s); });
+    }
+    //! local (y,y) and (y,z) of the updated y if z is given
+    template <typename TVec>
+    nTuple<Real, 2> Update_(TVec &y, Real a, TVec const &x, Real b, detail::krylov_ptr<TVec> w, Real c,
+                            detail::krylov_ptr<TVec> z) const {
+        nTuple<Real, 2> res{0, 0};
+        for (int n = 0, ne = detail::krylov_size(x); n < ne; ++n) {
+            auto range = GetRange(n, x);
+            Real *py = const_cast<Real *>(detail::krylov_data(detail::krylov_component(y, n), range));
+            Real const *px = detail::krylov_data(detail::krylov_component(x, n), range);
+            Real const *pw = w == nullptr ? px : detail::krylov_data(detail::krylov_component(*w, n), range);
+            Real const *pz = z == nullptr ? nullptr : detail::krylov_data(detail::krylov_component(*z, n), range);
+            Real cw = w == nullptr ? 0 : c;
+            auto r = Sweep(range, [&](index_type s) {
+                Real v = a * px[s] + cw * pw[s];
+                py[s] = b == 0 ? v : v + b * py[s];
+                return pz == nullptr ? nTuple<Real, 2>{0, 0} : nTuple<Real, 2>{py[s] * py[s], py[s] * pz[s]};
+            });
+            res[0] += r[0];
+            res[1] += r[1];
+        }
+        return res;
+    }
+};
+
+/** z = r, returns (r,z) */
+struct IdentityPreconditioner {
+    template <typename TVec>
+    Real operator()(KrylovSpace const &space, TVec &z, TVec const &r) const {
+        return space.UpdateDot(z, 1, r, 0);
+    }
+};
+/**
+ * z = r / diag, returns (r,z). diag is the diagonal of the operator, e.g. FVM::GetLaplacianDiagonal, it must not
+ * vanish in the owned range. diag is kept by reference.
+ */
+template <typename TVec>
+class JacobiPreconditioner {
+   public:
+    explicit JacobiPreconditioner(TVec const &diag) : m_diag_(diag) {}
+    Real operator()(KrylovSpace const &space, TVec &z, TVec const &r) const { return space.Divide(z, r, m_diag_); }
+
+   private:
+    TVec const &m_diag_;
+};
+
+struct KrylovControl {
+    size_type max_iterations = 1000;
+    //! converged if |b - A x| <= max(rtol * |b|, atol)
+    Real rtol = 1.0e-8;
+    Real atol = 0;
+    //! number of iterations of GMRES between restarts
+    size_type restart = 30;
+};
+struct KrylovStatus {
+    size_type iterations = 0;
+    //! |b - A x| at the last iteration, as estimated by the solver
+    Real residual = 0;
+    bool converged = false;
+};
+
+/**
+ * @addtogroup numeric
+ *  Matrix free solvers of  A x = b . A is a function A(x, y) that computes y = A x, e.g.
+ *      [&](auto &x, auto &y) { y = codifferential_derivative(exterior_derivative(x)); }
+ *  it may update the ghost entities of x (halo exchange, boundary condition) before the stencil is applied. The
+ *  preconditioner M(space, z, r) computes z = M^-1 r and returns (r,z). x is the initial guess and the solution.
+ *  The work vectors have the shape of x, they are allocated by the caller and kept between solves; they are cleared,
+ *  ghost entities included, at the start of a solve. Every dot product is reduced over the ranks by the space.
+ *  @{
+ */
+/** preconditioned conjugate gradient, A and M symmetric positive definite, 4 work vectors */
+template <typename TVec, typename TOp, typename TPre>
+KrylovStatus CG(KrylovSpace const &space, TOp const &A, TPre const &M, TVec const &b, TVec &x,
+                std::vector<TVec *> const &work, KrylovControl const &ctl = KrylovControl()) {
+    ASSERT(work.size() >= 4);
+    TVec &r = *work[0];
+    TVec &z = *work[1];
+    TVec &p = *work[2];
+    TVec &q = *work[3];
+    for (auto *v : work) { space.Clear(*v); }
+    KrylovStatus status;
+    Real tol = std::max(ctl.rtol * std::sqrt(space.Dot(b, b)), ctl.atol);
+    A(x, q);
+    status.residual = std::sqrt(space.UpdateDot(r, 1, b, 0, &q, -1));
+    if (status.residual <= tol) {
+        status.converged = true;
+        return status;
+    }
+    Real rz = M(space, z, r);
+    space.Update(p, 1, z, 0);
+    while (status.iterations < ctl.max_iterations) {
+        ++status.iterations;
+        A(p, q);
+        Real alpha = rz / space.Dot(p, q);
+        space.Update(x, alpha, p, 1);
+        status.residual = std::sqrt(space.UpdateDot(r, -alpha, q, 1));
+        if (status.residual <= tol) {
+            status.converged = true;
+            break;
+        }
+        Real rz_new = M(space, z, r);
+        space.Update(p, 1, z, rz_new / rz);
+        rz = rz_new;
+    }
+    return status;
+}
+/** right preconditioned BiCGStab, 7 work vectors */
+template <typename TVec, typename TOp, typename TPre>
+KrylovStatus BiCGStab(KrylovSpace const &space, TOp const &A, TPre const &M, TVec const &b, TVec &x,
+                      std::vector<TVec *> const &work, KrylovControl const &ctl = KrylovControl()) {
+    ASSERT(work.size() >= 7);
+    TVec &r = *work[0];
+    TVec &r0 = *work[1];
+    TVec &p = *work[2];
+    TVec &v = *work[3];
+    TVec &t = *work[4];
+    TVec &p_hat = *work[5];
+    TVec &s_hat = *work[6];
+    for (auto *u : work) { space.Clear(*u); }
+    KrylovStatus status;
+    Real tol = std::max(ctl.rtol * std::sqrt(space.Dot(b, b)), ctl.atol);
+    A(x, t);
+    status.residual = std::sqrt(space.UpdateDot(r, 1, b, 0, &t, -1));
+    space.Update(r0, 1, r, 0);
+    Real rho = status.residual * status.residual, alpha = 1, omega = 1, rho_old = 1;
+    while (status.residual > tol && status.iterations < ctl.max_iterations) {
+        ++status.iterations;
+        if (rho == 0 || omega == 0) { break; }
+        Real beta = (rho / rho_old) * (alpha / omega);
+        //  p = r + beta * (p - omega * v)
+        space.Update(p, 1, r, beta, &v, -beta * omega);
+        M(space, p_hat, p);
+        A(p_hat, v);
+        alpha = rho / space.Dot(r0, v);
+        //  s = r - alpha * v , kept in r
+        status.residual = std::sqrt(space.UpdateDot(r, -alpha, v, 1));
+        if (status.residual <= tol) {
+            space.Update(x, alpha, p_hat, 1);
+            break;
+        }
+        M(space, s_hat, r);
+        A(s_hat, t);
+        Real ts = 0;
+        Real tt = space.Dot(t, t, &r, &ts);
+        omega = tt == 0 ? 0 : ts / tt;
+        space.Update(x, alpha, p_hat, 1, &s_hat, omega);
+        rho_old = rho;
+        //  r = s - omega * t , and rho = (r, r0) in the same sweep
+        status.residual = std::sqrt(space.UpdateDot(r, -omega, t, 1, nullptr, 0, &r0, &rho));
+    }
+    status.converged = status.residual <= tol;
+    return status;
+}
+/**
+ * restarted, right preconditioned GMRES(m), m = ctl.restart, m + 3 work vectors. The Arnoldi basis is orthogonalized
+ * by modified Gram-Schmidt, the projection on the next basis vector is taken in the sweep of the previous update.
+ */
+template <typename TVec, typename TOp, typename TPre>
+KrylovStatus GMRES(KrylovSpace const &space, TOp const &A, TPre const &M, TVec const &b, TVec &x,
+                   std::vector<TVec *> const &work, KrylovControl const &ctl = KrylovControl()) {
+    size_type m = std::max<size_type>(ctl.restart, 1);
+    ASSERT(work.size() >= m + 3);
+    TVec &z = *work[m + 1];
+    TVec &w = *work[m + 2];
+    for (auto *u : work) { space.Clear(*u); }
+    std::vector<Real> H((m + 1) * m, 0), g(m + 1, 0), cs(m, 0), sn(m, 0), y(m, 0);
+    auto h = [&](size_type i, size_type j) -> Real & { return H[i * m + j]; };
+
+    KrylovStatus status;
+    Real tol = std::max(ctl.rtol * std::sqrt(space.Dot(b, b)), ctl.atol);
+    while (true) {
+        A(x, w);
+        Real beta = std::sqrt(space.UpdateDot(*work[0], 1, b, 0, &w, -1));
+        status.residual = beta;
+        if (beta <= tol || beta == 0 || status.iterations >= ctl.max_iterations) { break; }
+        space.Update(*work[0], 1 / beta, *work[0], 0);
+        std::fill(g.begin(), g.end(), 0);
+        g[0] = beta;
+        size_type k = 0;
+        while (k < m && status.iterations < ctl.max_iterations) {
+            ++status.iterations;
+            M(space, z, *work[k]);
+            A(z, w);
+            h(0, k) = space.Dot(w, *work[0]);
+            Real ww = 0;
+            for (size_type i = 0; i <= k; ++i) {
+                ww = i < k ? space.UpdateDot(w, -h(i, k), *work[i], 1, nullptr, 0, work[i + 1], &h(i + 1, k))
+                           : space.UpdateDot(w, -h(i, k), *work[i], 1);
+            }
+            h(k + 1, k) = std::sqrt(ww);
+            if (h(k + 1, k) > 0) { space.Update(*work[k + 1], 1 / h(k + 1, k), w, 0); }
+            // Givens rotations of the column k of the Hessenberg matrix
+            for (size_type i = 0; i < k; ++i) {
+                Real t = cs[i] * h(i, k) + sn[i] * h(i + 1, k);
+                h(i + 1, k) = -sn[i] * h(i, k) + cs[i] * h(i + 1, k);
+                h(i, k) = t;
+            }
+            Real d = std::hypot(h(k, k), h(k + 1, k));
+            cs[k] = d == 0 ? 1 : h(k, k) / d;
+            sn[k] = d == 0 ? 0 : h(k + 1, k) / d;
+            h(k, k) = d;
+            h(k + 1, k) = 0;
+            g[k + 1] = -sn[k] * g[k];
+            g[k] = cs[k] * g[k];
+            status.residual = std::abs(g[k + 1]);
+            ++k;
+            if (status.residual <= tol || d == 0) { break; }
+        }
+        // x += M^-1 (V y) , H y = g
+        for (size_type i = k; i-- > 0;) {
+            y[i] = g[i];
+            for (size_type j = i + 1; j < k; ++j) { y[i] -= h(i, j) * y[j]; }
+            y[i] = h(i, i) == 0 ? 0 : y[i] / h(i, i);
+        }
+        space.Update(w, y[0], *work[0], 0);
+        for (size_type i = 1; i < k; ++i) { space.Update(w, y[i], *work[i], 1); }
+        M(space, z, w);
+        space.Update(x, 1, z, 1);
+        if (status.residual <= tol) { break; }
+    }
+    status.converged = status.residual <= tol;
+    return status;
+}
+/** @} */
+}  // namespace linear_solver
+}  // namespace simpla
+
+#endif  // SIMPLA_KRYLOV_H
@@ -8,21 +8,49 @@
 #ifndef NORMAL_DISTRIBUTION_ICDF_H_
 #define NORMAL_DISTRIBUTION_ICDF_H_
 
-#include "icdf_distribution.h"
+#include <algorithm>
 #include <cmath>
-namespace simpla
-{
-/** @ingroup numeric */
-class normal_distribution_icdf
-{
+namespace simpla {
+/** @ingroup numeric
+ *
+ * \brief normal distribution by the inverse of its cumulative distribution function, maps a uniform number in (0,1)
+ *        to a normal one. Relative error is less than 1.15e-9.
+ *
+ *  Both the central and the tail approximations are evaluated and one is selected, there is no branch, so a loop of
+ *  calls is vectorized.
+ *
+ * \note P. J. Acklam, An algorithm for computing the inverse normal cumulative distribution function (2003).
+ */
+class normal_distribution_icdf {
+   public:
+    normal_distribution_icdf(double mean = 0, double stddev = 1) : m_mean_(mean), m_stddev_(stddev) {}
 
-public:
-private:
-	normal_distribution_icdf(double mean, double stddev)
-	{
+    double operator()(double u) const { return m_mean_ + m_stddev_ * value(u); }
 
-	}
+    /** standard normal quantile of u in (0,1) */
+    static inline double value(double u) {
+        static constexpr double p_low = 0.02425;
+        // central region
+        double q = u - 0.5;
+        double r = q * q;
+        double x_c = (((((-3.969683028665376e+01 * r + 2.209460984245205e+02) * r - 2.759285104469687e+02) * r +
+                        1.383577518672690e+02) * r - 3.066479806614716e+01) * r + 2.506628277459239e+00) * q /
+                     (((((-5.447609879822406e+01 * r + 1.615858368580409e+02) * r - 1.556989798598866e+02) * r +
+                        6.680131188771972e+01) * r - 1.328068155288572e+01) * r + 1.0);
+        // tails, lower tail of min(u,1-u) and the sign of the side
+        double p = std::min(u, 1.0 - u);
+        double t = std::sqrt(-2.0 * std::log(p));
+        double x_t = (((((-7.784894002430293e-03 * t - 3.223964580411365e-01) * t - 2.400758277161838e+00) * t -
+                        2.549732539343734e+00) * t + 4.374664141464968e+00) * t + 2.938163982698783e+00) /
+                     ((((7.784695709041462e-03 * t + 3.224671290700398e-01) * t + 2.445134137142996e+00) * t +
+                       3.754408661907416e+00) * t + 1.0);
+        x_t = u < 0.5 ? x_t : -x_t;
+        return p < p_low ? x_t : x_c;
+    }
 
+   private:
+    double m_mean_;
+    double m_stddev_;
 };
 
 }  // namespace simpla
@@ -0,0 +1,64 @@
+/**
+ *  @file philox_engine.h
+ *  Philox4x32-10 counter based random number engine.
+ */
+
+#ifndef PHILOX_ENGINE_H_
+#define PHILOX_ENGINE_H_
+
+#include "simpla/SIMPLA_config.h"
+
+#include <cstdint>
+
+namespace simpla {
+
+/** @ingroup numeric
+ *
+ * \brief Philox4x32-10, counter-based random number generator
+ *
+ *  The output is a pure function of a 128 bit counter and a 64 bit key, so the n-th number of a stream is computed
+ *  directly, without state, and does not depend on how the stream is distributed over threads or processes.
+ *
+ * \note J. K. Salmon, M. A. Moraes, R. O. Dror, and D. E. Shaw, Parallel random numbers: as easy as 1, 2, 3,
+ *       SC '11 (2011).
+ */
+struct philox_engine {
+    typedef uint32_t result_type;
+    static constexpr int NUMBER_OF_ROUNDS = 10;
+
+    static inline void round(uint32_t *ctr, uint32_t const *key) {
+        uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * ctr[0];
+        uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * ctr[2];
+        uint32_t c1 = ctr[1];
+        uint32_t c3 = ctr[3];
+        ctr[0] = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ key[0];
+        ctr[1] = static_cast<uint32_t>(p1);
+        ctr[2] = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ key[1];
+        ctr[3] = static_cast<uint32_t>(p0);
+    }
+    /** ctr is replaced by the four random words of (ctr, key) */
+    static inline void generate(uint32_t *ctr, uint32_t const *key) {
+        uint32_t k[2] = {key[0], key[1]};
+        for (int i = 0; i < NUMBER_OF_ROUNDS; ++i) {
+            round(ctr, k);
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+    }
+    /** 53 random bits of two words to a double in (0,1) */
+    static inline double to_uniform(uint32_t hi, uint32_t lo) {
+        uint64_t bits = (static_cast<uint64_t>(hi) << 21) ^ (lo >> 11);
+        return (static_cast<double>(bits) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+    /** uniform number in (0,1) of the stream of seed, indexed by (index, n) */
+    static inline double uniform(uint64_t seed, uint64_t index, uint32_t n) {
+        uint32_t ctr[4] = {static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32), n, 0};
+        uint32_t key[2] = {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+        generate(ctr, key);
+        return to_uniform(ctr[0], ctr[1]);
+    }
+};
+
+}  // namespace simpla
+
+#endif /* PHILOX_ENGINE_H_ */
@@ -13,20 +13,20 @@
 #include <memory>
 #include <mutex>
 #include <thread>
-#include "type_traits.h"
 #include "MPIComm.h"
-#include "MPIUpdate.h"
+#include "simpla/utilities/Log.h"
 
-namespace simpla { namespace parallel
-{
-
-struct DistributedCounter
-{
+namespace simpla {
+namespace parallel {
 
+/**
+ *  global numbering of items (e.g. particles) created on many processes: reserve() gives every process a
+ *  contiguous range of global indices, in the order of the ranks, get() takes indices from this range.
+ */
+struct DistributedCounter {
     std::atomic<size_t> m_start_, m_end_;
 
-public:
-
+   public:
     DistributedCounter() : m_start_(0), m_end_(0) {}
 
     virtual ~DistributedCounter() {}
@@ -34,29 +34,24 @@ public:
     DistributedCounter(DistributedCounter const &other) = delete;
 
     /**
-     * // thread safe
-     *  @param pic      number of sample point
-     *  @param volume   volume of sample region
-     *  @param box      shape of spatial sample region (e.g. box(x_min,x_max))
-     *  @param args...  other of args for v_dist
+     * thread safe
+     *  @param num  number of items
+     *  @return     global index of the first item
      */
-    size_t get(size_t num) { return (m_start_ += num) - num; };
-
-
-    void reserve(size_t num)
-    {
-        ASSERT(m_start_.load() == 0);
-
-        int offset = 0;
-        int total = 0;
-        std::tie(m_start_, std::ignore) =
-                parallel::sync_global_location(GLOBAL_COMM, static_cast<int>(num ));
+    size_t get(size_t num) {
+        size_t res = (m_start_ += num) - num;
+        ASSERT(res + num <= m_end_);
+        return res;
+    };
+
+    /** collective, reserve num items on this process */
+    void reserve(size_t num) {
+        ASSERT(m_start_.load() == m_end_.load());
+        size_t offset = GLOBAL_COMM.exclusive_scan(num);
         m_start_ = offset;
         m_end_ = offset + num;
-
     }
-
 };
-
-}}
-#endif //SIMPLA_DISTRIBUTEDCOUNTER_H
+}  // namespace parallel
+}  // namespace simpla
+#endif  // SIMPLA_DISTRIBUTEDCOUNTER_H
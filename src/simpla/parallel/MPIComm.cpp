@@ -34,9 +34,32 @@ struct MPIComm::pimpl_s {
     size_type m_object_id_count_ = 0;
     int m_topology_ndims_ = 3;
     int m_topology_dims_[3] = {0, 1, 1};
+    int m_thread_level_ = MPI_THREAD_SINGLE;
 
     MPI_Datatype DataType(size_type type_hash);
+    //! requests of non-blocking calls, a finished slot is reused
+    std::vector<MPI_Request> m_requests_;
+    std::vector<int> m_free_requests_;
+    int AddRequest();
+    //! duplicates of m_comm_ for threads other than the main thread, see UseThreadComm
+    std::vector<MPI_Comm> m_thread_comms_;
+    MPI_Comm comm() const;
 };
+static thread_local int t_thread_comm_ = -1;
+MPI_Comm MPIComm::pimpl_s::comm() const {
+    return t_thread_comm_ < 0 || m_comm_ == MPI_COMM_NULL ? m_comm_ : m_thread_comms_[t_thread_comm_];
+}
+int MPIComm::pimpl_s::AddRequest() {
+    int res;
+    if (m_free_requests_.empty()) {
+        res = static_cast<int>(m_requests_.size());
+        m_requests_.push_back(MPI_REQUEST_NULL);
+    } else {
+        res = m_free_requests_.back();
+        m_free_requests_.pop_back();
+    }
+    return res;
+}
 
 MPIComm::MPIComm() : m_pimpl_(new pimpl_s) {}
 MPIComm::MPIComm(int argc, char **argv) : MPIComm() { Initialize(argc, argv); }
@@ -57,25 +80,32 @@ int MPIComm::size() const {
 
 int MPIComm::get_rank(int const *d) const {
     int res = 0;
-    MPI_CALL(MPI_Cart_rank(m_pimpl_->m_comm_, (int *)d, &res));
+    MPI_CALL(MPI_Cart_rank(m_pimpl_->comm(), (int *)d, &res));
     return res;
 }
 
 void MPIComm::Initialize(int argc, char **argv) {
-    MPI_CALL(MPI_Init(&argc, &argv));
+    // only the main thread calls MPI, unless the checkpoints are written by a background thread ("checkpoint_async")
+    int required = MPI_THREAD_FUNNELED;
     parse_cmd_line(argc, argv, [&](std::string const &opt, std::string const &value) -> int {
         if (opt == "mpi_topology") {
             auto v = type_cast<nTuple<int, 3> >(value);
             m_pimpl_->m_topology_dims_[0] = v[0];
             m_pimpl_->m_topology_dims_[1] = v[1];
             m_pimpl_->m_topology_dims_[2] = v[2];
+        } else if (opt == "checkpoint_async") {
+            required = MPI_THREAD_MULTIPLE;
         }
         return CONTINUE;
     });
+    MPI_CALL(MPI_Init_thread(&argc, &argv, required, &m_pimpl_->m_thread_level_));
 
     m_pimpl_->m_object_id_count_ = 0;
     int m_num_process_;
     MPI_CALL(MPI_Comm_size(MPI_COMM_WORLD, &m_num_process_));
+    if (m_num_process_ > 1 && m_pimpl_->m_thread_level_ < required) {
+        WARNING << "MPI does not provide MPI_THREAD_MULTIPLE, checkpoints are written synchronously!" << std::endl;
+    }
     if (m_num_process_ > 1) {
         int m_topology_coord_[3] = {0, 0, 0};
         MPI_CALL(MPI_Dims_create(m_num_process_, m_pimpl_->m_topology_ndims_, m_pimpl_->m_topology_dims_));
@@ -84,7 +114,7 @@ void MPIComm::Initialize(int argc, char **argv) {
         MPI_CALL(MPI_Cart_create(MPI_COMM_WORLD, m_pimpl_->m_topology_ndims_, m_pimpl_->m_topology_dims_, periods,
                                  MPI_ORDER_C, &m_pimpl_->m_comm_));
         logger::set_mpi_comm(rank(), size());
-        MPI_CALL(MPI_Cart_coords(m_pimpl_->m_comm_, rank(), m_pimpl_->m_topology_ndims_, m_topology_coord_));
+        MPI_CALL(MPI_Cart_coords(m_pimpl_->comm(), rank(), m_pimpl_->m_topology_ndims_, m_topology_coord_));
 
         INFORM << "MPI communicator is initialized! "
                   "[("
@@ -101,6 +131,32 @@ size_type MPIComm::generate_object_id() {
     return m_pimpl_->m_object_id_count_;
 }
 
+size_type MPIComm::exclusive_scan(size_type count, size_type *total) const {
+    unsigned long long in = count, res = 0, sum = count;
+    if (is_valid()) {
+        MPI_CALL(MPI_Exscan(&in, &res, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, m_pimpl_->comm()));
+        if (rank() == 0) { res = 0; }
+        MPI_CALL(MPI_Allreduce(&in, &sum, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, m_pimpl_->comm()));
+    }
+    if (total != nullptr) { *total = static_cast<size_type>(sum); }
+    return static_cast<size_type>(res);
+}
+void MPIComm::all_reduce_min(index_type *v, int n) const {
+    if (is_valid()) { MPI_CALL(MPI_Allreduce(MPI_IN_PLACE, v, n, MPI_INT64_T, MPI_MIN, m_pimpl_->comm())); }
+}
+void MPIComm::all_reduce_max(index_type *v, int n) const {
+    if (is_valid()) { MPI_CALL(MPI_Allreduce(MPI_IN_PLACE, v, n, MPI_INT64_T, MPI_MAX, m_pimpl_->comm())); }
+}
+void MPIComm::all_reduce_min(Real *v, int n) const {
+    if (is_valid()) { MPI_CALL(MPI_Allreduce(MPI_IN_PLACE, v, n, MPI_DOUBLE, MPI_MIN, m_pimpl_->comm())); }
+}
+void MPIComm::all_reduce_max(Real *v, int n) const {
+    if (is_valid()) { MPI_CALL(MPI_Allreduce(MPI_IN_PLACE, v, n, MPI_DOUBLE, MPI_MAX, m_pimpl_->comm())); }
+}
+void MPIComm::all_reduce_sum(Real *v, int n) const {
+    if (is_valid()) { MPI_CALL(MPI_Allreduce(MPI_IN_PLACE, v, n, MPI_DOUBLE, MPI_SUM, m_pimpl_->comm())); }
+}
+
 // MPI_Comm MPIComm::comm() const { return m_pimpl_->m_comm_; }
 //
 // MPI_Info MPIComm::info() {
@@ -109,9 +165,22 @@ size_type MPIComm::generate_object_id() {
 //}
 
 void MPIComm::barrier() {
-    if (m_pimpl_->m_comm_ != MPI_COMM_NULL) { MPI_Barrier(m_pimpl_->m_comm_); }
+    if (m_pimpl_->m_comm_ != MPI_COMM_NULL) { MPI_Barrier(m_pimpl_->comm()); }
 }
 
+bool MPIComm::is_thread_multiple() const { return m_pimpl_->m_thread_level_ >= MPI_THREAD_MULTIPLE; }
+int MPIComm::CreateThreadComm() {
+    int res = -1;
+    if (m_pimpl_->m_comm_ != MPI_COMM_NULL) {
+        MPI_Comm c;
+        MPI_CALL(MPI_Comm_dup(m_pimpl_->comm(), &c));
+        res = static_cast<int>(m_pimpl_->m_thread_comms_.size());
+        m_pimpl_->m_thread_comms_.push_back(c);
+    }
+    return res;
+}
+void MPIComm::UseThreadComm(int id) { t_thread_comm_ = id; }
+
 bool MPIComm::is_valid() const { return ((!!m_pimpl_) && m_pimpl_->m_comm_ != MPI_COMM_NULL) && num_of_process() > 1; }
 
 int MPIComm::topology(int *mpi_topo_ndims, int *mpi_topo_dims, int *periods, int *mpi_topo_coord) const {
@@ -125,22 +194,24 @@ int MPIComm::topology(int *mpi_topo_ndims, int *mpi_topo_dims, int *periods, int
     } else {
         int tope_type = MPI_CART;
 
-        MPI_CALL(MPI_Topo_test(m_pimpl_->m_comm_, &tope_type));
+        MPI_CALL(MPI_Topo_test(m_pimpl_->comm(), &tope_type));
 
         if (tope_type == MPI_CART) {
-            MPI_CALL(MPI_Cartdim_get(m_pimpl_->m_comm_, mpi_topo_ndims));
+            MPI_CALL(MPI_Cartdim_get(m_pimpl_->comm(), mpi_topo_ndims));
 
-            MPI_CALL(MPI_Cart_get(m_pimpl_->m_comm_, *mpi_topo_ndims, mpi_topo_dims, periods, mpi_topo_coord));
+            MPI_CALL(MPI_Cart_get(m_pimpl_->comm(), *mpi_topo_ndims, mpi_topo_dims, periods, mpi_topo_coord));
         }
     }
     return SP_SUCCESS;
 };
 void MPIComm::CartShift(int dirction, int disp, int *left, int *right) const {
-    if (is_valid()) { MPI_CALL(MPI_Cart_shift(m_pimpl_->m_comm_, dirction, disp, left, right)); }
+    if (is_valid()) { MPI_CALL(MPI_Cart_shift(m_pimpl_->comm(), dirction, disp, left, right)); }
 }
 void MPIComm::Finalize() {
     if (m_pimpl_ != nullptr && m_pimpl_->m_comm_ != MPI_COMM_NULL) {
         VERBOSE << "MPI Communicator is closed!" << std::endl;
+        for (auto &c : m_pimpl_->m_thread_comms_) { MPI_Comm_free(&c); }
+        m_pimpl_->m_thread_comms_.clear();
         MPI_CALL(MPI_Finalize());
         m_pimpl_->m_comm_ = MPI_COMM_NULL;
     }
@@ -166,6 +237,9 @@ MPI_Datatype MPIComm::pimpl_s::DataType(size_type type_hash) {
     } else if (type_hash == std::type_index(typeid(unsigned int)).hash_code()) {
         ele_size = sizeof(unsigned int);
         ele_type = MPI_UNSIGNED;
+    } else if (type_hash == std::type_index(typeid(char)).hash_code()) {
+        ele_size = sizeof(char);
+        ele_type = MPI_BYTE;
     } else {
         UNIMPLEMENTED;
     }
@@ -178,7 +252,46 @@ void MPIComm::SendRecv(const void *sendbuf, int sendcount, size_type sendtype_ha
                           m_pimpl_->DataType(sendtype_hash), dest, sendtag,    //
                           recvbuf, recvcount,                                  //
                           m_pimpl_->DataType(recvtype_hash), source, recvtag,  //
-                          m_pimpl_->m_comm_, MPI_STATUS_IGNORE));
+                          m_pimpl_->comm(), MPI_STATUS_IGNORE));
+}
+
+int MPIComm::ISend(const void *buf, int count, size_type type_hash, int dest, int tag) {
+    int res = m_pimpl_->AddRequest();
+    MPI_CALL(MPI_Isend(buf, count, m_pimpl_->DataType(type_hash), dest, tag, m_pimpl_->comm(),
+                       &m_pimpl_->m_requests_[res]));
+    return res;
+}
+int MPIComm::IRecv(void *buf, int count, size_type type_hash, int source, int tag) {
+    int res = m_pimpl_->AddRequest();
+    MPI_CALL(MPI_Irecv(buf, count, m_pimpl_->DataType(type_hash), source, tag, m_pimpl_->comm(),
+                       &m_pimpl_->m_requests_[res]));
+    return res;
+}
+void MPIComm::WaitAll(int num, int const *requests) {
+    if (num <= 0) { return; }
+    std::vector<MPI_Request> r(static_cast<size_t>(num));
+    for (int i = 0; i < num; ++i) { r[i] = m_pimpl_->m_requests_[requests[i]]; }
+    MPI_CALL(MPI_Waitall(num, &r[0], MPI_STATUSES_IGNORE));
+    for (int i = 0; i < num; ++i) {
+        m_pimpl_->m_requests_[requests[i]] = MPI_REQUEST_NULL;
+        m_pimpl_->m_free_requests_.push_back(requests[i]);
+    }
+}
+int MPIComm::GetNeighbour(int const *disp) const {
+    if (!is_valid()) { return 0; }  // the only process is its own neighbour
+    int ndims = 0, dims[pimpl_s::MAX_NUM_OF_DIMS], periods[pimpl_s::MAX_NUM_OF_DIMS],
+        coords[pimpl_s::MAX_NUM_OF_DIMS];
+    topology(&ndims, dims, periods, coords);
+    for (int i = ndims; i < pimpl_s::MAX_NUM_OF_DIMS; ++i) {
+        if (disp[i] != 0) { return -1; }
+    }
+    for (int i = 0; i < ndims; ++i) {
+        coords[i] += disp[i];
+        if (!periods[i] && (coords[i] < 0 || coords[i] >= dims[i])) { return -1; }
+    }
+    int res = -1;
+    MPI_CALL(MPI_Cart_rank(m_pimpl_->comm(), coords, &res));
+    return res;
 }
 
 std::string bcast_string(std::string const &str, int root) {
@@ -186,10 +299,10 @@ std::string bcast_string(std::string const &str, int root) {
     std::string s_buffer = str;
     int name_len;
     if (GLOBAL_COMM.process_num() == root) { name_len = s_buffer.size(); }
-    MPI_Bcast(&name_len, 1, MPI_INT, 0, GLOBAL_COMM.m_pimpl_->m_comm_);
+    MPI_Bcast(&name_len, 1, MPI_INT, 0, GLOBAL_COMM.m_pimpl_->comm());
     std::vector<char> buffer(static_cast<size_type>(name_len));
     if (GLOBAL_COMM.process_num() == root) { std::copy(s_buffer.begin(), s_buffer.end(), buffer.begin()); }
-    MPI_Bcast((&buffer[0]), name_len, MPI_CHAR, 0, GLOBAL_COMM.m_pimpl_->m_comm_);
+    MPI_Bcast((&buffer[0]), name_len, MPI_CHAR, 0, GLOBAL_COMM.m_pimpl_->comm());
     buffer.push_back('\0');
     if (GLOBAL_COMM.process_num() != root) { s_buffer = &buffer[0]; }
     return s_buffer;
@@ -221,7 +334,7 @@ std::string gather_string(std::string const &str, int root, size_type *num, size
         int str_len = static_cast<int>(str.size());
 
         GLOBAL_COMM.barrier();
-        MPI_Gather(&str_len, 1, MPI_INT, recvcounts, 1, MPI_INT, root, MPI_COMM_WORLD);
+        MPI_Gather(&str_len, 1, MPI_INT, recvcounts, 1, MPI_INT, root, GLOBAL_COMM.m_pimpl_->comm());
         GLOBAL_COMM.barrier();
 
         /*
@@ -253,7 +366,7 @@ std::string gather_string(std::string const &str, int root, size_type *num, size
          * can gather the strings
          */
         MPI_Gatherv(str.c_str(), static_cast<int>(str.size()), MPI_CHAR, recvbuf, recvcounts, displs, MPI_CHAR, root,
-                    MPI_COMM_WORLD);
+                    GLOBAL_COMM.m_pimpl_->comm());
         GLOBAL_COMM.barrier();
         recvbuf[totlen - 1] = '\0';
         res = recvbuf;
@@ -262,11 +375,11 @@ std::string gather_string(std::string const &str, int root, size_type *num, size
     } else {
         int str_len = static_cast<int>(str.size());
         GLOBAL_COMM.barrier();
-        MPI_Gather(&str_len, 1, MPI_INT, nullptr, 1, MPI_INT, root, MPI_COMM_WORLD);
+        MPI_Gather(&str_len, 1, MPI_INT, nullptr, 1, MPI_INT, root, GLOBAL_COMM.m_pimpl_->comm());
         GLOBAL_COMM.barrier();
 
         MPI_Gatherv(str.c_str(), static_cast<int>(str.size()), MPI_CHAR, nullptr, nullptr, nullptr, MPI_CHAR, root,
-                    MPI_COMM_WORLD);
+                    GLOBAL_COMM.m_pimpl_->comm());
         GLOBAL_COMM.barrier();
     }
     if (do_bcast) { res = bcast_string(res, root); }
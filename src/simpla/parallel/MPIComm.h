@@ -32,14 +32,45 @@ class MPIComm {
     int process_num() const;
     int num_of_process() const;
     size_type generate_object_id();
+    /** exclusive prefix sum of count over the ranks, the total is returned in *total */
+    size_type exclusive_scan(size_type count, size_type *total = nullptr) const;
+    /** element-wise minimum / maximum of v[0..n) over the ranks, in place */
+    void all_reduce_min(index_type *v, int n) const;
+    void all_reduce_max(index_type *v, int n) const;
+    void all_reduce_min(Real *v, int n) const;
+    void all_reduce_max(Real *v, int n) const;
+    /** element-wise sum of v[0..n) over the ranks, in place */
+    void all_reduce_sum(Real *v, int n) const;
     int topology(int *mpi_topo_ndims, int *mpi_topo_dims, int *periods, int *mpi_topo_coord) const;
     void CartShift(int dirction, int disp, int *left, int *right) const;
     int rank() const;
     int size() const;
     int get_rank(int const *d) const;
+    /**
+     * MPI provides MPI_THREAD_MULTIPLE, threads other than the main thread may communicate. It is only requested if
+     * the command line has "--checkpoint_async", otherwise MPI is initialized with MPI_THREAD_FUNNELED.
+     */
+    bool is_thread_multiple() const;
+    /**
+     * duplicate the communicator for a thread, collective, called by the main thread before the thread is started.
+     * @return the id of the duplicate, -1 if MPI is not initialized
+     */
+    int CreateThreadComm();
+    /**
+     * the calling thread communicates over the duplicate id (-1 is the communicator itself), so its collective calls,
+     * e.g. those of a background writer, never match the ones of the main thread. Non-blocking calls (ISend/IRecv)
+     * are kept to the main thread.
+     */
+    void UseThreadComm(int id);
 
     void SendRecv(const void *sendbuf, int sendcount, size_type sendtype_hash, int dest, int sendtag, void *recvbuf,
                   int recvcount, size_type recvtype_hash, int source, int recvtag);
+    /** non-blocking send/receive, the returned request is completed by WaitAll */
+    int ISend(const void *buf, int count, size_type type_hash, int dest, int tag);
+    int IRecv(void *buf, int count, size_type type_hash, int source, int tag);
+    void WaitAll(int num, int const *requests);
+    /** rank of the process at the shift disp in the cartesian topology, -1 if there is none */
+    int GetNeighbour(int const *disp) const;
     //    std::tuple<int, int, int> make_send_recv_tag(size_t prefix, const nTuple<int, 3> &m_global_start_);
     struct pimpl_s;
     std::unique_ptr<pimpl_s> m_pimpl_;
@@ -4,42 +4,78 @@
 #include "MPIUpdater.h"
 #include <simpla/SIMPLA_config.h>
 #include <simpla/utilities/macro.h>
+#include <simpla/utilities/memory.h>
+#include <cstring>
+#include <map>
+#include <typeindex>
 #include <typeinfo>
+#include <vector>
 #include "MPIComm.h"
 namespace simpla {
 namespace parallel {
+namespace detail {
+template <typename V>
+std::shared_ptr<ArrayBase> mpi_updater_view() {
+    return std::make_shared<Array<V>>();
+}
+static size_type box_volume(index_box_type const &b) {
+    size_type res = 1;
+    for (int i = 0; i < 3; ++i) {
+        res *= static_cast<size_type>(std::max(std::get<1>(b)[i] - std::get<0>(b)[i], index_type(0)));
+    }
+    return res;
+}
+//! index of the shift d in {-1,0,1}^3, the opposite shift is 26 - index
+static int mpi_updater_direction(int const *d) { return (d[0] + 1) * 9 + (d[1] + 1) * 3 + (d[2] + 1); }
+static constexpr int MPI_UPDATER_NUM_OF_DIRECTIONS = 27;
+//! variables are aligned to 8 bytes in a message
+static constexpr size_type MPI_UPDATER_ALIGNMENT = 8;
+}  // namespace detail
 
 struct MPIUpdater::pimpl_s {
     bool m_is_setup_ = false;
-    int ndims = 3;
-    int mpi_topology_ndims = 0;
-    int mpi_dims[3] = {1, 1, 1};
-    int mpi_periods[3] = {1, 1, 1};
-    int mpi_coords[3] = {0, 0, 0};
+    bool m_is_pending_ = false;
 
     index_box_type m_index_box_{{0, 0, 0}, {1, 1, 1}};
     index_box_type m_halo_box_{{0, 0, 0}, {1, 1, 1}};
 
-    //    index_tuple m_gw_{2, 2, 2};
-
-    //    MPI_Datatype ele_type;
-    size_t ele_type;
     int tag = 0;
-    int m_direction_ = 0;
-    int left = 0, right = 0;
     int m_rank_ = 0;
-    int m_coord_[3] = {0, 0, 0};
     bool m_is_perodic_ = true;
+
+    //! empty array of the value type and size of value, of every variable
+    std::vector<std::pair<std::shared_ptr<ArrayBase>, size_type>> m_variables_;
+
+    struct neighbour_s {
+        int rank = -1;
+        int direction = 0;
+        std::vector<index_box_type> send_boxes;
+        std::vector<index_box_type> recv_boxes;
+        size_type send_size = 0;
+        size_type recv_size = 0;
+        std::shared_ptr<char> send_buffer;
+        std::shared_ptr<char> recv_buffer;
+        //! variables in the buffers, the view of variable v in box b is [b * number of variables + v]
+        std::vector<std::shared_ptr<ArrayBase>> send;
+        std::vector<std::shared_ptr<ArrayBase>> recv;
+    };
+    std::vector<neighbour_s> m_neighbours_;
+    int m_neighbour_of_direction_[detail::MPI_UPDATER_NUM_OF_DIRECTIONS];
+    std::vector<int> m_requests_;
+    //! explicit send and receive regions of every rank, see AddSendRegion
+    std::map<int, std::pair<std::vector<index_box_type>, std::vector<index_box_type>>> m_regions_;
+
+    size_type MakeViews(std::vector<index_box_type> const &boxes, char *buffer,
+                        std::vector<std::shared_ptr<ArrayBase>> *views) const;
+    void AddNeighbour(neighbour_s &&n);
 };
-MPIUpdater::MPIUpdater() : m_pimpl_(new pimpl_s) {
-    if (GLOBAL_COMM.size() <= 1) { return; }
-    SP_CALL(GLOBAL_COMM.topology(&m_pimpl_->mpi_topology_ndims, m_pimpl_->mpi_dims, m_pimpl_->mpi_periods,
-                                 m_pimpl_->mpi_coords));
-};
-MPIUpdater::~MPIUpdater() { TearDown(); };
+MPIUpdater::MPIUpdater() : m_pimpl_(new pimpl_s) {}
+MPIUpdater::~MPIUpdater() {
+    TearDown();
+    delete m_pimpl_;
+}
+std::shared_ptr<MPIUpdater> MPIUpdater::New() { return std::shared_ptr<MPIUpdater>(new MPIUpdater); }
 
-void MPIUpdater::SetDirection(int d) { m_pimpl_->m_direction_ = d; }
-int MPIUpdater::GetDirection() const { return m_pimpl_->m_direction_; }
 void MPIUpdater::SetPeriodic(bool tag) { m_pimpl_->m_is_perodic_ = tag; }
 bool MPIUpdater::IsPeriodic() const { return m_pimpl_->m_is_perodic_; }
 
@@ -50,7 +86,7 @@ void MPIUpdater::SetIndexBox(index_box_type const &idx_box) {
 index_box_type MPIUpdater::GetIndexBox() const { return m_pimpl_->m_index_box_; }
 
 void MPIUpdater::SetHaloWidth(index_tuple const &gw) {
-    for (int i = 0; i < m_pimpl_->ndims; ++i) {
+    for (int i = 0; i < 3; ++i) {
         if (std::get<1>(m_pimpl_->m_index_box_)[i] - std::get<0>(m_pimpl_->m_index_box_)[i] > 2 * gw[i]) {
             std::get<0>(m_pimpl_->m_halo_box_)[i] = std::get<0>(m_pimpl_->m_index_box_)[i] - gw[i];
             std::get<1>(m_pimpl_->m_halo_box_)[i] = std::get<1>(m_pimpl_->m_index_box_)[i] + gw[i];
@@ -60,108 +96,208 @@ void MPIUpdater::SetHaloWidth(index_tuple const &gw) {
 
 void MPIUpdater::SetHaloIndexBox(index_box_type const &b) { m_pimpl_->m_halo_box_ = b; }
 index_box_type MPIUpdater::GetHaloIndexBox() const { return m_pimpl_->m_halo_box_; }
+void MPIUpdater::SetTag(int tag) { m_pimpl_->tag = tag; }
+
+int MPIUpdater::AddVariable(std::type_info const &t_info) {
+    std::shared_ptr<ArrayBase> view = nullptr;
+    size_type ele_size = 0;
+    if (t_info == typeid(float)) {
+        view = detail::mpi_updater_view<float>();
+        ele_size = sizeof(float);
+    } else if (t_info == typeid(double)) {
+        view = detail::mpi_updater_view<double>();
+        ele_size = sizeof(double);
+    } else if (t_info == typeid(int)) {
+        view = detail::mpi_updater_view<int>();
+        ele_size = sizeof(int);
+    } else if (t_info == typeid(long)) {
+        view = detail::mpi_updater_view<long>();
+        ele_size = sizeof(long);
+    } else if (t_info == typeid(unsigned int)) {
+        view = detail::mpi_updater_view<unsigned int>();
+        ele_size = sizeof(unsigned int);
+    } else if (t_info == typeid(unsigned long)) {
+        view = detail::mpi_updater_view<unsigned long>();
+        ele_size = sizeof(unsigned long);
+    } else {
+        UNIMPLEMENTED;
+    }
+    if (isSetUp()) { TearDown(); }
+    m_pimpl_->m_variables_.emplace_back(view, ele_size);
+    return static_cast<int>(m_pimpl_->m_variables_.size() - 1);
+}
+int MPIUpdater::GetNumberOfVariables() const { return static_cast<int>(m_pimpl_->m_variables_.size()); }
+int MPIUpdater::GetNumberOfNeighbours() const { return static_cast<int>(m_pimpl_->m_neighbours_.size()); }
 
 bool MPIUpdater::isSetUp() const { return m_pimpl_->m_is_setup_; }
+bool MPIUpdater::isPending() const { return m_pimpl_->m_is_pending_; }
 
+size_type MPIUpdater::pimpl_s::MakeViews(std::vector<index_box_type> const &boxes, char *buffer,
+                                         std::vector<std::shared_ptr<ArrayBase>> *views) const {
+    size_type offset = 0;
+    for (auto const &b : boxes) {
+        for (auto const &v : m_variables_) {
+            if (views != nullptr) {
+                auto view = v.first->DuplicateArray();
+                view->reset(buffer + offset, &std::get<0>(b)[0], &std::get<1>(b)[0]);
+                views->push_back(view);
+            }
+            offset += (detail::box_volume(b) * v.second + detail::MPI_UPDATER_ALIGNMENT - 1) /
+                      detail::MPI_UPDATER_ALIGNMENT * detail::MPI_UPDATER_ALIGNMENT;
+        }
+    }
+    return offset;
+}
+void MPIUpdater::pimpl_s::AddNeighbour(neighbour_s &&n) {
+    n.send_size = MakeViews(n.send_boxes, nullptr, nullptr);
+    n.recv_size = MakeViews(n.recv_boxes, nullptr, nullptr);
+    n.send_buffer = spMakeShared<char>(nullptr, n.send_size);
+    n.recv_buffer = spMakeShared<char>(nullptr, n.recv_size);
+    MakeViews(n.send_boxes, n.send_buffer.get(), &n.send);
+    MakeViews(n.recv_boxes, n.recv_buffer.get(), &n.recv);
+    // in the region mode all messages are in the center direction, which then refers to the process itself
+    if (n.direction != detail::MPI_UPDATER_NUM_OF_DIRECTIONS / 2 || n.rank == m_rank_) {
+        m_neighbour_of_direction_[n.direction] = static_cast<int>(m_neighbours_.size());
+    }
+    m_neighbours_.push_back(std::move(n));
+}
+void MPIUpdater::AddSendRegion(int rank, index_box_type const &b) {
+    if (isSetUp()) { TearDown(); }
+    m_pimpl_->m_regions_[rank].first.push_back(b);
+}
+void MPIUpdater::AddRecvRegion(int rank, index_box_type const &b) {
+    if (isSetUp()) { TearDown(); }
+    m_pimpl_->m_regions_[rank].second.push_back(b);
+}
+
+/**
+ *  Along an axis, the neighbour at -1 receives the lower part of the box with the width of its upper halo, which is
+ *  the width of our upper halo, and sends the part of its box in our lower halo.
+ */
 void MPIUpdater::SetUp() {
     if (m_pimpl_->m_is_setup_) { return; }
-
     m_pimpl_->m_is_setup_ = true;
-    index_box_type send_box[2];
-    index_box_type recv_box[2];
-
-    for (auto &b : send_box) { b = m_pimpl_->m_index_box_; }
-    for (auto &b : recv_box) { b = m_pimpl_->m_index_box_; }
-
-    auto d = m_pimpl_->m_direction_;
-
-    for (int i = 0; i < d; ++i) {
-        std::get<0>(send_box[0])[i] = std::get<0>(m_pimpl_->m_halo_box_)[i];
-        std::get<1>(send_box[0])[i] = std::get<1>(m_pimpl_->m_halo_box_)[i];
-
-        std::get<0>(recv_box[0])[i] = std::get<0>(m_pimpl_->m_halo_box_)[i];
-        std::get<1>(recv_box[0])[i] = std::get<1>(m_pimpl_->m_halo_box_)[i];
-
-        std::get<0>(send_box[1])[i] = std::get<0>(m_pimpl_->m_halo_box_)[i];
-        std::get<1>(send_box[1])[i] = std::get<1>(m_pimpl_->m_halo_box_)[i];
-
-        std::get<0>(recv_box[1])[i] = std::get<0>(m_pimpl_->m_halo_box_)[i];
-        std::get<1>(recv_box[1])[i] = std::get<1>(m_pimpl_->m_halo_box_)[i];
+    m_pimpl_->m_rank_ = GLOBAL_COMM.rank();
+    m_pimpl_->m_neighbours_.clear();
+    for (auto &n : m_pimpl_->m_neighbour_of_direction_) { n = -1; }
+    if (!m_pimpl_->m_regions_.empty()) {
+        // one message per rank, in the center direction
+        for (auto const &item : m_pimpl_->m_regions_) {
+            pimpl_s::neighbour_s n;
+            n.rank = item.first;
+            n.direction = detail::MPI_UPDATER_NUM_OF_DIRECTIONS / 2;
+            n.send_boxes = item.second.first;
+            n.recv_boxes = item.second.second;
+            m_pimpl_->AddNeighbour(std::move(n));
+        }
+        Clear();
+        return;
     }
 
-    std::get<0>(send_box[0])[d] = std::get<0>(m_pimpl_->m_index_box_)[d];
-    std::get<1>(send_box[0])[d] = std::get<0>(m_pimpl_->m_index_box_)[d] * 2 - std::get<0>(m_pimpl_->m_halo_box_)[d];
-
-    std::get<0>(recv_box[0])[d] = std::get<0>(m_pimpl_->m_halo_box_)[d];
-    std::get<1>(recv_box[0])[d] = std::get<0>(m_pimpl_->m_index_box_)[d];
+    auto const &lo = std::get<0>(m_pimpl_->m_index_box_);
+    auto const &hi = std::get<1>(m_pimpl_->m_index_box_);
+    auto const &h_lo = std::get<0>(m_pimpl_->m_halo_box_);
+    auto const &h_hi = std::get<1>(m_pimpl_->m_halo_box_);
 
-    std::get<0>(send_box[1])[d] = std::get<1>(m_pimpl_->m_index_box_)[d] * 2 - std::get<1>(m_pimpl_->m_halo_box_)[d];
-    std::get<1>(send_box[1])[d] = std::get<1>(m_pimpl_->m_index_box_)[d];
-
-    std::get<0>(recv_box[1])[d] = std::get<1>(m_pimpl_->m_index_box_)[d];
-    std::get<1>(recv_box[1])[d] = std::get<1>(m_pimpl_->m_halo_box_)[d];
-
-    m_pimpl_->ele_type = value_type_info().hash_code();
-
-    for (int i = 0; i < 2; ++i) {
-        GetSendBuffer(i).reset(send_box[i]);
-        GetRecvBuffer(i).reset(recv_box[i]);
-        GetSendBuffer(i).Clear();
-        GetRecvBuffer(i).Clear();
-    }
-
-    m_pimpl_->m_rank_ = GLOBAL_COMM.rank();
-    GLOBAL_COMM.CartShift(m_pimpl_->m_direction_, 1, &m_pimpl_->left, &m_pimpl_->right);
+    int disp[3];
+    for (disp[0] = -1; disp[0] <= 1; ++disp[0])
+        for (disp[1] = -1; disp[1] <= 1; ++disp[1])
+            for (disp[2] = -1; disp[2] <= 1; ++disp[2]) {
+                if (disp[0] == 0 && disp[1] == 0 && disp[2] == 0) { continue; }
+                pimpl_s::neighbour_s n;
+                n.direction = detail::mpi_updater_direction(disp);
+                index_box_type send_box = m_pimpl_->m_index_box_;
+                index_box_type recv_box = m_pimpl_->m_index_box_;
+                bool empty = false;
+                for (int i = 0; i < 3; ++i) {
+                    if (disp[i] < 0) {
+                        std::get<0>(send_box)[i] = lo[i];
+                        std::get<1>(send_box)[i] = lo[i] + (h_hi[i] - hi[i]);
+                        std::get<0>(recv_box)[i] = h_lo[i];
+                        std::get<1>(recv_box)[i] = lo[i];
+                    } else if (disp[i] > 0) {
+                        std::get<0>(send_box)[i] = hi[i] - (lo[i] - h_lo[i]);
+                        std::get<1>(send_box)[i] = hi[i];
+                        std::get<0>(recv_box)[i] = hi[i];
+                        std::get<1>(recv_box)[i] = h_hi[i];
+                    }
+                    empty = empty || (disp[i] != 0 && (h_lo[i] >= lo[i] || h_hi[i] <= hi[i]));
+                }
+                if (empty) { continue; }
+                n.rank = GLOBAL_COMM.GetNeighbour(disp);
+                if (n.rank < 0 || (n.rank == m_pimpl_->m_rank_ && !m_pimpl_->m_is_perodic_)) { continue; }
+                n.send_boxes.push_back(send_box);
+                n.recv_boxes.push_back(recv_box);
+                m_pimpl_->AddNeighbour(std::move(n));
+            }
+    Clear();
 }
 void MPIUpdater::Clear() {
-    GetRecvBuffer(0).FillNaN();
-    GetRecvBuffer(1).FillNaN();
-    GetSendBuffer(0).FillNaN();
-    GetSendBuffer(1).FillNaN();
+    for (auto &n : m_pimpl_->m_neighbours_) {
+        for (auto &v : n.send) { v->FillNaN(); }
+        for (auto &v : n.recv) { v->FillNaN(); }
+    }
 }
 
-void MPIUpdater::TearDown() { m_pimpl_->m_is_setup_ = false; }
-
-void MPIUpdater::SetTag(int tag) { m_pimpl_->tag = tag; }
+void MPIUpdater::TearDown() {
+    if (m_pimpl_->m_is_pending_) { End(); }
+    m_pimpl_->m_neighbours_.clear();
+    m_pimpl_->m_is_setup_ = false;
+}
 
-void MPIUpdater::Push(ArrayBase const &a) {
-    GetSendBuffer(0).CopyIn(a);
-    GetSendBuffer(1).CopyIn(a);
+void MPIUpdater::Push(int v, ArrayBase const &a) {
+    auto num = m_pimpl_->m_variables_.size();
+    for (auto &n : m_pimpl_->m_neighbours_) {
+        for (size_type s = v; s < n.send.size(); s += num) { n.send[s]->CopyIn(a); }
+    }
 }
-void MPIUpdater::Pop(ArrayBase &a) const {
-    a.CopyIn(GetRecvBuffer(0));
-    a.CopyIn(GetRecvBuffer(1));
+void MPIUpdater::Pop(int v, ArrayBase &a) const {
+    auto num = m_pimpl_->m_variables_.size();
+    for (auto const &n : m_pimpl_->m_neighbours_) {
+        for (size_type s = v; s < n.recv.size(); s += num) { a.CopyIn(*n.recv[s]); }
+    }
 }
 
-void MPIUpdater::SendRecv() {
-    if (GLOBAL_COMM.size() > 1 && m_pimpl_->left != m_pimpl_->m_rank_ && m_pimpl_->right != m_pimpl_->m_rank_) {
-        GLOBAL_COMM.barrier();
-        GLOBAL_COMM.SendRecv(GetSendBuffer(0).pointer(), static_cast<int>(GetSendBuffer(0).size()),  //
-                             m_pimpl_->ele_type, m_pimpl_->left, m_pimpl_->tag,                      //
-                             GetRecvBuffer(1).pointer(), static_cast<int>(GetRecvBuffer(1).size()),  //
-                             m_pimpl_->ele_type, m_pimpl_->right, m_pimpl_->tag                      //
-                             );
-        GLOBAL_COMM.barrier();
-        GLOBAL_COMM.SendRecv(GetSendBuffer(1).pointer(), static_cast<int>(GetSendBuffer(1).size()),  //
-                             m_pimpl_->ele_type, m_pimpl_->right, m_pimpl_->tag,                     //
-                             GetRecvBuffer(0).pointer(), static_cast<int>(GetRecvBuffer(0).size()),  //
-                             m_pimpl_->ele_type, m_pimpl_->left, m_pimpl_->tag                       //
-                             );
-        GLOBAL_COMM.barrier();
-    } else  // if (IsPeriodic())
-    {
-        index_tuple shift = {0, 0, 0};
-        shift[m_pimpl_->m_direction_] = std::get<1>(m_pimpl_->m_index_box_)[m_pimpl_->m_direction_] -
-                                        std::get<0>(m_pimpl_->m_index_box_)[m_pimpl_->m_direction_];
-        auto s0 = GetSendBuffer(0).DuplicateArray();
-        s0->Shift(&shift[0]);
-        GetRecvBuffer(1).CopyIn(*s0);
-        shift[m_pimpl_->m_direction_] *= -1;
-        auto s1 = GetSendBuffer(1).DuplicateArray();
-        s1->Shift(&shift[0]);
-        GetRecvBuffer(0).CopyIn(*s1);
+/**
+ * the message to the neighbour in direction d is tagged d, it is received from the neighbour in the opposite
+ * direction. Messages to the process itself (periodic) are copied.
+ */
+void MPIUpdater::Begin() {
+    if (!m_pimpl_->m_is_setup_) { SetUp(); }
+    if (m_pimpl_->m_is_pending_) { End(); }
+    auto char_type = std::type_index(typeid(char)).hash_code();
+    int tag_base = m_pimpl_->tag * detail::MPI_UPDATER_NUM_OF_DIRECTIONS;
+    auto &requests = m_pimpl_->m_requests_;
+    for (auto &n : m_pimpl_->m_neighbours_) {
+        if (n.rank == m_pimpl_->m_rank_) { continue; }
+        int from = detail::MPI_UPDATER_NUM_OF_DIRECTIONS - 1 - n.direction;
+        requests.push_back(GLOBAL_COMM.IRecv(n.recv_buffer.get(), static_cast<int>(n.recv_size), char_type, n.rank,
+                                             tag_base + from));
+    }
+    for (auto &n : m_pimpl_->m_neighbours_) {
+        if (n.rank == m_pimpl_->m_rank_) { continue; }
+        requests.push_back(GLOBAL_COMM.ISend(n.send_buffer.get(), static_cast<int>(n.send_size), char_type, n.rank,
+                                             tag_base + n.direction));
+    }
+    for (auto &n : m_pimpl_->m_neighbours_) {
+        if (n.rank != m_pimpl_->m_rank_) { continue; }
+        int s = m_pimpl_->m_neighbour_of_direction_[detail::MPI_UPDATER_NUM_OF_DIRECTIONS - 1 - n.direction];
+        ASSERT(s >= 0 && m_pimpl_->m_neighbours_[s].send_size == n.recv_size);
+        std::memcpy(n.recv_buffer.get(), m_pimpl_->m_neighbours_[s].send_buffer.get(), n.recv_size);
     }
+    m_pimpl_->m_is_pending_ = true;
+}
+void MPIUpdater::End() {
+    if (!m_pimpl_->m_is_pending_) { return; }
+    auto &requests = m_pimpl_->m_requests_;
+    GLOBAL_COMM.WaitAll(static_cast<int>(requests.size()), requests.empty() ? nullptr : &requests[0]);
+    requests.clear();
+    m_pimpl_->m_is_pending_ = false;
+}
+void MPIUpdater::SendRecv() {
+    Begin();
+    End();
 }
 
 }  // namespace parallel {
-}  // namespace simpla {
\ No newline at end of file
+}  // namespace simpla {
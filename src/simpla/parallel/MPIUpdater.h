@@ -7,23 +7,31 @@
 
 #include <simpla/utilities/SPDefines.h>
 #include <memory>
+#include <typeinfo>
 #include "simpla/SIMPLA_config.h"
 #include "simpla/algebra/Array.h"
 
 namespace simpla {
 namespace parallel {
-
+/**
+ * @brief  halo exchange of a set of variables with the neighbour processes.
+ *
+ *  The halo of the index box is split into the 26 regions of faces, edges and corners, one for every neighbour in the
+ *  cartesian topology. All variables sent to a neighbour are packed into one message, the buffers are kept between
+ *  exchanges. Begin posts the receives and sends of all neighbours without waiting, End waits for them, so work which
+ *  does not touch the halo can be done in between. Variables must be added in the same order on every process, and
+ *  neighbours must agree on the shape of their common face (a tensor product decomposition).
+ *
+ *  usage:  AddVariable ... SetUp() ; { Push ... Begin() ... End() ; Pop ... }
+ */
 struct MPIUpdater {
    protected:
     MPIUpdater();
 
    public:
     virtual ~MPIUpdater();
-    template <typename V>
     static std::shared_ptr<MPIUpdater> New();
 
-    void SetDirection(int);
-    int GetDirection() const;
     void SetPeriodic(bool tag = true);
     bool IsPeriodic() const;
 
@@ -34,74 +42,40 @@ struct MPIUpdater {
     index_box_type GetHaloIndexBox() const;
     void SetTag(int tag);
 
+    /**
+     * exchange explicit regions instead of the halo of the index box: the part of the variables in b is sent to rank,
+     * and b is received from rank. The regions of a pair of processes are added in the same order on both sides, a
+     * region sent to the process itself is received by its own region of the same position. For a decomposition
+     * which is not a tensor product, e.g. patches along a space filling curve.
+     */
+    void AddSendRegion(int rank, index_box_type const &b);
+    void AddRecvRegion(int rank, index_box_type const &b);
+
+    /** @return id of the variable, one variable is one component of an attribute */
+    int AddVariable(std::type_info const &t_info);
+    int GetNumberOfVariables() const;
+    /** number of neighbours which messages are exchanged with, including the process itself if periodic */
+    int GetNumberOfNeighbours() const;
+
     virtual void SetUp();
     virtual void Clear();
     virtual void TearDown();
     bool isSetUp() const;
 
-    void Push(ArrayBase const &a);
-    void Pop(ArrayBase &a) const;
-    void SendRecv();
+    /** copy the part of a in the send regions to the buffers of variable v */
+    void Push(int v, ArrayBase const &a);
+    /** copy the received halo of variable v to a */
+    void Pop(int v, ArrayBase &a) const;
 
-   protected:
-    virtual std::type_info const &value_type_info() const = 0;
-    virtual ArrayBase &GetSendBuffer(int i) = 0;
-    virtual ArrayBase const &GetSendBuffer(int i) const = 0;
-    virtual ArrayBase &GetRecvBuffer(int i) = 0;
-    virtual ArrayBase const &GetRecvBuffer(int i) const = 0;
+    void Begin();
+    void End();
+    bool isPending() const;
+    void SendRecv();
 
    private:
     struct pimpl_s;
     pimpl_s *m_pimpl_;
 };
-template <typename V>
-struct MPIUpdaterT : public MPIUpdater {
-   protected:
-    MPIUpdaterT();
-
-   public:
-    ~MPIUpdaterT() override;
-    std::type_info const &value_type_info() const override { return typeid(V); };
-
-    static std::shared_ptr<MPIUpdaterT<V>> New();
-    void SetUp() override;
-    void TearDown() override;
-
-    ArrayBase &GetSendBuffer(int i) override { return send_buffer[i]; }
-    ArrayBase const &GetSendBuffer(int i) const override { return send_buffer[i]; }
-    ArrayBase &GetRecvBuffer(int i) override { return recv_buffer[i]; }
-    ArrayBase const &GetRecvBuffer(int i) const override { return recv_buffer[i]; }
-
-   private:
-    Array<V> send_buffer[2];
-    Array<V> recv_buffer[2];
-};
-
-template <typename V>
-std::shared_ptr<MPIUpdater> MPIUpdater::New() {
-    return MPIUpdaterT<V>::New();
-}
-
-template <typename V>
-MPIUpdaterT<V>::MPIUpdaterT() : MPIUpdater() {}
-template <typename V>
-MPIUpdaterT<V>::~MPIUpdaterT() {}
-template <typename V>
-std::shared_ptr<MPIUpdaterT<V>> MPIUpdaterT<V>::New() {
-    return std::shared_ptr<MPIUpdaterT<V>>(new MPIUpdaterT<V>);
-}
-template <typename V>
-void MPIUpdaterT<V>::SetUp() {
-    if (isSetUp()) { return; }
-    MPIUpdater::SetUp();
-}
-template <typename V>
-void MPIUpdaterT<V>::TearDown() {
-    for (auto &v : send_buffer) { v.free(); }
-    for (auto &v : recv_buffer) { v.free(); }
-    MPIUpdater::TearDown();
-}
-
 }  // namespace parallel
 }  // namespace simpla
 #endif  // SIMPLA_MPIUPDATER_H
@@ -9,85 +9,62 @@
 
 #include "simpla/SIMPLA_config.h"
 
-#include <atomic>
-#include <memory>
-#include <mutex>
-#include <thread>
-#include "type_traits.h"
-#include "MPIComm.h"
-#include "MPIUpdate.h"
+#include <iterator>
+#include <tuple>
+#include "DistributedCounter.h"
+#include "simpla/numeric/normal_distribution_icdf.h"
+#include "simpla/numeric/philox_engine.h"
 
-namespace simpla { namespace parallel
-{
+namespace simpla {
+namespace parallel {
 
-struct DistributedCounter
-{
-
-
-    std::atomic<size_t> m_start_, m_end_;
-
-public:
-
-    DistributedCounter() : m_start_(0), m_end_(0) {}
+/**
+ *  random numbers of items with a global index: number n of item i is a function of (seed, i, n) only (counter based
+ *  generator), so a sample does not depend on the number of threads or processes which create it.
+ */
+struct ParallelRandomGenerator {
+   public:
+    explicit ParallelRandomGenerator(size_t seed = 0) : m_seed_(seed) {}
 
-    ~RandomGenerator() {}
+    ~ParallelRandomGenerator() {}
 
-    DistributedCounter(DistributedCounter const &other) = delete;
+    ParallelRandomGenerator(ParallelRandomGenerator const &other) = delete;
 
     struct input_iterator;
 
+    /** collective, see DistributedCounter::reserve */
+    void reserve(size_t num) { m_counter_.reserve(num); }
+
     /**
-     *
-     *  @param pic      number of sample point
-     *  @param volume   volume of sample region
-     *  @param box      shape of spatial sample region (e.g. box(x_min,x_max))
-     *  @param args...  other of args for v_dist
+     * thread safe
+     *  @param num  number of items
+     *  @return     range of global indices of items
      */
-    template<typename TSeed>
-    std::tuple<input_iterator, input_iterator>
-    generator(size_t num) // thread safe
-    {
-        size_t end = (m_start_ += num);
-        size_t start = end - num;
-
-        return std::make_tuple(input_iterator(start), input_iterator(end));
-
-    };
-
-
-    void reserve(size_t num)
-    {
-        ASSERT(m_start_.load() == 0);
-
-        int offset = 0;
-        int total = 0;
-        std::tie(m_start_, std::ignore) =
-                parallel::sync_global_location(GLOBAL_COMM, static_cast<int>(num ));
-        m_start_ = offset;
-        m_end_ = offset + num;
+    std::tuple<input_iterator, input_iterator> generator(size_t num);
 
+    /** uniform number in (0,1) */
+    Real uniform(size_t index, int n) const {
+        return static_cast<Real>(philox_engine::uniform(m_seed_, index, static_cast<uint32_t>(n)));
+    }
+    /** standard normal number */
+    Real normal(size_t index, int n) const {
+        return static_cast<Real>(
+            normal_distribution_icdf::value(philox_engine::uniform(m_seed_, index, static_cast<uint32_t>(n))));
     }
 
+   private:
+    size_t m_seed_ = 0;
+    DistributedCounter m_counter_;
 };
 
-struct DistributedCounter::input_iterator : public std::iterator<std::input_iterator_tag, size_t>
-{
-private:
+struct ParallelRandomGenerator::input_iterator : public std::iterator<std::input_iterator_tag, size_t> {
+   private:
     size_t m_count_;
-public:
 
+   public:
+    explicit input_iterator(size_t start) : m_count_(start) {}
 
-    input_iterator(size_t start) : m_count_(0)
-    {
-        advance(start);
-    }
-
-
-    input_iterator(input_iterator const &other)
-            : m_count_(0)
-    {
-        advance(other.m_count_);
-    }
+    input_iterator(input_iterator const &other) : m_count_(other.m_count_) {}
 
     ~input_iterator() {}
 
@@ -95,8 +72,7 @@ public:
 
     value_type const *operator->() const { return &m_count_; }
 
-    input_iterator &operator++()
-    {
+    input_iterator &operator++() {
         ++m_count_;
         return *this;
     }
@@ -109,7 +85,13 @@ public:
 
     bool operator!=(input_iterator const &other) const { return (m_count_ != other.m_count_); }
 
+};  // struct input_iterator
 
-}; //struct input_iterator
-}}
-#endif //SIMPLA_PARALLELRANDOMGENERATOR_H
+inline std::tuple<ParallelRandomGenerator::input_iterator, ParallelRandomGenerator::input_iterator>
+ParallelRandomGenerator::generator(size_t num) {
+    size_t start = m_counter_.get(num);
+    return std::make_tuple(input_iterator(start), input_iterator(start + num));
+}
+}  // namespace parallel
+}  // namespace simpla
+#endif  // SIMPLA_PARALLELRANDOMGENERATOR_H
@@ -0,0 +1,82 @@
+//
+// Profiler report and Chrome trace gathered over the ranks.
+//
+#include "ProfileReport.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <vector>
+#include "MPIComm.h"
+#include "simpla/utilities/Log.h"
+#include "simpla/utilities/Profiler.h"
+
+namespace simpla {
+namespace parallel {
+std::ostream &ReportProfile(std::ostream &os) {
+    auto records = Profiler::Global().GetRecords();
+    // the union of the timers of the ranks
+    std::ostringstream names;
+    for (auto const &r : records) { names << r.path << std::endl; }
+    std::set<std::string> paths;
+    std::istringstream is(gather_string(names.str(), -1));
+    for (std::string line; std::getline(is, line);) {
+        // gather_string puts a space between the strings of the ranks
+        auto pos = line.find_first_not_of(' ');
+        if (pos != std::string::npos) { paths.insert(line.substr(pos)); }
+    }
+    auto num = paths.size();
+    std::vector<Real> count(num, 0), t_min(num, 0), t_max(num, 0), t_sum(num, 0);
+    size_type n = 0;
+    auto it = records.begin();
+    for (auto const &p : paths) {
+        while (it != records.end() && it->path < p) { ++it; }
+        if (it != records.end() && it->path == p) {
+            count[n] = static_cast<Real>(it->count);
+            t_min[n] = t_max[n] = t_sum[n] = it->total;
+        }
+        ++n;
+    }
+    auto m = static_cast<int>(num);
+    if (m > 0) {
+        GLOBAL_COMM.all_reduce_sum(&count[0], m);
+        GLOBAL_COMM.all_reduce_min(&t_min[0], m);
+        GLOBAL_COMM.all_reduce_max(&t_max[0], m);
+        GLOBAL_COMM.all_reduce_sum(&t_sum[0], m);
+    }
+    if (GLOBAL_COMM.rank() != 0) { return os; }
+    auto num_of_ranks = std::max(GLOBAL_COMM.size(), 1);
+    os << std::left << std::setw(60) << "timer (" + std::to_string(num_of_ranks) + " ranks)" << std::right
+       << std::setw(10) << "count" << std::setw(14) << "min [s]" << std::setw(14) << "mean [s]" << std::setw(14)
+       << "max [s]" << std::setw(10) << "max/mean" << std::endl;
+    n = 0;
+    for (auto const &p : paths) {
+        auto depth = std::count(p.begin(), p.end(), '/');
+        auto pos = p.rfind('/');
+        Real mean = t_sum[n] / num_of_ranks;
+        os << std::left << std::setw(60)
+           << (std::string(static_cast<size_t>(depth * 2), ' ') + (pos == std::string::npos ? p : p.substr(pos + 1)))
+           << std::right << std::setw(10) << static_cast<size_type>(count[n]) << std::setw(14) << t_min[n]
+           << std::setw(14) << mean << std::setw(14) << t_max[n] << std::setw(10)
+           << (mean > 0 ? t_max[n] / mean : 1.0) << std::endl;
+        ++n;
+    }
+    return os;
+}
+void WriteProfileTrace(std::string const &path) {
+    auto events = gather_string(Profiler::Global().GetTraceEvents(GLOBAL_COMM.rank()), 0);
+    if (GLOBAL_COMM.rank() != 0) { return; }
+    // drop the comma after the last event
+    auto pos = events.find_last_of(',');
+    if (pos != std::string::npos) { events.erase(pos, 1); }
+    std::ofstream os(path);
+    if (!os) {
+        WARNING << "Can not write profile trace to [" << path << "]" << std::endl;
+        return;
+    }
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl << events << "]}" << std::endl;
+}
+}  // namespace parallel
+}  // namespace simpla
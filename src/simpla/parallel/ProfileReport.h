@@ -0,0 +1,25 @@
+//
+// Profiler report and Chrome trace gathered over the ranks.
+//
+
+#ifndef SIMPLA_PROFILEREPORT_H
+#define SIMPLA_PROFILEREPORT_H
+
+#include <iosfwd>
+#include <string>
+
+namespace simpla {
+namespace parallel {
+/**
+ * Table of the timers of Profiler::Global() over the ranks: the calls summed, and min / mean / max of the total time
+ * of the ranks, a rank without a timer counts as zero. Written to os by rank 0. Collective.
+ */
+std::ostream &ReportProfile(std::ostream &os);
+/**
+ * Trace events of Profiler::Global() of all ranks as one Chrome trace file (chrome://tracing, Perfetto), the process
+ * id of an event is the rank. Written by rank 0. Collective.
+ */
+void WriteProfileTrace(std::string const &path);
+}  // namespace parallel
+}  // namespace simpla
+#endif  // SIMPLA_PROFILEREPORT_H
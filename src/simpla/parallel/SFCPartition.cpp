@@ -0,0 +1,65 @@
+//
+// Partition of weighted tiles along a Morton curve.
+//
+#include "SFCPartition.h"
+#include <algorithm>
+#include <numeric>
+namespace simpla {
+namespace parallel {
+static std::uint64_t spread_bits(std::uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffff;
+    v = (v | v << 16) & 0x1f0000ff0000ff;
+    v = (v | v << 8) & 0x100f00f00f00f00f;
+    v = (v | v << 4) & 0x10c30c30c30c30c3;
+    v = (v | v << 2) & 0x1249249249249249;
+    return v;
+}
+std::uint64_t MortonCode(index_type i, index_type j, index_type k) {
+    return spread_bits(static_cast<std::uint64_t>(i)) << 2 | spread_bits(static_cast<std::uint64_t>(j)) << 1 |
+           spread_bits(static_cast<std::uint64_t>(k));
+}
+
+std::vector<int> PartitionMorton(std::vector<index_box_type> const &tiles, std::vector<Real> const &costs,
+                                 int num_of_parts) {
+    auto num = tiles.size();
+    std::vector<int> res(num, 0);
+    if (num == 0 || num_of_parts <= 1) { return res; }
+    // position of a tile in the grid: rank of its lower corner among the lower corners of all tiles
+    std::vector<index_type> corners[3];
+    for (int n = 0; n < 3; ++n) {
+        for (auto const &b : tiles) { corners[n].push_back(std::get<0>(b)[n]); }
+        std::sort(corners[n].begin(), corners[n].end());
+        corners[n].erase(std::unique(corners[n].begin(), corners[n].end()), corners[n].end());
+    }
+    std::vector<std::pair<std::uint64_t, size_type>> order(num);
+    for (size_type s = 0; s < num; ++s) {
+        index_type idx[3];
+        for (int n = 0; n < 3; ++n) {
+            idx[n] = std::lower_bound(corners[n].begin(), corners[n].end(), std::get<0>(tiles[s])[n]) -
+                     corners[n].begin();
+        }
+        order[s] = std::make_pair(MortonCode(idx[0], idx[1], idx[2]), s);
+    }
+    std::sort(order.begin(), order.end());
+
+    Real total = std::accumulate(costs.begin(), costs.end(), Real(0));
+    if (total <= 0) { total = 1; }
+    // a tile goes to the part which contains the middle of its segment of the curve
+    Real prefix = 0;
+    for (auto const &item : order) {
+        auto c = std::max(costs[item.second], Real(0));
+        auto p = static_cast<int>((prefix + 0.5 * c) * num_of_parts / total);
+        res[item.second] = std::min(std::max(p, 0), num_of_parts - 1);
+        prefix += c;
+    }
+    return res;
+}
+Real PartitionImbalance(std::vector<int> const &parts, std::vector<Real> const &costs, int num_of_parts) {
+    std::vector<Real> sum(static_cast<size_type>(std::max(num_of_parts, 1)), 0);
+    for (size_type s = 0; s < parts.size(); ++s) { sum[parts[s]] += costs[s]; }
+    Real total = std::accumulate(sum.begin(), sum.end(), Real(0));
+    return total > 0 ? *std::max_element(sum.begin(), sum.end()) * sum.size() / total : 1;
+}
+}  // namespace parallel
+}  // namespace simpla
@@ -0,0 +1,32 @@
+//
+// Partition of weighted tiles along a Morton curve.
+//
+
+#ifndef SIMPLA_SFCPARTITION_H
+#define SIMPLA_SFCPARTITION_H
+
+#include <cstdint>
+#include <vector>
+#include "simpla/SIMPLA_config.h"
+#include "simpla/algebra/nTuple.h"
+#include "simpla/utilities/SPDefines.h"
+
+namespace simpla {
+namespace parallel {
+/** interleave the bits of the three indices (21 bits each), z is the fastest */
+std::uint64_t MortonCode(index_type i, index_type j, index_type k);
+/**
+ * @brief  partition of weighted tiles along a Morton curve.
+ *
+ *  Tiles are ordered by the Morton code of the position of their lower corner in the tile grid, and the curve is cut
+ *  into num_of_parts pieces of nearly equal cost, so that a part is a compact set of tiles. Every process computes the
+ *  same partition from the same costs.
+ * @return part of every tile
+ */
+std::vector<int> PartitionMorton(std::vector<index_box_type> const &tiles, std::vector<Real> const &costs,
+                                 int num_of_parts);
+/** max / mean of the costs of the parts, 1 is balanced */
+Real PartitionImbalance(std::vector<int> const &parts, std::vector<Real> const &costs, int num_of_parts);
+}  // namespace parallel
+}  // namespace simpla
+#endif  // SIMPLA_SFCPARTITION_H
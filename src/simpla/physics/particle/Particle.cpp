@@ -14,42 +14,57 @@ class ParticleEngineBase;
 struct ParticlePool : public data::DataEntity {};
 
 struct ParticleBase::pimpl_s {
-    static constexpr int MAX_NUMBER_OF_PARTICLE_ATTRIBUTES = 10;
-    engine::DomainBase const* m_domain_;
+    engine::DomainBase const* m_domain_ = nullptr;
     size_type m_num_pic_ = 100;
-    size_type m_max_size_ = 0;
     int m_num_of_attr_ = 3;
     std::shared_ptr<ParticleData> m_data_block_ = nullptr;
-    id_type* m_tag_;
-    Real* m_data_[MAX_NUMBER_OF_PARTICLE_ATTRIBUTES];
 };
 
-ParticleBase::ParticleBase() : m_pimpl_(new pimpl_s) { Initialize(); }
-
-ParticleBase::~ParticleBase() {
-    Finalize();
-    delete m_pimpl_;
-}
-
-void ParticleBase::DoInitialize() {
+ParticleBase::ParticleBase() : m_pimpl_(new pimpl_s) {}
+ParticleBase::~ParticleBase() { delete m_pimpl_; }
+void ParticleBase::Initialize(engine::DomainBase const* grp) {
     m_pimpl_ = new pimpl_s;
-    int dof = db()->GetValue<int>("DOF", 6);
-    SetDOF(1, &dof);
+    m_pimpl_->m_domain_ = grp;
+    m_pimpl_->m_num_of_attr_ = GetProperty<int>("DOF", 6);
+}
+std::shared_ptr<engine::Attribute> ParticleBase::Copy() const {
+    auto res = std::shared_ptr<ParticleBase>(new ParticleBase);
+    *res->m_pimpl_ = *m_pimpl_;
+    res->m_pimpl_->m_data_block_ = nullptr;
+    ReRegister(res);
+    return res;
 }
-void ParticleBase::DoFinalize() {
-    delete m_pimpl_;
-    m_pimpl_ = nullptr;
+std::shared_ptr<engine::Attribute> ParticleBase::CreateNew() const {
+    return std::shared_ptr<ParticleBase>(new ParticleBase);
 }
+bool ParticleBase::isNull() const { return m_pimpl_->m_data_block_ == nullptr; }
+
 std::shared_ptr<simpla::data::DataEntry> ParticleBase::Serialize() const { return base_type::Serialize(); }
-void ParticleBase::Deserialize(std::shared_ptr<data::DataEntry> const& cfg) { base_type::Deserialize(cfg); }
+void ParticleBase::Deserialize(std::shared_ptr<const data::DataEntry> const& cfg) { base_type::Deserialize(cfg); }
 void ParticleBase::Push(std::shared_ptr<data::DataEntry> const& dblk) {
-    SetUp();
-    //    base_type::Push(dblk);
-    Update();
+    auto& blk = m_pimpl_->m_data_block_;
+    blk = dblk == nullptr ? nullptr : std::dynamic_pointer_cast<ParticleData>(dblk->GetEntity());
+    if (blk == nullptr) { blk = ParticleData::New(GetNumberOfAttributes(), GetNumberOfPIC()); }
+    // the block of the patch may have changed, e.g. by regridding, then the particles are re-binned by the next Sort
+    auto const* domain = m_pimpl_->m_domain_;
+    if (domain != nullptr && domain->GetMeshBlock() != nullptr) {
+        auto box = domain->GetMeshBlock()->GetIndexBox();
+        auto const& old_box = blk->GetIndexBox();
+        bool changed = false;
+        for (int n = 0; n < 3; ++n) {
+            changed = changed || std::get<0>(old_box)[n] != std::get<0>(box)[n] ||
+                      std::get<1>(old_box)[n] != std::get<1>(box)[n];
+        }
+        if (changed) { blk->SetIndexBox(box); }
+    }
 }
-std::shared_ptr<data::DataEntry> ParticleBase::Pop() const {
-    //    auto res = engine::Attribute::Pop();
-    return nullptr;
+std::shared_ptr<data::DataEntry> ParticleBase::Pop() {
+    auto res = m_pimpl_->m_data_block_ == nullptr ? nullptr : data::DataEntry::New(m_pimpl_->m_data_block_);
+    m_pimpl_->m_data_block_ = nullptr;
+    return res;
+}
+void ParticleBase::Clear() {
+    if (m_pimpl_->m_data_block_ != nullptr) { m_pimpl_->m_data_block_->RemoveBucket(NULL_ID); }
 }
 void ParticleBase::SetNumberOfAttributes(int n) { m_pimpl_->m_num_of_attr_ = n; }
 int ParticleBase::GetNumberOfAttributes() const { return m_pimpl_->m_num_of_attr_; }
@@ -57,48 +72,47 @@ int ParticleBase::GetNumberOfAttributes() const { return m_pimpl_->m_num_of_attr
 void ParticleBase::SetNumberOfPIC(size_type n) { m_pimpl_->m_num_pic_ = n; }
 size_type ParticleBase::GetNumberOfPIC() { return m_pimpl_->m_num_pic_; }
 
-size_type ParticleBase::GetMaxSize() const { return m_pimpl_->m_max_size_; }
-std::shared_ptr<ParticleBase::Bucket> ParticleBase::GetBucket(id_type s) { return nullptr; }
-std::shared_ptr<ParticleBase::Bucket> ParticleBase::GetBucket(id_type s) const { return nullptr; }
-std::shared_ptr<ParticleBase::Bucket> ParticleBase::AddBucket(id_type s, size_type num) { return nullptr; }
-void ParticleBase::RemoveBucket(id_type s) {}
+size_type ParticleBase::GetMaxSize() const {
+    return m_pimpl_->m_data_block_ == nullptr ? 0 : m_pimpl_->m_data_block_->GetCapacity();
+}
+std::shared_ptr<ParticleData> ParticleBase::GetDataBlock() const { return m_pimpl_->m_data_block_; }
+std::shared_ptr<ParticleBase::Bucket> ParticleBase::GetBucket(id_type s) {
+    return m_pimpl_->m_data_block_ == nullptr ? nullptr : m_pimpl_->m_data_block_->GetBucket(s);
+}
+std::shared_ptr<ParticleBase::Bucket> ParticleBase::GetBucket(id_type s) const {
+    return m_pimpl_->m_data_block_ == nullptr ? nullptr : m_pimpl_->m_data_block_->GetBucket(s);
+}
+std::shared_ptr<ParticleBase::Bucket> ParticleBase::AddBucket(id_type s, size_type num) {
+    return m_pimpl_->m_data_block_ == nullptr ? nullptr : m_pimpl_->m_data_block_->AddBucket(s, num);
+}
+void ParticleBase::RemoveBucket(id_type s) {
+    if (m_pimpl_->m_data_block_ != nullptr) { m_pimpl_->m_data_block_->RemoveBucket(s); }
+}
 size_type ParticleBase::Count(id_type s) const {
-    size_type res = 0;
-    if (s == NULL_ID) {
-    } else {
-        for (auto bucket = GetBucket(s); bucket != nullptr; bucket = bucket->next) { res += bucket->count; }
-    }
-    return res;
+    return m_pimpl_->m_data_block_ == nullptr ? 0 : m_pimpl_->m_data_block_->Count(s);
 }
-//*********************************************************************************************************************
-enum { SP_RAND_UNIFORM = 0x1, SP_RAND_NORMAL = 0x10 };
-
-int ParticleInitialLoad(Real**, size_type num, int n_dof, int const* dist_types, size_type random_seed_offset);
-void ParticleUpdateTag(size_type num, id_type* tag, Real** r);
-void ParticleSort(size_type num, int num_of_attr, id_type const* tag_in, id_type* tag_out, Real** in, Real** out);
-//*********************************************************************************************************************
-
 void ParticleBase::Sort() {
-    ParticleUpdateTag(GetMaxSize(), m_pimpl_->m_tag_, m_pimpl_->m_data_);
-
-    ParticleSort(GetMaxSize(), GetNumberOfAttributes(), m_pimpl_->m_tag_, m_pimpl_->m_tag_, m_pimpl_->m_data_,
-                 m_pimpl_->m_data_);
+    if (m_pimpl_->m_data_block_ != nullptr) { m_pimpl_->m_data_block_->Sort(); }
 }
-void ParticleBase::DeepSort() {}
+//! counting sort always re-bins all particles
+void ParticleBase::DeepSort() { Sort(); }
 
 void ParticleBase::InitialLoad(int const* rnd_dist_type, size_type rnd_offset) {
     int dist_type[GetNumberOfAttributes()];
-    int ndims = m_pimpl_->m_domain_->GetNDIMS();
+    int ndims = m_pimpl_->m_domain_->GetChart()->GetNDIMS();
     ASSERT(GetNumberOfAttributes() >= 2 * ndims);
 
     if (rnd_dist_type == nullptr) {
-        for (int i = 0; i < m_pimpl_->m_domain_->GetNDIMS(); ++i) { dist_type[i] = SP_RAND_UNIFORM; }
+        for (int i = 0; i < ndims; ++i) { dist_type[i] = SP_RAND_UNIFORM; }
         for (int i = ndims; i < 2 * ndims; ++i) { dist_type[i] = SP_RAND_NORMAL; }
 
     } else {
         for (int i = 0; i < 2 * ndims; ++i) { dist_type[i] = rnd_dist_type[i]; }
     }
-    ParticleInitialLoad(m_pimpl_->m_data_, m_pimpl_->m_max_size_, 2 * ndims, dist_type, rnd_offset);
+    auto blk = m_pimpl_->m_data_block_;
+    if (blk == nullptr) { return; }
+    ParticleInitialLoad(blk->GetData(), blk->size(), 2 * ndims, dist_type, rnd_offset,
+                        static_cast<size_type>(GetProperty<int>("RandomSeed", 0)));
 }
 
 }  // namespace simpla {
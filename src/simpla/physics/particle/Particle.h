@@ -11,29 +11,47 @@
 #include "simpla/engine/Attribute.h"
 #include "simpla/engine/Domain.h"
 
+#include "ParticleData.h"
+
 namespace simpla {
 
 class ParticleBase : public engine::Attribute {
-    SP_OBJECT_HEAD(ParticleBase, engine::Attribute);
+    SP_SERIALIZABLE_HEAD(engine::Attribute, ParticleBase);
 
    protected:
+    ParticleBase();
+    /**
+     * the particles of a patch are sorted by the cells of the mesh block of the host domain, which DomainBase sets
+     * from the patch before the attributes are pushed, see Push
+     */
     template <typename... Args>
-    explicit ParticleBase(engine::DomainBase* grp, Args&&... args) : engine::Attribute(std::forward<Args>(args)...) {
-        Register(dynamic_cast<engine::AttributeGroup*>(grp));
-        Initialize();
+    explicit ParticleBase(engine::DomainBase* grp, Args&&... args)
+        : engine::Attribute(static_cast<engine::AttributeGroup*>(grp), std::forward<Args>(args)...) {
+        Initialize(grp);
     };
 
    public:
+    ~ParticleBase() override;
+
+    std::shared_ptr<engine::Attribute> Copy() const override;
+    std::shared_ptr<engine::Attribute> CreateNew() const override;
+    void Update() override {}
+    bool CheckType(engine::Attribute const& other) const override {
+        return dynamic_cast<ParticleBase const*>(&other) != nullptr;
+    }
+    bool isNull() const override;
     std::type_info const& value_type_info() const override { return typeid(Real); };
     int GetIFORM() const override { return FIBER; };
     int GetDOF() const override { return 1; };
     int GetRank() const override { return 1; };
 
-    void DoInitialize() override;
-    void DoFinalize() override;
+    std::shared_ptr<simpla::data::DataEntry> Serialize() const override;
+    void Deserialize(std::shared_ptr<const data::DataEntry> const& cfg) override;
 
+    /** take the particles of the patch, the index box follows the mesh block of the host domain */
     void Push(std::shared_ptr<data::DataEntry> const& blk) override;
-    std::shared_ptr<data::DataEntry> Pop() const override;
+    std::shared_ptr<data::DataEntry> Pop() override;
+    void Clear() override;
 
     void SetNumberOfAttributes(int n);
     int GetNumberOfAttributes() const;
@@ -43,22 +61,25 @@ class ParticleBase : public engine::Attribute {
 
     size_type GetMaxSize() const;
 
-    struct Bucket {
-        std::shared_ptr<Bucket> next = nullptr;
-        size_type count = 0;
-        int* tag = nullptr;
-        Real** data = nullptr;
-    };
+    typedef ParticleData::Bucket Bucket;
 
+    std::shared_ptr<ParticleData> GetDataBlock() const;
     std::shared_ptr<Bucket> GetBucket(id_type s = NULL_ID);
     std::shared_ptr<Bucket> AddBucket(id_type s, size_type num);
     void RemoveBucket(id_type s);
     std::shared_ptr<Bucket> GetBucket(id_type s = NULL_ID) const;
 
+    /** rnd_offset is the global index of the first particle of this patch, see parallel::DistributedCounter */
     void InitialLoad(int const* rnd_type = nullptr, size_type rnd_offset = 0);
     size_type Count(id_type s = NULL_ID) const;
     void Sort();
     void DeepSort();
+
+   private:
+    void Initialize(engine::DomainBase const* grp);
+
+    struct pimpl_s;
+    pimpl_s* m_pimpl_ = nullptr;
 };
 
 /** @ingroup physical_object
@@ -116,7 +137,7 @@ class ParticleBase : public engine::Attribute {
 
 template <typename TM>
 class Particle : public ParticleBase {
-    SP_OBJECT_HEAD(Particle, ParticleBase);
+    SP_SERIALIZABLE_HEAD(ParticleBase, Particle);
 
    public:
     typedef TM mesh_type;
@@ -128,23 +149,17 @@ class Particle : public ParticleBase {
 
    public:
     template <typename... Args>
-    Particle(mesh_type* grp, Args&&... args)
-        : ParticleBase(grp->GetMesh(), std::forward<Args>(args)...), m_host_(grp) {}
+    explicit Particle(mesh_type* grp, Args&&... args)
+        : ParticleBase(grp, std::forward<Args>(args)...), m_host_(grp) {}
+    ~Particle() override = default;
+
+    template <typename... Args>
+    static std::shared_ptr<this_type> New(Args&&... args) {
+        return std::shared_ptr<this_type>(new this_type(std::forward<Args>(args)...));
+    }
 
 };  // class Particle
-template <typename TM>
-Particle<TM>::Particle(){};
-template <typename TM>
-Particle<TM>::~Particle(){};
 
-template <typename TM>
-std::shared_ptr<simpla::data::DataEntry> Particle<TM>::Serialize() const {
-    return base_type::Serialize();
-}
-template <typename TM>
-void Particle<TM>::Deserialize(std::shared_ptr<data::DataEntry> const& cfg) {
-    base_type::Deserialize(cfg);
-}
 }  // namespace simpla{
 
 #endif  // SIMPLA_PARTICLE_H
@@ -0,0 +1,148 @@
+//
+// Boris push of the particles of a block, fields gathered per cell.
+//
+#include "simpla/SIMPLA_config.h"
+
+#include <algorithm>
+#include <cmath>
+#include "ParticleData.h"
+#include "simpla/utilities/Log.h"
+
+namespace simpla {
+namespace detail {
+/**
+ * staggering of the Yee components, bit n is set if the component lies between the points of axis n:
+ * E_x at (i+1/2,j,k) ... B_x at (i,j+1/2,k+1/2) ...
+ */
+static constexpr int BORIS_STAGGER[6] = {0b001, 0b010, 0b100, 0b110, 0b101, 0b011};
+static constexpr int BORIS_STENCIL_SIZE = 27;
+
+/** points (i+a-1, j+b-1, k+c-1) of component n around cell (i,j,k), zero outside the array */
+static void boris_load_cell(Array<Real> const* const* f, index_type i, index_type j, index_type k, Real* cache) {
+    for (int n = 0; n < 6; ++n) {
+        auto const& a = *f[n];
+        auto const* d = a.get();
+        auto const& sfc = a.GetSpaceFillingCurve();
+        Real* c = cache + n * BORIS_STENCIL_SIZE;
+        if (d != nullptr && sfc.in_box(i - 1, j - 1, k - 1) && sfc.in_box(i + 1, j + 1, k + 1)) {
+            index_type s0 = sfc.hash(i - 1, j - 1, k - 1);
+            index_type sx = sfc.hash(i, j - 1, k - 1) - s0;
+            index_type sy = sfc.hash(i - 1, j, k - 1) - s0;
+            index_type sz = sfc.hash(i - 1, j - 1, k) - s0;
+            for (index_type di = 0; di < 3; ++di)
+                for (index_type dj = 0; dj < 3; ++dj)
+                    for (index_type dk = 0; dk < 3; ++dk) {
+                        c[(di * 3 + dj) * 3 + dk] = d[s0 + di * sx + dj * sy + dk * sz];
+                    }
+            continue;
+        }
+        for (index_type di = 0; di < 3; ++di)
+            for (index_type dj = 0; dj < 3; ++dj)
+                for (index_type dk = 0; dk < 3; ++dk) {
+                    index_type x = i + di - 1, y = j + dj - 1, z = k + dk - 1;
+                    c[(di * 3 + dj) * 3 + dk] = (d != nullptr && sfc.in_box(x, y, z)) ? d[sfc.hash(x, y, z)] : 0;
+                }
+    }
+}
+
+/**
+ * push particles [s0,s1) of one cell. Weights of the points i-1,i,i+1 are {0,1-r,r} for an unstaggered axis and
+ * {max(1/2-r,0),1-|r-1/2|,max(r-1/2,0)} for a staggered one, so all lanes take the same path.
+ */
+template <int W>
+static void boris_push_cell(size_type s0, size_type s1, Real** data, Real const* cache, Real const* inv_dx, Real cmr,
+                            Real dt) {
+    Real* rx = data[0];
+    Real* ry = data[1];
+    Real* rz = data[2];
+    Real* vx = data[3];
+    Real* vy = data[4];
+    Real* vz = data[5];
+    Real h = 0.5 * cmr * dt;
+    Real sx = dt * inv_dx[0], sy = dt * inv_dx[1], sz = dt * inv_dx[2];
+
+    for (size_type b = s0; b < s1; b += W) {
+        int n = static_cast<int>(std::min(static_cast<size_type>(W), s1 - b));
+        Real F[6][W];
+#pragma omp simd
+        for (int l = 0; l < n; ++l) {
+            Real r[3] = {rx[b + l], ry[b + l], rz[b + l]};
+            Real w[2][3][3];
+            for (int d = 0; d < 3; ++d) {
+                w[0][d][0] = 0;
+                w[0][d][1] = 1 - r[d];
+                w[0][d][2] = r[d];
+                w[1][d][0] = std::max(0.5 - r[d], 0.0);
+                w[1][d][1] = 1 - std::abs(r[d] - 0.5);
+                w[1][d][2] = std::max(r[d] - 0.5, 0.0);
+            }
+            for (int m = 0; m < 6; ++m) {
+                Real const* wx = w[(BORIS_STAGGER[m] >> 0) & 1][0];
+                Real const* wy = w[(BORIS_STAGGER[m] >> 1) & 1][1];
+                Real const* wz = w[(BORIS_STAGGER[m] >> 2) & 1][2];
+                Real const* c = cache + m * BORIS_STENCIL_SIZE;
+                Real res = 0;
+                for (int p = 0; p < 3; ++p) {
+                    Real t = 0;
+                    for (int q = 0; q < 3; ++q) {
+                        t += wy[q] * (wz[0] * c[(p * 3 + q) * 3] + wz[1] * c[(p * 3 + q) * 3 + 1] +
+                                      wz[2] * c[(p * 3 + q) * 3 + 2]);
+                    }
+                    res += wx[p] * t;
+                }
+                F[m][l] = res;
+            }
+        }
+#pragma omp simd
+        for (int l = 0; l < n; ++l) {
+            size_type s = b + l;
+            Real ux = vx[s] + h * F[0][l];
+            Real uy = vy[s] + h * F[1][l];
+            Real uz = vz[s] + h * F[2][l];
+            Real tx = h * F[3][l], ty = h * F[4][l], tz = h * F[5][l];
+            Real f = 2.0 / (1.0 + tx * tx + ty * ty + tz * tz);
+            Real px = ux + (uy * tz - uz * ty);
+            Real py = uy + (uz * tx - ux * tz);
+            Real pz = uz + (ux * ty - uy * tx);
+            ux += f * (py * tz - pz * ty);
+            uy += f * (pz * tx - px * tz);
+            uz += f * (px * ty - py * tx);
+            vx[s] = ux + h * F[0][l];
+            vy[s] = uy + h * F[1][l];
+            vz[s] = uz + h * F[2][l];
+            rx[s] += vx[s] * sx;
+            ry[s] += vy[s] * sy;
+            rz[s] += vz[s] * sz;
+        }
+    }
+}
+}  // namespace detail
+
+void ParticleBorisPush(ParticleData& p, Array<Real> const* E, Array<Real> const* B, Real const* inv_dx, Real cmr,
+                       Real dt) {
+    if (p.GetDOF() < 6) {
+        RUNTIME_ERROR << "Boris push needs coordinates and velocity, DOF = " << p.GetDOF() << std::endl;
+    }
+    if (!p.isSorted()) { p.Sort(); }
+    Array<Real> const* f[6] = {&E[0], &E[1], &E[2], &B[0], &B[1], &B[2]};
+    Real** data = p.GetData();
+    auto const& box = p.GetIndexBox();
+    index_type lo[3], dims[3];
+    for (int n = 0; n < 3; ++n) {
+        lo[n] = std::get<0>(box)[n];
+        dims[n] = std::get<1>(box)[n] - std::get<0>(box)[n];
+    }
+    auto num_of_cell = static_cast<index_type>(p.GetNumberOfCells());
+
+#pragma omp parallel for schedule(dynamic, 64)
+    for (index_type c = 0; c < num_of_cell; ++c) {
+        size_type count = p.GetBucketCount(static_cast<size_type>(c));
+        if (count == 0) { continue; }
+        size_type start = p.GetBucketStart(static_cast<size_type>(c));
+        Real cache[6 * detail::BORIS_STENCIL_SIZE];
+        detail::boris_load_cell(f, lo[0] + c / (dims[1] * dims[2]), lo[1] + (c / dims[2]) % dims[1],
+                                lo[2] + c % dims[2], cache);
+        detail::boris_push_cell<SP_PARTICLE_SIMD_WIDTH>(start, start + count, data, cache, inv_dx, cmr, dt);
+    }
+}
+}  // namespace simpla
@@ -3,3 +3,217 @@
 //
 
 #include "ParticleData.h"
+#include <algorithm>
+#include <cstring>
+#include "simpla/utilities/Factory.h"
+#include "simpla/utilities/Log.h"
+#include "simpla/utilities/memory.h"
+
+namespace simpla {
+constexpr int ParticleData::MAX_NUMBER_OF_ATTRIBUTES;
+//! created by Atlas when a patch is migrated, see DataEntity::Pack
+bool ParticleData::_is_registered = Factory<data::DataEntity>::RegisterCreator(
+    traits::type_name<ParticleData>::value(), []() { return std::dynamic_pointer_cast<data::DataEntity>(New()); });
+
+ParticleData::ParticleData(int DOF, size_type NumberOfPIC) : m_dof_(DOF), m_number_of_pic_(NumberOfPIC) {
+    ASSERT(DOF <= MAX_NUMBER_OF_ATTRIBUTES);
+    for (auto& p : m_data_) { p = nullptr; }
+    SetIndexBox(m_box_);
+}
+
+void ParticleData::SetIndexBox(index_box_type const& b) {
+    m_box_ = b;
+    size_type num_of_cell = 1;
+    for (int n = 0; n < 3; ++n) {
+        num_of_cell *= static_cast<size_type>(std::max(std::get<1>(m_box_)[n] - std::get<0>(m_box_)[n], 0L));
+    }
+    // particles are found by cell only after the next Sort
+    m_bucket_start_.assign(num_of_cell + 3, 0);
+    m_bucket_count_.assign(num_of_cell + 2, 0);
+    m_num_of_sorted_ = 0;
+    m_pages_.clear();
+}
+
+void ParticleData::Reserve(size_type n) {
+    if (n <= m_capacity_) { return; }
+    auto tag = spMakeShared<id_type>(nullptr, n);
+    if (m_size_ > 0) { spMemoryCopy(tag.get(), m_tag_.get(), m_size_); }
+    m_tag_ = tag;
+    m_tag_buffer_.reset();
+    for (int i = 0; i < m_dof_; ++i) {
+        auto d = spMakeShared<Real>(nullptr, n);
+        if (m_size_ > 0) { spMemoryCopy(d.get(), m_holder_[i].get(), m_size_); }
+        m_holder_[i] = d;
+        m_data_[i] = d.get();
+        m_buffer_[i].reset();
+    }
+    m_capacity_ = n;
+}
+
+size_type ParticleData::GetNumberOfOutOfBox() const {
+    auto num_of_cell = m_bucket_count_.size() - 2;
+    return m_num_of_sorted_ > 0 ? m_bucket_count_[num_of_cell] : 0;
+}
+
+size_type ParticleData::GetCellIndex(id_type s) const {
+    auto num_of_cell = m_bucket_count_.size() - 2;
+    if (s == NULL_ID) { return num_of_cell + 1; }
+    EntityId id;
+    id.v = static_cast<int64_t>(s);
+    index_type idx[3] = {id.x, id.y, id.z};
+    size_type res = 0;
+    for (int n = 0; n < 3; ++n) {
+        if (idx[n] < std::get<0>(m_box_)[n] || idx[n] >= std::get<1>(m_box_)[n]) { return num_of_cell; }
+        res = res * (std::get<1>(m_box_)[n] - std::get<0>(m_box_)[n]) + (idx[n] - std::get<0>(m_box_)[n]);
+    }
+    return res;
+}
+
+std::shared_ptr<ParticleData::Bucket> ParticleData::MakeBucket(size_type start, size_type count) const {
+    auto res = std::make_shared<Bucket>();
+    res->count = count;
+    res->tag = m_tag_.get() + start;
+    for (int i = 0; i < MAX_NUMBER_OF_ATTRIBUTES; ++i) { res->data[i] = i < m_dof_ ? m_data_[i] + start : nullptr; }
+    return res;
+}
+
+std::shared_ptr<ParticleData::Bucket> ParticleData::GetBucket(id_type s) const {
+    if (s == NULL_ID) { return m_size_ > 0 ? MakeBucket(0, m_size_) : nullptr; }
+    std::shared_ptr<Bucket> res = nullptr;
+    std::shared_ptr<Bucket>* tail = &res;
+    auto c = GetCellIndex(s);
+    if (m_num_of_sorted_ > 0 && c < m_bucket_count_.size() - 2 && m_bucket_count_[c] > 0) {
+        *tail = MakeBucket(m_bucket_start_[c], m_bucket_count_[c]);
+        tail = &(*tail)->next;
+    }
+    for (auto const& page : m_pages_) {
+        if (std::get<0>(page) == s && std::get<2>(page) > 0) {
+            *tail = MakeBucket(std::get<1>(page), std::get<2>(page));
+            tail = &(*tail)->next;
+        }
+    }
+    return res;
+}
+
+std::shared_ptr<ParticleData::Bucket> ParticleData::AddBucket(id_type s, size_type num) {
+    if (m_size_ + num > m_capacity_) { Reserve(std::max(m_size_ + num, 2 * m_capacity_)); }
+    auto start = m_size_;
+    auto* tag = m_tag_.get();
+#pragma omp parallel for
+    for (size_type i = start; i < start + num; ++i) { tag[i] = s; }
+    m_size_ += num;
+    m_pages_.emplace_back(s, start, num);
+    return MakeBucket(start, num);
+}
+
+void ParticleData::RemoveBucket(id_type s) {
+    if (s == NULL_ID) {
+        m_size_ = 0;
+        m_num_of_sorted_ = 0;
+        m_num_of_removed_ = 0;
+        std::fill(m_bucket_start_.begin(), m_bucket_start_.end(), 0);
+        std::fill(m_bucket_count_.begin(), m_bucket_count_.end(), 0);
+        m_pages_.clear();
+        return;
+    }
+    for (auto bucket = GetBucket(s); bucket != nullptr; bucket = bucket->next) {
+        for (size_type i = 0; i < bucket->count; ++i) { bucket->tag[i] = NULL_ID; }
+        m_num_of_removed_ += bucket->count;
+    }
+    auto c = GetCellIndex(s);
+    if (c < m_bucket_count_.size() - 2) { m_bucket_count_[c] = 0; }
+    m_pages_.erase(std::remove_if(m_pages_.begin(), m_pages_.end(),
+                                  [&](std::tuple<id_type, size_type, size_type> const& page) {
+                                      return std::get<0>(page) == s;
+                                  }),
+                   m_pages_.end());
+}
+
+size_type ParticleData::Count(id_type s) const {
+    size_type res = 0;
+    if (s == NULL_ID) {
+        res = m_size_ - m_num_of_removed_;
+    } else {
+        for (auto bucket = GetBucket(s); bucket != nullptr; bucket = bucket->next) { res += bucket->count; }
+    }
+    return res;
+}
+
+void ParticleData::Sort() {
+    if (m_dof_ >= 3) { ParticleUpdateTag(m_size_, m_tag_.get(), m_data_); }
+    if (m_tag_buffer_ == nullptr && m_capacity_ > 0) {
+        m_tag_buffer_ = spMakeShared<id_type>(nullptr, m_capacity_);
+        for (int i = 0; i < m_dof_; ++i) { m_buffer_[i] = spMakeShared<Real>(nullptr, m_capacity_); }
+    }
+    Real* out[MAX_NUMBER_OF_ATTRIBUTES];
+    for (int i = 0; i < m_dof_; ++i) { out[i] = m_buffer_[i].get(); }
+    m_size_ = ParticleSort(m_size_, m_dof_, m_box_, m_tag_.get(), m_tag_buffer_.get(), m_data_, out,
+                           &m_bucket_start_[0]);
+    std::swap(m_tag_, m_tag_buffer_);
+    for (int i = 0; i < m_dof_; ++i) {
+        std::swap(m_holder_[i], m_buffer_[i]);
+        m_data_[i] = m_holder_[i].get();
+    }
+    for (size_type c = 0; c < m_bucket_count_.size(); ++c) {
+        m_bucket_count_[c] = m_bucket_start_[c + 1] - m_bucket_start_[c];
+    }
+    m_num_of_sorted_ = m_size_;
+    m_num_of_removed_ = 0;
+    m_pages_.clear();
+}
+
+namespace detail {
+template <typename T>
+void particle_pack(std::string* buf, T const* v, size_type num = 1) {
+    buf->append(reinterpret_cast<char const*>(v), num * sizeof(T));
+}
+template <typename T>
+void particle_unpack(char const*& p, T* v, size_type num = 1) {
+    std::memcpy(v, p, num * sizeof(T));
+    p += num * sizeof(T);
+}
+}  // namespace detail
+bool ParticleData::Pack(std::string* buf) const {
+    size_type num = Count();
+    detail::particle_pack(buf, &m_dof_);
+    detail::particle_pack(buf, &m_number_of_pic_);
+    detail::particle_pack(buf, &std::get<0>(m_box_)[0], 3);
+    detail::particle_pack(buf, &std::get<1>(m_box_)[0], 3);
+    detail::particle_pack(buf, &num);
+    // the tags, then column by column, removed particles are skipped
+    auto const* tag = m_tag_.get();
+    for (int i = -1; i < m_dof_; ++i) {
+        for (size_type s = 0; s < m_size_; ++s) {
+            if (tag[s] == NULL_ID) { continue; }
+            if (i < 0) {
+                detail::particle_pack(buf, tag + s);
+            } else {
+                detail::particle_pack(buf, m_data_[i] + s);
+            }
+        }
+    }
+    return true;
+}
+char const* ParticleData::Unpack(char const* p) {
+    index_box_type box;
+    size_type num = 0;
+    detail::particle_unpack(p, &m_dof_);
+    ASSERT(m_dof_ <= MAX_NUMBER_OF_ATTRIBUTES);
+    detail::particle_unpack(p, &m_number_of_pic_);
+    detail::particle_unpack(p, &std::get<0>(box)[0], 3);
+    detail::particle_unpack(p, &std::get<1>(box)[0], 3);
+    detail::particle_unpack(p, &num);
+    m_size_ = 0;
+    m_capacity_ = 0;
+    m_num_of_removed_ = 0;
+    SetIndexBox(box);
+    if (num > 0) {
+        Reserve(num);
+        detail::particle_unpack(p, m_tag_.get(), num);
+        for (int i = 0; i < m_dof_; ++i) { detail::particle_unpack(p, m_data_[i], num); }
+        m_size_ = num;
+        Sort();
+    }
+    return p;
+}
+}  // namespace simpla
@@ -8,19 +8,167 @@
 #include "simpla/SIMPLA_config.h"
 
 #include <simpla/data/DataBlock.h>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include "simpla/algebra/Array.h"
+#include "simpla/algebra/EntityId.h"
+
+#ifndef SP_PARTICLE_SIMD_WIDTH
+#ifdef __AVX512F__
+#define SP_PARTICLE_SIMD_WIDTH 16
+#else
+#define SP_PARTICLE_SIMD_WIDTH 8
+#endif
+#endif
+#ifndef SP_PARTICLE_TILE_SIZE
+#define SP_PARTICLE_TILE_SIZE 8
+#endif
 
 namespace simpla {
+static constexpr id_type NULL_ID = static_cast<id_type>(-1);
+
+/**
+ * @name particle kernels
+ *  Particle attributes are stored as structure of arrays (SoA): column n of particle s is  r[n][s]. The tag of a
+ *  particle is the EntityId of its cell, the first three columns are the coordinates relative to this cell, in [0,1).
+ *  Empty slots are tagged NULL_ID.
+ * @{
+ */
+enum { SP_RAND_UNIFORM = 0x1, SP_RAND_NORMAL = 0x10 };
+/**
+ * fill the first n_dof columns of num particles with samples of dist_types (uniform in (0,1) or standard normal).
+ * The particles are numbered from random_seed_offset, their global index, so loading is reproducible for any
+ * decomposition.
+ */
+int ParticleInitialLoad(Real** data, size_type num, int n_dof, int const* dist_types, size_type random_seed_offset,
+                        size_type random_seed = 0);
+/** move particles which left their cell ( r<0 or r>=1 ) to the cell they are in */
+void ParticleUpdateTag(size_type num, id_type* tag, Real** r);
+/**
+ * stable counting sort of particles by cell. The bins are the cells of box in C order, followed by the bin of particles
+ * outside the box and the bin of empty slots.
+ * @param bucket_start  start of every bin in out, size of the array is number of cells + 3
+ * @return number of particles, excluding empty slots
+ */
+size_type ParticleSort(size_type num, int num_of_attr, index_box_type const& box, id_type const* tag_in,
+                       id_type* tag_out, Real const* const* in, Real** out, size_type* bucket_start);
+struct ParticleData;
+/**
+ * leapfrog Boris push of the particles inside the index box, columns 3..5 are the velocity. E and B are the
+ * components of the edge and face fields on the Yee mesh, they are interpolated trilinearly from the 3x3x3 points
+ * around the cell of a particle, which are loaded once per cell. Particles are pushed SP_PARTICLE_SIMD_WIDTH at a time.
+ * @param inv_dx  inverse of the cell width, converts the displacement to cell-local coordinates
+ * @param cmr     charge-mass ratio
+ */
+void ParticleBorisPush(ParticleData& p, Array<Real> const* E, Array<Real> const* B, Real const* inv_dx, Real cmr,
+                       Real dt);
+/**
+ * charge conserving (Esirkepov) deposition of the current of particles inside the index box, which moved by v*dt in
+ * the last push. Call it after ParticleBorisPush and before Sort, while particles are still binned by their old cell.
+ * Cells are grouped in tiles of SP_PARTICLE_TILE_SIZE^3, every tile accumulates into its own buffer with guard cells,
+ * then the buffers are added to J in eight passes of non-adjacent tiles, so no atomics are needed and the result does
+ * not depend on the number of threads. J is accumulated, not cleared. Column 6, if present, is the weight.
+ * @param J   components of the edge field, J_x at (i+1/2,j,k) ...
+ */
+void ParticleDepositCurrent(ParticleData const& p, Array<Real>* J, Real const* inv_dx, Real charge, Real dt);
+/** @} */
+
+/**
+ * @brief  particles of one patch, stored in SoA columns and sorted by cell.
+ *
+ *  After Sort the particles of a cell are contiguous, so a cell is one page (Bucket) of the columns. Particles
+ *  injected by AddBucket are appended as extra pages, linked after the page of their cell, and merged into it by the
+ *  next Sort. Particles which left the index box are kept after the sorted cells until they are migrated.
+ */
 struct ParticleData : public data::DataEntity {
     SP_DEFINE_FANCY_TYPE_NAME(ParticleData, data::DataEntity);
-    ParticleData(int DOF = 0, size_type NumberOfPIC = 100) : m_dof_(DOF), m_number_of_pic_(NumberOfPIC) {}
+    static constexpr int MAX_NUMBER_OF_ATTRIBUTES = 10;
+
+    struct Bucket {
+        std::shared_ptr<Bucket> next = nullptr;
+        size_type count = 0;
+        id_type* tag = nullptr;
+        Real* data[MAX_NUMBER_OF_ATTRIBUTES];
+    };
+
+    explicit ParticleData(int DOF = 0, size_type NumberOfPIC = 100);
     ~ParticleData() override = default;
+    static std::shared_ptr<ParticleData> New(int DOF = 0, size_type NumberOfPIC = 100) {
+        return std::make_shared<ParticleData>(DOF, NumberOfPIC);
+    }
+
+    std::type_info const& value_type_info() const override { return typeid(Real); };
+    size_type value_sizeof() const override { return sizeof(Real); };
+    size_type size() const override { return m_size_; }
 
+    int GetDOF() const { return m_dof_; }
     size_type GetNumberOfPIC() const { return m_number_of_pic_; }
     void SetNumberOfPIC(size_type n) { m_number_of_pic_ = n; }
 
+    /** cells of the patch, the bins of Sort */
+    void SetIndexBox(index_box_type const& b);
+    index_box_type const& GetIndexBox() const { return m_box_; }
+
+    /** capacity of columns, content is kept */
+    void Reserve(size_type n);
+    size_type GetCapacity() const { return m_capacity_; }
+    /** number of particles after the last Sort, including those outside the box */
+    size_type GetNumberOfSortedParticles() const { return m_num_of_sorted_; }
+    /** sorted particles outside the box, stored in [ GetNumberOfSortedParticles() - GetNumberOfOutOfBox(), ...) */
+    size_type GetNumberOfOutOfBox() const;
+
+    id_type* GetTag() { return m_tag_.get(); }
+    id_type const* GetTag() const { return m_tag_.get(); }
+    Real** GetData() { return m_data_; }
+    Real* GetData(int n) { return m_data_[n]; }
+    Real const* GetData(int n) const { return m_data_[n]; }
+
+    /** pages of cell s; s=NULL_ID returns all particles as one page */
+    std::shared_ptr<Bucket> GetBucket(id_type s = NULL_ID) const;
+    /** append a page of num particles to cell s, the attributes are not initialized */
+    std::shared_ptr<Bucket> AddBucket(id_type s, size_type num);
+    /** remove the particles of cell s; s=NULL_ID removes all particles, the capacity is kept */
+    void RemoveBucket(id_type s);
+    size_type Count(id_type s = NULL_ID) const;
+
+    /** true if no page was appended after the last Sort */
+    bool isSorted() const { return m_pages_.empty(); }
+    size_type GetNumberOfCells() const { return m_bucket_count_.size() - 2; }
+    /** particles of the c-th cell of the box in C order, valid if isSorted() */
+    size_type GetBucketStart(size_type c) const { return m_bucket_start_[c]; }
+    size_type GetBucketCount(size_type c) const { return m_bucket_count_[c]; }
+
+    /** update tags and sort particles by cell, extra pages are merged and removed particles are dropped */
+    void Sort();
+
+    /** DOF, number of PIC, index box and the particles which are not removed */
+    bool Pack(std::string* buf) const override;
+    /** the particles are sorted into the cells of the index box */
+    char const* Unpack(char const* p) override;
+
    private:
+    size_type GetCellIndex(id_type s) const;
+    std::shared_ptr<Bucket> MakeBucket(size_type start, size_type count) const;
+
     int m_dof_ = 0;
     size_type m_number_of_pic_ = 100;
+    index_box_type m_box_{{0, 0, 0}, {0, 0, 0}};
+    size_type m_size_ = 0;
+    size_type m_num_of_sorted_ = 0;
+    size_type m_capacity_ = 0;
+    std::shared_ptr<id_type> m_tag_ = nullptr;
+    std::shared_ptr<id_type> m_tag_buffer_ = nullptr;
+    std::shared_ptr<Real> m_holder_[MAX_NUMBER_OF_ATTRIBUTES];
+    std::shared_ptr<Real> m_buffer_[MAX_NUMBER_OF_ATTRIBUTES];
+    Real* m_data_[MAX_NUMBER_OF_ATTRIBUTES];
+    size_type m_num_of_removed_ = 0;
+    //! start of every bin after the last Sort, see ParticleSort
+    std::vector<size_type> m_bucket_start_;
+    //! particles of every bin, zero for removed cells
+    std::vector<size_type> m_bucket_count_;
+    //! pages appended after the last Sort : cell, start, count
+    std::vector<std::tuple<id_type, size_type, size_type>> m_pages_;
 };
 }  // namespace simpla
 
@@ -0,0 +1,179 @@
+//
+// Esirkepov current deposition of the particles of a block, per tile and colour.
+//
+#include "simpla/SIMPLA_config.h"
+
+#include <algorithm>
+#include <cmath>
+#include "ParticleData.h"
+#include "simpla/utilities/Log.h"
+#include "simpla/utilities/memory.h"
+
+namespace simpla {
+namespace detail {
+//! a particle of cell i touches the nodes i-1 .. i+2 before and after a move of less than one cell
+static constexpr index_type DEPOSIT_GUARD_LO = 1;
+static constexpr index_type DEPOSIT_GUARD_HI = 2;
+static constexpr index_type DEPOSIT_TILE_WIDTH = SP_PARTICLE_TILE_SIZE + DEPOSIT_GUARD_LO + DEPOSIT_GUARD_HI;
+static constexpr index_type DEPOSIT_TILE_VOLUME = DEPOSIT_TILE_WIDTH * DEPOSIT_TILE_WIDTH * DEPOSIT_TILE_WIDTH;
+//! tiles of one colour are at least one tile apart, their buffers do not overlap
+static_assert(SP_PARTICLE_TILE_SIZE >= DEPOSIT_GUARD_LO + DEPOSIT_GUARD_HI, "particle tile is smaller than guards");
+
+/**
+ * Esirkepov weights of a particle moving from r0 to r1 (coordinates relative to its cell) on the nodes -1..2 of the
+ * cell, the current of edge a is the partial sum of -W over the nodes up to a. j[n] points to node -1 of the cell in
+ * a tile buffer.
+ */
+static void deposit_particle(Real const* r0, Real const* r1, Real const* f, Real* const* j) {
+    static constexpr index_type S0 = DEPOSIT_TILE_WIDTH * DEPOSIT_TILE_WIDTH, S1 = DEPOSIT_TILE_WIDTH;
+    Real S[3][4], dS[3][4];
+    for (int d = 0; d < 3; ++d)
+        for (int n = 0; n < 4; ++n) {
+            S[d][n] = std::max(1 - std::abs(r0[d] - (n - 1)), 0.0);
+            dS[d][n] = std::max(1 - std::abs(r1[d] - (n - 1)), 0.0) - S[d][n];
+        }
+    for (int b = 0; b < 4; ++b)
+        for (int c = 0; c < 4; ++c) {
+            Real w = S[1][b] * S[2][c] + 0.5 * (dS[1][b] * S[2][c] + S[1][b] * dS[2][c]) + dS[1][b] * dS[2][c] / 3.0;
+            Real acc = 0;
+            for (int a = 0; a < 3; ++a) {
+                acc -= dS[0][a] * w;
+                j[0][a * S0 + b * S1 + c] += f[0] * acc;
+            }
+        }
+    for (int a = 0; a < 4; ++a)
+        for (int c = 0; c < 4; ++c) {
+            Real w = S[0][a] * S[2][c] + 0.5 * (dS[0][a] * S[2][c] + S[0][a] * dS[2][c]) + dS[0][a] * dS[2][c] / 3.0;
+            Real acc = 0;
+            for (int b = 0; b < 3; ++b) {
+                acc -= dS[1][b] * w;
+                j[1][a * S0 + b * S1 + c] += f[1] * acc;
+            }
+        }
+    for (int a = 0; a < 4; ++a)
+        for (int b = 0; b < 4; ++b) {
+            Real w = S[0][a] * S[1][b] + 0.5 * (dS[0][a] * S[1][b] + S[0][a] * dS[1][b]) + dS[0][a] * dS[1][b] / 3.0;
+            Real acc = 0;
+            for (int c = 0; c < 3; ++c) {
+                acc -= dS[2][c] * w;
+                j[2][a * S0 + b * S1 + c] += f[2] * acc;
+            }
+        }
+}
+
+/** add the buffer of a tile, whose node 0 is at lo - DEPOSIT_GUARD_LO, to J */
+static void deposit_reduce_tile(Real const* buffer, index_type const* lo, index_type const* hi, Array<Real>* J) {
+    index_type b[3], e[3];
+    for (int d = 0; d < 3; ++d) {
+        b[d] = lo[d] - DEPOSIT_GUARD_LO;
+        e[d] = hi[d] + DEPOSIT_GUARD_HI;
+    }
+    for (int n = 0; n < 3; ++n) {
+        Real const* src = buffer + n * DEPOSIT_TILE_VOLUME;
+        Real* dst = J[n].get();
+        auto const& sfc = J[n].GetSpaceFillingCurve();
+        if (dst == nullptr) { continue; }
+        for (index_type i = b[0]; i < e[0]; ++i)
+            for (index_type j = b[1]; j < e[1]; ++j) {
+                Real const* s = src + ((i - b[0]) * DEPOSIT_TILE_WIDTH + (j - b[1])) * DEPOSIT_TILE_WIDTH - b[2];
+                if (sfc.in_box(i, j, b[2]) && sfc.in_box(i, j, e[2] - 1)) {
+                    Real* d = dst + sfc.hash(i, j, b[2]) - b[2];
+                    index_type stride = e[2] - b[2] > 1 ? sfc.hash(i, j, b[2] + 1) - sfc.hash(i, j, b[2]) : 1;
+                    if (stride == 1) {
+#pragma omp simd
+                        for (index_type k = b[2]; k < e[2]; ++k) { d[k] += s[k]; }
+                        continue;
+                    }
+                }
+                for (index_type k = b[2]; k < e[2]; ++k) {
+                    if (sfc.in_box(i, j, k)) { dst[sfc.hash(i, j, k)] += s[k]; }
+                }
+            }
+    }
+}
+}  // namespace detail
+
+void ParticleDepositCurrent(ParticleData const& p, Array<Real>* J, Real const* inv_dx, Real charge, Real dt) {
+    if (p.GetDOF() < 6) {
+        RUNTIME_ERROR << "Current deposition needs coordinates and velocity, DOF = " << p.GetDOF() << std::endl;
+    }
+    if (!p.isSorted()) {
+        RUNTIME_ERROR << "Current deposition needs particles sorted by cell, call it before appending particles."
+                      << std::endl;
+    }
+    static constexpr index_type T = SP_PARTICLE_TILE_SIZE;
+    auto const& box = p.GetIndexBox();
+    index_type lo[3], hi[3], dims[3], num_of_tiles[3];
+    for (int d = 0; d < 3; ++d) {
+        lo[d] = std::get<0>(box)[d];
+        hi[d] = std::get<1>(box)[d];
+        dims[d] = hi[d] - lo[d];
+        num_of_tiles[d] = (dims[d] + T - 1) / T;
+    }
+    index_type total = num_of_tiles[0] * num_of_tiles[1] * num_of_tiles[2];
+    if (total <= 0 || p.GetNumberOfSortedParticles() == 0) { return; }
+
+    Real const* rx = p.GetData(0);
+    Real const* ry = p.GetData(1);
+    Real const* rz = p.GetData(2);
+    Real const* vx = p.GetData(3);
+    Real const* vy = p.GetData(4);
+    Real const* vz = p.GetData(5);
+    Real const* weight = p.GetDOF() > 6 ? p.GetData(6) : nullptr;
+    Real f0[3] = {charge * inv_dx[1] * inv_dx[2] / dt, charge * inv_dx[0] * inv_dx[2] / dt,
+                  charge * inv_dx[0] * inv_dx[1] / dt};
+    Real sx = dt * inv_dx[0], sy = dt * inv_dx[1], sz = dt * inv_dx[2];
+
+    auto buffer = spMakeShared<Real>(nullptr, static_cast<size_type>(total * 3 * detail::DEPOSIT_TILE_VOLUME));
+    Real* buffer_ptr = buffer.get();
+
+    auto tile_box = [&](index_type t, index_type* t_lo, index_type* t_hi) {
+        index_type idx[3] = {t / (num_of_tiles[1] * num_of_tiles[2]), (t / num_of_tiles[2]) % num_of_tiles[1],
+                             t % num_of_tiles[2]};
+        for (int d = 0; d < 3; ++d) {
+            t_lo[d] = lo[d] + idx[d] * T;
+            t_hi[d] = std::min(t_lo[d] + T, hi[d]);
+        }
+    };
+
+    // deposit, one tile per task. The buffer is touched first by the thread which fills it.
+#pragma omp parallel for schedule(dynamic, 1)
+    for (index_type t = 0; t < total; ++t) {
+        Real* tile = buffer_ptr + t * 3 * detail::DEPOSIT_TILE_VOLUME;
+        std::fill(tile, tile + 3 * detail::DEPOSIT_TILE_VOLUME, 0.0);
+        Real* j[3] = {tile, tile + detail::DEPOSIT_TILE_VOLUME, tile + 2 * detail::DEPOSIT_TILE_VOLUME};
+        index_type t_lo[3], t_hi[3];
+        tile_box(t, t_lo, t_hi);
+        for (index_type i = t_lo[0]; i < t_hi[0]; ++i)
+            for (index_type k1 = t_lo[1]; k1 < t_hi[1]; ++k1)
+                for (index_type k2 = t_lo[2]; k2 < t_hi[2]; ++k2) {
+                    auto c = static_cast<size_type>(((i - lo[0]) * dims[1] + (k1 - lo[1])) * dims[2] + (k2 - lo[2]));
+                    size_type start = p.GetBucketStart(c);
+                    size_type end = start + p.GetBucketCount(c);
+                    index_type offset = ((i - t_lo[0]) * detail::DEPOSIT_TILE_WIDTH + (k1 - t_lo[1])) *
+                                            detail::DEPOSIT_TILE_WIDTH +
+                                        (k2 - t_lo[2]);
+                    Real* jc[3] = {j[0] + offset, j[1] + offset, j[2] + offset};
+                    for (size_type s = start; s < end; ++s) {
+                        Real r1[3] = {rx[s], ry[s], rz[s]};
+                        Real r0[3] = {rx[s] - vx[s] * sx, ry[s] - vy[s] * sy, rz[s] - vz[s] * sz};
+                        Real w = weight == nullptr ? 1.0 : weight[s];
+                        Real f[3] = {f0[0] * w, f0[1] * w, f0[2] * w};
+                        detail::deposit_particle(r0, r1, f, jc);
+                    }
+                }
+    }
+    // reduction, tiles of the same colour do not overlap
+    for (int color = 0; color < 8; ++color) {
+#pragma omp parallel for schedule(dynamic, 1)
+        for (index_type t = 0; t < total; ++t) {
+            index_type idx[3] = {t / (num_of_tiles[1] * num_of_tiles[2]), (t / num_of_tiles[2]) % num_of_tiles[1],
+                                 t % num_of_tiles[2]};
+            if ((idx[0] % 2) * 4 + (idx[1] % 2) * 2 + (idx[2] % 2) != color) { continue; }
+            index_type t_lo[3], t_hi[3];
+            tile_box(t, t_lo, t_hi);
+            detail::deposit_reduce_tile(buffer_ptr + t * 3 * detail::DEPOSIT_TILE_VOLUME, t_lo, t_hi, J);
+        }
+    }
+}
+}  // namespace simpla
@@ -2,12 +2,19 @@
 // Created by salmon on 16-9-6.
 //
 
-#include </usr/local/cuda/include/curand_kernel.h>
+#include "simpla/SIMPLA_config.h"
+
+#include "ParticleData.h"
+#include "simpla/numeric/normal_distribution_icdf.h"
+#include "simpla/numeric/philox_engine.h"
+#include "simpla/utilities/Log.h"
+#include "simpla/utilities/SPDefines.h"
+
+#ifdef __CUDA__
+#include <curand_kernel.h>
 #include <simpla/utilities/host_define.h>
 #include "cuda_runtime.h"
 #include "host_defines.h"
-#include "simpla/utilities/Log.h"
-#include "simpla/utilities/SPDefines.h"
 
 #define SP_CALL(_CMD_)                                                                                      \
     {                                                                                                       \
@@ -46,6 +53,7 @@
             return SP_FAILED;                                               \
         }                                                                   \
     }
+#endif  // __CUDA__
 //
 //__global__ void spParticleBucketInitialize_kernel(dim3 start, dim3 count, dim3 strides, int num_pic,
 //                                                  size_type *start_pos, size_type *f_count) {
@@ -253,6 +261,7 @@
 namespace simpla {
 
 
+#ifdef __CUDA__
 /* Number of 64-bit vectors per dimension */
 #define VECTOR_SIZE 64
 
@@ -263,7 +272,6 @@ namespace simpla {
             return EXIT_FAILURE;                              \
         }                                                     \
     } while (0)
-#ifdef __CUDA__
 
 /**
  * This kernel initializes state per thread for each of x, y, and z,vx,vy,vz
@@ -300,10 +308,9 @@ __global__ void spRandomDistributionNormalKernel(struct curandStateScrambledSobo
 
     state[total_thread_id] = local_state;
 }
-#endif  // __CUDA__
-enum { SP_RAND_UNIFORM = 0x1, SP_RAND_NORMAL = 0x10 };
-
-int ParticleInitialLoad(Real **data, size_type num, int n_dof, int const *dist_types, size_type random_seed_offset) {
+/** device path, quasi-random numbers of scrambled Sobol sequences, random_seed is ignored */
+int ParticleInitialLoad(Real **data, size_type num, int n_dof, int const *dist_types, size_type random_seed_offset,
+                        size_type random_seed) {
     int error_code = SP_SUCCESS;
 
     struct curandStateScrambledSobol64 *devSobol64States;
@@ -365,4 +372,34 @@ int ParticleInitialLoad(Real **data, size_type num, int n_dof, int const *dist_t
     SP_DEVICE_CALL(cudaFree(devScrambleConstants64));
     return error_code;
 }
+#else
+/**
+ * host path, attribute n of the particle with global index  random_seed_offset + s  is the number (s, n) of the
+ * Philox stream of random_seed. The result does not depend on the number of threads or processes.
+ */
+int ParticleInitialLoad(Real **data, size_type num, int n_dof, int const *dist_types, size_type random_seed_offset,
+                        size_type random_seed) {
+    for (int n = 0; n < n_dof; ++n) {
+        Real *v = data[n];
+        auto dof = static_cast<uint32_t>(n);
+        switch (dist_types[n]) {
+            case SP_RAND_NORMAL:
+#pragma omp parallel for simd schedule(static)
+                for (size_type s = 0; s < num; ++s) {
+                    auto u = philox_engine::uniform(random_seed, random_seed_offset + s, dof);
+                    v[s] = static_cast<Real>(normal_distribution_icdf::value(u));
+                }
+                break;
+            case SP_RAND_UNIFORM:
+            default:
+#pragma omp parallel for simd schedule(static)
+                for (size_type s = 0; s < num; ++s) {
+                    v[s] = static_cast<Real>(philox_engine::uniform(random_seed, random_seed_offset + s, dof));
+                }
+                break;
+        }
+    }
+    return SP_SUCCESS;
+}
+#endif  // __CUDA__
 }  // namespace simpla{
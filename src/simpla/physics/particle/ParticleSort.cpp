@@ -2,8 +2,120 @@
 // Created by salmon on 17-8-10.
 //
 #include "simpla/SIMPLA_config.h"
+
+#include <algorithm>
+#include <cmath>
+#include "ParticleData.h"
+#include "simpla/algebra/EntityId.h"
+#include "simpla/utilities/memory.h"
+
 namespace simpla {
+namespace detail {
+//! particles of one chunk are counted and scattered by one thread, the result does not depend on the number of threads
+static constexpr size_type PARTICLE_SORT_MAX_NUMBER_OF_CHUNKS = 256;
+static constexpr size_type PARTICLE_SORT_MIN_CHUNK_SIZE = 4096;
+}  // namespace detail
+
+void ParticleUpdateTag(size_type num, id_type* tag, Real** r) {
+    Real* rx = r[0];
+    Real* ry = r[1];
+    Real* rz = r[2];
+#pragma omp parallel for schedule(static)
+    for (size_type s = 0; s < num; ++s) {
+        if (tag[s] == NULL_ID) { continue; }
+        Real dx = std::floor(rx[s]);
+        Real dy = std::floor(ry[s]);
+        Real dz = std::floor(rz[s]);
+        EntityId id;
+        id.v = static_cast<int64_t>(tag[s]);
+        id.x += static_cast<int16_t>(dx);
+        id.y += static_cast<int16_t>(dy);
+        id.z += static_cast<int16_t>(dz);
+        rx[s] -= dx;
+        ry[s] -= dy;
+        rz[s] -= dz;
+        tag[s] = static_cast<id_type>(id.v);
+    }
+}
+
+size_type ParticleSort(size_type num, int num_of_attr, index_box_type const& box, id_type const* tag_in,
+                       id_type* tag_out, Real const* const* in, Real** out, size_type* bucket_start) {
+    index_type lo[3], extents[3];
+    size_type num_of_cell = 1;
+    for (int n = 0; n < 3; ++n) {
+        lo[n] = std::get<0>(box)[n];
+        extents[n] = std::max(std::get<1>(box)[n] - lo[n], 0L);
+        num_of_cell *= static_cast<size_type>(extents[n]);
+    }
+    // cells in C order, out of box, empty slots
+    size_type num_of_bin = num_of_cell + 2;
+    auto bin_of = [&](id_type t) -> size_type {
+        if (t == NULL_ID) { return num_of_cell + 1; }
+        EntityId id;
+        id.v = static_cast<int64_t>(t);
+        index_type i = id.x - lo[0], j = id.y - lo[1], k = id.z - lo[2];
+        return (i < 0 || i >= extents[0] || j < 0 || j >= extents[1] || k < 0 || k >= extents[2])
+                   ? num_of_cell
+                   : static_cast<size_type>((i * extents[1] + j) * extents[2] + k);
+    };
+
+    // the histograms of all chunks are no larger than a few columns of particles
+    size_type num_of_chunk = std::min(detail::PARTICLE_SORT_MAX_NUMBER_OF_CHUNKS,
+                                      std::max(std::min(num / detail::PARTICLE_SORT_MIN_CHUNK_SIZE,
+                                                        4 * num / num_of_bin),
+                                               static_cast<size_type>(1)));
+    size_type chunk_size = (num + num_of_chunk - 1) / num_of_chunk;
+    auto bin_holder = spMakeShared<size_type>(nullptr, num);
+    auto dest_holder = spMakeShared<size_type>(nullptr, num);
+    auto offset_holder = spMakeShared<size_type>(nullptr, num_of_chunk * num_of_bin);
+    size_type* bin = bin_holder.get();
+    size_type* dest = dest_holder.get();
+    size_type* offset = offset_holder.get();
+
+#pragma omp parallel for schedule(static)
+    for (size_type c = 0; c < num_of_chunk; ++c) {
+        size_type* hist = &offset[c * num_of_bin];
+        std::fill(hist, hist + num_of_bin, 0);
+        for (size_type s = c * chunk_size, se = std::min(s + chunk_size, num); s < se; ++s) {
+            bin[s] = bin_of(tag_in[s]);
+            ++hist[bin[s]];
+        }
+    }
+    // exclusive scan in (bin, chunk) order keeps particles of a bin in their original order
+#pragma omp parallel for schedule(static)
+    for (size_type b = 0; b < num_of_bin; ++b) {
+        size_type count = 0;
+        for (size_type c = 0; c < num_of_chunk; ++c) {
+            size_type t = offset[c * num_of_bin + b];
+            offset[c * num_of_bin + b] = count;
+            count += t;
+        }
+        bucket_start[b + 1] = count;
+    }
+    bucket_start[0] = 0;
+    for (size_type b = 0; b < num_of_bin; ++b) { bucket_start[b + 1] += bucket_start[b]; }
 
-void ParticleUpdateTag(size_type num, id_type* tag, Real** r) {}
-void ParticleSort(size_type num, int num_of_attr, id_type const* tag_in, id_type* tag_out, Real** in, Real** out) {}
-}
\ No newline at end of file
+#pragma omp parallel for schedule(static)
+    for (size_type c = 0; c < num_of_chunk; ++c) {
+        size_type* pos = &offset[c * num_of_bin];
+        for (size_type s = c * chunk_size, se = std::min(s + chunk_size, num); s < se; ++s) {
+            dest[s] = bucket_start[bin[s]] + pos[bin[s]]++;
+        }
+    }
+    // empty slots are not copied
+    size_type num_of_particle = bucket_start[num_of_cell + 1];
+#pragma omp parallel for schedule(static)
+    for (size_type s = 0; s < num; ++s) {
+        if (dest[s] < num_of_particle) { tag_out[dest[s]] = tag_in[s]; }
+    }
+    for (int n = 0; n < num_of_attr; ++n) {
+        Real const* src = in[n];
+        Real* dst = out[n];
+#pragma omp parallel for schedule(static)
+        for (size_type s = 0; s < num; ++s) {
+            if (dest[s] < num_of_particle) { dst[dest[s]] = src[s]; }
+        }
+    }
+    return num_of_particle;
+}
+}  // namespace simpla
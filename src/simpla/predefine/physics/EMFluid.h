@@ -52,6 +52,9 @@ class EMFluid : public TDomain {
     std::map<std::string, std::shared_ptr<fluid_s>> m_fluid_sp_;
     std::shared_ptr<fluid_s> AddSpecies(std::string const& name, std::shared_ptr<data::DataEntry> d);
     std::map<std::string, std::shared_ptr<fluid_s>>& GetSpecies() { return m_fluid_sp_; };
+
+    //! 1/omega, omega the largest plasma or cyclotron frequency of the species on the patch
+    Real DoComputeStableDt(Real time_now) const override;
 };
 
 template <typename TM>
@@ -118,6 +121,25 @@ void EMFluid<TM>::DoInitialCondition(Real time_now) {
     Ev = map_to<CELL>(E);
 }
 
+template <typename TM>
+Real EMFluid<TM>::DoComputeStableDt(Real time_now) const {
+    DEFINE_PHYSICAL_CONST
+    Real BB_max = 0;
+    BB.Foreach([&](Real const& v, index_type, index_type, index_type) { BB_max = std::max(BB_max, v); });
+    Real omega_p2 = 0, omega_c = 0;
+    for (auto const& p : m_fluid_sp_) {
+        Real ms = p.second->mass;
+        Real qs = p.second->charge;
+        Real ns_max = 0;
+        p.second->n->Foreach(
+            [&](Real const& v, index_type, index_type, index_type) { ns_max = std::max(ns_max, v); });
+        omega_p2 += ns_max * qs * qs / (epsilon0 * ms);
+        omega_c = std::max(omega_c, std::abs(qs) * std::sqrt(BB_max) / ms);
+    }
+    Real omega = std::max(std::sqrt(omega_p2), omega_c);
+    return std::min(base_type::DoComputeStableDt(time_now),
+                    omega > 0 ? 1.0 / omega : std::numeric_limits<Real>::infinity());
+}
 template <typename TM>
 void EMFluid<TM>::DoAdvance(Real time_now, Real dt) {
     DEFINE_PHYSICAL_CONST
@@ -125,12 +147,12 @@ void EMFluid<TM>::DoAdvance(Real time_now, Real dt) {
     if (m_fluid_sp_.size() <= 0) { return; }
     Ev = map_to<CELL>(E);
 
-    Field<this_type, Real, CELL, 3> Q{this};
-    Field<this_type, Real, CELL, 3> K{this};
+    Field<this_type, Real, CELL, 3> Q{this, "SCRATCH"_};
+    Field<this_type, Real, CELL, 3> K{this, "SCRATCH"_};
 
-    Field<this_type, Real, CELL> a{this};
-    Field<this_type, Real, CELL> b{this};
-    Field<this_type, Real, CELL> c{this};
+    Field<this_type, Real, CELL> a{this, "SCRATCH"_};
+    Field<this_type, Real, CELL> b{this, "SCRATCH"_};
+    Field<this_type, Real, CELL> c{this, "SCRATCH"_};
 
     a.Clear();
     b.Clear();
@@ -157,15 +179,13 @@ void EMFluid<TM>::DoAdvance(Real time_now, Real dt) {
 
         Q -= (0.5 * dt / epsilon0) * Js;
 
-        a += qs * ns * (as / (BB * as * as + 1));
-        b += qs * ns * (as * as / (BB * as * as + 1));
-        c += qs * ns * (as * as * as / (BB * as * as + 1));
+        this->Fuse(assign(a, a + qs * ns * (as / (BB * as * as + 1))),
+                   assign(b, b + qs * ns * (as * as / (BB * as * as + 1))),
+                   assign(c, c + qs * ns * (as * as * as / (BB * as * as + 1))));
     }
 
-    a *= 0.5 * dt / epsilon0;
-    b *= 0.5 * dt / epsilon0;
-    c *= 0.5 * dt / epsilon0;
-    a += 1;
+    this->Fuse(assign(a, a * (0.5 * dt / epsilon0) + 1), assign(b, b * (0.5 * dt / epsilon0)),
+               assign(c, c * (0.5 * dt / epsilon0)));
 
     dE = (Q * a - cross(Q, B0v) * b + B0v * (dot(Q, B0v) * (b * b - c * a) / (a + c * BB))) / (b * b * BB + a * a);
 
@@ -24,6 +24,9 @@ class Maxwell : public TDomain {
     FIELD(E, Real, EDGE);
     FIELD(B, Real, FACE);
     FIELD(J, Real, EDGE);
+
+    //! light crossing time of the smallest cell
+    Real DoComputeStableDt(Real time_now) const override;
 };
 template <typename TDomain>
 bool Maxwell<TDomain>::_is_registered = Factory<TDomain>::template RegisterCreator<Maxwell<TDomain>>("Maxwell");
@@ -55,6 +58,11 @@ void Maxwell<TDomain>::DoInitialCondition(Real time_now) {
     J.Clear();
 }
 
+template <typename TDomain>
+Real Maxwell<TDomain>::DoComputeStableDt(Real time_now) const {
+    DEFINE_PHYSICAL_CONST
+    return std::min(base_type::DoComputeStableDt(time_now), this->GetMinCellWidth() / speed_of_light);
+}
 template <typename TDomain>
 void Maxwell<TDomain>::DoAdvance(Real time_now, Real time_dt) {
     DEFINE_PHYSICAL_CONST
@@ -18,66 +18,70 @@ using namespace data;
 template <typename TDomain>
 class PICBoris : public TDomain {
     SP_DOMAIN_HEAD(PICBoris, TDomain);
+    void Deserialize(std::shared_ptr<const data::DataEntry> const& cfg) override;
+    std::shared_ptr<data::DataEntry> Serialize() const override;
 
-   public:
-    int DOF = 7;
+    Field<this_type, Real, CELL> ne{this, "Name"_ = "ne"};
+    Field<this_type, Real, CELL, 3> B0v{this, "Name"_ = "B0v"};
 
-    Particle<this_type> ele{this, "name"_ = "ele", "DOF"_ = 6};
+    Field<this_type, Real, EDGE> E0{this, "Name"_ = "E0"};
+    Field<this_type, Real, FACE> B0{this, "Name"_ = "B0"};
+    Field<this_type, Real, CELL> BB{this, "Name"_ = "BB"};
+    Field<this_type, Real, CELL, 3> Jv{this, "Name"_ = "Jv"};
 
-    Field<this_type, Real, CELL> ne{this, "name"_ = "ne"};
-    Field<this_type, Real, CELL, 3> B0v{this, "name"_ = "B0v"};
-
-    Field<this_type, Real, EDGE> E0{this, "name"_ = "E0"};
-    Field<this_type, Real, FACE> B0{this, "name"_ = "B0"};
-    Field<this_type, Real, CELL> BB{this, "name"_ = "BB"};
-    Field<this_type, Real, CELL, 3> Jv{this, "name"_ = "Jv"};
-
-    Field<this_type, Real, FACE> B{this, "name"_ = "B"};
-    Field<this_type, Real, EDGE> E{this, "name"_ = "E"};
-    Field<this_type, Real, EDGE> J{this, "name"_ = "J"};
+    Field<this_type, Real, FACE> B{this, "Name"_ = "B"};
+    Field<this_type, Real, EDGE> E{this, "Name"_ = "E"};
+    Field<this_type, Real, EDGE> J{this, "Name"_ = "J"};
 
     //    void TagRefinementCells(Real time_now);
 
+    /** the particles of a species are the attribute of its name, columns x,y,z (in the cell) vx,vy,vz,w */
     std::map<std::string, std::shared_ptr<Particle<base_type>>> m_particle_sp_;
-    std::shared_ptr<Particle<base_type>> AddSpecies(std::string const& name, std::shared_ptr<data::DataEntry> d);
+    std::shared_ptr<Particle<base_type>> AddSpecies(std::string const& name,
+                                                    std::shared_ptr<const data::DataEntry> const& d);
     std::map<std::string, std::shared_ptr<Particle<base_type>>>& GetSpecies() { return m_particle_sp_; };
-
-    //    template <typename... Args>
-    //    std::shared_ptr<Particle<base_type>> AddSpecies(std::string const& name, Args&&... args) {
-    //        data::DataEntry t;
-    //        t.Assign(std::forward<Args>(args)...);
-    //        return AddSpecies(name, t);
-    //    };
 };
+template <typename TM>
+bool PICBoris<TM>::_is_registered = Factory<TM>::template RegisterCreator<PICBoris<TM>>("PICBoris");
+
+template <typename TM>
+PICBoris<TM>::PICBoris() : base_type() {}
+template <typename TM>
+PICBoris<TM>::~PICBoris() {}
 
 template <typename TM>
 std::shared_ptr<data::DataEntry> PICBoris<TM>::Serialize() const {
     auto res = data::DataEntry::New();
-    for (auto& item : m_particle_sp_) { res->Set(item.first, item.second->Serialize()); }
+    for (auto& item : m_particle_sp_) {
+        res->SetValue("Species/" + item.first + "/mass",
+                      item.second->template GetProperty<double>("mass") / SI_proton_mass);
+        res->SetValue("Species/" + item.first + "/Z",
+                      item.second->template GetProperty<double>("charge") / SI_elementary_charge);
+    }
     return res;
 };
 template <typename TM>
-void PICBoris<TM>::Deserialize(std::shared_ptr<data::DataEntry> const& cfg) {
-    cfg->Get("Species")->Foreach(
-        [&](std::string k, std::shared_ptr<data::DataEntry> t) { return AddSpecies(k, t) != nullptr; });
-
-    //        t.SetEntity<double>("mass", item.m_node_->mass / SI_proton_mass);
-    //        t.SetEntity<double>("Z", item.m_node_->charge / SI_elementary_charge);
-    //        t.SetEntity<double>("ratio", item.m_node_->ratio);
+void PICBoris<TM>::Deserialize(std::shared_ptr<const data::DataEntry> const& cfg) {
+    if (auto species = cfg->Get("Species")) {
+        species->Foreach([&](std::string const& k, std::shared_ptr<const data::DataEntry> v) {
+            return AddSpecies(k, v) != nullptr ? 1 : 0;
+        });
+    }
 }
 
 template <typename TM>
-std::shared_ptr<Particle<TM>> PICBoris<TM>::AddSpecies(std::string const& name, std::shared_ptr<data::DataEntry> d) {
-    auto sp = Particle<TM>::New(this, d);
-    sp->SetDOF(7);
-    sp->db()->SetValue("mass", d->GetValue<double>("mass", d->GetValue<double>("mass", 1)) * SI_proton_mass);
-    sp->db()->SetValue("charge", d->GetValue<double>("charge", d->GetValue<double>("Z", 1)) * SI_elementary_charge);
-    //    sp->ratio = d->Get<double>("ratio", d->GetEntity<double>("ratio", 1));
+std::shared_ptr<Particle<TM>> PICBoris<TM>::AddSpecies(std::string const& name,
+                                                       std::shared_ptr<const data::DataEntry> const& d) {
+    if (d == nullptr) { return nullptr; }
+    auto sp = Particle<TM>::New(this, "Name"_ = name);
+    sp->SetNumberOfAttributes(7);
+    sp->SetProperty("mass", d->GetValue<double>("mass", 1) * SI_proton_mass);
+    sp->SetProperty("charge", d->GetValue<double>("charge", d->GetValue<double>("Z", 1)) * SI_elementary_charge);
 
     m_particle_sp_.emplace(name, sp);
     VERBOSE << "AddEntity particle : {\" Name=" << name
-            << "\", mass = " << sp->db()->template GetValue<double>("mass") / SI_proton_mass
-            << " [m_p], charge = " << sp->db()->template GetValue<double>("charge") / SI_elementary_charge << " [q_e] }"
+            << "\", mass = " << sp->template GetProperty<double>("mass") / SI_proton_mass
+            << " [m_p], charge = " << sp->template GetProperty<double>("charge") / SI_elementary_charge << " [q_e] }"
             << std::endl;
     return sp;
 }
@@ -88,17 +92,36 @@ std::shared_ptr<Particle<TM>> PICBoris<TM>::AddSpecies(std::string const& name,
 //}
 
 template <typename TM>
-void PICBoris<TM>::DoSetUp() {}
+void PICBoris<TM>::DoSetUp() {
+    base_type::DoSetUp();
+}
 template <typename TM>
-void PICBoris<TM>::DoUpdate() {}
+void PICBoris<TM>::DoUpdate() {
+    base_type::DoUpdate();
+}
 template <typename TM>
-void PICBoris<TM>::DoTearDown() {}
+void PICBoris<TM>::DoTearDown() {
+    base_type::DoTearDown();
+}
 
 template <typename TM>
 void PICBoris<TM>::DoInitialCondition(Real time_now) {}
 
 template <typename TM>
-void PICBoris<TM>::DoAdvance(Real time_now, Real dt) {}
+void PICBoris<TM>::DoAdvance(Real time_now, Real dt) {
+    auto dx = this->GetChart()->GetGridWidth(this->GetChart()->GetLevel());
+    Real inv_dx[3] = {1.0 / dx[0], 1.0 / dx[1], 1.0 / dx[2]};
+    J.Clear();
+    for (auto& item : m_particle_sp_) {
+        auto blk = item.second->GetDataBlock();
+        if (blk == nullptr) { continue; }
+        Real charge = item.second->template GetProperty<double>("charge");
+        Real cmr = charge / item.second->template GetProperty<double>("mass");
+        ParticleBorisPush(*blk, &E.GetData(0), &B.GetData(0), inv_dx, cmr, dt);
+        ParticleDepositCurrent(*blk, &J.GetData(0), inv_dx, charge, dt);
+        blk->Sort();
+    }
+}
 template <typename TM>
 void PICBoris<TM>::DoTagRefinementCells(Real time_now) {}
 
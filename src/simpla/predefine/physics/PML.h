@@ -149,29 +149,23 @@ template <typename TM>
 void PML<TM>::DoAdvance(Real time_now, Real time_dt) {
     DEFINE_PHYSICAL_CONST
 
-    dX2 = (X20 * (-2.0 * time_dt * s0) + curl_pdx(E) * time_dt) / (a0 + s0 * time_dt);
-    X20 += dX2;
-    B -= dX2;
-
-    dX2 = (X21 * (-2.0 * time_dt * s0) + curl_pdy(E) * time_dt) / (a1 + s1 * time_dt);
-    X21 += dX2;
-    B -= dX2;
-
-    dX2 = (X22 * (-2.0 * time_dt * s0) + curl_pdz(E) * time_dt) / (a2 + s2 * time_dt);
-    X22 += dX2;
-    B -= dX2;
-
-    dX1 = (X10 * (-2.0 * time_dt * s0) + curl_pdx(B) / (mu0 * epsilon0) * time_dt) / (a0 + s0 * time_dt);
-    X10 += dX1;
-    E += dX1;
-
-    dX1 = (X11 * (-2.0 * time_dt * s0) + curl_pdy(B) / (mu0 * epsilon0) * time_dt) / (a1 + s1 * time_dt);
-    X11 += dX1;
-    E += dX1;
-
-    dX1 = (X12 * (-2.0 * time_dt * s0) + curl_pdz(B) / (mu0 * epsilon0) * time_dt) / (a2 + s2 * time_dt);
-    X12 += dX1;
-    E += dX1;
+    // each half is one fused sweep, the stencil on B in the second half splits them
+    this->Fuse(assign(dX2, (X20 * (-2.0 * time_dt * s0) + curl_pdx(E) * time_dt) / (a0 + s0 * time_dt)),
+               assign(X20, X20 + dX2), assign(B, B - dX2),
+               assign(dX2, (X21 * (-2.0 * time_dt * s0) + curl_pdy(E) * time_dt) / (a1 + s1 * time_dt)),
+               assign(X21, X21 + dX2), assign(B, B - dX2),
+               assign(dX2, (X22 * (-2.0 * time_dt * s0) + curl_pdz(E) * time_dt) / (a2 + s2 * time_dt)),
+               assign(X22, X22 + dX2), assign(B, B - dX2),
+
+               assign(dX1, (X10 * (-2.0 * time_dt * s0) + curl_pdx(B) / (mu0 * epsilon0) * time_dt) /
+                               (a0 + s0 * time_dt)),
+               assign(X10, X10 + dX1), assign(E, E + dX1),
+               assign(dX1, (X11 * (-2.0 * time_dt * s0) + curl_pdy(B) / (mu0 * epsilon0) * time_dt) /
+                               (a1 + s1 * time_dt)),
+               assign(X11, X11 + dX1), assign(E, E + dX1),
+               assign(dX1, (X12 * (-2.0 * time_dt * s0) + curl_pdz(B) / (mu0 * epsilon0) * time_dt) /
+                               (a2 + s2 * time_dt)),
+               assign(X12, X12 + dX1), assign(E, E + dX1));
 }
 }  //    namespace  domain{
 }  // namespace simpla
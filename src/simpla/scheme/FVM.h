@@ -16,6 +16,7 @@
 #include "simpla/algebra/Calculus.h"
 #include "simpla/algebra/EntityId.h"
 #include "simpla/algebra/ExpressionTemplate.h"
+#include "simpla/algebra/SeparableArray.h"
 #include "simpla/engine/Attribute.h"
 #include "simpla/engine/Engine.h"
 #include "simpla/utilities/type_traits.h"
@@ -61,6 +62,14 @@ struct FVM {
     auto get_(nTuple<Array<V...>, N...> const& v, IdxShift S) const {
         return st::nt_get_r<I>(v).GetShift(S);
     }
+    template <int I, typename V>
+    auto get_(SeparableArray<V> const& v, IdxShift S) const {
+        return v.GetShift(S);
+    }
+    template <int I, typename V, int... N>
+    auto get_(nTuple<SeparableArray<V>, N...> const& v, IdxShift S) const {
+        return st::nt_get_r<I>(v).GetShift(S);
+    }
 
     template <int I, typename TOP, typename... Args>
     auto get_diff_expr(Expression<TOP, Args...> const& expr, IdxShift S) const {
@@ -85,7 +94,7 @@ struct FVM {
     }
     template <int I>
     auto _getV(std::integral_constant<int, NODE> _, IdxShift S) const {
-        return get_<I>(m_host_->m_vertex_volume_, S);
+        return get_<I>(m_host_->m_node_volume_, S);
     }
     template <int I>
     auto _getV(std::integral_constant<int, EDGE> _, IdxShift S) const {
@@ -97,12 +106,12 @@ struct FVM {
     }
     template <int I>
     auto _getV(std::integral_constant<int, CELL> _, IdxShift S) const {
-        return get_<I>(m_host_->m_volume_volume_, S);
+        return get_<I>(m_host_->m_cell_volume_, S);
     }
 
     template <int I>
     auto _getDualV(std::integral_constant<int, NODE> _, IdxShift S) const {
-        return get_<I>(m_host_->m_vertex_dual_volume_, S);
+        return get_<I>(m_host_->m_node_dual_volume_, S);
     }
 
     template <int I>
@@ -117,7 +126,7 @@ struct FVM {
 
     template <int I>
     auto _getDualV(std::integral_constant<int, CELL> _, IdxShift S) const {
-        return get_<I>(m_host_->m_volume_dual_volume_, S);
+        return get_<I>(m_host_->m_cell_dual_volume_, S);
     }
 
     template <int I, typename TExpr>
@@ -180,7 +189,7 @@ struct FVM {
 
         return ((getV<IX>(l, S + SX) - getV<IX>(l, S)) + (getV<IY>(l, S + SY) - getV<IY>(l, S)) +
                 (getV<IZ>(l, S + SZ) - getV<IZ>(l, S))) *
-               get_<0>(m_host_->m_volume_inv_volume_, S);
+               get_<0>(m_host_->m_cell_inv_volume_, S);
     }
 
     //! curl<2>
@@ -219,7 +228,7 @@ struct FVM {
         return ((getDualV<IX>(l, S) - getDualV<IX>(l, S - SX)) +  //
                 (getDualV<IY>(l, S) - getDualV<IY>(l, S - SY)) +  //
                 (getDualV<IZ>(l, S) - getDualV<IZ>(l, S - SZ))) *
-               (-get_<I>(m_host_->m_vertex_inv_dual_volume_, S));
+               (-get_<I>(m_host_->m_node_inv_dual_volume_, S));
 
         ;
     }
@@ -246,7 +255,7 @@ struct FVM {
                 getV<I>(l, S + IdxShift{0, 1, 0}) + getV<I>(l, S + IdxShift{0, 1, 1}) +
                 getV<I>(l, S + IdxShift{1, 0, 0}) + getV<I>(l, S + IdxShift{1, 0, 1}) +
                 getV<I>(l, S + IdxShift{1, 1, 0}) + getV<I>(l, S + IdxShift{1, 1, 1})) *
-               get_<I>(m_host_->m_volume_inv_volume_, S) * 0.125;
+               get_<I>(m_host_->m_cell_inv_volume_, S) * 0.125;
     };
     ////***************************************************************************************************
     //! p_curl<1>
@@ -579,12 +588,41 @@ struct FVM {
 
         return get_<IY>(l, S) * get_<IZ>(r, S) - get_<IZ>(l, S) * get_<IY>(r, S);
     }
+    //! product of two leaves as an expression, there is no operator* of two SeparableArrays
+    template <typename TL, typename TR>
+    static auto _product(TL const& l, TR const& r) {
+        return Expression<tags::multiplication, TL, TR>(l, r);
+    }
+    //! the coefficients of phi(S) in the fluxes of the edges W at S and at S - D
+    template <int W>
+    auto _getLaplacianDiagonal(IdxShift D) const {
+        IdxShift S{0, 0, 0};
+        return _product(get_<W>(m_host_->m_edge_dual_volume_, S), get_<W>(m_host_->m_edge_inv_volume_, S)) +
+               _product(get_<W>(m_host_->m_edge_dual_volume_, S - D), get_<W>(m_host_->m_edge_inv_volume_, S - D));
+    }
 
    public:
     template <int I, typename... TOP>
     decltype(auto) Calculate(Expression<TOP...> const& rhs) const {
         return get_<I>(rhs, IdxShift{0, 0, 0});
     };
+    /** component I of expr times the volume of its entity, the integrand of Domain::Integrate */
+    template <int I, typename TExpr>
+    decltype(auto) CalculateV(TExpr const& expr) const {
+        return getV<I>(expr, IdxShift{0, 0, 0});
+    };
+    /**
+     * diagonal of  codifferential_derivative(exterior_derivative(phi))  of a NODE form phi, from the volumes of the
+     * mesh, for linear_solver::JacobiPreconditioner
+     */
+    template <typename U>
+    void GetLaplacianDiagonal(Array<U>& diag) const {
+        IdxShift S{0, 0, 0};
+        diag = get_<0>(m_host_->m_node_volume_, S) *
+               (get_<0>(m_host_->m_node_inv_dual_volume_, S) *
+                (_getLaplacianDiagonal<0>(IdxShift{1, 0, 0}) + _getLaplacianDiagonal<1>(IdxShift{0, 1, 0}) +
+                 _getLaplacianDiagonal<2>(IdxShift{0, 0, 1})));
+    }
 
 };  // class FVM
 
@@ -0,0 +1,184 @@
+//
+// Registry of hierarchical wall clock timers.
+//
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <tuple>
+
+namespace simpla {
+typedef std::chrono::steady_clock profiler_clock;
+
+struct Profiler::pimpl_s {
+    struct Event {
+        std::string path;
+        size_type id;
+        //! in micro seconds since m_epoch_
+        Real ts;
+        Real dur;
+    };
+    struct ThreadData {
+        int tid = 0;
+        std::mutex m_mutex_;
+        std::vector<std::tuple<std::string, size_type, profiler_clock::time_point>> m_stack_;
+        std::map<std::string, Record> m_records_;
+        std::vector<Event> m_events_;
+    };
+    //! profilers of the same address are told apart by the serial number
+    size_type m_serial_ = 0;
+    std::atomic<bool> m_enable_{false};
+    std::atomic<bool> m_trace_{false};
+    profiler_clock::time_point m_epoch_ = profiler_clock::now();
+    std::mutex m_mutex_;
+    std::vector<std::unique_ptr<ThreadData>> m_threads_;
+
+    ThreadData &Local();
+};
+Profiler::pimpl_s::ThreadData &Profiler::pimpl_s::Local() {
+    static thread_local std::map<size_type, ThreadData *> local;
+    auto it = local.find(m_serial_);
+    if (it != local.end()) { return *it->second; }
+    std::lock_guard<std::mutex> lock(m_mutex_);
+    m_threads_.emplace_back(new ThreadData);
+    m_threads_.back()->tid = static_cast<int>(m_threads_.size() - 1);
+    local[m_serial_] = m_threads_.back().get();
+    return *m_threads_.back();
+}
+
+Profiler::Profiler() : m_pimpl_(new pimpl_s) {
+    static std::atomic<size_type> serial{0};
+    m_pimpl_->m_serial_ = serial++;
+}
+Profiler::~Profiler() { delete m_pimpl_; }
+Profiler &Profiler::Global() {
+    static Profiler res;
+    return res;
+}
+void Profiler::SetEnable(bool flag) { m_pimpl_->m_enable_ = flag; }
+bool Profiler::IsEnabled() const { return m_pimpl_->m_enable_; }
+void Profiler::SetTrace(bool flag) { m_pimpl_->m_trace_ = flag; }
+bool Profiler::IsTraceEnabled() const { return m_pimpl_->m_trace_; }
+
+void Profiler::Begin(std::string const &name, std::string const &parent, size_type id) {
+    auto &d = m_pimpl_->Local();
+    std::string path = !parent.empty() ? parent : d.m_stack_.empty() ? "" : std::get<0>(d.m_stack_.back());
+    path = path.empty() ? name : path + "/" + name;
+    d.m_stack_.emplace_back(std::move(path), id, profiler_clock::now());
+}
+void Profiler::End() {
+    auto t1 = profiler_clock::now();
+    auto &d = m_pimpl_->Local();
+    if (d.m_stack_.empty()) { return; }
+    auto &top = d.m_stack_.back();
+    Real dt = std::chrono::duration<Real>(t1 - std::get<2>(top)).count();
+    {
+        std::lock_guard<std::mutex> lock(d.m_mutex_);
+        auto &r = d.m_records_[std::get<0>(top)];
+        r.min = r.count == 0 ? dt : std::min(r.min, dt);
+        r.max = r.count == 0 ? dt : std::max(r.max, dt);
+        r.total += dt;
+        ++r.count;
+        if (m_pimpl_->m_trace_) {
+            d.m_events_.push_back(pimpl_s::Event{
+                std::get<0>(top), std::get<1>(top),
+                std::chrono::duration<Real, std::micro>(std::get<2>(top) - m_pimpl_->m_epoch_).count(), dt * 1.0e6});
+        }
+    }
+    d.m_stack_.pop_back();
+}
+std::string Profiler::GetPath() const {
+    auto &d = m_pimpl_->Local();
+    return d.m_stack_.empty() ? "" : std::get<0>(d.m_stack_.back());
+}
+
+std::vector<Profiler::Record> Profiler::GetRecords() const {
+    std::map<std::string, Record> merged;
+    std::lock_guard<std::mutex> lock(m_pimpl_->m_mutex_);
+    for (auto const &d : m_pimpl_->m_threads_) {
+        std::lock_guard<std::mutex> d_lock(d->m_mutex_);
+        for (auto const &item : d->m_records_) {
+            auto &r = merged[item.first];
+            r.min = r.count == 0 ? item.second.min : std::min(r.min, item.second.min);
+            r.max = r.count == 0 ? item.second.max : std::max(r.max, item.second.max);
+            r.total += item.second.total;
+            r.count += item.second.count;
+        }
+    }
+    std::vector<Record> res;
+    for (auto &item : merged) {
+        item.second.path = item.first;
+        res.push_back(item.second);
+    }
+    return res;
+}
+namespace detail {
+static std::string profiler_json_escape(std::string const &s) {
+    std::string res;
+    for (auto c : s) {
+        if (c == '"' || c == '\\') { res.push_back('\\'); }
+        res.push_back(c);
+    }
+    return res;
+}
+}  // namespace detail
+std::string Profiler::GetTraceEvents(int pid) const {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(3);
+    std::lock_guard<std::mutex> lock(m_pimpl_->m_mutex_);
+    for (auto const &d : m_pimpl_->m_threads_) {
+        std::lock_guard<std::mutex> d_lock(d->m_mutex_);
+        for (auto const &e : d->m_events_) {
+            auto path = detail::profiler_json_escape(e.path);
+            auto pos = path.rfind('/');
+            os << "{\"name\":\"" << (pos == std::string::npos ? path : path.substr(pos + 1)) << "\",\"ph\":\"X\""
+               << ",\"ts\":" << e.ts << ",\"dur\":" << e.dur << ",\"pid\":" << pid << ",\"tid\":" << d->tid
+               << ",\"args\":{\"path\":\"" << path << "\"";
+            if (e.id != NULL_ID) { os << ",\"id\":" << e.id; }
+            os << "}}," << std::endl;
+        }
+    }
+    return os.str();
+}
+std::ostream &Profiler::Report(std::ostream &os) const {
+    os << std::left << std::setw(60) << "timer" << std::right << std::setw(10) << "count" << std::setw(14)
+       << "total [s]" << std::setw(14) << "mean [s]" << std::setw(14) << "min [s]" << std::setw(14) << "max [s]"
+       << std::endl;
+    for (auto const &r : GetRecords()) {
+        auto depth = std::count(r.path.begin(), r.path.end(), '/');
+        auto pos = r.path.rfind('/');
+        os << std::left << std::setw(60)
+           << (std::string(static_cast<size_t>(depth * 2), ' ') +
+               (pos == std::string::npos ? r.path : r.path.substr(pos + 1)))
+           << std::right << std::setw(10) << r.count << std::setw(14) << r.total << std::setw(14)
+           << r.total / std::max<size_type>(r.count, 1) << std::setw(14) << r.min << std::setw(14) << r.max
+           << std::endl;
+    }
+    return os;
+}
+void Profiler::Clear() {
+    std::lock_guard<std::mutex> lock(m_pimpl_->m_mutex_);
+    for (auto const &d : m_pimpl_->m_threads_) {
+        std::lock_guard<std::mutex> d_lock(d->m_mutex_);
+        d->m_records_.clear();
+        d->m_events_.clear();
+    }
+    m_pimpl_->m_epoch_ = profiler_clock::now();
+}
+
+ProfilerScope::ProfilerScope(char const *name, std::string const &tag, size_type id, std::string const &parent) {
+    auto &p = Profiler::Global();
+    if (!p.IsEnabled()) { return; }
+    p.Begin(tag.empty() ? std::string(name) : std::string(name) + "[" + tag + "]", parent, id);
+    m_is_running_ = true;
+}
+ProfilerScope::~ProfilerScope() {
+    if (m_is_running_) { Profiler::Global().End(); }
+}
+}  // namespace simpla
@@ -0,0 +1,90 @@
+//
+// Registry of hierarchical wall clock timers.
+//
+
+#ifndef SIMPLA_PROFILER_H
+#define SIMPLA_PROFILER_H
+
+#include "simpla/SIMPLA_config.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace simpla {
+/** @ingroup toolbox
+ * @brief  Registry of hierarchical wall clock timers.
+ *
+ *  A timer is started by Begin and stopped by End of the same thread. It is named by its path, the path of the
+ *  running timer of the thread (or the given parent) and its own name, e.g.
+ *  "Step/Advance/Inner/Patch/Advance[EMFluid]".
+ *  Every thread keeps its own records and events, so a timer costs two clock reads and a map lookup, and nothing
+ *  if the profiler is disabled. If tracing is enabled, every timer is also kept as an event of a Chrome trace.
+ */
+class Profiler {
+   public:
+    Profiler();
+    ~Profiler();
+    Profiler(Profiler const &) = delete;
+    Profiler(Profiler &&) = delete;
+    Profiler &operator=(Profiler const &) = delete;
+    Profiler &operator=(Profiler &&) = delete;
+
+    static Profiler &Global();
+
+    void SetEnable(bool flag);
+    bool IsEnabled() const;
+    void SetTrace(bool flag);
+    bool IsTraceEnabled() const;
+
+    /**
+     * start the timer name, nested in parent, or in the running timer of the calling thread if parent is empty.
+     * id (e.g. the GUID of a patch) is an argument of the trace event, if it is not NULL_ID.
+     */
+    void Begin(std::string const &name, std::string const &parent = "", size_type id = NULL_ID);
+    void End();
+    /** path of the running timer of the calling thread, empty if there is none */
+    std::string GetPath() const;
+
+    struct Record {
+        std::string path;
+        size_type count = 0;
+        //! in seconds, sum / min / max of the calls
+        Real total = 0;
+        Real min = 0;
+        Real max = 0;
+    };
+    /** records of all threads merged by path, sorted by path */
+    std::vector<Record> GetRecords() const;
+    /** trace events of all threads as Chrome trace_event objects, one per line, each followed by a comma */
+    std::string GetTraceEvents(int pid = 0) const;
+    /** table of GetRecords */
+    std::ostream &Report(std::ostream &os) const;
+    void Clear();
+
+    static constexpr size_type NULL_ID = static_cast<size_type>(-1);
+
+   private:
+    struct pimpl_s;
+    pimpl_s *m_pimpl_ = nullptr;
+};
+
+/** Profiler::Global() timer of the enclosing scope, the path is "name[tag]" or "name" if tag is empty */
+class ProfilerScope {
+   public:
+    explicit ProfilerScope(char const *name, std::string const &tag = "", size_type id = Profiler::NULL_ID,
+                           std::string const &parent = "");
+    ~ProfilerScope();
+    ProfilerScope(ProfilerScope const &) = delete;
+    ProfilerScope &operator=(ProfilerScope const &) = delete;
+
+   private:
+    bool m_is_running_ = false;
+};
+}  // namespace simpla
+
+#define SP_PROFILE_CONCAT_(_A_, _B_) _A_##_B_
+#define SP_PROFILE_CONCAT(_A_, _B_) SP_PROFILE_CONCAT_(_A_, _B_)
+#define SP_PROFILE_SCOPE(...) simpla::ProfilerScope SP_PROFILE_CONCAT(_sp_profile_scope_, __LINE__)(__VA_ARGS__)
+
+#endif  // SIMPLA_PROFILER_H
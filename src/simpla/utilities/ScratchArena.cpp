@@ -0,0 +1,126 @@
+//
+// Stack-like allocator for temporary arrays.
+//
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+#include "Log.h"
+
+namespace simpla {
+namespace detail {
+static std::atomic<size_t> g_scratch_bytes_in_use{0};
+static std::atomic<size_t> g_scratch_peak_bytes{0};
+}  // namespace detail
+
+struct ScratchArena::pimpl_s {
+    struct chunk_s {
+        char *data;
+        size_t size;
+        size_t top;
+    };
+    struct block_s {
+        void *addr;
+        size_t chunk;
+        size_t offset;
+        size_t size;
+        bool is_free;
+    };
+    std::mutex m_mutex_;
+    std::vector<chunk_s> m_chunks_;
+    std::vector<block_s> m_blocks_;
+    size_t m_bytes_in_use_ = 0;
+    size_t m_peak_bytes_ = 0;
+    size_t m_num_of_chunk_alloc_ = 0;
+};
+
+ScratchArena::ScratchArena() : m_pimpl_(new pimpl_s) {}
+ScratchArena::~ScratchArena() {
+    if (!m_pimpl_->m_blocks_.empty()) { WARNING << "Scratch arena is destroyed with unreleased blocks." << std::endl; }
+    for (auto &c : m_pimpl_->m_chunks_) { free(c.data); }
+    delete m_pimpl_;
+}
+
+std::shared_ptr<ScratchArena> ScratchArena::Local() {
+    static thread_local std::shared_ptr<ScratchArena> arena = std::make_shared<ScratchArena>();
+    return arena;
+}
+
+void *ScratchArena::Allocate(size_t s) {
+    s = (s + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    std::lock_guard<std::mutex> lock(m_pimpl_->m_mutex_);
+    auto &chunks = m_pimpl_->m_chunks_;
+
+    // chunks above the one of the top block are empty
+    size_t n = m_pimpl_->m_blocks_.empty() ? 0 : m_pimpl_->m_blocks_.back().chunk;
+    while (n < chunks.size() && chunks[n].size - chunks[n].top < s) { ++n; }
+    if (n >= chunks.size()) {
+        pimpl_s::chunk_s c;
+        c.size = std::max(s, static_cast<size_t>(SP_SCRATCH_CHUNK_SIZE));
+        c.top = 0;
+        void *p = nullptr;
+        if (posix_memalign(&p, ALIGNMENT, c.size) != 0) { THROW_EXCEPTION_BAD_ALLOC(c.size); }
+        c.data = reinterpret_cast<char *>(p);
+        chunks.push_back(c);
+        n = chunks.size() - 1;
+        ++m_pimpl_->m_num_of_chunk_alloc_;
+    }
+    pimpl_s::block_s b;
+    b.chunk = n;
+    b.offset = chunks[n].top;
+    b.size = s;
+    b.addr = chunks[n].data + b.offset;
+    b.is_free = false;
+    chunks[n].top += s;
+    m_pimpl_->m_blocks_.push_back(b);
+
+    m_pimpl_->m_bytes_in_use_ += s;
+    m_pimpl_->m_peak_bytes_ = std::max(m_pimpl_->m_peak_bytes_, m_pimpl_->m_bytes_in_use_);
+    size_t total = (detail::g_scratch_bytes_in_use += s);
+    size_t peak = detail::g_scratch_peak_bytes.load();
+    while (total > peak && !detail::g_scratch_peak_bytes.compare_exchange_weak(peak, total)) {}
+    return b.addr;
+}
+
+void ScratchArena::Deallocate(void *p) {
+    if (p == nullptr) { return; }
+    std::lock_guard<std::mutex> lock(m_pimpl_->m_mutex_);
+    auto &blocks = m_pimpl_->m_blocks_;
+    auto it = std::find_if(blocks.rbegin(), blocks.rend(), [&](pimpl_s::block_s const &b) { return b.addr == p; });
+    if (it == blocks.rend() || it->is_free) {
+        RUNTIME_ERROR << "Release a block which is not allocated by this scratch arena!" << std::endl;
+        return;
+    }
+    it->is_free = true;
+    m_pimpl_->m_bytes_in_use_ -= it->size;
+    detail::g_scratch_bytes_in_use -= it->size;
+    while (!blocks.empty() && blocks.back().is_free) {
+        m_pimpl_->m_chunks_[blocks.back().chunk].top = blocks.back().offset;
+        blocks.pop_back();
+    }
+}
+
+void ScratchArena::Shrink() {
+    std::lock_guard<std::mutex> lock(m_pimpl_->m_mutex_);
+    auto &chunks = m_pimpl_->m_chunks_;
+    size_t n = m_pimpl_->m_blocks_.empty() ? 0 : m_pimpl_->m_blocks_.back().chunk + 1;
+    for (size_t i = n; i < chunks.size(); ++i) { free(chunks[i].data); }
+    if (n < chunks.size()) { chunks.resize(n); }
+}
+
+size_t ScratchArena::GetBytesInUse() const { return m_pimpl_->m_bytes_in_use_; }
+size_t ScratchArena::GetBytesReserved() const {
+    size_t res = 0;
+    for (auto const &c : m_pimpl_->m_chunks_) { res += c.size; }
+    return res;
+}
+size_t ScratchArena::GetPeakBytes() const { return m_pimpl_->m_peak_bytes_; }
+size_t ScratchArena::GetNumberOfChunkAllocations() const { return m_pimpl_->m_num_of_chunk_alloc_; }
+void ScratchArena::ResetPeak() { m_pimpl_->m_peak_bytes_ = m_pimpl_->m_bytes_in_use_; }
+
+size_t ScratchArena::GetTotalBytesInUse() { return detail::g_scratch_bytes_in_use.load(); }
+size_t ScratchArena::GetTotalPeakBytes() { return detail::g_scratch_peak_bytes.load(); }
+}  // namespace simpla
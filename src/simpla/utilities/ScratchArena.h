@@ -0,0 +1,69 @@
+//
+// Stack-like allocator for temporary arrays.
+//
+
+#ifndef SIMPLA_SCRATCHARENA_H
+#define SIMPLA_SCRATCHARENA_H
+
+#include "simpla/SIMPLA_config.h"
+
+#include <cstddef>
+#include <memory>
+
+#ifndef SP_SCRATCH_CHUNK_SIZE
+#define SP_SCRATCH_CHUNK_SIZE (32ul * 1024ul * 1024ul)
+#endif
+
+namespace simpla {
+/** @ingroup toolbox
+ * @brief  Stack-like allocator for temporary arrays (scratch fields), one per domain (view), see
+ *         AttributeGroup::GetScratchArena, or one per thread (Local).
+ *
+ *  Memory is taken from large chunks, which are kept after the temporaries are released, so the temporaries of
+ *  every time step reuse the same (already touched) pages instead of calling malloc/free. Blocks are expected to be
+ *  released in reverse order of allocation, as local variables are. A block released out of order is marked, and
+ *  its memory is reclaimed when the blocks above it are released.
+ */
+class ScratchArena : public std::enable_shared_from_this<ScratchArena> {
+   public:
+    ScratchArena();
+    ~ScratchArena();
+    ScratchArena(ScratchArena const &) = delete;
+    ScratchArena(ScratchArena &&) = delete;
+    ScratchArena &operator=(ScratchArena const &) = delete;
+    ScratchArena &operator=(ScratchArena &&) = delete;
+
+    /** arena of the calling thread */
+    static std::shared_ptr<ScratchArena> Local();
+
+    void *Allocate(size_t s);
+    void Deallocate(void *p);
+
+    /** the returned block keeps the arena alive, and goes back to the arena when the last reference is dropped */
+    template <typename T>
+    std::shared_ptr<T> MakeShared(size_t n) {
+        auto self = shared_from_this();
+        return std::shared_ptr<T>(reinterpret_cast<T *>(Allocate(n * sizeof(T))),
+                                  [self](T *p) { self->Deallocate(p); });
+    }
+    /** return unused chunks to the system */
+    void Shrink();
+
+    size_t GetBytesInUse() const;
+    size_t GetBytesReserved() const;
+    size_t GetPeakBytes() const;
+    size_t GetNumberOfChunkAllocations() const;
+    void ResetPeak();
+
+    /** statistics over the arenas of all threads */
+    static size_t GetTotalBytesInUse();
+    static size_t GetTotalPeakBytes();
+
+    static constexpr size_t ALIGNMENT = 64;
+
+   private:
+    struct pimpl_s;
+    pimpl_s *m_pimpl_ = nullptr;
+};
+}  // namespace simpla
+#endif  // SIMPLA_SCRATCHARENA_H
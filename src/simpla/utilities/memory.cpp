@@ -8,146 +8,253 @@
 
 #include "memory.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdlib>
 #include <cstring>
-#include <map>
 #include <mutex>
 #include <new>
-#include <tuple>
+#include <vector>
+#if defined(__unix__)
+#include <sys/mman.h>
+#endif
 #include "Log.h"
-#include "SingletonHolder.h"
 #include "device_common.h"
-#include "simpla/utilities/SingletonHolder.h"
 
 namespace simpla {
-class MemoryPool {
-   public:
-    typedef char byte_type;
-
-    MemoryPool();
-    ~MemoryPool();
-    MemoryPool(MemoryPool const &) = delete;
-    MemoryPool(MemoryPool &&) = delete;
-    MemoryPool &operator=(MemoryPool const &) = delete;
-    MemoryPool &operator=(MemoryPool &&) = delete;
-    //!  unused memory will be freed when total memory size >= pool size
-    void max_size(size_t s);
-
-    /**
-     *  return the total size of memory in pool
-     * @return
-     */
-    double size() const;
-
-    /**
-     *  push memory into pool
-     * @param d memory address
-     * @param s size of memory in byte
-     */
-    int push(void *p, size_t s, int loc = MANAGED_MEMORY);
-
-    /**
-     * allocate an array TV[s] from local pool or system memory
-     * if s < MIN_BLOCK_SIZE or s > MAX_BLOCK_SIZE or
-     *    s + pool_depth_> max_pool_depth_ then directly allocate
-     *    memory from system
-     *
-     * @param s size of memory in byte
-     * @return shared point of memory
-     */
-    void *pop(size_t s, int loc = MANAGED_MEMORY);
-
-    void clear();
-
-    std::mutex locker_;
-    std::multimap<size_t, void *> pool_;
-    std::multimap<size_t, void *> pool_dev_ptr_;
-
-    static constexpr size_t ONE_GIGA = 1024l * 1024l * 1024l;
-    static constexpr size_t MAX_BLOCK_SIZE = 4 * ONE_GIGA;  // std::numeric_limits<size_t>::max();
-    static constexpr size_t MIN_BLOCK_SIZE = 256;
-
-    size_t max_pool_depth_ = 16 * ONE_GIGA;
-    size_t pool_depth_ = 0;
+namespace detail {
+//! 2^MEMORY_POOL_CLASS_SHIFT size classes per power of two above MIN_BLOCK_SIZE
+static constexpr int MEMORY_POOL_CLASS_SHIFT = 2;
+static constexpr int MEMORY_POOL_MIN_POWER = 8;  // MIN_BLOCK_SIZE = 2^8
+static constexpr size_t MEMORY_POOL_NUM_OF_CLASSES = (32 - MEMORY_POOL_MIN_POWER) * (1 << MEMORY_POOL_CLASS_SHIFT) + 1;
+static constexpr size_t MEMORY_POOL_PAGE_SIZE = 4096;
+
+static size_t memory_pool_class(size_t s) {
+    if (s <= MemoryPool::MIN_BLOCK_SIZE) { return 0; }
+    // 2^p < s <= 2^(p+1)
+    int p = MEMORY_POOL_MIN_POWER;
+    while ((static_cast<size_t>(1) << (p + 1)) < s) { ++p; }
+    size_t step = static_cast<size_t>(1) << (p - MEMORY_POOL_CLASS_SHIFT);
+    size_t k = (s - (static_cast<size_t>(1) << p) + step - 1) / step;
+    return (p - MEMORY_POOL_MIN_POWER) * (1 << MEMORY_POOL_CLASS_SHIFT) + k;
+}
+static size_t memory_pool_class_size(size_t n) {
+    if (n == 0) { return MemoryPool::MIN_BLOCK_SIZE; }
+    int p = static_cast<int>((n - 1) >> MEMORY_POOL_CLASS_SHIFT) + MEMORY_POOL_MIN_POWER;
+    size_t k = ((n - 1) & ((1 << MEMORY_POOL_CLASS_SHIFT) - 1)) + 1;
+    return (static_cast<size_t>(1) << p) + k * (static_cast<size_t>(1) << (p - MEMORY_POOL_CLASS_SHIFT));
+}
+
+static void *memory_pool_system_alloc(size_t s, bool huge_page) {
+    void *addr = nullptr;
+#ifdef __CUDA__
+    SP_DEVICE_CALL(cudaMallocManaged(&addr, s));
+#else
+    size_t alignment =
+        (huge_page && s >= MemoryPool::HUGE_PAGE_SIZE) ? MemoryPool::HUGE_PAGE_SIZE : MemoryPool::ALIGNMENT;
+    if (posix_memalign(&addr, alignment, s) != 0) { THROW_EXCEPTION_BAD_ALLOC(s); }
+#if defined(MADV_HUGEPAGE)
+    if (alignment == MemoryPool::HUGE_PAGE_SIZE) { madvise(addr, s, MADV_HUGEPAGE); }
+#endif
+#endif
+    return addr;
+}
+static void memory_pool_system_free(void *p) {
+#ifdef __CUDA__
+    SP_DEVICE_CALL(cudaFree(p));
+#else
+    free(p);
+#endif
+}
+/**
+ * touch one byte of every page with a static schedule, as the parallel traversal of Array does, so pages are placed
+ * on the NUMA nodes of the threads which will use them
+ */
+static void memory_pool_first_touch(void *p, size_t s) {
+#ifndef __CUDA__
+    auto *b = reinterpret_cast<char *>(p);
+    auto num = static_cast<long>((s + MEMORY_POOL_PAGE_SIZE - 1) / MEMORY_POOL_PAGE_SIZE);
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < num; ++i) { b[i * MEMORY_POOL_PAGE_SIZE] = 0; }
+#endif
+}
+//! blocks released after the pool (or the thread cache) is destroyed go to the global pool (or the system)
+static std::atomic<bool> g_memory_pool_is_alive{false};
+static thread_local bool g_memory_pool_thread_cache_is_destroyed = false;
+}  // namespace detail
+
+struct MemoryPool::pimpl_s {
+    std::mutex m_mutex_;
+    std::vector<void *> m_free_[detail::MEMORY_POOL_NUM_OF_CLASSES];
+
+    size_t m_max_pool_depth_ = 16 * ONE_GIGA;
+    bool m_huge_page_ = true;
+    bool m_first_touch_ = true;
+
+    std::atomic<size_t> m_hits_{0};
+    std::atomic<size_t> m_misses_{0};
+    std::atomic<size_t> m_bytes_held_{0};
+    std::atomic<size_t> m_bytes_in_use_{0};
+    std::atomic<size_t> m_peak_bytes_in_use_{0};
+
+    /** put a free block to the global list of class n, or return it to the system if the pool is full */
+    void Release(void *p, size_t n) {
+        size_t s = detail::memory_pool_class_size(n);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex_);
+            if (m_bytes_held_ + s <= m_max_pool_depth_) {
+                m_free_[n].push_back(p);
+                m_bytes_held_ += s;
+                p = nullptr;
+            }
+        }
+        if (p != nullptr) { detail::memory_pool_system_free(p); }
+    }
 };
 
-MemoryPool::MemoryPool() { pool_depth_ = 0; }
-MemoryPool::~MemoryPool() { clear(); }
+/** free blocks of one thread, taken without locking */
+struct MemoryPool::thread_cache_s {
+    std::vector<void *> m_free_[detail::MEMORY_POOL_NUM_OF_CLASSES];
+    size_t m_depth_ = 0;
 
-//!  unused MemoryPool will be freed when total MemoryPool size >= pool size
-void MemoryPool::max_size(size_t s) { max_pool_depth_ = s; }
+    ~thread_cache_s() {
+        detail::g_memory_pool_thread_cache_is_destroyed = true;
+        Flush();
+    }
+    void Flush() {
+        bool pool_is_alive = detail::g_memory_pool_is_alive;
+        auto *pimpl = pool_is_alive ? MemoryPool::instance().m_pimpl_ : nullptr;
+        for (size_t n = 0; n < detail::MEMORY_POOL_NUM_OF_CLASSES; ++n) {
+            for (auto *p : m_free_[n]) {
+                if (pimpl != nullptr) {
+                    pimpl->m_bytes_held_ -= detail::memory_pool_class_size(n);
+                    pimpl->Release(p, n);
+                } else {
+                    detail::memory_pool_system_free(p);
+                }
+            }
+            m_free_[n].clear();
+        }
+        m_depth_ = 0;
+    }
+    static thread_cache_s *Local() {
+        if (detail::g_memory_pool_thread_cache_is_destroyed) { return nullptr; }
+        static thread_local thread_cache_s cache;
+        return &cache;
+    }
+};
+
+constexpr size_t MemoryPool::ONE_GIGA;
+constexpr size_t MemoryPool::MAX_BLOCK_SIZE;
+constexpr size_t MemoryPool::MIN_BLOCK_SIZE;
+constexpr size_t MemoryPool::ALIGNMENT;
+constexpr size_t MemoryPool::HUGE_PAGE_SIZE;
+constexpr size_t MemoryPool::MAX_THREAD_CACHE_BLOCK_SIZE;
+constexpr size_t MemoryPool::MAX_THREAD_CACHE_DEPTH;
+
+MemoryPool::MemoryPool() : m_pimpl_(new pimpl_s) { detail::g_memory_pool_is_alive = true; }
+MemoryPool::~MemoryPool() {
+    clear();
+    detail::g_memory_pool_is_alive = false;
+    delete m_pimpl_;
+}
+MemoryPool &MemoryPool::instance() {
+    static MemoryPool pool;
+    return pool;
+}
 
+//!  unused MemoryPool will be freed when total MemoryPool size >= pool size
+void MemoryPool::max_size(size_t s) { m_pimpl_->m_max_pool_depth_ = s; }
+size_t MemoryPool::max_size() const { return m_pimpl_->m_max_pool_depth_; }
 /**
  *  return the total size of MemoryPool in pool
  * @return
  */
-double MemoryPool::size() const { return static_cast<double>(pool_depth_); }
+double MemoryPool::size() const { return static_cast<double>(m_pimpl_->m_bytes_held_); }
 
 void MemoryPool::clear() {
-    locker_.lock();
-    for (auto &item : pool_) { delete[] reinterpret_cast<byte_type *>(item.second); }
-    locker_.unlock();
+    if (auto *cache = thread_cache_s::Local()) { cache->Flush(); }
+    std::lock_guard<std::mutex> lock(m_pimpl_->m_mutex_);
+    for (size_t n = 0; n < detail::MEMORY_POOL_NUM_OF_CLASSES; ++n) {
+        for (auto *p : m_pimpl_->m_free_[n]) { detail::memory_pool_system_free(p); }
+        m_pimpl_->m_bytes_held_ -= m_pimpl_->m_free_[n].size() * detail::memory_pool_class_size(n);
+        m_pimpl_->m_free_[n].clear();
+    }
+}
+void MemoryPool::EnableHugePage(bool flag) { m_pimpl_->m_huge_page_ = flag; }
+void MemoryPool::EnableFirstTouch(bool flag) { m_pimpl_->m_first_touch_ = flag; }
+
+size_t MemoryPool::BlockSize(size_t s) {
+    return s > MAX_BLOCK_SIZE ? s : detail::memory_pool_class_size(detail::memory_pool_class(s));
 }
 
 int MemoryPool::push(void *p, size_t s, int loc) {
-    if ((s > MIN_BLOCK_SIZE) && (s < MAX_BLOCK_SIZE)) {
-        locker_.lock();
-        if ((pool_depth_ + s < max_pool_depth_)) {
-            pool_.emplace(s, p);
-            pool_depth_ += s;
-            p = nullptr;
-        }
-        locker_.unlock();
-        if (p != nullptr) {
-#ifdef __CUDA__
-            SP_DEVICE_CALL(cudaFree(p));
-#else
-            free(p);
-#endif
-        }
+    if (p == nullptr) { return SP_SUCCESS; }
+    if (!detail::g_memory_pool_is_alive) {
+        detail::memory_pool_system_free(p);
+        return SP_SUCCESS;
+    }
+    size_t block_size = BlockSize(s);
+    m_pimpl_->m_bytes_in_use_ -= block_size;
+    if (s > MAX_BLOCK_SIZE) {
+        detail::memory_pool_system_free(p);
+        return SP_SUCCESS;
+    }
+    size_t n = detail::memory_pool_class(s);
+    auto *cache = block_size <= MAX_THREAD_CACHE_BLOCK_SIZE ? thread_cache_s::Local() : nullptr;
+    if (cache != nullptr && cache->m_depth_ + block_size <= MAX_THREAD_CACHE_DEPTH) {
+        cache->m_free_[n].push_back(p);
+        cache->m_depth_ += block_size;
+        m_pimpl_->m_bytes_held_ += block_size;
+    } else {
+        m_pimpl_->Release(p, n);
     }
     return SP_SUCCESS;
-    //    VERBOSE << SHORT_FILE_LINE_STAMP << "Free MemoryPool [" << s << " ]" << std::endl;
 }
 
 void *MemoryPool::pop(size_t s, int loc) {
     void *addr = nullptr;
-
-    if ((s > MIN_BLOCK_SIZE) && (s < MAX_BLOCK_SIZE)) {
-        locker_.lock();
-
-        // find MemoryPool block which is not smaller than demand size
-        auto pt = pool_.lower_bound(s);
-
-        if (pt != pool_.end()) {
-            size_t ts = 0;
-            std::tie(ts, addr) = *pt;
-            if (ts < s * 2) {
-                s = ts;
-                pool_.erase(pt);
-                pool_depth_ -= s;
-            } else {
-                addr = nullptr;
+    size_t block_size = BlockSize(s);
+    if (s <= MAX_BLOCK_SIZE) {
+        size_t n = detail::memory_pool_class(s);
+        auto *cache = block_size <= MAX_THREAD_CACHE_BLOCK_SIZE ? thread_cache_s::Local() : nullptr;
+        if (cache != nullptr && !cache->m_free_[n].empty()) {
+            addr = cache->m_free_[n].back();
+            cache->m_free_[n].pop_back();
+            cache->m_depth_ -= block_size;
+        } else {
+            std::lock_guard<std::mutex> lock(m_pimpl_->m_mutex_);
+            if (!m_pimpl_->m_free_[n].empty()) {
+                addr = m_pimpl_->m_free_[n].back();
+                m_pimpl_->m_free_[n].pop_back();
             }
         }
-        locker_.unlock();
     }
-
-    if (addr == nullptr) {
-        try {
-#ifdef __CUDA__
-            SP_DEVICE_CALL(cudaMallocManaged(&addr, s));
-#else
-            addr = malloc(s);
-#endif
-        } catch (std::bad_alloc const &error) { THROW_EXCEPTION_BAD_ALLOC(s); }
+    if (addr != nullptr) {
+        ++m_pimpl_->m_hits_;
+        m_pimpl_->m_bytes_held_ -= block_size;
+    } else {
+        ++m_pimpl_->m_misses_;
+        addr = detail::memory_pool_system_alloc(block_size, m_pimpl_->m_huge_page_);
+        if (m_pimpl_->m_first_touch_ && block_size > MAX_THREAD_CACHE_BLOCK_SIZE) {
+            detail::memory_pool_first_touch(addr, block_size);
+        }
     }
+    size_t in_use = (m_pimpl_->m_bytes_in_use_ += block_size);
+    size_t peak = m_pimpl_->m_peak_bytes_in_use_.load();
+    while (in_use > peak && !m_pimpl_->m_peak_bytes_in_use_.compare_exchange_weak(peak, in_use)) {}
     return addr;
 }
 
-// std::shared_ptr<void> sp_alloc_MemoryPool(size_t s) {
-//    void *addr = SingletonHolder<MemoryPool>::instance().pop(s);
-//    return std::shared_ptr<void>(addr, MemoryPool::deleter_s(addr, s));
-//}
-
+size_t MemoryPool::GetNumberOfHits() const { return m_pimpl_->m_hits_; }
+size_t MemoryPool::GetNumberOfMisses() const { return m_pimpl_->m_misses_; }
+size_t MemoryPool::GetBytesHeld() const { return m_pimpl_->m_bytes_held_; }
+size_t MemoryPool::GetBytesInUse() const { return m_pimpl_->m_bytes_in_use_; }
+size_t MemoryPool::GetPeakBytesInUse() const { return m_pimpl_->m_peak_bytes_in_use_; }
+void MemoryPool::ResetStatistics() {
+    m_pimpl_->m_hits_ = 0;
+    m_pimpl_->m_misses_ = 0;
+    m_pimpl_->m_peak_bytes_in_use_ = m_pimpl_->m_bytes_in_use_.load();
+}
 }  // namespace simpla
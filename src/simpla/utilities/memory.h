@@ -26,6 +26,80 @@ namespace simpla {
 
 enum { MANAGED_MEMORY, HOST_MEMORY, DEVICE_MEMORY };
 
+/**
+ * @brief  pooled allocator of memory blocks.
+ *
+ *  Requests are rounded up to size classes (four classes per power of two, so at most 25% of a block is wasted).
+ *  A released block is kept in the cache of the releasing thread, or, if it is large or the thread cache is full, in
+ *  the global free list of its class; it is returned to the system when the pool holds more than max_size() bytes.
+ *  Blocks are aligned to ALIGNMENT bytes, blocks not smaller than HUGE_PAGE_SIZE are aligned to huge pages. A block
+ *  fresh from the system is touched by an OpenMP static loop, so its pages are placed on the NUMA nodes of the
+ *  threads that traverse it.
+ */
+class MemoryPool {
+   public:
+    MemoryPool();
+    ~MemoryPool();
+    MemoryPool(MemoryPool const &) = delete;
+    MemoryPool(MemoryPool &&) = delete;
+    MemoryPool &operator=(MemoryPool const &) = delete;
+    MemoryPool &operator=(MemoryPool &&) = delete;
+
+    static MemoryPool &instance();
+
+    //!  unused memory will be freed when total memory size >= pool size
+    void max_size(size_t s);
+    size_t max_size() const;
+    /**
+     *  return the total size of memory in pool
+     * @return
+     */
+    double size() const;
+    /**
+     *  push memory into pool
+     * @param d memory address
+     * @param s size of memory in byte, the size passed to pop
+     */
+    int push(void *p, size_t s, int loc = MANAGED_MEMORY);
+    /**
+     * allocate s bytes from the thread cache, the global pool or the system
+     * @param s size of memory in byte
+     * @return address of memory
+     */
+    void *pop(size_t s, int loc = MANAGED_MEMORY);
+    /** return the blocks of the global pool and of the calling thread's cache to the system */
+    void clear();
+
+    void EnableHugePage(bool flag = true);
+    void EnableFirstTouch(bool flag = true);
+
+    size_t GetNumberOfHits() const;
+    size_t GetNumberOfMisses() const;
+    /** bytes of the free blocks held by the pool and the thread caches */
+    size_t GetBytesHeld() const;
+    /** bytes of the blocks handed out by pop and not yet pushed back */
+    size_t GetBytesInUse() const;
+    size_t GetPeakBytesInUse() const;
+    void ResetStatistics();
+
+    /** size class of s, the size of the block actually allocated */
+    static size_t BlockSize(size_t s);
+
+    static constexpr size_t ONE_GIGA = 1024l * 1024l * 1024l;
+    static constexpr size_t MAX_BLOCK_SIZE = 4 * ONE_GIGA;
+    static constexpr size_t MIN_BLOCK_SIZE = 256;
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t HUGE_PAGE_SIZE = 2l * 1024l * 1024l;
+    //! blocks larger than this bypass the thread cache
+    static constexpr size_t MAX_THREAD_CACHE_BLOCK_SIZE = 1024l * 1024l;
+    static constexpr size_t MAX_THREAD_CACHE_DEPTH = 32l * 1024l * 1024l;
+
+   private:
+    struct pimpl_s;
+    pimpl_s *m_pimpl_ = nullptr;
+    struct thread_cache_s;
+};
+
 template <typename T>
 int spMemoryAlloc(T **addr, size_t n, int location = MANAGED_MEMORY) {
     if (addr == nullptr) { return SP_FAILED; };
@@ -88,14 +162,17 @@ struct deleter_device_ptr_s {
 
     deleter_device_ptr_s &operator=(deleter_device_ptr_s &&) = default;
 
-    inline void operator()(void *ptr) { spMemoryFree(&ptr, m_size_); }
+    inline void operator()(void *ptr) { MemoryPool::instance().push(ptr, m_size_, m_loc_); }
 };
 }
 
+/**
+ * allocate  T[n] from the memory pool, the memory goes back to the pool when the last reference is dropped. Array,
+ * DataBlock and the MPI buffers allocate through this function.
+ */
 template <typename T>
 std::shared_ptr<T> spMakeShared(T *d, size_t n, int location = MANAGED_MEMORY) {
-    T *addr = nullptr;
-    spMemoryAlloc(&addr, n, location);
+    T *addr = reinterpret_cast<T *>(MemoryPool::instance().pop(n * sizeof(T), location));
     return std::shared_ptr<T>(addr, simpla::detail::deleter_device_ptr_s(addr, n * sizeof(T), location));
 }
 #ifdef __CUDA__
@@ -0,0 +1,108 @@
+//
+// Memory bandwidth of Array::Fill/CopyIn/Assign against STREAM-style raw loops.
+// Arguments are the edge length N of the N^3 box.
+//
+#include <benchmark/benchmark.h>
+#include <memory>
+#include "simpla/algebra/Array.h"
+
+using namespace simpla;
+
+static constexpr Real s = 3.0;
+
+static void BM_stream_copy(benchmark::State &state) {
+    auto n = static_cast<size_type>(state.range(0) * state.range(0) * state.range(0));
+    std::unique_ptr<Real[]> a(new Real[n]), b(new Real[n]);
+#pragma omp parallel for
+    for (size_type i = 0; i < n; ++i) {
+        a[i] = 0;
+        b[i] = i;
+    }
+    Real *pa = a.get();
+    Real const *pb = b.get();
+    while (state.KeepRunning()) {
+#pragma omp parallel for simd
+        for (size_type i = 0; i < n; ++i) { pa[i] = pb[i]; }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * n * 2 * sizeof(Real));
+}
+static void BM_stream_triad(benchmark::State &state) {
+    auto n = static_cast<size_type>(state.range(0) * state.range(0) * state.range(0));
+    std::unique_ptr<Real[]> a(new Real[n]), b(new Real[n]), c(new Real[n]);
+#pragma omp parallel for
+    for (size_type i = 0; i < n; ++i) {
+        a[i] = 0;
+        b[i] = i;
+        c[i] = i;
+    }
+    Real *pa = a.get();
+    Real const *pb = b.get();
+    Real const *pc = c.get();
+    while (state.KeepRunning()) {
+#pragma omp parallel for simd
+        for (size_type i = 0; i < n; ++i) { pa[i] = pb[i] + s * pc[i]; }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * n * 3 * sizeof(Real));
+}
+
+static index_box_type make_box(benchmark::State const &state) {
+    index_type n = state.range(0);
+    return index_box_type{{0, 0, 0}, {n, n, n}};
+}
+static void BM_array_fill(benchmark::State &state) {
+    Array<Real> a(make_box(state));
+    a.Fill(0);
+    while (state.KeepRunning()) {
+        a.Fill(s);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * a.size() * sizeof(Real));
+}
+static void BM_array_copy_in(benchmark::State &state) {
+    Array<Real> a(make_box(state)), b(make_box(state));
+    a.Fill(0);
+    b.Fill(1);
+    while (state.KeepRunning()) {
+        a.CopyIn(b);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * a.size() * 2 * sizeof(Real));
+}
+static void BM_array_triad(benchmark::State &state) {
+    Array<Real> a(make_box(state)), b(make_box(state)), c(make_box(state));
+    a.Fill(0);
+    b.Fill(1);
+    c.Fill(2);
+    while (state.KeepRunning()) {
+        a = b + s * c;
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * a.size() * 3 * sizeof(Real));
+}
+/**
+ * untiled traversal, i.e. the tile covers the whole box
+ */
+static void BM_array_triad_untiled(benchmark::State &state) {
+    ZSFC<3> sfc(make_box(state));
+    sfc.SetTileShape(nullptr);
+    Array<Real> a(sfc), b(sfc), c(sfc);
+    a.Fill(0);
+    b.Fill(1);
+    c.Fill(2);
+    while (state.KeepRunning()) {
+        a = b + s * c;
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * a.size() * 3 * sizeof(Real));
+}
+
+BENCHMARK(BM_stream_copy)->RangeMultiplier(2)->Range(32, 256)->UseRealTime();
+BENCHMARK(BM_array_copy_in)->RangeMultiplier(2)->Range(32, 256)->UseRealTime();
+BENCHMARK(BM_array_fill)->RangeMultiplier(2)->Range(32, 256)->UseRealTime();
+BENCHMARK(BM_stream_triad)->RangeMultiplier(2)->Range(32, 256)->UseRealTime();
+BENCHMARK(BM_array_triad)->RangeMultiplier(2)->Range(32, 256)->UseRealTime();
+BENCHMARK(BM_array_triad_untiled)->RangeMultiplier(2)->Range(32, 256)->UseRealTime();
+
+BENCHMARK_MAIN();
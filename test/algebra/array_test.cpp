@@ -92,6 +92,90 @@ TYPED_TEST(TestArray, self_assign) {
             0, std::abs(TestFixture::vB(i, j, k) - static_cast<typename TestFixture::value_type>(2 * (i + j + k))));
     }
 }
+TYPED_TEST(TestArray, tiled_copy) {
+    typedef typename TestFixture::type array_type;
+    typedef typename TestFixture::value_type value_type;
+    index_box_type b0 = {{-3, 0, 2}, {14, 9, 21}};
+    index_box_type b1 = {{1, -2, 5}, {20, 7, 17}};
+    index_type tile[3] = {3, 5, 4};
+    ZSFC<3> sfc(b0, FAST_FIRST);
+    sfc.SetTileShape(tile);
+    array_type u{sfc}, v{b1};
+
+    u = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+    v.Fill(TestFixture::d);
+    v.CopyIn(u);
+    for (index_type i = std::get<0>(b1)[0]; i < std::get<1>(b1)[0]; ++i)
+        for (index_type j = std::get<0>(b1)[1]; j < std::get<1>(b1)[1]; ++j)
+            for (index_type k = std::get<0>(b1)[2]; k < std::get<1>(b1)[2]; ++k) {
+                value_type expect = u.in_box(i, j, k) ? static_cast<value_type>(i * 100 + j * 10 + k)
+                                                       : TestFixture::d;
+                EXPECT_DOUBLE_EQ(0, std::abs(v(i, j, k) - expect));
+            }
+}
+TYPED_TEST(TestArray, copy_in_box) {
+    typedef typename TestFixture::type array_type;
+    typedef typename TestFixture::value_type value_type;
+    index_box_type b0 = {{-3, 0, 2}, {14, 9, 21}};
+    index_box_type b1 = {{1, -2, 5}, {20, 7, 17}};
+    index_box_type box = {{0, 1, 3}, {16, 8, 15}};
+    array_type u{b0}, v{b1}, f{ZSFC<3>(b1, FAST_FIRST)};
+    u = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+    for (auto* a : {&v, &f}) {
+        a->Fill(TestFixture::d);
+        a->CopyIn(static_cast<ArrayBase const&>(u), box);
+        for (index_type i = std::get<0>(b1)[0]; i < std::get<1>(b1)[0]; ++i)
+            for (index_type j = std::get<0>(b1)[1]; j < std::get<1>(b1)[1]; ++j)
+                for (index_type k = std::get<0>(b1)[2]; k < std::get<1>(b1)[2]; ++k) {
+                    bool in_box = u.in_box(i, j, k) && std::get<0>(box)[0] <= i && i < std::get<1>(box)[0] &&
+                                  std::get<0>(box)[1] <= j && j < std::get<1>(box)[1] &&
+                                  std::get<0>(box)[2] <= k && k < std::get<1>(box)[2];
+                    value_type expect = in_box ? static_cast<value_type>(i * 100 + j * 10 + k) : TestFixture::d;
+                    EXPECT_DOUBLE_EQ(0, std::abs((*a)(i, j, k) - expect));
+                }
+    }
+}
+/**
+ *  shifted operands are lowered to a pointer and a constant offset if they have the strides of the lhs, operands
+ *  of another shape or order are read through at()
+ */
+TYPED_TEST(TestArray, shifted_stencil) {
+    typedef typename TestFixture::type array_type;
+    typedef typename TestFixture::value_type value_type;
+    index_box_type b0 = {{-3, 0, 2}, {14, 9, 21}};
+    index_box_type b1 = {{-1, -2, 5}, {20, 7, 17}};
+    array_type u{b0}, w{b0}, v{b1}, f{ZSFC<3>(b0, FAST_FIRST)};
+    auto fun = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+    u = fun;
+    v = fun;
+    f = fun;
+    for (int n = 0; n < 2; ++n) {
+        w.Fill(TestFixture::d);
+        if (n == 0) {
+            w = (u.GetShift(IdxShift{0, 1, 0}) - u) * TestFixture::a + u.GetShift(IdxShift{0, 0, -1});
+        } else {
+            w = (v.GetShift(IdxShift{0, 1, 0}) - f) * TestFixture::a + u.GetShift(IdxShift{0, 0, -1});
+        }
+        // the shift moves the box of the operand, so u.GetShift(S)(idx) == u(idx - S)
+        index_box_type box = n == 0 ? b0 : b1;
+        std::get<0>(box)[1] += 1;
+        std::get<1>(box)[1] += 1;
+        box = detail::overlap<3>(b0, box);
+        std::get<1>(box)[2] = std::min(std::get<1>(box)[2], std::get<1>(b0)[2] - 1);
+        for (index_type i = std::get<0>(b0)[0]; i < std::get<1>(b0)[0]; ++i)
+            for (index_type j = std::get<0>(b0)[1]; j < std::get<1>(b0)[1]; ++j)
+                for (index_type k = std::get<0>(b0)[2]; k < std::get<1>(b0)[2]; ++k) {
+                    bool in_box = std::get<0>(box)[0] <= i && i < std::get<1>(box)[0] &&
+                                  std::get<0>(box)[1] <= j && j < std::get<1>(box)[1] &&
+                                  std::get<0>(box)[2] <= k && k < std::get<1>(box)[2];
+                    value_type expect = in_box ? static_cast<value_type>(fun(i, j - 1, k) - fun(i, j, k)) *
+                                                         TestFixture::a +
+                                                     static_cast<value_type>(fun(i, j, k + 1))
+                                               : TestFixture::d;
+                    EXPECT_DOUBLE_EQ(0, std::abs(w(i, j, k) - expect));
+                }
+    }
+}
 //
 // TYPED_TEST(TestArray, cross) {
 //    nTuple<typename TestFixture::value_type, 3> vA, vB, vC, vD;
@@ -0,0 +1,85 @@
+//
+// Fused assignment of Array expressions: pointwise, and with the lhs read by the rhs at a shift.
+//
+
+#include <gtest/gtest.h>
+
+#include "simpla/algebra/Array.h"
+#include "simpla/algebra/FusedAssign.h"
+using namespace simpla;
+
+class TestFusedAssign : public testing::Test {
+   public:
+    index_box_type idx_box = {{-3, 2, 5}, {19, 13, 22}};
+    Array<Real> a{idx_box}, b{idx_box}, c{idx_box}, ra{idx_box}, rc{idx_box};
+
+    void SetUp() override {
+        b = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+        a.Fill(0);
+        c.Fill(0);
+        ra.Fill(0);
+        rc.Fill(0);
+    }
+    /** same as DomainAssign: out of box operands read NaN */
+    template <typename RHS>
+    void Reference(Array<Real>& r, RHS const& rhs) {
+        r.GetSpaceFillingCurve().Foreach([&](index_type i, index_type j, index_type k) {
+            r.Set(simpla::detail::array_parser(rhs, i, j, k), i, j, k);
+        });
+    }
+    static void Check(Real v, Real expect) {
+        if (std::isnan(expect)) {
+            EXPECT_TRUE(std::isnan(v));
+        } else {
+            EXPECT_DOUBLE_EQ(v, expect);
+        }
+    }
+    void Check() const {
+        for (index_type i = std::get<0>(idx_box)[0]; i < std::get<1>(idx_box)[0]; ++i)
+            for (index_type j = std::get<0>(idx_box)[1]; j < std::get<1>(idx_box)[1]; ++j)
+                for (index_type k = std::get<0>(idx_box)[2]; k < std::get<1>(idx_box)[2]; ++k) {
+                    Check(a(i, j, k), ra(i, j, k));
+                    Check(c(i, j, k), rc(i, j, k));
+                }
+    }
+};
+
+TEST_F(TestFusedAssign, pointwise) {
+    FusedAssign loop;
+    loop.Push({MakeFusedKernel(a, b * 2.0 + 1.0, idx_box)});
+    loop.Push({MakeFusedKernel(c, a - b, idx_box)});
+    loop.Push({MakeFusedKernel(a, a + c, idx_box)});
+    loop.Flush();
+    EXPECT_EQ(loop.GetNumberOfSweeps(), 1);
+
+    Reference(ra, b * 2.0 + 1.0);
+    Reference(rc, ra - b);
+    Reference(ra, ra + rc);
+    Check();
+}
+
+TEST_F(TestFusedAssign, read_after_write) {
+    FusedAssign loop;
+    loop.Push({MakeFusedKernel(a, b * 2.0, idx_box)});
+    loop.Push({MakeFusedKernel(c, a.GetShift(IdxShift{1, 0, 0}) - a.GetShift(IdxShift{0, 0, -1}), idx_box)});
+    loop.Flush();
+    EXPECT_EQ(loop.GetNumberOfSweeps(), 2);
+
+    Reference(ra, b * 2.0);
+    Reference(rc, ra.GetShift(IdxShift{1, 0, 0}) - ra.GetShift(IdxShift{0, 0, -1}));
+    Check();
+}
+
+TEST_F(TestFusedAssign, write_after_read) {
+    a = b;
+    ra = b;
+    FusedAssign loop;
+    loop.Push({MakeFusedKernel(c, a.GetShift(IdxShift{0, -1, 0}) + b, idx_box)});
+    loop.Push({MakeFusedKernel(a, c * 0.5, idx_box)});
+    loop.Flush();
+    EXPECT_EQ(loop.GetNumberOfSweeps(), 2);
+
+    Reference(rc, ra.GetShift(IdxShift{0, -1, 0}) + b);
+    Reference(ra, rc * 0.5);
+    Check();
+}
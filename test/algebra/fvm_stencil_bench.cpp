@@ -0,0 +1,92 @@
+//
+// Throughput of the expression trees built by FVM::Calculate for curl/diverge/grad: the per point evaluation through
+// Array::at() ("old") against the lowered pointer + offset stencil of Array::Assign ("new").
+// Arguments are the edge length N of the N^3 box.
+//
+#include <benchmark/benchmark.h>
+#include "simpla/algebra/Array.h"
+
+using namespace simpla;
+
+static index_box_type make_box(benchmark::State const &state) {
+    index_type n = state.range(0);
+    return index_box_type{{-2, -2, -2}, {n + 2, n + 2, n + 2}};
+}
+static IdxShift shift(int n, index_type d) {
+    IdxShift s{0, 0, 0};
+    s[n] = d;
+    return s;
+}
+/** same trees as FVM::getV and FVM::get_, the operand times its volume, both shifted by S */
+static auto getV(Array<Real> const &f, Array<Real> const &vol, IdxShift const &S) {
+    return f.GetShift(S) * vol.GetShift(S);
+}
+/** Array::Assign before the lowering, every operand is read through at() */
+template <typename RHS>
+static void assign_old(Array<Real> &lhs, RHS const &rhs) {
+    Real *dst = lhs.get();
+    lhs.GetSpaceFillingCurve().Overlap(rhs).ForeachOffset([&](index_type s, auto &&... idx) {
+        dst[s] = detail::array_parser_in_box(rhs, std::forward<decltype(idx)>(idx)...);
+    });
+}
+struct Fields {
+    Array<Real> E[3], V[3], inv_V[3], phi, phi_V, res;
+    // all arrays of a patch have the same shape, the result covers the points where the stencil is in box
+    explicit Fields(index_box_type const &b) {
+        for (int n = 0; n < 3; ++n) {
+            E[n].reset(b);
+            V[n].reset(b);
+            inv_V[n].reset(b);
+            E[n] = [&](index_type i, index_type j, index_type k) { return i + 2 * j + 3 * k + n; };
+            V[n].Fill(1.0);
+            inv_V[n].Fill(1.0);
+        }
+        phi.reset(b);
+        phi_V.reset(b);
+        phi = [&](index_type i, index_type j, index_type k) { return i * j + k; };
+        phi_V.Fill(1.0);
+        res.reset(b);
+        res.Fill(0);
+    }
+    //! curl<1> , component 0
+    auto curl() const {
+        return ((getV(E[1], V[1], shift(2, 1)) - getV(E[1], V[1], shift(2, 0))) -
+                (getV(E[2], V[2], shift(1, 1)) - getV(E[2], V[2], shift(1, 0)))) *
+               inv_V[0];
+    }
+    //! div<2>
+    auto diverge() const {
+        return ((getV(E[0], V[0], shift(0, 1)) - getV(E[0], V[0], shift(0, 0))) +
+                (getV(E[1], V[1], shift(1, 1)) - getV(E[1], V[1], shift(1, 0))) +
+                (getV(E[2], V[2], shift(2, 1)) - getV(E[2], V[2], shift(2, 0)))) *
+               inv_V[0];
+    }
+    //! grad<0> , component 0
+    auto grad() const { return (getV(phi, phi_V, shift(0, 1)) - getV(phi, phi_V, shift(0, 0))) * inv_V[0]; }
+};
+
+#define SP_DEFINE_FVM_BENCH(_NAME_)                                                    \
+    static void BM_##_NAME_##_old(benchmark::State &state) {                           \
+        Fields f(make_box(state));                                                     \
+        while (state.KeepRunning()) {                                                  \
+            assign_old(f.res, f._NAME_());                                             \
+            benchmark::ClobberMemory();                                                \
+        }                                                                              \
+        state.SetItemsProcessed(state.iterations() * f.res.size());                    \
+    }                                                                                  \
+    static void BM_##_NAME_##_new(benchmark::State &state) {                           \
+        Fields f(make_box(state));                                                     \
+        while (state.KeepRunning()) {                                                  \
+            f.res = f._NAME_();                                                        \
+            benchmark::ClobberMemory();                                                \
+        }                                                                              \
+        state.SetItemsProcessed(state.iterations() * f.res.size());                    \
+    }                                                                                  \
+    BENCHMARK(BM_##_NAME_##_old)->RangeMultiplier(2)->Range(32, 128)->UseRealTime();  \
+    BENCHMARK(BM_##_NAME_##_new)->RangeMultiplier(2)->Range(32, 128)->UseRealTime();
+
+SP_DEFINE_FVM_BENCH(curl)
+SP_DEFINE_FVM_BENCH(diverge)
+SP_DEFINE_FVM_BENCH(grad)
+
+BENCHMARK_MAIN();
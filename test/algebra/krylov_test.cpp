@@ -0,0 +1,100 @@
+//
+// CG, BiCGStab and GMRES on a 7-point operator with a known solution.
+//
+
+#include <gtest/gtest.h>
+
+#include "simpla/algebra/Array.h"
+#include "simpla/algebra/Reduction.h"
+#include "simpla/numeric/Krylov.h"
+using namespace simpla;
+using namespace simpla::linear_solver;
+
+/**
+ * 7-point  (6 + sigma) x - sum(neighbours) + c (x(i+1) - x(i-1))  on the owned box [0,N)^3 of arrays with one layer
+ * of ghost cells, which are zero (Dirichlet).
+ */
+class TestKrylov : public testing::Test {
+   public:
+    static constexpr index_type N = 12;
+    index_box_type ghost_box = {{-1, -1, -1}, {N + 1, N + 1, N + 1}};
+    index_box_type box = {{0, 0, 0}, {N, N, N}};
+    Array<Real> x{ghost_box}, b{ghost_box}, solution{ghost_box}, diag{ghost_box};
+    Array<Real> w0{ghost_box}, w1{ghost_box}, w2{ghost_box}, w3{ghost_box}, w4{ghost_box}, w5{ghost_box},
+        w6{ghost_box};
+    std::vector<Array<Real>*> work{&w0, &w1, &w2, &w3, &w4, &w5, &w6};
+    KrylovSpace space;
+    Real c = 0;
+    std::function<void(Array<Real>&, Array<Real>&)> A = [&](Array<Real>& u, Array<Real>& y) {
+        for (index_type i = 0; i < N; ++i)
+            for (index_type j = 0; j < N; ++j)
+                for (index_type k = 0; k < N; ++k) {
+                    y(i, j, k) = diag(i, j, k) * u(i, j, k) - u(i + 1, j, k) - u(i - 1, j, k) - u(i, j + 1, k) -
+                                 u(i, j - 1, k) - u(i, j, k + 1) - u(i, j, k - 1) +
+                                 c * (u(i + 1, j, k) - u(i - 1, j, k));
+                }
+    };
+
+    void SetUp() override {
+        space.SetRange(0, x.GetSpaceFillingCurve().GetSelection(box));
+        for (auto* v : {&x, &b, &solution}) { v->Fill(0); }
+        diag = [&](index_type i, index_type j, index_type k) { return 6 + 0.5 * (i % 4) + 0.1 * k; };
+        solution = [&](index_type i, index_type j, index_type k) {
+            bool ghost = std::min({i, j, k}) < 0 || std::max({i, j, k}) >= N;
+            return ghost ? 0 : std::sin(0.3 * i + 0.2 * j) + 0.01 * k;
+        };
+    }
+    void SetProblem(Real convection) {
+        c = convection;
+        A(solution, b);
+    }
+    Real Error() const {
+        auto range = x.GetSpaceFillingCurve().GetSelection(box);
+        return Norm2(range, x - solution) / Norm2(range, solution);
+    }
+};
+
+TEST_F(TestKrylov, dot) {
+    auto range = x.GetSpaceFillingCurve().GetSelection(box);
+    Real xz = 0;
+    EXPECT_NEAR(space.Dot(solution, diag, &solution, &xz), Dot(range, solution, diag), 1.0e-10);
+    EXPECT_NEAR(xz, Dot(range, solution, solution), 1.0e-10);
+    Real yz = 0;
+    space.Clear(w0);
+    Real yy = space.UpdateDot(w0, 2.0, solution, 0, &diag, -1, &diag, &yz);
+    EXPECT_NEAR(yy, Dot(range, solution * 2.0 - diag, solution * 2.0 - diag), 1.0e-8);
+    EXPECT_NEAR(yz, Dot(range, solution * 2.0 - diag, diag), 1.0e-8);
+    // the ghost cells are out of range
+    EXPECT_DOUBLE_EQ(w0(-1, 3, 3), 0);
+}
+TEST_F(TestKrylov, cg) {
+    SetProblem(0);
+    auto status = CG(space, A, IdentityPreconditioner(), b, x, work);
+    EXPECT_TRUE(status.converged);
+    EXPECT_LT(Error(), 1.0e-6);
+}
+TEST_F(TestKrylov, cg_jacobi) {
+    SetProblem(0);
+    auto plain = CG(space, A, IdentityPreconditioner(), b, x, work);
+    x.Fill(0);
+    auto status = CG(space, A, JacobiPreconditioner<Array<Real>>(diag), b, x, work);
+    EXPECT_TRUE(status.converged);
+    EXPECT_LE(status.iterations, plain.iterations);
+    EXPECT_LT(Error(), 1.0e-6);
+}
+TEST_F(TestKrylov, bicgstab) {
+    SetProblem(0.8);
+    auto status = BiCGStab(space, A, JacobiPreconditioner<Array<Real>>(diag), b, x, work);
+    EXPECT_TRUE(status.converged);
+    EXPECT_LT(Error(), 1.0e-6);
+}
+TEST_F(TestKrylov, gmres) {
+    SetProblem(0.8);
+    KrylovControl ctl;
+    ctl.restart = 4;
+    std::vector<Array<Real>*> gmres_work{work.begin(), work.begin() + ctl.restart + 3};
+    auto status = GMRES(space, A, JacobiPreconditioner<Array<Real>>(diag), b, x, gmres_work, ctl);
+    EXPECT_TRUE(status.converged);
+    EXPECT_GT(status.iterations, ctl.restart);
+    EXPECT_LT(Error(), 1.0e-6);
+}
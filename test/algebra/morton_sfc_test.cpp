@@ -0,0 +1,89 @@
+//
+// Hash, assignment, shift and linearization of arrays on MortonSFC.
+//
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include "simpla/algebra/Array.h"
+#include "simpla/algebra/sfc/morton_sfc.h"
+using namespace simpla;
+
+class TestMortonSFC : public testing::Test {
+   public:
+    index_box_type idx_box = {{-3, 2, 5}, {11, 9, 22}};
+    Array<Real> zA{idx_box}, zB{idx_box};
+    Array<Real, MortonSFC<3>> mA{idx_box}, mB{idx_box};
+};
+
+#define BOX_FOREACH(_B_)                                                                   \
+    for (index_type i = std::get<0>(_B_)[0], ie = std::get<1>(_B_)[0]; i < ie; ++i)        \
+        for (index_type j = std::get<0>(_B_)[1], je = std::get<1>(_B_)[1]; j < je; ++j) \
+            for (index_type k = std::get<0>(_B_)[2], ke = std::get<1>(_B_)[2]; k < ke; ++k)
+
+TEST_F(TestMortonSFC, hash) {
+    MortonSFC<3> sfc(idx_box);
+    std::set<index_type> offsets;
+    BOX_FOREACH(idx_box) {
+        auto s = sfc.hash(i, j, k);
+        EXPECT_GE(s, 0);
+        EXPECT_LT(s, static_cast<index_type>(sfc.shape_size()));
+        offsets.insert(s);
+    }
+    EXPECT_EQ(offsets.size(), sfc.size());
+
+    size_type count = 0;
+    sfc.ForeachOffset([&](index_type s, index_type i, index_type j, index_type k) {
+        EXPECT_EQ(s, sfc.hash(i, j, k));
+#pragma omp atomic
+        ++count;
+    });
+    EXPECT_EQ(count, sfc.size());
+}
+
+TEST_F(TestMortonSFC, assign) {
+    zA = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+    mA = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+    BOX_FOREACH(idx_box) { EXPECT_DOUBLE_EQ(zA(i, j, k), mA(i, j, k)); }
+}
+
+TEST_F(TestMortonSFC, shift) {
+    zA = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+    mA = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+    zB.Fill(0);
+    mB.Fill(0);
+    // same shifted access as FVM::get_
+    zB = zA.GetShift(IdxShift{1, 0, 0}) - zA.GetShift(IdxShift{0, 0, -1});
+    mB = mA.GetShift(IdxShift{1, 0, 0}) - mA.GetShift(IdxShift{0, 0, -1});
+    BOX_FOREACH(idx_box) { EXPECT_DOUBLE_EQ(zB(i, j, k), mB(i, j, k)); }
+}
+
+TEST_F(TestMortonSFC, copy_from_smaller) {
+    index_box_type small_box = {{0, 3, 6}, {8, 7, 20}};
+    Array<Real, MortonSFC<3>> small{small_box};
+    small = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+    mA.Fill(-1);
+    EXPECT_EQ(mA.CopyIn(small), small.size());
+    BOX_FOREACH(idx_box) {
+        bool inside = small.GetSpaceFillingCurve().in_box(i, j, k);
+        EXPECT_DOUBLE_EQ(mA(i, j, k), inside ? i * 100 + j * 10 + k : -1);
+    }
+}
+
+TEST_F(TestMortonSFC, linearize) {
+    mA = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+    mA.Select(index_box_type{{0, 3, 6}, {8, 7, 20}});
+    EXPECT_FALSE(mA.isLinear());
+
+    auto res = std::dynamic_pointer_cast<Array<Real>>(mA.Linearize());
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_TRUE(res->isLinear());
+    for (int n = 0; n < 3; ++n) {
+        EXPECT_EQ(std::get<0>(res->GetShape())[n], std::get<0>(mA.GetShape())[n]);
+        EXPECT_EQ(std::get<1>(res->GetShape())[n], std::get<1>(mA.GetShape())[n]);
+        EXPECT_EQ(std::get<0>(res->GetIndexBox())[n], std::get<0>(mA.GetIndexBox())[n]);
+        EXPECT_EQ(std::get<1>(res->GetIndexBox())[n], std::get<1>(mA.GetIndexBox())[n]);
+    }
+    auto const* p = res->get();
+    BOX_FOREACH(idx_box) { EXPECT_DOUBLE_EQ(p[res->GetSpaceFillingCurve().hash(i, j, k)], mA(i, j, k)); }
+}
@@ -0,0 +1,60 @@
+//
+// Parallel reductions of arrays, expressions and ranges against serial sums.
+//
+
+#include <gtest/gtest.h>
+
+#include "simpla/algebra/Array.h"
+#include "simpla/algebra/Reduction.h"
+using namespace simpla;
+
+class TestReduction : public testing::Test {
+   public:
+    index_box_type idx_box = {{-3, 2, 5}, {19, 13, 22}};
+    Array<Real> a{idx_box}, b{idx_box};
+
+    void SetUp() override {
+        a = [&](index_type i, index_type j, index_type k) { return std::sin(0.1 * i + 0.2 * j + 0.3 * k); };
+        b = [&](index_type i, index_type j, index_type k) { return 0.01 * (i * 100 + j * 10 + k); };
+    }
+    template <typename TFun>
+    Real Fold(index_box_type const& box, Real init, TFun const& fun) const {
+        Real res = init;
+        for (index_type i = std::get<0>(box)[0]; i < std::get<1>(box)[0]; ++i)
+            for (index_type j = std::get<0>(box)[1]; j < std::get<1>(box)[1]; ++j)
+                for (index_type k = std::get<0>(box)[2]; k < std::get<1>(box)[2]; ++k) { res = fun(res, i, j, k); }
+        return res;
+    }
+};
+
+TEST_F(TestReduction, array) {
+    auto sum = Fold(idx_box, 0, [&](Real r, index_type i, index_type j, index_type k) { return r + a(i, j, k); });
+    auto sq = Fold(idx_box, 0,
+                   [&](Real r, index_type i, index_type j, index_type k) { return r + a(i, j, k) * a(i, j, k); });
+    auto dot = Fold(idx_box, 0,
+                    [&](Real r, index_type i, index_type j, index_type k) { return r + a(i, j, k) * b(i, j, k); });
+    EXPECT_NEAR(Sum(a), sum, 1.0e-10);
+    EXPECT_NEAR(Norm2(a), std::sqrt(sq), 1.0e-10);
+    EXPECT_NEAR(Dot(a, b), dot, 1.0e-10 * std::abs(dot));
+    EXPECT_DOUBLE_EQ(Max(b), b(18, 12, 21));
+    EXPECT_DOUBLE_EQ(Min(b), b(-3, 2, 5));
+}
+TEST_F(TestReduction, expression) {
+    IdxShift S{1, 0, 0};
+    // the shifted array at idx is b at idx - S
+    index_box_type box = {{-2, 2, 5}, {19, 13, 22}};
+    auto ref = Fold(box, 0, [&](Real r, index_type i, index_type j, index_type k) {
+        return r + (b(i, j, k) - b(i - 1, j, k)) * 2.0 + a(i, j, k);
+    });
+    EXPECT_NEAR(Sum(a.GetSpaceFillingCurve(), (b - b.GetShift(S)) * 2.0 + a), ref, 1.0e-10 * std::abs(ref));
+}
+TEST_F(TestReduction, range) {
+    index_box_type box = {{0, 4, 7}, {5, 9, 11}};
+    auto range = a.GetSpaceFillingCurve().GetSelection(box);
+    auto ref = Fold(box, -std::numeric_limits<Real>::infinity(),
+                    [&](Real r, index_type i, index_type j, index_type k) { return std::max(r, a(i, j, k)); });
+    EXPECT_DOUBLE_EQ(Max(range, a), ref);
+    EXPECT_DOUBLE_EQ(Sum(range, b), Fold(box, 0, [&](Real r, index_type i, index_type j, index_type k) {
+                         return r + b(i, j, k);
+                     }));
+}
@@ -0,0 +1,63 @@
+//
+// Factorization of SeparableArray and its use as a leaf of Array expressions.
+//
+
+#include <gtest/gtest.h>
+
+#include "simpla/algebra/Array.h"
+#include "simpla/algebra/SeparableArray.h"
+using namespace simpla;
+
+class TestSeparableArray : public testing::Test {
+   public:
+    index_box_type idx_box = {{-4, 2, 5}, {19, 13, 22}};
+    SeparableArray<Real> m{idx_box};
+    Array<Real> full{idx_box}, f{idx_box}, r0{idx_box}, r1{idx_box};
+
+    //! area of a face with normal Z in cylindrical coordinates, (r1^2-r0^2)/2 * dphi
+    static Real fun(index_type i, index_type j, index_type k) {
+        Real r0 = 0.1 * i, r1 = 0.1 * (i + 1);
+        return 0.5 * (r1 * r1 - r0 * r0) * 0.01 * (j - 4);
+    }
+    void SetUp() override {
+        m.Factorize(&fun);
+        full = [&](index_type i, index_type j, index_type k) { return fun(i, j, k); };
+        f = [&](index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; };
+        r0.Fill(0);
+        r1.Fill(0);
+    }
+    void Check(Array<Real> const& a, Array<Real> const& b) const {
+        for (index_type i = std::get<0>(idx_box)[0] + 1; i < std::get<1>(idx_box)[0] - 1; ++i)
+            for (index_type j = std::get<0>(idx_box)[1] + 1; j < std::get<1>(idx_box)[1] - 1; ++j)
+                for (index_type k = std::get<0>(idx_box)[2] + 1; k < std::get<1>(idx_box)[2] - 1; ++k) {
+                    EXPECT_NEAR(a.Get(i, j, k), b.Get(i, j, k), 1.0e-12 * (1 + std::abs(b.Get(i, j, k))));
+                }
+    }
+};
+
+TEST_F(TestSeparableArray, factorize) {
+    for (index_type i = std::get<0>(idx_box)[0]; i < std::get<1>(idx_box)[0]; ++i)
+        for (index_type j = std::get<0>(idx_box)[1]; j < std::get<1>(idx_box)[1]; ++j)
+            for (index_type k = std::get<0>(idx_box)[2]; k < std::get<1>(idx_box)[2]; ++k) {
+                EXPECT_NEAR(m(i, j, k), fun(i, j, k), 1.0e-15);
+            }
+}
+TEST_F(TestSeparableArray, inverse) {
+    auto inv = m.Inverse();
+    // fun vanishes at j == 4 , so does its inverse
+    EXPECT_DOUBLE_EQ(inv(3, 4, 6), 0);
+    EXPECT_NEAR(inv(3, 5, 6) * fun(3, 5, 6), 1, 1.0e-12);
+    EXPECT_DOUBLE_EQ((-m)(3, 5, 6), -m(3, 5, 6));
+}
+TEST_F(TestSeparableArray, expression) {
+    IdxShift S{1, 0, 0};
+    r0 = (f.GetShift(S) * full.GetShift(S) - f * full) * 0.5;
+    r1 = (f.GetShift(S) * m.GetShift(S) - f * m) * 0.5;
+    Check(r1, r0);
+}
+TEST_F(TestSeparableArray, expression_negative_shift) {
+    IdxShift S{0, -1, 1};
+    r0 = f * full.GetShift(S) + (-full);
+    r1 = f * m.GetShift(S) + (-m);
+    Check(r1, r0);
+}
@@ -0,0 +1,75 @@
+//
+// Array::Assign of a triad and of a 7 point stencil, Array::CopyIn of a whole patch and of one halo face, as
+// Atlas::SyncLocal copies it. Arguments are the edge length N of the N^3 box.
+//
+#include <benchmark/benchmark.h>
+#include "simpla/algebra/Array.h"
+
+namespace simpla {
+static const index_type HALO = 3;
+
+static index_box_type make_box(benchmark::State const &state) {
+    index_type n = state.range(0);
+    return index_box_type{{-HALO, -HALO, -HALO}, {n + HALO, n + HALO, n + HALO}};
+}
+static IdxShift shift(int n, index_type d) {
+    IdxShift s{0, 0, 0};
+    s[n] = d;
+    return s;
+}
+static void BM_array_assign_triad(benchmark::State &state) {
+    Array<Real> a(make_box(state)), b(make_box(state)), c(make_box(state));
+    a.Fill(0);
+    b.Fill(1);
+    c.Fill(2);
+    while (state.KeepRunning()) {
+        a = b + 3.0 * c;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * a.size());
+    state.SetBytesProcessed(state.iterations() * a.size() * 3 * sizeof(Real));
+}
+static void BM_array_assign_stencil(benchmark::State &state) {
+    Array<Real> a(make_box(state)), b(make_box(state));
+    a.Fill(0);
+    b = [](index_type i, index_type j, index_type k) { return i + 2 * j + 3 * k; };
+    while (state.KeepRunning()) {
+        a = (b.GetShift(shift(0, 1)) + b.GetShift(shift(0, -1)) + b.GetShift(shift(1, 1)) +
+             b.GetShift(shift(1, -1)) + b.GetShift(shift(2, 1)) + b.GetShift(shift(2, -1))) -
+            6.0 * b;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * a.size());
+    state.SetBytesProcessed(state.iterations() * a.size() * 2 * sizeof(Real));
+}
+static void BM_array_copy_in(benchmark::State &state) {
+    Array<Real> a(make_box(state)), b(make_box(state));
+    a.Fill(0);
+    b.Fill(1);
+    while (state.KeepRunning()) {
+        a.CopyIn(b);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * a.size());
+    state.SetBytesProcessed(state.iterations() * a.size() * 2 * sizeof(Real));
+}
+//! the upper x halo of a, filled from b
+static void BM_array_copy_in_halo(benchmark::State &state) {
+    index_type n = state.range(0);
+    Array<Real> a(make_box(state)), b(make_box(state));
+    a.Fill(0);
+    b.Fill(1);
+    index_box_type halo{{n, -HALO, -HALO}, {n + HALO, n + HALO, n + HALO}};
+    auto num = static_cast<size_type>(HALO * (n + 2 * HALO) * (n + 2 * HALO));
+    while (state.KeepRunning()) {
+        a.CopyIn(b, halo);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * num);
+    state.SetBytesProcessed(state.iterations() * num * 2 * sizeof(Real));
+}
+BENCHMARK(BM_array_assign_triad)->RangeMultiplier(2)->Range(32, 128)->UseRealTime();
+BENCHMARK(BM_array_assign_stencil)->RangeMultiplier(2)->Range(32, 128)->UseRealTime();
+BENCHMARK(BM_array_copy_in)->RangeMultiplier(2)->Range(32, 128)->UseRealTime();
+BENCHMARK(BM_array_copy_in_halo)->RangeMultiplier(2)->Range(32, 128)->UseRealTime();
+}  // namespace simpla
@@ -0,0 +1,84 @@
+//
+// Checkpoint write of one patch set: the tree of Scenario::CheckPoint (chart, mesh blocks and the E / B arrays of
+// 2^3 patches) written through the backend of the file suffix, "h5" (one file per process), "ph5" (shared file,
+// collective writes) and "xdmf" (HDF5 + XDMF description).
+// Arguments are the backend (0 h5, 1 ph5, 2 xdmf) and the edge length N of the N^3 patch.
+//
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include "simpla/SIMPLA_config.h"
+
+#include "simpla/data/DataEntry.h"
+#include "simpla/engine/Attribute.h"
+#include "simpla/engine/MeshBlock.h"
+#include "simpla/engine/Patch.h"
+#include "simpla/geometry/csCartesian.h"
+
+namespace simpla {
+using namespace simpla::data;
+using namespace simpla::engine;
+static const index_type NUM_OF_PATCHES = 2;
+static char const *CHECKPOINT_SUFFIX[] = {"h5", "ph5", "xdmf"};
+
+struct CheckPointFields : public AttributeGroup {
+    AttributeT<Real, EDGE> E{this, "Name"_ = "E"};
+    AttributeT<Real, FACE> B{this, "Name"_ = "B"};
+};
+
+static void BM_checkpoint_write(benchmark::State &state) {
+    auto suffix = CHECKPOINT_SUFFIX[state.range(0)];
+    index_type n = state.range(1);
+    auto chart = geometry::csCartesian::New(point_type{0, 0, 0}, point_type{0.01, 0.01, 0.01});
+    CheckPointFields f;
+    std::vector<std::shared_ptr<Patch>> patches;
+    for (index_type i = 0; i < NUM_OF_PATCHES; ++i)
+        for (index_type j = 0; j < NUM_OF_PATCHES; ++j)
+            for (index_type k = 0; k < NUM_OF_PATCHES; ++k) {
+                index_box_type const b{{i * n, j * n, k * n}, {(i + 1) * n, (j + 1) * n, (k + 1) * n}};
+                for (int d = 0; d < 3; ++d) {
+                    f.E[d].reset(b);
+                    f.B[d].reset(b);
+                    f.E[d] = [&](index_type x, index_type y, index_type z) { return std::sin(0.1 * (x + y + z + d)); };
+                    f.B[d] = [&](index_type x, index_type y, index_type z) { return std::cos(0.1 * (x - y + z + d)); };
+                }
+                patches.push_back(Patch::New(MeshBlock::New(b)));
+                auto blk = f.Pop();
+                blk->SetMeshBlock(patches.back()->GetMeshBlock());
+                patches.back()->Push(blk);
+            }
+    std::string path = std::string("simpla_bench_checkpoint.") + suffix;
+    while (state.KeepRunning()) {
+        // same tree as Scenario::CheckPoint
+        auto dump = data::DataEntry::New(data::DataEntry::DN_TABLE);
+        dump->Set("Atlas/Chart", chart->Serialize());
+        auto d_patches = dump->CreateNode("Atlas/Patches", data::DataEntry::DN_TABLE);
+        for (auto const &patch : patches) {
+            auto d_patch = d_patches->CreateNode(std::to_string(patch->GetGUID()), data::DataEntry::DN_TABLE);
+            d_patch->Set("MeshBlock", patch->GetMeshBlock()->Serialize());
+            auto d_attrs = d_patch->CreateNode("Attributes", data::DataEntry::DN_TABLE);
+            for (auto const &item : patch->GetAllDataBlocks()) { d_attrs->Set(item.first, item.second); }
+        }
+        dump->SetValue<Real>("Time", 0);
+        auto file = data::DataEntry::New(path);
+        file->Set(dump);
+        file->Flush();
+    }
+    auto num = static_cast<size_type>(n * n * n * NUM_OF_PATCHES * NUM_OF_PATCHES * NUM_OF_PATCHES);
+    state.SetLabel(suffix);
+    state.SetItemsProcessed(state.iterations() * num);
+    state.SetBytesProcessed(state.iterations() * num * 6 * sizeof(Real));
+    // the xdmf backend writes the arrays to <prefix>.h5 and the description to <prefix>.xmf
+    std::remove(path.c_str());
+    std::remove("simpla_bench_checkpoint.h5");
+    std::remove("simpla_bench_checkpoint.xmf");
+}
+BENCHMARK(BM_checkpoint_write)
+    ->Args({0, 32})
+    ->Args({1, 32})
+    ->Args({2, 32})
+    ->Args({0, 64})
+    ->Args({1, 64})
+    ->Args({2, 64})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace simpla
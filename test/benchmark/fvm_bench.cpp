@@ -0,0 +1,155 @@
+//
+// FVM curl / diverge / grad of the fields of a domain on one patch, CoRectMesh (csCartesian, constant metric) and
+// RectMesh (csCylindrical, separable metric), through the same Field assignment DoAdvance uses.
+// Arguments are the edge length N of the N^3 patch.
+//
+#include <benchmark/benchmark.h>
+#include "simpla/SIMPLA_config.h"
+
+#include "simpla/algebra/Algebra.h"
+#include "simpla/engine/Domain.h"
+#include "simpla/engine/MeshBlock.h"
+#include "simpla/physics/Field.h"
+#include "simpla/predefine/physics/PredefineDomains.h"
+
+namespace simpla {
+using namespace simpla::data;
+/** the four forms a stencil reads and writes */
+template <typename TDomain>
+class StencilBench : public TDomain {
+    SP_DOMAIN_HEAD(StencilBench, TDomain);
+
+    FIELD(phi, Real, NODE);
+    FIELD(E, Real, EDGE);
+    FIELD(B, Real, FACE);
+    FIELD(rho, Real, CELL);
+};
+template <typename TDomain>
+bool StencilBench<TDomain>::_is_registered =
+    Factory<TDomain>::template RegisterCreator<StencilBench<TDomain>>("StencilBench");
+template <typename TDomain>
+StencilBench<TDomain>::StencilBench() : base_type() {}
+template <typename TDomain>
+StencilBench<TDomain>::~StencilBench() {}
+template <typename TDomain>
+void StencilBench<TDomain>::DoSetUp() {
+    base_type::DoSetUp();
+}
+template <typename TDomain>
+void StencilBench<TDomain>::DoUpdate() {
+    base_type::DoUpdate();
+}
+template <typename TDomain>
+void StencilBench<TDomain>::DoTearDown() {
+    base_type::DoTearDown();
+}
+template <typename TDomain>
+void StencilBench<TDomain>::DoTagRefinementCells(Real time_now) {}
+template <typename TDomain>
+void StencilBench<TDomain>::DoInitialCondition(Real time_now) {}
+template <typename TDomain>
+void StencilBench<TDomain>::DoAdvance(Real time_now, Real time_dt) {}
+
+template <typename TDomain>
+struct StencilBenchTraits;
+template <>
+struct StencilBenchTraits<CartesianFVM> {
+    static std::shared_ptr<geometry::Chart> chart() {
+        return geometry::csCartesian::New(point_type{0, 0, 0}, point_type{0.01, 0.01, 0.01});
+    }
+};
+template <>
+struct StencilBenchTraits<CylindricalFVM> {
+    //! R is off the axis, so that no metric factor vanishes
+    static std::shared_ptr<geometry::Chart> chart() {
+        return geometry::csCylindrical::New(point_type{1, 0, 0}, point_type{0.01, 0.01, 0.01});
+    }
+};
+/** a domain bound to one N^3 patch with its metric set up, as Bind and PreInitialCondition leave it */
+template <typename TDomain>
+std::shared_ptr<StencilBench<TDomain>> make_stencil_domain(benchmark::State const &state) {
+    index_type n = state.range(0);
+    auto d = StencilBench<TDomain>::New();
+    d->SetChart(StencilBenchTraits<TDomain>::chart());
+    d->SetUp();
+    d->SetMeshBlock(engine::MeshBlock::New(index_box_type{{0, 0, 0}, {n, n, n}}));
+    d->PreInitialCondition(d.get(), 0);
+    d->phi = [](point_type const &x) { return std::sin(x[0]) * std::cos(x[1]) + x[2]; };
+    d->E = [](point_type const &x) { return point_type{std::sin(x[1]), std::cos(x[2]), x[0] * x[1]}; };
+    d->B = [](point_type const &x) { return point_type{x[1] * x[2], std::sin(x[0]), std::cos(x[1])}; };
+    d->rho = 0.0;
+    return d;
+}
+/** cells/s, and bytes/s of the components read and written once per cell */
+static void set_processed(benchmark::State &state, int num_of_components) {
+    auto num = static_cast<size_type>(state.range(0) * state.range(0) * state.range(0));
+    state.SetItemsProcessed(state.iterations() * num);
+    state.SetBytesProcessed(state.iterations() * num * num_of_components * sizeof(Real));
+}
+
+template <typename TDomain>
+static void BM_fvm_curl_edge(benchmark::State &state) {
+    auto d = make_stencil_domain<TDomain>(state);
+    while (state.KeepRunning()) {
+        d->B = curl(d->E);
+        benchmark::ClobberMemory();
+    }
+    set_processed(state, 6);
+}
+template <typename TDomain>
+static void BM_fvm_curl_face(benchmark::State &state) {
+    auto d = make_stencil_domain<TDomain>(state);
+    while (state.KeepRunning()) {
+        d->E = curl(d->B);
+        benchmark::ClobberMemory();
+    }
+    set_processed(state, 6);
+}
+template <typename TDomain>
+static void BM_fvm_diverge(benchmark::State &state) {
+    auto d = make_stencil_domain<TDomain>(state);
+    while (state.KeepRunning()) {
+        d->rho = diverge(d->B);
+        benchmark::ClobberMemory();
+    }
+    set_processed(state, 4);
+}
+template <typename TDomain>
+static void BM_fvm_grad(benchmark::State &state) {
+    auto d = make_stencil_domain<TDomain>(state);
+    while (state.KeepRunning()) {
+        d->E = grad(d->phi);
+        benchmark::ClobberMemory();
+    }
+    set_processed(state, 4);
+}
+//! energy of E on the patch: one sweep over the three components and the edge volumes
+template <typename TDomain>
+static void BM_fvm_integrate(benchmark::State &state) {
+    auto d = make_stencil_domain<TDomain>(state);
+    Real res = 0;
+    while (state.KeepRunning()) { benchmark::DoNotOptimize(res += d->Integrate(d->E, d->E)); }
+    set_processed(state, 3);
+}
+template <typename TDomain>
+static void BM_fvm_dot(benchmark::State &state) {
+    auto d = make_stencil_domain<TDomain>(state);
+    Real res = 0;
+    while (state.KeepRunning()) { benchmark::DoNotOptimize(res += d->Dot(d->E, d->E)); }
+    set_processed(state, 3);
+}
+#define SP_FVM_BENCH(_FUN_, _DOMAIN_) \
+    BENCHMARK_TEMPLATE(_FUN_, _DOMAIN_)->RangeMultiplier(2)->Range(32, 128)->UseRealTime();
+
+SP_FVM_BENCH(BM_fvm_curl_edge, CartesianFVM)
+SP_FVM_BENCH(BM_fvm_curl_edge, CylindricalFVM)
+SP_FVM_BENCH(BM_fvm_curl_face, CartesianFVM)
+SP_FVM_BENCH(BM_fvm_curl_face, CylindricalFVM)
+SP_FVM_BENCH(BM_fvm_diverge, CartesianFVM)
+SP_FVM_BENCH(BM_fvm_diverge, CylindricalFVM)
+SP_FVM_BENCH(BM_fvm_grad, CartesianFVM)
+SP_FVM_BENCH(BM_fvm_grad, CylindricalFVM)
+SP_FVM_BENCH(BM_fvm_integrate, CartesianFVM)
+SP_FVM_BENCH(BM_fvm_integrate, CylindricalFVM)
+SP_FVM_BENCH(BM_fvm_dot, CartesianFVM)
+}  // namespace simpla
@@ -0,0 +1,21 @@
+//
+// simpla_bench: the kernels which dominate the run time of a simulation, with the throughput in cells/s (items) and
+// bytes/s, so that a regression shows up before it reaches a production run.
+//
+//   fvm_bench.cpp          FVM curl / diverge / grad on CoRectMesh and RectMesh
+//   array_bench.cpp        Array::Assign and Array::CopyIn
+//   sync_bench.cpp         Atlas::SyncLocal and the periodic exchange of a single rank MPIUpdater
+//   checkpoint_bench.cpp   HDF5 / XDMF write of one patch set
+//
+// e.g.  simpla_bench --benchmark_filter=fvm --benchmark_format=json --benchmark_out=fvm.json
+//
+#include <benchmark/benchmark.h>
+#include "simpla/parallel/Parallel.h"
+
+int main(int argc, char **argv) {
+    simpla::parallel::Initialize(argc, argv);
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+    simpla::parallel::Finalize();
+    return 0;
+}
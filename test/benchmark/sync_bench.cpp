@@ -0,0 +1,98 @@
+//
+// Halo exchange: Atlas::SyncLocal between the patches of one process, and the periodic exchange of the MPIUpdater of
+// a single rank, i.e. the pack / message / unpack path of SyncGlobal with the process as its own neighbour.
+// Arguments are the edge length N of the N^3 patch.
+//
+#include <benchmark/benchmark.h>
+#include "simpla/SIMPLA_config.h"
+
+#include "simpla/algebra/Array.h"
+#include "simpla/engine/Atlas.h"
+#include "simpla/engine/Attribute.h"
+#include "simpla/engine/MeshBlock.h"
+#include "simpla/engine/Patch.h"
+#include "simpla/parallel/MPIUpdater.h"
+
+namespace simpla {
+using namespace simpla::data;
+using namespace simpla::engine;
+//! patches per direction of the atlas
+static const index_type NUM_OF_PATCHES = 4;
+
+struct SyncFields : public AttributeGroup {
+    AttributeT<Real, EDGE> E{this, "Name"_ = "E"};
+};
+static index_box_type expand(index_box_type const &b, index_tuple const &gw) {
+    index_box_type res;
+    std::get<0>(res) = std::get<0>(b) - gw;
+    std::get<1>(res) = std::get<1>(b) + gw;
+    return res;
+}
+/** number of points of the halo of box covered by the other patches of the M^3 grid of N^3 patches */
+static size_type covered_halo(index_box_type const &b, index_tuple const &gw, index_type n) {
+    size_type outer = 1, inner = 1;
+    for (int d = 0; d < 3; ++d) {
+        outer *= static_cast<size_type>(std::min(std::get<1>(b)[d] + gw[d], n * NUM_OF_PATCHES) -
+                                        std::max(std::get<0>(b)[d] - gw[d], index_type(0)));
+        inner *= static_cast<size_type>(n);
+    }
+    return outer - inner;
+}
+static void BM_atlas_sync_local(benchmark::State &state) {
+    index_type n = state.range(0);
+    auto atlas = Atlas::New();
+    auto gw = atlas->GetHaloWidth();
+    SyncFields f;
+    size_type num = 0;
+    for (index_type i = 0; i < NUM_OF_PATCHES; ++i)
+        for (index_type j = 0; j < NUM_OF_PATCHES; ++j)
+            for (index_type k = 0; k < NUM_OF_PATCHES; ++k) {
+                index_box_type const b{{i * n, j * n, k * n}, {(i + 1) * n, (j + 1) * n, (k + 1) * n}};
+                index_box_type const outer = expand(b, gw);
+                for (int d = 0; d < 3; ++d) {
+                    f.E[d].reset(outer);
+                    f.E[d].Fill(static_cast<Real>((i * NUM_OF_PATCHES + j) * NUM_OF_PATCHES + k));
+                }
+                auto patch = atlas->NewPatch(MeshBlock::New(b));
+                auto blk = f.Pop();
+                blk->SetMeshBlock(patch->GetMeshBlock());
+                patch->Push(blk);
+                num += covered_halo(b, gw, n);
+            }
+    // the adjacency graph is built by the first call
+    atlas->SyncLocal(0);
+    while (state.KeepRunning()) { atlas->SyncLocal(0); }
+    state.SetItemsProcessed(state.iterations() * num * 3);
+    state.SetBytesProcessed(state.iterations() * num * 3 * 2 * sizeof(Real));
+}
+static void BM_mpi_updater_periodic(benchmark::State &state) {
+    index_type n = state.range(0);
+    index_box_type const box{{0, 0, 0}, {n, n, n}};
+    index_tuple const gw{3, 3, 3};
+    auto updater = parallel::MPIUpdater::New();
+    updater->SetPeriodic(true);
+    updater->SetIndexBox(box);
+    updater->SetHaloWidth(gw);
+    int v[3];
+    for (auto &item : v) { item = updater->AddVariable(typeid(Real)); }
+    updater->SetUp();
+    index_box_type const outer = expand(box, gw);
+    Array<Real> E[3];
+    for (auto &a : E) {
+        a.reset(outer);
+        a.Fill(1);
+    }
+    while (state.KeepRunning()) {
+        for (int d = 0; d < 3; ++d) { updater->Push(v[d], E[d]); }
+        updater->Begin();
+        updater->End();
+        for (int d = 0; d < 3; ++d) { updater->Pop(v[d], E[d]); }
+    }
+    auto num = static_cast<size_type>((n + 2 * gw[0]) * (n + 2 * gw[1]) * (n + 2 * gw[2]) - n * n * n);
+    state.SetItemsProcessed(state.iterations() * num * 3);
+    // packed into the send buffer, copied out of the receive buffer
+    state.SetBytesProcessed(state.iterations() * num * 3 * 2 * sizeof(Real));
+}
+BENCHMARK(BM_atlas_sync_local)->RangeMultiplier(2)->Range(16, 64)->UseRealTime();
+BENCHMARK(BM_mpi_updater_periodic)->RangeMultiplier(2)->Range(16, 64)->UseRealTime();
+}  // namespace simpla
@@ -0,0 +1,107 @@
+//
+// mpirun -np 4 ./HDF5Shared_test : every process writes a row of 8x8x8 patches of a scalar and an edge attribute into
+// one file, rank 0 reads the global datasets back. The edge attribute is compressed, the last patch of a row is all
+// zero (but for the upper x boundary) and is left to the fill value. The components of the edge attribute are on
+// their own staggered boxes, the x-edges have one more point along y and z, and so on; the points a component does
+// not have are zero.
+//
+#include <simpla/parallel/MPIComm.h>
+#include <simpla/parallel/Parallel.h>
+#include "simpla/SIMPLA_config.h"
+#include "simpla/data/Data.h"
+#include "simpla/data/DataBlock.h"
+#include "simpla/utilities/SPDefines.h"
+extern "C" {
+#include <hdf5.h>
+}
+using namespace simpla;
+using namespace simpla::data;
+
+static Real value(index_type i, index_type j, index_type k, int n) {
+    return i >= 16 && i < 24 ? 0 : (n + 1) * 1000000 + i * 10000 + j * 100 + k;
+}
+
+int main(int argc, char** argv) {
+    parallel::Initialize(argc, argv);
+    int rank = GLOBAL_COMM.rank();
+    int size = GLOBAL_COMM.size();
+    static constexpr int num_of_patches = 3;
+    {
+        auto dump = DataEntry::New("HDF5Shared_test.ph5");
+        auto patches = dump->CreateNode("Atlas/Patches", DataEntry::DN_TABLE);
+        for (int p = 0; p < num_of_patches; ++p) {
+            index_tuple lo{8 * p, 8 * rank, 0}, hi{8 * (p + 1), 8 * (rank + 1), 8};
+            auto guid = rank * num_of_patches + p;
+            auto d_patch = patches->CreateNode(std::to_string(guid), DataEntry::DN_TABLE);
+            d_patch->SetValue("MeshBlock/GUID", static_cast<id_type>(guid));
+            d_patch->SetValue("MeshBlock/LowIndex", lo);
+            d_patch->SetValue("MeshBlock/HighIndex", hi);
+            // arrays carry a ghost cell
+            index_box_type const outer{lo - 1, hi + 1};
+            auto rho = d_patch->CreateNode("Attributes/rho", DataEntry::DN_TABLE);
+            rho->SetValue<int>("IFORM", CELL);
+            auto blk = DataBlock<Real>::New();
+            blk->reset(outer);
+            blk->Foreach([&](Real& v, index_type i, index_type j, index_type k) { v = value(i, j, k, 0); });
+            rho->Set("_DATA_", DataEntry::New(blk));
+            auto E = d_patch->CreateNode("Attributes/E", DataEntry::DN_TABLE);
+            E->SetValue<int>("IFORM", EDGE);
+            E->SetValue<int>("Compression", 6);
+            auto d_E = E->CreateNode("_DATA_", DataEntry::DN_ARRAY);
+            for (int n = 0; n < 3; ++n) {
+                // the x-edge lies on the nodes along y and z
+                index_tuple c_hi = hi + 1;
+                c_hi[n] -= 1;
+                index_box_type const c_outer{lo - 1, c_hi + 1};
+                auto b = DataBlock<Real>::New();
+                b->reset(c_outer);
+                b->Foreach([&](Real& v, index_type i, index_type j, index_type k) { v = value(i, j, k, n); });
+                d_E->Add(DataEntry::New(b));
+            }
+        }
+        dump->SetValue<Real>("Time", 1.5);
+        dump->Flush();
+    }
+    GLOBAL_COMM.barrier();
+
+    int num_of_error = 0;
+    if (rank == 0) {
+        hid_t file = H5Fopen("HDF5Shared_test.h5", H5F_ACC_RDONLY, H5P_DEFAULT);
+        hsize_t dims[4] = {0, 0, 0, 0};
+        hid_t dset = H5Dopen(file, "/Attributes/E", H5P_DEFAULT);
+        hid_t f_space = H5Dget_space(dset);
+        H5Sget_simple_extent_dims(f_space, dims, nullptr);
+        if (dims[0] != 8 * num_of_patches + 1 || dims[1] != 8 * static_cast<hsize_t>(size) + 1 || dims[2] != 9 ||
+            dims[3] != 3) {
+            ++num_of_error;
+        } else {
+            std::vector<Real> buffer(dims[0] * dims[1] * dims[2] * dims[3]);
+            H5Dread(dset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, &buffer[0]);
+            size_type s = 0;
+            for (index_type i = 0; i < dims[0]; ++i)
+                for (index_type j = 0; j < dims[1]; ++j)
+                    for (index_type k = 0; k < dims[2]; ++k)
+                        for (int n = 0; n < 3; ++n, ++s) {
+                            index_type idx[3] = {i, j, k};
+                            bool has_point = idx[n] < static_cast<index_type>(dims[n] - 1);
+                            if (buffer[s] != (has_point ? value(i, j, k, n) : 0)) { ++num_of_error; }
+                        }
+        }
+        hid_t dcpl = H5Dget_create_plist(dset);
+        if (H5Pget_nfilters(dcpl) < 1) { ++num_of_error; }
+        H5Pclose(dcpl);
+        H5Sclose(f_space);
+        H5Dclose(dset);
+
+        dset = H5Dopen(file, "/Atlas/Patches", H5P_DEFAULT);
+        f_space = H5Dget_space(dset);
+        H5Sget_simple_extent_dims(f_space, dims, nullptr);
+        if (dims[0] != static_cast<hsize_t>(num_of_patches * size) || dims[1] != 7) { ++num_of_error; }
+        H5Sclose(f_space);
+        H5Dclose(dset);
+        H5Fclose(file);
+        std::cout << "HDF5Shared_test : " << num_of_error << " errors" << std::endl;
+    }
+    parallel::Finalize();
+    return num_of_error > 0 ? 1 : 0;
+}
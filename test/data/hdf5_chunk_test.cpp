@@ -0,0 +1,70 @@
+//
+// "Chunk" of HDF5WriteArray is in the order of the array index, for slow first and fast first arrays.
+//
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <vector>
+#include "simpla/algebra/Array.h"
+#include "simpla/data/DataEntry.h"
+#include "simpla/data/backend/HDF5Common.h"
+
+using namespace simpla;
+using namespace simpla::data;
+
+static Real value(index_type i, index_type j, index_type k) { return i * 100 + j * 10 + k; }
+
+/** write an array of shape {8,6,4} with chunk {4,3,2}, @return dims and chunk of the dataset, and its values */
+static void write_and_read(enumArrayOrder order, hsize_t* dims, hsize_t* chunk, std::vector<Real>* res) {
+    index_type lo[3] = {0, 0, 0};
+    index_type hi[3] = {8, 6, 4};
+    auto data = std::make_shared<Array<Real>>(lo, hi, order);
+    data->Fill(0);
+    data->Foreach([&](Real& v, index_type i, index_type j, index_type k) { v = value(i, j, k); });
+    auto cfg = DataEntry::New(DataEntry::DN_TABLE);
+    cfg->SetValue("Compression", 1);
+    cfg->SetValue("Chunk", index_tuple{4, 3, 2});
+
+    std::string path = "hdf5_chunk_test.h5";
+    hid_t f_id;
+    H5_ERROR(f_id = H5Fcreate(path.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT));
+    HDF5WriteArray(f_id, "E", data, cfg);
+    hid_t dset = H5Dopen(f_id, "E", H5P_DEFAULT);
+    hid_t f_space = H5Dget_space(dset);
+    EXPECT_EQ(H5Sget_simple_extent_dims(f_space, dims, nullptr), 3);
+    hid_t dcpl = H5Dget_create_plist(dset);
+    EXPECT_EQ(H5Pget_chunk(dcpl, 3, chunk), 3);
+    res->resize(static_cast<size_type>(dims[0] * dims[1] * dims[2]));
+    H5_ERROR(H5Dread(dset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, &(*res)[0]));
+    H5Pclose(dcpl);
+    H5Sclose(f_space);
+    H5Dclose(dset);
+    H5Fclose(f_id);
+    std::remove(path.c_str());
+}
+
+TEST(HDF5Chunk, slow_first) {
+    hsize_t dims[3], chunk[3];
+    std::vector<Real> v;
+    write_and_read(SLOW_FIRST, dims, chunk, &v);
+    EXPECT_EQ(dims[0], 8);
+    EXPECT_EQ(dims[1], 6);
+    EXPECT_EQ(dims[2], 4);
+    EXPECT_EQ(chunk[0], 4);
+    EXPECT_EQ(chunk[1], 3);
+    EXPECT_EQ(chunk[2], 2);
+    EXPECT_EQ(v[(7 * 6 + 5) * 4 + 1], value(7, 5, 1));
+}
+//! the dataset dims are k, j, i, and so is the chunk
+TEST(HDF5Chunk, fast_first) {
+    hsize_t dims[3], chunk[3];
+    std::vector<Real> v;
+    write_and_read(FAST_FIRST, dims, chunk, &v);
+    EXPECT_EQ(dims[0], 4);
+    EXPECT_EQ(dims[1], 6);
+    EXPECT_EQ(dims[2], 8);
+    EXPECT_EQ(chunk[0], 2);
+    EXPECT_EQ(chunk[1], 3);
+    EXPECT_EQ(chunk[2], 4);
+    EXPECT_EQ(v[(1 * 6 + 5) * 8 + 7], value(7, 5, 1));
+}
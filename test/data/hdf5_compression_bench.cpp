@@ -0,0 +1,53 @@
+//
+// Write bandwidth and file size of HDF5WriteArray for a mostly zero field, e.g. the PML layer of a patch, stored
+// contiguous against chunked + deflated with the all zero chunks skipped.
+// Arguments are the deflate level (0 = contiguous) and the chunk edge length.
+//
+#include <benchmark/benchmark.h>
+#include <sys/stat.h>
+#include "simpla/algebra/Array.h"
+#include "simpla/data/DataEntry.h"
+#include "simpla/data/backend/HDF5Common.h"
+
+using namespace simpla;
+using namespace simpla::data;
+
+static const index_type N = 64;
+static const index_type PML_WIDTH = 8;
+
+static long file_size(std::string const &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? static_cast<long>(st.st_size) : 0;
+}
+
+static void BM_write(benchmark::State &state) {
+    auto level = static_cast<int>(state.range(0));
+    index_type c = state.range(1);
+    const index_box_type box{{0, 0, 0}, {N, N, N}};
+    auto data = std::make_shared<Array<Real>>();
+    data->reset(box);
+    data->Fill(0);
+    // only the absorbing layer at the upper x boundary is non-zero
+    data->Foreach([&](Real &v, index_type i, index_type j, index_type k) {
+        if (i >= N - PML_WIDTH) { v = 1.0e-3 * (i - N + PML_WIDTH + 1) * (1 + (j + k) % 7); }
+    });
+    auto cfg = DataEntry::New(DataEntry::DN_TABLE);
+    if (level > 0) {
+        cfg->SetValue("Compression", level);
+        cfg->SetValue("Chunk", index_tuple{c, c, c});
+    }
+    std::string path = "hdf5_compression_bench_" + std::to_string(level) + ".h5";
+    while (state.KeepRunning()) {
+        hid_t f_id;
+        H5_ERROR(f_id = H5Fcreate(path.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT));
+        HDF5WriteArray(f_id, "E", data, cfg);
+        H5Fclose(f_id);
+    }
+    auto raw = static_cast<long>(data->size() * sizeof(Real));
+    state.SetBytesProcessed(state.iterations() * raw);
+    state.counters["size_ratio"] = static_cast<double>(file_size(path)) / raw;
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_write)->Args({0, 0})->Args({1, 16})->Args({6, 16})->Args({6, 32})->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,41 @@
+//
+// Atlas::CheckHaloIsLocal for patches one cell inside and one cell outside the reach of the halo of a neighbour
+// tile. The atlas is cut into one tile per process along x, the tile of rank r is [16r, 16r+16), so the lower
+// neighbour tile is remote (or outside the atlas for rank 0) and so is the upper one. Run it on 1 or more processes.
+//
+#include <simpla/parallel/MPIComm.h>
+#include <simpla/parallel/Parallel.h>
+#include "simpla/SIMPLA_config.h"
+#include "simpla/engine/Atlas.h"
+#include "simpla/geometry/csCartesian.h"
+using namespace simpla;
+
+int main(int argc, char** argv) {
+    parallel::Initialize(argc, argv);
+    int rank = GLOBAL_COMM.rank();
+    int size = GLOBAL_COMM.size();
+    index_type L = 16, lo = rank * L, hi = lo + L;
+
+    auto atlas = engine::Atlas::New();
+    atlas->SetChart(geometry::csCartesian::New(point_type{0, 0, 0}, point_type{1, 1, 1}));
+    atlas->SetBoundingBox(box_type{{0, 0, 0}, {static_cast<Real>(L * size), 16, 16}});
+    atlas->SetNumberOfTiles(index_tuple{size, 1, 1});
+    atlas->SetUp();
+    // a halo of 3 cells reaches 4 cells, the node on the upper face of a patch is one cell further
+    index_type gw = atlas->GetHaloWidth()[0] + 1;
+
+    int num_of_error = 0;
+    auto check = [&](index_type x0, index_type x1, bool expect) {
+        if (atlas->CheckHaloIsLocal(index_box_type{{x0, 4, 4}, {x1, 8, 8}}) != expect) {
+            std::cerr << "[" << rank << "] CheckHaloIsLocal [" << x0 << "," << x1 << ") != " << expect << std::endl;
+            ++num_of_error;
+        }
+    };
+    check(lo + gw, hi - gw, true);
+    check(lo + gw - 1, hi - gw, false);
+    check(lo + gw, hi - gw + 1, false);
+
+    if (num_of_error > 0) { std::cerr << "[" << rank << "] " << num_of_error << " errors" << std::endl; }
+    parallel::Finalize();
+    return num_of_error > 0 ? 1 : 0;
+}
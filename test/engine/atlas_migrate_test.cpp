@@ -0,0 +1,115 @@
+//
+// Atlas::Rebalance on 2 processes: four tiles along x, two per process, the first tile is made expensive, so that the
+// second tile moves from rank 0 to rank 1 with its patch. The patch carries a node field and a block of particles,
+// rank 1 compares them with the values they were created with.
+//
+#include <simpla/parallel/MPIComm.h>
+#include <simpla/parallel/Parallel.h>
+#include "simpla/SIMPLA_config.h"
+#include "simpla/data/Data.h"
+#include "simpla/data/DataBlock.h"
+#include "simpla/engine/Atlas.h"
+#include "simpla/engine/Patch.h"
+#include "simpla/geometry/csCartesian.h"
+#include "simpla/physics/particle/ParticleData.h"
+using namespace simpla;
+using namespace simpla::data;
+
+static Real value(index_type i, index_type j, index_type k) { return i * 10000 + j * 100 + k; }
+static id_type Tag(index_type i, index_type j, index_type k) {
+    EntityId id;
+    id.x = static_cast<int16_t>(i);
+    id.y = static_cast<int16_t>(j);
+    id.z = static_cast<int16_t>(k);
+    id.w = 0;
+    return static_cast<id_type>(id.v);
+}
+//! i+1 particles in cell (i,1,1) of the patch, attribute n of particle s is  i + n / 10 + s / 100
+static Real particle_value(index_type i, int n, size_type s) { return i + 0.1 * n + 0.01 * s; }
+
+int main(int argc, char** argv) {
+    parallel::Initialize(argc, argv);
+    int rank = GLOBAL_COMM.rank();
+    int num_of_error = 0;
+    if (GLOBAL_COMM.size() != 2) {
+        if (rank == 0) { std::cerr << "atlas_migrate_test runs on 2 processes" << std::endl; }
+        parallel::Finalize();
+        return 1;
+    }
+    auto atlas = engine::Atlas::New();
+    atlas->SetChart(geometry::csCartesian::New(point_type{0, 0, 0}, point_type{1, 1, 1}));
+    atlas->SetBoundingBox(box_type{{0, 0, 0}, {32, 4, 4}});
+    atlas->SetNumberOfTiles(index_tuple{4, 1, 1});
+    atlas->SetUp();
+    atlas->AddPatch(index_box_type{{0, 0, 0}, {32, 4, 4}});
+
+    std::map<id_type, Real> costs;
+    atlas->Foreach([&](std::shared_ptr<engine::Patch> const& patch) {
+        auto b = patch->GetIndexBox();
+        index_box_type const outer{std::get<0>(b) - 1, std::get<1>(b) + 2};
+        auto blk = DataBlock<Real>::New();
+        blk->reset(outer);
+        blk->Foreach([&](Real& v, index_type i, index_type j, index_type k) { v = value(i, j, k); });
+        auto rho = DataEntry::New(DataEntry::DN_TABLE);
+        rho->SetValue<int>("IFORM", NODE);
+        rho->Set("_DATA_", DataEntry::New(blk));
+        patch->SetDataBlock("rho", rho);
+
+        auto ele = ParticleData::New(4);
+        ele->SetIndexBox(b);
+        for (index_type i = std::get<0>(b)[0]; i < std::get<1>(b)[0]; ++i) {
+            auto bucket = ele->AddBucket(Tag(i, 1, 1), static_cast<size_type>(i - std::get<0>(b)[0] + 1));
+            for (size_type s = 0; s < bucket->count; ++s) {
+                for (int n = 0; n < 3; ++n) { bucket->data[n][s] = 0.5; }
+                bucket->data[3][s] = particle_value(i, 3, s);
+            }
+        }
+        // a removed cell is not migrated
+        ele->RemoveBucket(Tag(std::get<0>(b)[0], 1, 1));
+        ele->Sort();
+        patch->SetDataBlock("ele", DataEntry::New(ele));
+        costs[patch->GetGUID()] = std::get<0>(b)[0] == 0 ? 10 : 1;
+    });
+    if (!atlas->Rebalance(costs)) { ++num_of_error; }
+
+    int num_of_patches = 0;
+    bool found = false;
+    atlas->Foreach([&](std::shared_ptr<engine::Patch> const& patch) {
+        ++num_of_patches;
+        auto b = patch->GetIndexBox();
+        if (std::get<0>(b)[0] != 8) { return; }
+        found = true;
+        auto rho = std::dynamic_pointer_cast<DataBlock<Real>>(patch->GetDataBlock("rho")->Get("_DATA_")->GetEntity());
+        if (rho == nullptr) {
+            ++num_of_error;
+        } else {
+            rho->Foreach([&](Real const& v, index_type i, index_type j, index_type k) {
+                if (v != value(i, j, k)) { ++num_of_error; }
+            });
+        }
+        auto ele = std::dynamic_pointer_cast<ParticleData>(patch->GetDataBlock("ele")->GetEntity());
+        if (ele == nullptr || ele->GetDOF() != 4 || ele->GetNumberOfOutOfBox() != 0) {
+            ++num_of_error;
+            return;
+        }
+        size_type total = 0;
+        for (index_type i = std::get<0>(b)[0]; i < std::get<1>(b)[0]; ++i) {
+            size_type num = i == std::get<0>(b)[0] ? 0 : static_cast<size_type>(i - std::get<0>(b)[0] + 1);
+            if (ele->Count(Tag(i, 1, 1)) != num) { ++num_of_error; }
+            total += num;
+            size_type s = 0;
+            for (auto bucket = ele->GetBucket(Tag(i, 1, 1)); bucket != nullptr; bucket = bucket->next) {
+                for (size_type t = 0; t < bucket->count; ++t, ++s) {
+                    if (bucket->data[3][t] != particle_value(i, 3, s) || bucket->data[0][t] != 0.5) { ++num_of_error; }
+                }
+            }
+        }
+        if (ele->Count() != total) { ++num_of_error; }
+    });
+    // rank 0 keeps the first tile, rank 1 gets the second one
+    if (num_of_patches != (rank == 0 ? 1 : 3) || found != (rank == 1)) { ++num_of_error; }
+
+    if (num_of_error > 0) { std::cerr << "[" << rank << "] " << num_of_error << " errors" << std::endl; }
+    parallel::Finalize();
+    return num_of_error > 0 ? 1 : 0;
+}
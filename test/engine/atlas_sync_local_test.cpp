@@ -0,0 +1,145 @@
+//
+// Atlas::SyncLocal over the adjacency graph of the patches: patches of mixed sizes, one far away, one on the other
+// side of the periodic boundary (its halo is filled by SyncGlobal, shifted by the period), and a rebuild of the graph
+// after AddPatch and DeletePatch. Every halo value is compared with the pairs of the O(P^2) isAdjoining test which
+// the graph replaces.
+//
+
+#include <gtest/gtest.h>
+
+#include <vector>
+#include "simpla/SIMPLA_config.h"
+#include "simpla/data/Data.h"
+#include "simpla/data/DataBlock.h"
+#include "simpla/engine/Atlas.h"
+#include "simpla/engine/Patch.h"
+#include "simpla/geometry/BoxUtilities.h"
+#include "simpla/geometry/csCartesian.h"
+using namespace simpla;
+using namespace simpla::data;
+
+class TestAtlasSyncLocal : public testing::Test {
+   public:
+    std::shared_ptr<engine::Atlas> atlas = engine::Atlas::New();
+    //! width of the arrays outside of the box, as in BuildSyncEdges
+    index_tuple gw;
+
+    static Real value(index_type i, index_type j, index_type k) { return i * 10000 + j * 100 + k; }
+
+    void SetUp() override {
+        atlas->SetChart(geometry::csCartesian::New(point_type{0, 0, 0}, point_type{1, 1, 1}));
+        atlas->SetBoundingBox(box_type{{0, 0, 0}, {64, 48, 16}});
+        atlas->SetPeriodicDimension(index_tuple{1, 0, 0});
+        atlas->SetUp();
+        gw = atlas->GetHaloWidth() + 1;
+        // a block of patches of mixed sizes which touch each other, along faces, edges and corners
+        index_type x[] = {0, 4, 12, 16, 32};
+        index_type y[] = {0, 8, 12, 40};
+        index_type z[] = {0, 8, 16};
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 3; ++j)
+                for (int k = 0; k < 2; ++k) {
+                    AddPatch(index_box_type{{x[i], y[j], z[k]}, {x[i + 1], y[j + 1], z[k + 1]}});
+                }
+        // out of reach of the others
+        AddPatch(index_box_type{{40, 20, 4}, {44, 24, 8}});
+        // two as long as the longest one and two cells apart, the lower corners are more than one patch apart
+        AddPatch(index_box_type{{30, 40, 8}, {46, 48, 16}});
+        AddPatch(index_box_type{{48, 40, 8}, {64, 48, 16}});
+        // across the periodic boundary of the block
+        AddPatch(index_box_type{{60, 0, 0}, {64, 8, 8}});
+    }
+    /** a patch with a node array over the box and gw more, the box is filled with value and the halo with -1 */
+    std::shared_ptr<engine::Patch> AddPatch(index_box_type const& b) {
+        auto patch = atlas->AddPatch(b);
+        auto blk = DataBlock<Real>::New();
+        index_box_type const outer = geometry::Expand(b, gw);
+        blk->reset(outer);
+        auto rho = DataEntry::New(DataEntry::DN_TABLE);
+        rho->SetValue<int>("IFORM", NODE);
+        rho->Set("_DATA_", DataEntry::New(blk));
+        patch->SetDataBlock("rho", rho);
+        ResetHalo(patch);
+        return patch;
+    }
+    static std::shared_ptr<DataBlock<Real>> Data(std::shared_ptr<engine::Patch> const& patch) {
+        return std::dynamic_pointer_cast<DataBlock<Real>>(patch->GetDataBlock("rho")->Get("_DATA_")->GetEntity());
+    }
+    static bool InBox(index_box_type const& b, index_type i, index_type j, index_type k) {
+        return i >= std::get<0>(b)[0] && i < std::get<1>(b)[0] && j >= std::get<0>(b)[1] && j < std::get<1>(b)[1] &&
+               k >= std::get<0>(b)[2] && k < std::get<1>(b)[2];
+    }
+    //! the patch of box b, or nullptr
+    std::shared_ptr<engine::Patch> FindPatch(index_box_type const& b) const {
+        std::shared_ptr<engine::Patch> res = nullptr;
+        atlas->Foreach([&](std::shared_ptr<engine::Patch> const& patch) {
+            auto c = patch->GetIndexBox();
+            bool same = true;
+            for (int n = 0; n < 3; ++n) {
+                same = same && std::get<0>(c)[n] == std::get<0>(b)[n] && std::get<1>(c)[n] == std::get<1>(b)[n];
+            }
+            if (same) { res = patch; }
+        });
+        return res;
+    }
+    static void ResetHalo(std::shared_ptr<engine::Patch> const& patch) {
+        auto b = patch->GetIndexBox();
+        Data(patch)->Foreach([&](Real& v, index_type i, index_type j, index_type k) {
+            v = InBox(b, i, j, k) ? value(i, j, k) : -1;
+        });
+    }
+    /**
+     * the halo of every patch holds the values of the patches which adjoin it, by the pairwise test SyncLocal used
+     * before the graph, and -1 elsewhere
+     */
+    size_type CheckHalo() const {
+        std::vector<std::shared_ptr<engine::Patch>> patches;
+        atlas->Foreach([&](std::shared_ptr<engine::Patch> const& patch) { patches.push_back(patch); });
+        size_type num_of_error = 0;
+        for (auto const& dst : patches) {
+            auto b = dst->GetIndexBox();
+            std::vector<index_box_type> sources;
+            for (auto const& src : patches) {
+                if (src != dst && geometry::isAdjoining(src->GetIndexBox(), b, atlas->GetHaloWidth())) {
+                    sources.push_back(src->GetIndexBox());
+                }
+            }
+            Data(dst)->Foreach([&](Real& v, index_type i, index_type j, index_type k) {
+                if (InBox(b, i, j, k)) { return; }
+                bool covered = false;
+                for (auto const& s : sources) { covered = covered || InBox(s, i, j, k); }
+                if (v != (covered ? value(i, j, k) : -1)) { ++num_of_error; }
+            });
+        }
+        return num_of_error;
+    }
+};
+
+TEST_F(TestAtlasSyncLocal, halo) {
+    atlas->SyncLocal(0);
+    EXPECT_EQ(CheckHalo(), 0);
+    // the halo of the first patch is not filled across the periodic boundary
+    auto first = FindPatch(index_box_type{{0, 0, 0}, {4, 8, 8}});
+    ASSERT_TRUE(first != nullptr);
+    EXPECT_EQ((*Data(first))(-1, 4, 4), -1);
+    // a second call uses the same graph
+    atlas->Foreach(ResetHalo);
+    atlas->SyncLocal(0);
+    EXPECT_EQ(CheckHalo(), 0);
+}
+TEST_F(TestAtlasSyncLocal, rebuild) {
+    atlas->SyncLocal(0);
+    // a patch which touches the far one
+    AddPatch(index_box_type{{44, 20, 4}, {52, 28, 12}});
+    atlas->Foreach(ResetHalo);
+    atlas->SyncLocal(0);
+    EXPECT_EQ(CheckHalo(), 0);
+    // and a hole in the block
+    auto hole = FindPatch(index_box_type{{4, 8, 0}, {12, 12, 8}});
+    ASSERT_TRUE(hole != nullptr);
+    EXPECT_EQ(atlas->DeletePatch(hole->GetGUID()), 1);
+    EXPECT_TRUE(FindPatch(hole->GetIndexBox()) == nullptr);
+    atlas->Foreach(ResetHalo);
+    atlas->SyncLocal(0);
+    EXPECT_EQ(CheckHalo(), 0);
+}
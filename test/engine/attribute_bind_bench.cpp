@@ -0,0 +1,81 @@
+//
+// Per patch overhead of handing the data of a patch to the attributes of a domain: Push/Pop, which moves the arrays
+// through new DataEntry nodes, against Bind/Unbind, which swaps the storage in place.
+// Arguments are the number of 16^3 patches, each holds an EDGE, a FACE and a NODE attribute.
+//
+#include <benchmark/benchmark.h>
+#include "simpla/data/DataBlock.h"
+#include "simpla/engine/Attribute.h"
+#include "simpla/engine/Patch.h"
+
+using namespace simpla;
+using namespace simpla::data;
+using namespace simpla::engine;
+
+struct Fields : public AttributeGroup {
+    AttributeT<Real, EDGE> E{this, "Name"_ = "E"};
+    AttributeT<Real, FACE> B{this, "Name"_ = "B"};
+    AttributeT<Real, NODE> rho{this, "Name"_ = "rho"};
+    //! the work done on a patch, touch the first point of every component
+    void Touch() {
+        for (int n = 0; n < 3; ++n) {
+            E.GetData(n).get()[0] += 1;
+            B.GetData(n).get()[0] += 1;
+        }
+        rho.GetData(0).get()[0] += 1;
+    }
+};
+
+//! same as DomainBase::Pop followed by Patch::Push
+static void pop_to(Fields const &f, std::shared_ptr<Patch> const &patch) {
+    auto res = f.Pop();
+    res->SetMeshBlock(patch->GetMeshBlock());
+    patch->Push(res);
+}
+static std::vector<std::shared_ptr<Patch>> make_patches(benchmark::State const &state) {
+    std::vector<std::shared_ptr<Patch>> res;
+    Fields f;
+    for (index_type n = 0; n < state.range(0); ++n) {
+        index_box_type const b{{0, 0, 16 * n}, {16, 16, 16 * (n + 1)}};
+        for (int i = 0; i < 3; ++i) {
+            f.E[i].reset(b);
+            f.B[i].reset(b);
+            f.E[i].Fill(0);
+            f.B[i].Fill(0);
+        }
+        f.rho.reset(b);
+        f.rho.Fill(0);
+        res.push_back(Patch::New(MeshBlock::New(b)));
+        pop_to(f, res.back());
+    }
+    return res;
+}
+
+static void BM_PushPop(benchmark::State &state) {
+    auto patches = make_patches(state);
+    Fields f;
+    while (state.KeepRunning()) {
+        for (auto &patch : patches) {
+            f.Push(patch);
+            f.Touch();
+            pop_to(f, patch);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * patches.size());
+}
+static void BM_BindUnbind(benchmark::State &state) {
+    auto patches = make_patches(state);
+    Fields f;
+    while (state.KeepRunning()) {
+        for (auto &patch : patches) {
+            f.Bind(patch);
+            f.Touch();
+            f.Unbind(patch);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * patches.size());
+}
+BENCHMARK(BM_PushPop)->RangeMultiplier(10)->Range(100, 10000)->UseRealTime();
+BENCHMARK(BM_BindUnbind)->RangeMultiplier(10)->Range(100, 10000)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,90 @@
+//
+// Bind / Unbind of the attributes of a group to the data of a patch.
+//
+
+#include <gtest/gtest.h>
+
+#include "simpla/data/Data.h"
+#include "simpla/engine/Attribute.h"
+#include "simpla/engine/Patch.h"
+using namespace simpla;
+using namespace simpla::data;
+using namespace simpla::engine;
+
+struct Fields : public AttributeGroup {
+    AttributeT<Real, NODE> rho{this, "Name"_ = "rho"};
+};
+static std::shared_ptr<Patch> make_patch(index_type n) {
+    index_box_type const b{{0, 0, 8 * n}, {8, 8, 8 * (n + 1)}};
+    Fields f;
+    f.rho.reset(b);
+    f.rho.Fill(static_cast<Real>(n));
+    auto res = Patch::New(MeshBlock::New(b));
+    auto p = f.Pop();
+    p->SetMeshBlock(res->GetMeshBlock());
+    res->Push(p);
+    return res;
+}
+
+TEST(AttributeBind, scratch_is_not_registered) {
+    Fields f;
+    AttributeT<Real, NODE> tmp{&f, "SCRATCH"_};
+    EXPECT_EQ(f.GetAttributes().count(&tmp), 0);
+    EXPECT_EQ(f.GetAttributes().count(&f.rho), 1);
+}
+
+TEST(AttributeBind, scratch_scoped_to_patch) {
+    Fields f;
+    auto p0 = make_patch(0);
+    auto p1 = make_patch(1);
+    size_t n = 8 * 8 * 8;
+
+    Real *addr = nullptr;
+    f.Bind(p0);
+    {
+        auto tmp = f.GetScratchArena()->MakeShared<Real>(n);
+        addr = tmp.get();
+    }
+    EXPECT_NO_THROW(f.Unbind(p0));
+    EXPECT_EQ(f.GetScratchArena()->GetBytesInUse(), 0);
+
+    // the temporaries of the next patch reuse the memory
+    f.Bind(p1);
+    auto leaked = f.GetScratchArena()->MakeShared<Real>(n);
+    EXPECT_EQ(leaked.get(), addr);
+    EXPECT_THROW(f.Unbind(p1), std::runtime_error);
+    // the data of the patch is handed back before the error
+    EXPECT_TRUE(f.rho.isNull());
+    EXPECT_TRUE(p1->GetDataBlock("rho") != nullptr);
+}
+
+/** two groups holding the same attribute, as the domains of a scenario share E and B */
+TEST(AttributeBind, shared_attribute_bound_in_turn) {
+    Fields f0, f1;
+    auto p = make_patch(1);
+    for (auto *f : {&f0, &f1}) {
+        f->Bind(p);
+        ASSERT_FALSE(f->rho.isNull());
+        f->rho.GetData(0)(0, 0, 8) += 1;
+        f->Unbind(p);
+    }
+    // each group works on the data left by the other one
+    f0.Bind(p);
+    EXPECT_DOUBLE_EQ(f0.rho.GetData(0)(0, 0, 8), 3);
+    EXPECT_DOUBLE_EQ(f0.rho.GetData(0)(7, 7, 15), 1);
+    f0.Unbind(p);
+    EXPECT_TRUE(f0.rho.isNull());
+    EXPECT_TRUE(f1.rho.isNull());
+}
+
+/** nested binds of a shared attribute: the inner group gets the empty storage the outer one left in the patch */
+TEST(AttributeBind, shared_attribute_nested) {
+    Fields f0, f1;
+    auto p = make_patch(1);
+    f0.Bind(p);
+    f1.Bind(p);
+    EXPECT_FALSE(f0.rho.isNull());
+    EXPECT_TRUE(f1.rho.isNull());
+    f1.Unbind(p);
+    f0.Unbind(p);
+}
@@ -0,0 +1,117 @@
+//
+// Scenario::CheckPoint with the background writer: more checkpoints than "CheckPointMaxPending" are queued, the live
+// data is changed as soon as CheckPoint returns, each file has to hold the data of its own step.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "simpla/SIMPLA_config.h"
+#include "simpla/data/Data.h"
+#include "simpla/engine/Atlas.h"
+#include "simpla/engine/Attribute.h"
+#include "simpla/engine/Domain.h"
+#include "simpla/engine/Patch.h"
+#include "simpla/engine/Scenario.h"
+#include "simpla/geometry/csCartesian.h"
+extern "C" {
+#include <hdf5.h>
+}
+using namespace simpla;
+using namespace simpla::data;
+using namespace simpla::engine;
+
+struct CheckPointHost : public DomainBase {
+    AttributeT<Real, NODE> rho{this, "Name"_ = "rho", "CheckPoint"_ = 1};
+};
+struct CheckPointFields : public AttributeGroup {
+    AttributeT<Real, NODE> rho{this, "Name"_ = "rho"};
+};
+static std::string file_name(size_type step) {
+    std::ostringstream os;
+    os << "scenario_checkpoint_test" << std::setfill('0') << std::setw(8) << step << ".h5";
+    return os.str();
+}
+/** values of the datasets of attribute rho in a checkpoint */
+static std::vector<Real> read_rho(std::string const& path) {
+    std::vector<Real> res;
+    hid_t file = H5Fopen(path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (file < 0) { return res; }
+    H5Ovisit(file, H5_INDEX_NAME, H5_ITER_NATIVE,
+             [](hid_t obj, const char* name, const H5O_info_t* info, void* op_data) -> herr_t {
+                 if (info->type != H5O_TYPE_DATASET || std::string(name).find("Attributes/rho") == std::string::npos) {
+                     return 0;
+                 }
+                 auto* values = reinterpret_cast<std::vector<Real>*>(op_data);
+                 hid_t d = H5Dopen(obj, name, H5P_DEFAULT);
+                 hid_t space = H5Dget_space(d);
+                 auto num = static_cast<size_type>(H5Sget_simple_extent_npoints(space));
+                 auto offset = values->size();
+                 values->resize(offset + num);
+                 H5Dread(d, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, &(*values)[offset]);
+                 H5Sclose(space);
+                 H5Dclose(d);
+                 return 0;
+             },
+             &res);
+    H5Fclose(file);
+    return res;
+}
+
+TEST(ScenarioCheckPoint, async_writes_snapshots) {
+    static constexpr size_type num_of_steps = 6;
+    auto scenario = Scenario::New();
+    scenario->SetName("scenario_checkpoint_test");
+    scenario->SetProperty("CheckPointFileSuffix", std::string("h5"));
+    scenario->SetProperty("CheckPointAsync", true);
+    scenario->SetProperty<size_type>("CheckPointMaxPending", 2);
+    auto atlas = Atlas::New();
+    atlas->SetChart(geometry::csCartesian::New(point_type{0, 0, 0}, point_type{1, 1, 1}));
+    atlas->SetBoundingBox(box_type{{0, 0, 0}, {32, 32, 32}});
+    scenario->SetAtlas(atlas);
+    scenario->SetDomain("host", std::make_shared<CheckPointHost>());
+    scenario->SetUp();
+
+    CheckPointFields f;
+    std::vector<std::shared_ptr<Patch>> patches;
+    for (index_type n = 0; n < 2; ++n) {
+        index_box_type const b{{16 * n, 0, 0}, {16 * n + 16, 32, 32}};
+        patches.push_back(atlas->AddPatch(b));
+        f.rho.reset(b);
+        f.rho.Fill(-1);
+        auto blk = f.Pop();
+        blk->SetMeshBlock(patches.back()->GetMeshBlock());
+        patches.back()->Push(blk);
+    }
+    for (size_type s = 0; s < num_of_steps; ++s) {
+        for (auto const& patch : patches) {
+            f.Bind(patch);
+            f.rho.Fill(static_cast<Real>(s));
+            f.Unbind(patch);
+        }
+        scenario->SetStepNumber(s);
+        scenario->CheckPoint(s);
+        // the next step goes on while the writer runs
+        for (auto const& patch : patches) {
+            f.Bind(patch);
+            f.rho.Fill(-1);
+            f.Unbind(patch);
+        }
+    }
+    scenario->WaitCheckPoint();
+
+    for (size_type s = 0; s < num_of_steps; ++s) {
+        auto values = read_rho(file_name(s));
+        // the arrays of both patches, with their ghost cells
+        EXPECT_GE(values.size(), 2 * 16 * 32 * 32);
+        size_type num_of_error = 0;
+        for (auto v : values) { num_of_error += v != static_cast<Real>(s) ? 1 : 0; }
+        EXPECT_EQ(num_of_error, 0) << file_name(s);
+        std::remove(file_name(s).c_str());
+    }
+    scenario->TearDown();
+}
@@ -0,0 +1,194 @@
+//
+// TimeIntegrator::ForeachPatch: every patch is visited once by the tasks of several threads, the cost of a patch is
+// recorded, and patches are started from the most expensive one, measured or estimated.
+// TimeIntegrator::ComputeStableDtOnPatch: the stable time step of the domains is limited by CFL, the growth limit and
+// TimeEnd; DomainBase::GetMinCellWidth on a cylindrical chart.
+//
+
+#include <gtest/gtest.h>
+
+#include <omp.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include "simpla/engine/Atlas.h"
+#include "simpla/engine/Domain.h"
+#include "simpla/engine/MeshBlock.h"
+#include "simpla/engine/Patch.h"
+#include "simpla/engine/TimeIntegrator.h"
+#include "simpla/geometry/Box.h"
+#include "simpla/geometry/csCartesian.h"
+#include "simpla/geometry/csCylindrical.h"
+using namespace simpla;
+using namespace simpla::engine;
+
+struct PatchLoop : public TimeIntegrator {
+    PatchLoop() = default;
+    using TimeIntegrator::ForeachPatch;
+    using TimeIntegrator::domain_views_type;
+};
+static std::vector<std::shared_ptr<Patch>> make_patches(index_type num) {
+    std::vector<std::shared_ptr<Patch>> res;
+    for (index_type n = 0; n < num; ++n) {
+        res.push_back(Patch::New(MeshBlock::New(index_box_type{{n * 8, 0, 0}, {n * 8 + 8, 8, 8}})));
+    }
+    return res;
+}
+static void sleep_ms(int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+class TestForeachPatch : public testing::Test {
+   public:
+    PatchLoop loop;
+    int num_of_threads = 0;
+    void SetUp() override {
+        num_of_threads = omp_get_max_threads();
+        omp_set_num_threads(4);
+    }
+    void TearDown() override { omp_set_num_threads(num_of_threads); }
+};
+
+TEST_F(TestForeachPatch, every_patch_once) {
+    auto patches = make_patches(64);
+    std::mutex m;
+    std::multiset<id_type> visited;
+    std::set<int> threads;
+    loop.ForeachPatch(patches, [&](PatchLoop::domain_views_type& views, std::shared_ptr<Patch> const& patch) {
+        sleep_ms(1);
+        std::lock_guard<std::mutex> lock(m);
+        visited.insert(patch->GetGUID());
+        threads.insert(omp_get_thread_num());
+        // every other patch crosses a boundary
+        return (std::get<0>(patch->GetIndexBox())[0] / 8) % 2 == 1;
+    });
+    EXPECT_GT(threads.size(), 1);
+    ASSERT_EQ(visited.size(), patches.size());
+    auto const& costs = loop.GetPatchCosts();
+    for (auto const& patch : patches) {
+        EXPECT_EQ(visited.count(patch->GetGUID()), 1);
+        auto it = costs.find(patch->GetGUID());
+        ASSERT_TRUE(it != costs.end());
+        EXPECT_EQ(it->second.num_of_cells, 8 * 8 * 8);
+        EXPECT_EQ(it->second.cross_boundary, (std::get<0>(patch->GetIndexBox())[0] / 8) % 2 == 1);
+        EXPECT_GE(it->second.time, 1.0e-3);
+    }
+}
+TEST_F(TestForeachPatch, error_is_rethrown) {
+    auto patches = make_patches(16);
+    std::atomic<int> count{0};
+    EXPECT_THROW(
+        loop.ForeachPatch(patches,
+                          [&](PatchLoop::domain_views_type& views, std::shared_ptr<Patch> const& patch) -> bool {
+                              ++count;
+                              if (patch == patches[5]) { throw std::runtime_error("patch 5"); }
+                              return false;
+                          }),
+        std::runtime_error);
+    // the other tasks are not cancelled
+    EXPECT_EQ(count, 16);
+}
+/** with one thread the tasks run in the order they are created, the most expensive first */
+TEST_F(TestForeachPatch, expensive_first) {
+    omp_set_num_threads(1);
+    auto patches = make_patches(2);
+    loop.ForeachPatch(patches, [&](PatchLoop::domain_views_type& views, std::shared_ptr<Patch> const& patch) {
+        sleep_ms(patch == patches[0] ? 2 : 20);
+        return false;
+    });
+    // new patches are estimated at the mean time per cell of the measured ones, 11 ms for the same number of cells
+    // and 22 ms for twice as many
+    patches.push_back(Patch::New(MeshBlock::New(index_box_type{{0, 8, 0}, {8, 16, 8}})));
+    patches.push_back(Patch::New(MeshBlock::New(index_box_type{{16, 0, 0}, {24, 16, 8}})));
+    std::vector<std::shared_ptr<Patch>> order;
+    loop.ForeachPatch(patches, [&](PatchLoop::domain_views_type& views, std::shared_ptr<Patch> const& patch) {
+        order.push_back(patch);
+        return false;
+    });
+    ASSERT_EQ(order.size(), 4);
+    EXPECT_EQ(order[0], patches[3]);
+    EXPECT_EQ(order[1], patches[1]);
+    EXPECT_EQ(order[2], patches[2]);
+    EXPECT_EQ(order[3], patches[0]);
+}
+
+struct StableDtDomain : public DomainBase {
+    Real stable_dt = 0.1;
+    //! the default one saves the mesh block with the geometry engine
+    void DoInitialCondition(Real time_now) override {}
+    Real DoComputeStableDt(Real time_now) const override { return stable_dt; }
+};
+/** one thread, so that the patch is swept by the domain of the scenario itself */
+class TestStableDt : public testing::Test {
+   public:
+    std::shared_ptr<TimeIntegrator> ti = TimeIntegrator::New();
+    std::shared_ptr<StableDtDomain> domain = std::make_shared<StableDtDomain>();
+    int num_of_threads = 0;
+    void SetUp() override {
+        num_of_threads = omp_get_max_threads();
+        omp_set_num_threads(1);
+        ti->SetProperty("AdaptiveTimeStep", true);
+        ti->SetTimeNow(0);
+        ti->SetTimeEnd(1);
+        ti->SetMaxStep(2);
+        auto atlas = Atlas::New();
+        atlas->SetChart(geometry::csCartesian::New(point_type{0, 0, 0}, point_type{0.1, 0.1, 0.1}));
+        atlas->SetBoundingBox(box_type{{0, 0, 0}, {8, 8, 8}});
+        ti->SetAtlas(atlas);
+        domain->SetBoundary(geometry::Box::New(box_type{{0, 0, 0}, {1, 1, 1}}));
+        ti->SetDomain("d", domain);
+        ti->SetUp();
+        atlas->AddPatch(index_box_type{{0, 0, 0}, {8, 8, 8}});
+    }
+    void TearDown() override {
+        ti->TearDown();
+        omp_set_num_threads(num_of_threads);
+    }
+};
+TEST_F(TestStableDt, cfl) {
+    ti->InitialCondition(0);
+    EXPECT_DOUBLE_EQ(ti->ComputeStableDtOnPatch(0, 1), 0.9 * 0.1);
+    // the stable time step is taken once, nothing is swept since
+    EXPECT_DOUBLE_EQ(ti->ComputeStableDtOnPatch(0, 0.05), 0.05);
+}
+TEST_F(TestStableDt, growth) {
+    domain->stable_dt = 10;
+    ti->InitialCondition(0);
+    EXPECT_DOUBLE_EQ(ti->ComputeStableDtOnPatch(0, 0.01), 1.1 * 0.01);
+    ti->SetProperty<Real>("MaxTimeStepGrowth", 2.0);
+    ti->InitialCondition(0);
+    EXPECT_DOUBLE_EQ(ti->ComputeStableDtOnPatch(0, 0.01), 2.0 * 0.01);
+}
+TEST_F(TestStableDt, time_end) {
+    domain->stable_dt = 10;
+    ti->InitialCondition(0.95);
+    EXPECT_NEAR(ti->ComputeStableDtOnPatch(0.95, 1), 0.05, 1.0e-12);
+    // also if no domain limits the time step
+    EXPECT_NEAR(ti->ComputeStableDtOnPatch(0.9, 0.5), 0.1, 1.0e-12);
+    EXPECT_DOUBLE_EQ(ti->ComputeStableDtOnPatch(0.5, 0.2), 0.2);
+}
+/** MaxStep only gives the first time step, the run ends at TimeEnd */
+TEST_F(TestStableDt, max_step) {
+    EXPECT_DOUBLE_EQ(ti->GetTimeStep(), 0.5);
+    ti->SetTimeNow(0.3);
+    ti->SetStepNumber(5);
+    EXPECT_FALSE(ti->Done());
+    ti->SetTimeNow(1);
+    EXPECT_TRUE(ti->Done());
+}
+
+/** axes R, Phi, Z: the width of a cell is 1/sqrt(1/dr^2 + 1/(r dphi)^2 + 1/dz^2), smallest at the smallest radius */
+TEST(DomainMinCellWidth, cylindrical) {
+    StableDtDomain domain;
+    domain.SetChart(geometry::csCylindrical::New(point_type{1, 0, 0}, point_type{0.1, 0.01, 0.2}));
+    domain.SetMeshBlock(MeshBlock::New(index_box_type{{0, 0, 0}, {4, 8, 3}}));
+    EXPECT_NEAR(domain.GetMinCellWidth(), 1 / std::sqrt(100 + 10000 + 25.0), 1.0e-12);
+    // r = 2
+    domain.SetMeshBlock(MeshBlock::New(index_box_type{{10, 0, 0}, {14, 8, 3}}));
+    EXPECT_NEAR(domain.GetMinCellWidth(), 1 / std::sqrt(100 + 2500 + 25.0), 1.0e-12);
+    // a direction of one cell does not limit the time step
+    domain.SetMeshBlock(MeshBlock::New(index_box_type{{0, 0, 0}, {4, 1, 3}}));
+    EXPECT_NEAR(domain.GetMinCellWidth(), 1 / std::sqrt(100 + 25.0), 1.0e-12);
+}
@@ -0,0 +1,146 @@
+//
+// FVM::GetLaplacianDiagonal is the diagonal of  codifferential_derivative(exterior_derivative(phi)) , on CoRectMesh
+// and RectMesh; Krylov solvers with that operator as a field expression and the Jacobi preconditioner.
+//
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include "simpla/SIMPLA_config.h"
+
+#include "simpla/algebra/Algebra.h"
+#include "simpla/engine/Domain.h"
+#include "simpla/numeric/Krylov.h"
+#include "simpla/physics/Field.h"
+#include "simpla/predefine/physics/PredefineDomains.h"
+
+namespace simpla {
+using namespace simpla::data;
+#define LAPLACIAN_HOST_FIELDS                                                                              \
+    FIELD(phi, Real, NODE);                                                                                \
+    FIELD(lap, Real, NODE);                                                                                \
+    FIELD(diag, Real, NODE);                                                                               \
+    FIELD(x, Real, NODE);                                                                                  \
+    FIELD(b, Real, NODE);                                                                                  \
+    FIELD(solution, Real, NODE);                                                                           \
+    FIELD(w0, Real, NODE);                                                                                 \
+    FIELD(w1, Real, NODE);                                                                                 \
+    FIELD(w2, Real, NODE);                                                                                 \
+    FIELD(w3, Real, NODE);                                                                                 \
+    FIELD(w4, Real, NODE);                                                                                 \
+    FIELD(w5, Real, NODE);                                                                                 \
+    FIELD(w6, Real, NODE);                                                                                 \
+    std::vector<Field<this_type, Real, NODE>*> work() { return {&w0, &w1, &w2, &w3, &w4, &w5, &w6}; }
+
+class CartesianLaplacian : public CartesianFVM {
+    SP_DOMAIN_HEAD(CartesianLaplacian, CartesianFVM);
+    LAPLACIAN_HOST_FIELDS
+};
+class CylindricalLaplacian : public CylindricalFVM {
+    SP_DOMAIN_HEAD(CylindricalLaplacian, CylindricalFVM);
+    LAPLACIAN_HOST_FIELDS
+};
+#undef LAPLACIAN_HOST_FIELDS
+#define LAPLACIAN_HOST_IMPL(_CLASS_NAME_, _BASE_NAME_)                                                                \
+    bool _CLASS_NAME_::_is_registered = Factory<_BASE_NAME_>::RegisterCreator<_CLASS_NAME_>(__STRING(_CLASS_NAME_)); \
+    _CLASS_NAME_::_CLASS_NAME_() : base_type() {}                                                                     \
+    _CLASS_NAME_::~_CLASS_NAME_() {}                                                                                  \
+    void _CLASS_NAME_::DoSetUp() { base_type::DoSetUp(); }                                                            \
+    void _CLASS_NAME_::DoUpdate() { base_type::DoUpdate(); }                                                          \
+    void _CLASS_NAME_::DoTearDown() { base_type::DoTearDown(); }                                                      \
+    void _CLASS_NAME_::DoTagRefinementCells(Real time_now) {}                                                         \
+    void _CLASS_NAME_::DoInitialCondition(Real time_now) {}                                                           \
+    void _CLASS_NAME_::DoAdvance(Real time_now, Real time_dt) {}
+LAPLACIAN_HOST_IMPL(CartesianLaplacian, CartesianFVM)
+LAPLACIAN_HOST_IMPL(CylindricalLaplacian, CylindricalFVM)
+#undef LAPLACIAN_HOST_IMPL
+}  // namespace simpla
+using namespace simpla;
+
+static index_box_type const box{{0, 0, 0}, {6, 5, 4}};
+
+template <typename THost>
+std::shared_ptr<THost> make_domain(std::shared_ptr<geometry::Chart> const& chart) {
+    auto d = THost::New();
+    d->SetChart(chart);
+    d->SetUp();
+    d->SetMeshBlock(engine::MeshBlock::New(box));
+    return d;
+}
+template <typename TField>
+Array<Real>& array(TField& f) {
+    return static_cast<Array<Real>&>(f);
+}
+/** A e_n at n, for the unit vectors e_n of the nodes of the box, the ghost nodes are zero */
+template <typename THost>
+void check_diagonal(THost* d) {
+    d->diag = 0.0;
+    d->GetLaplacianDiagonal(array(d->diag));
+    for (index_type i = std::get<0>(box)[0]; i < std::get<1>(box)[0]; ++i)
+        for (index_type j = std::get<0>(box)[1]; j < std::get<1>(box)[1]; ++j)
+            for (index_type k = std::get<0>(box)[2]; k < std::get<1>(box)[2]; ++k) {
+                d->phi = 0.0;
+                array(d->phi)(i, j, k) = 1;
+                d->lap = codifferential_derivative(exterior_derivative(d->phi));
+                Real expect = array(d->lap)(i, j, k);
+                EXPECT_GT(expect, 0);
+                EXPECT_NEAR(array(d->diag)(i, j, k), expect, 1.0e-10 * std::abs(expect)) << "(" << i << "," << j
+                                                                                         << "," << k << ")";
+            }
+}
+/** b = A solution, solved from x = 0 with the Jacobi preconditioner */
+template <typename THost, typename TSolver>
+void check_solve(THost* d, TSolver const& solve) {
+    for (auto* f : {&d->x, &d->b, &d->solution, &d->diag}) { *f = 0.0; }
+    for (auto* f : d->work()) { *f = 0.0; }
+    d->GetLaplacianDiagonal(array(d->diag));
+    array(d->solution) = [&](index_type i, index_type j, index_type k) {
+        bool ghost = false;
+        for (int n = 0; n < 3; ++n) {
+            index_type s = n == 0 ? i : (n == 1 ? j : k);
+            ghost = ghost || s < std::get<0>(box)[n] || s >= std::get<1>(box)[n];
+        }
+        return ghost ? 0 : std::sin(0.5 * i + 0.3 * j) + 0.1 * k;
+    };
+    auto A = [&](Field<THost, Real, NODE>& u, Field<THost, Real, NODE>& y) {
+        y = codifferential_derivative(exterior_derivative(u));
+    };
+    A(d->solution, d->b);
+    linear_solver::KrylovSpace space;
+    space.SetUp(d, NODE);
+    auto status = solve(space, A, linear_solver::JacobiPreconditioner<Field<THost, Real, NODE>>(d->diag), d->b, d->x,
+                        d->work());
+    EXPECT_TRUE(status.converged);
+    Real err = 0, norm = 0;
+    for (index_type i = std::get<0>(box)[0]; i < std::get<1>(box)[0]; ++i)
+        for (index_type j = std::get<0>(box)[1]; j < std::get<1>(box)[1]; ++j)
+            for (index_type k = std::get<0>(box)[2]; k < std::get<1>(box)[2]; ++k) {
+                err += std::pow(array(d->x)(i, j, k) - array(d->solution)(i, j, k), 2);
+                norm += std::pow(array(d->solution)(i, j, k), 2);
+            }
+    EXPECT_LT(std::sqrt(err / norm), 1.0e-6);
+}
+
+TEST(LaplacianDiagonal, co_rect_mesh) {
+    auto d =
+        make_domain<CartesianLaplacian>(geometry::csCartesian::New(point_type{0, 0, 0}, point_type{0.1, 0.2, 0.3}));
+    check_diagonal(d.get());
+}
+//! R is off the axis, so that no volume vanishes
+TEST(LaplacianDiagonal, rect_mesh) {
+    auto d =
+        make_domain<CylindricalLaplacian>(geometry::csCylindrical::New(point_type{1, 0, 0}, point_type{0.1, 0.1, 0.1}));
+    check_diagonal(d.get());
+}
+//! uniform volumes, the operator is symmetric
+TEST(LaplacianDiagonal, cg) {
+    auto d =
+        make_domain<CartesianLaplacian>(geometry::csCartesian::New(point_type{0, 0, 0}, point_type{0.1, 0.2, 0.3}));
+    check_solve(d.get(), [](auto&&... args) { return linear_solver::CG(std::forward<decltype(args)>(args)...); });
+}
+TEST(LaplacianDiagonal, bicgstab) {
+    auto d =
+        make_domain<CylindricalLaplacian>(geometry::csCylindrical::New(point_type{1, 0, 0}, point_type{0.1, 0.1, 0.1}));
+    check_solve(d.get(),
+                [](auto&&... args) { return linear_solver::BiCGStab(std::forward<decltype(args)>(args)...); });
+}
@@ -0,0 +1,90 @@
+//
+// The separable metric of RectMesh follows the patch a domain is bound to, also without the Pre* signals of a step,
+// e.g. in Scenario::Sum.
+//
+
+#include <gtest/gtest.h>
+
+#include "simpla/SIMPLA_config.h"
+
+#include "simpla/algebra/Algebra.h"
+#include "simpla/engine/Domain.h"
+#include "simpla/engine/Patch.h"
+#include "simpla/physics/Field.h"
+#include "simpla/predefine/physics/PredefineDomains.h"
+
+namespace simpla {
+using namespace simpla::data;
+class MetricHost : public CylindricalFVM {
+    SP_DOMAIN_HEAD(MetricHost, CylindricalFVM);
+
+    FIELD(rho, Real, CELL);
+};
+bool MetricHost::_is_registered = Factory<CylindricalFVM>::RegisterCreator<MetricHost>("MetricHost");
+MetricHost::MetricHost() : base_type() {}
+MetricHost::~MetricHost() {}
+void MetricHost::DoSetUp() { base_type::DoSetUp(); }
+void MetricHost::DoUpdate() { base_type::DoUpdate(); }
+void MetricHost::DoTearDown() { base_type::DoTearDown(); }
+void MetricHost::DoTagRefinementCells(Real time_now) {}
+void MetricHost::DoInitialCondition(Real time_now) {}
+void MetricHost::DoAdvance(Real time_now, Real time_dt) {}
+}  // namespace simpla
+using namespace simpla;
+
+class TestRectMesh : public testing::Test {
+   public:
+    //! R is off the axis, so that no cell volume vanishes
+    std::shared_ptr<geometry::Chart> chart =
+        geometry::csCylindrical::New(point_type{1, 0, 0}, point_type{0.01, 0.01, 0.01});
+
+    std::shared_ptr<MetricHost> make_domain() const {
+        auto d = MetricHost::New();
+        d->SetChart(chart);
+        d->SetUp();
+        return d;
+    }
+    /** a patch with rho = 1 on its cells */
+    std::shared_ptr<engine::Patch> make_patch(index_box_type const& b) const {
+        auto d = make_domain();
+        d->SetMeshBlock(engine::MeshBlock::New(b));
+        d->rho = 1.0;
+        return d->Pop();
+    }
+    Real volume(index_box_type const& b) const {
+        Real res = 0;
+        for (index_type i = std::get<0>(b)[0]; i < std::get<1>(b)[0]; ++i)
+            for (index_type j = std::get<0>(b)[1]; j < std::get<1>(b)[1]; ++j)
+                for (index_type k = std::get<0>(b)[2]; k < std::get<1>(b)[2]; ++k) {
+                    res += chart->volume(chart->local_coordinates(0b0, i, j, k),
+                                         chart->local_coordinates(0b0, i + 1, j + 1, k + 1));
+                }
+        return res;
+    }
+};
+
+TEST_F(TestRectMesh, bind_sets_up_metric) {
+    index_box_type b0{{0, 0, 0}, {8, 8, 8}};
+    index_box_type b1{{16, 4, 0}, {40, 12, 16}};
+    auto p0 = make_patch(b0);
+    auto p1 = make_patch(b1);
+    auto d = make_domain();
+    for (auto const& item : {std::make_pair(p0, b0), std::make_pair(p1, b1), std::make_pair(p0, b0)}) {
+        d->Bind(item.first);
+        auto b = d->m_cell_volume_.GetIndexBox();
+        for (int n = 0; n < 3; ++n) {
+            EXPECT_LT(std::get<0>(b)[n], std::get<0>(item.second)[n]);
+            EXPECT_GT(std::get<1>(b)[n], std::get<1>(item.second)[n]);
+        }
+        Real v = volume(item.second);
+        EXPECT_NEAR(d->Integrate(d->rho), v, 1.0e-12 * v);
+        d->Unbind(item.first);
+    }
+}
+TEST_F(TestRectMesh, push_sets_up_metric) {
+    index_box_type b1{{16, 4, 0}, {40, 12, 16}};
+    auto d = make_domain();
+    d->Push(make_patch(b1));
+    Real v = volume(b1);
+    EXPECT_NEAR(d->Integrate(d->rho), v, 1.0e-12 * v);
+}
@@ -0,0 +1,62 @@
+//
+// Halo exchange of a periodic ring of boxes through explicit regions of MPIUpdater, the left and right halo of the
+// box of rank r come from the ranks r-1 and r+1, which may be the same process. The box is also periodic along y on
+// every process, so that messages to the process itself are mixed with those to the others.
+//
+#include <simpla/parallel/MPIComm.h>
+#include <simpla/parallel/Parallel.h>
+#include "simpla/SIMPLA_config.h"
+#include "simpla/parallel/MPIUpdater.h"
+#include "simpla/utilities/SPDefines.h"
+using namespace simpla;
+
+static index_type wrap(index_type i, index_type n) { return ((i % n) + n) % n; }
+
+int main(int argc, char** argv) {
+    parallel::Initialize(argc, argv);
+    int rank = GLOBAL_COMM.rank();
+    int size = GLOBAL_COMM.size();
+    index_type L = 4, gw = 2, n = L * size;
+    index_type lo = rank * L, hi = lo + L;
+    int left = (rank + size - 1) % size;
+    int right = (rank + 1) % size;
+
+    auto updater = parallel::MPIUpdater::New();
+    int va = updater->AddVariable(typeid(int));
+    int vc = updater->AddVariable(typeid(double));
+    updater->AddRecvRegion(right, index_box_type{{hi, 0, 0}, {hi + gw, 3, 1}});
+    updater->AddRecvRegion(left, index_box_type{{lo - gw, 0, 0}, {lo, 3, 1}});
+    updater->AddSendRegion(left, index_box_type{{lo, 0, 0}, {lo + gw, 3, 1}});
+    updater->AddSendRegion(right, index_box_type{{hi - gw, 0, 0}, {hi, 3, 1}});
+    updater->AddRecvRegion(rank, index_box_type{{lo, -1, 0}, {hi, 0, 1}});
+    updater->AddRecvRegion(rank, index_box_type{{lo, 3, 0}, {hi, 4, 1}});
+    updater->AddSendRegion(rank, index_box_type{{lo, 2, 0}, {hi, 3, 1}});
+    updater->AddSendRegion(rank, index_box_type{{lo, 0, 0}, {hi, 1, 1}});
+    updater->SetUp();
+
+    Array<int> a(index_box_type{{lo - gw, -1, 0}, {hi + gw, 4, 1}});
+    Array<double> c(index_box_type{{lo - gw, -1, 0}, {hi + gw, 4, 1}});
+    a.Foreach([&](auto& v, index_type i, index_type j, index_type k) {
+        v = (i >= lo && i < hi && j >= 0 && j < 3) ? static_cast<int>(i * 100 + j) : -1;
+    });
+    c.Foreach([&](auto& v, index_type i, index_type j, index_type k) { v = -a(i, j, k); });
+
+    for (int step = 0; step < 2; ++step) {
+        updater->Push(va, a);
+        updater->Push(vc, c);
+        updater->Begin();
+        updater->End();
+        updater->Pop(va, a);
+        updater->Pop(vc, c);
+    }
+
+    int num_of_error = 0;
+    a.Foreach([&](auto& v, index_type i, index_type j, index_type k) {
+        bool corner = (i < lo || i >= hi) && (j < 0 || j >= 3);
+        int expect = corner ? -1 : static_cast<int>(wrap(i, n) * 100 + wrap(j, 3));
+        if (v != expect || c(i, j, k) != -expect) { ++num_of_error; }
+    });
+    if (num_of_error > 0) { std::cerr << "[" << rank << "] " << num_of_error << " errors" << std::endl; }
+    parallel::Finalize();
+    return num_of_error > 0 ? 1 : 0;
+}
@@ -8,6 +8,8 @@
 #include "simpla/utilities/SPDefines.h"
 using namespace simpla;
 
+static index_type wrap(index_type i, index_type n) { return ((i % n) + n) % n; }
+
 int main(int argc, char** argv) {
     parallel::Initialize(argc, argv);
     index_box_type box{{0, 0, 0}, {8, 6, 1}};
@@ -16,41 +18,53 @@ int main(int argc, char** argv) {
     std::get<0>(outer_box) = std::get<0>(box) - gw;
     std::get<1>(outer_box) = std::get<1>(box) + gw;
 
-    auto updater = parallel::MPIUpdater::New<int>();
+    auto updater = parallel::MPIUpdater::New();
     updater->SetIndexBox(box);
     updater->SetHaloWidth(gw);
+    // two attributes in one message
+    int va = updater->AddVariable(typeid(int));
+    int vc = updater->AddVariable(typeid(double));
+    updater->SetUp();
 
     Array<int> a(outer_box);
     Array<int> b(box);
+    Array<double> c(outer_box);
     a.FillNaN();
+    c.FillNaN();
     b.Fill(GLOBAL_COMM.rank());
-    auto rank = GLOBAL_COMM.rank();
     b.Foreach([&](auto& v, index_type i, index_type j, index_type k) { v = v * 1000000 + i * 10000 + j * 100 + k; });
     a.CopyIn(b);
-
-    auto center = a.GetSelection(box);
+    c.Foreach([&](auto& v, index_type i, index_type j, index_type k) { v = -a(i, j, k); });
 
     GLOBAL_COMM.barrier();
     if (GLOBAL_COMM.rank() == 0) { std::cout << a << std::endl; }
     GLOBAL_COMM.barrier();
 
-    for (int dir = 0; dir < 3; ++dir) {
-        updater->SetDirection(dir);
-        updater->SetUp();
-        updater->Push(a);
-        updater->SendRecv();
-        updater->Pop(a);
-        updater->TearDown();
+    for (int step = 0; step < 2; ++step) {
+        updater->Push(va, a);
+        updater->Push(vc, c);
+        updater->Begin();
+        updater->End();
+        updater->Pop(va, a);
+        updater->Pop(vc, c);
     }
 
+    // the halo holds the box of the neighbour, corners included
+    int num_of_error = 0;
+    index_type n[3] = {8, 6, 1};
+    a.Foreach([&](auto& v, index_type i, index_type j, index_type k) {
+        int disp[3] = {i < 0 ? -1 : (i >= n[0] ? 1 : 0), j < 0 ? -1 : (j >= n[1] ? 1 : 0), 0};
+        int r = GLOBAL_COMM.GetNeighbour(disp);
+        int expect = r * 1000000 + static_cast<int>(wrap(i, n[0]) * 10000 + wrap(j, n[1]) * 100 + k);
+        if (v != expect || c(i, j, k) != -expect) { ++num_of_error; }
+    });
+
     GLOBAL_COMM.barrier();
-    if (GLOBAL_COMM.rank() == 0) { std::cout << a << std::endl; }
-    GLOBAL_COMM.barrier();
-    if (GLOBAL_COMM.rank() == 1) { std::cout << a << std::endl; }
-    GLOBAL_COMM.barrier();
-    if (GLOBAL_COMM.rank() == 2) { std::cout << a << std::endl; }
-    GLOBAL_COMM.barrier();
-    if (GLOBAL_COMM.rank() == 3) { std::cout << a << std::endl; }
-    GLOBAL_COMM.barrier();
+    for (int r = 0; r < GLOBAL_COMM.size(); ++r) {
+        if (GLOBAL_COMM.rank() == r) { std::cout << a << std::endl; }
+        GLOBAL_COMM.barrier();
+    }
+    if (num_of_error > 0) { std::cerr << "[" << GLOBAL_COMM.rank() << "] " << num_of_error << " errors" << std::endl; }
     parallel::Finalize();
-}
\ No newline at end of file
+    return num_of_error > 0 ? 1 : 0;
+}
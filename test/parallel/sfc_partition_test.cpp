@@ -0,0 +1,54 @@
+//
+// Morton codes and the balance of SFCPartition.
+//
+
+#include <gtest/gtest.h>
+
+#include <vector>
+#include "simpla/parallel/SFCPartition.h"
+using namespace simpla;
+
+static std::vector<index_box_type> make_tiles(index_type n, index_type d) {
+    std::vector<index_box_type> res;
+    for (index_type i = 0; i < n; ++i)
+        for (index_type j = 0; j < n; ++j)
+            for (index_type k = 0; k < n; ++k) {
+                res.emplace_back(index_tuple{i * d, j * d, k * d}, index_tuple{(i + 1) * d, (j + 1) * d, (k + 1) * d});
+            }
+    return res;
+}
+
+TEST(SFCPartition, morton) {
+    EXPECT_EQ(parallel::MortonCode(0, 0, 1), 1);
+    EXPECT_EQ(parallel::MortonCode(0, 1, 0), 2);
+    EXPECT_EQ(parallel::MortonCode(1, 0, 0), 4);
+    EXPECT_EQ(parallel::MortonCode(1, 1, 1), 7);
+    EXPECT_EQ(parallel::MortonCode(2, 0, 0), 32);
+}
+
+TEST(SFCPartition, uniform) {
+    auto tiles = make_tiles(4, 8);
+    std::vector<Real> costs(tiles.size(), 1.0);
+    auto parts = parallel::PartitionMorton(tiles, costs, 8);
+    // a part is an octant of the tile grid
+    for (size_type s = 0; s < tiles.size(); ++s) {
+        auto const &lo = std::get<0>(tiles[s]);
+        EXPECT_EQ(parts[s], (lo[0] / 16) * 4 + (lo[1] / 16) * 2 + lo[2] / 16);
+    }
+    EXPECT_DOUBLE_EQ(parallel::PartitionImbalance(parts, costs, 8), 1.0);
+}
+
+TEST(SFCPartition, weighted) {
+    // the cost is in one corner of the box, the vacuum elsewhere is cheap
+    auto tiles = make_tiles(8, 4);
+    std::vector<Real> costs(tiles.size(), 0.01);
+    for (size_type s = 0; s < tiles.size(); ++s) {
+        if (std::get<0>(tiles[s])[0] < 16 && std::get<0>(tiles[s])[1] < 16) { costs[s] = 1.0; }
+    }
+    int num_of_parts = 16;
+    std::vector<int> even(tiles.size());
+    for (size_type s = 0; s < tiles.size(); ++s) { even[s] = static_cast<int>(s * num_of_parts / tiles.size()); }
+    auto parts = parallel::PartitionMorton(tiles, costs, num_of_parts);
+    EXPECT_LT(parallel::PartitionImbalance(parts, costs, num_of_parts), 1.2);
+    EXPECT_GT(parallel::PartitionImbalance(even, costs, num_of_parts), 2.0);
+}
@@ -0,0 +1,84 @@
+//
+// Particles of a domain, pushed from and popped to the patches of the domain.
+//
+
+#include <gtest/gtest.h>
+
+#include "simpla/data/Data.h"
+#include "simpla/engine/Domain.h"
+#include "simpla/engine/Patch.h"
+#include "simpla/physics/particle/Particle.h"
+using namespace simpla;
+using namespace simpla::data;
+
+struct ParticleHost : public engine::DomainBase {
+    Particle<ParticleHost> ele{this, "Name"_ = "ele", "DOF"_ = 6};
+};
+
+static id_type Tag(index_type i, index_type j, index_type k) {
+    EntityId id;
+    id.x = static_cast<int16_t>(i);
+    id.y = static_cast<int16_t>(j);
+    id.z = static_cast<int16_t>(k);
+    id.w = 0;
+    return static_cast<id_type>(id.v);
+}
+/** a patch holding particles which have never been binned, e.g. read from a checkpoint */
+static std::shared_ptr<engine::Patch> make_patch(index_box_type const& b) {
+    auto res = engine::Patch::New(engine::MeshBlock::New(b));
+    res->SetDataBlock("ele", DataEntry::New(ParticleData::New(6)));
+    return res;
+}
+
+TEST(ParticleBase, push_sets_index_box) {
+    ParticleHost host;
+    index_box_type b0{{0, 0, 0}, {4, 4, 4}};
+    host.Push(make_patch(b0));
+    ASSERT_FALSE(host.ele.isNull());
+    auto blk = host.ele.GetDataBlock();
+    EXPECT_EQ(std::get<0>(blk->GetIndexBox())[0], 0);
+    EXPECT_EQ(std::get<1>(blk->GetIndexBox())[0], 4);
+    EXPECT_EQ(blk->GetNumberOfCells(), 64);
+
+    auto bucket = host.ele.AddBucket(Tag(1, 2, 3), 5);
+    for (int n = 0; n < 6; ++n) {
+        for (size_type s = 0; s < 5; ++s) { bucket->data[n][s] = 0.5; }
+    }
+    host.ele.Sort();
+    EXPECT_EQ(host.ele.Count(Tag(1, 2, 3)), 5);
+    EXPECT_EQ(blk->GetNumberOfOutOfBox(), 0);
+}
+
+TEST(ParticleBase, index_box_follows_the_block) {
+    ParticleHost host;
+    index_box_type b0{{0, 0, 0}, {4, 4, 4}};
+    index_box_type b1{{2, 0, 0}, {6, 4, 4}};
+    auto p0 = make_patch(b0);
+    host.Push(p0);
+    auto bucket = host.ele.AddBucket(Tag(1, 1, 1), 2);
+    for (int n = 0; n < 6; ++n) { bucket->data[n][0] = bucket->data[n][1] = 0.5; }
+    bucket = host.ele.AddBucket(Tag(3, 1, 1), 3);
+    for (int n = 0; n < 6; ++n) {
+        for (size_type s = 0; s < 3; ++s) { bucket->data[n][s] = 0.5; }
+    }
+    host.ele.Sort();
+    EXPECT_EQ(host.ele.Count(), 5);
+    EXPECT_EQ(host.ele.GetDataBlock()->GetNumberOfOutOfBox(), 0);
+
+    // the same particles on a block which was moved, e.g. by regridding
+    auto p1 = host.Pop();
+    EXPECT_TRUE(host.ele.isNull());
+    p1->SetMeshBlock(engine::MeshBlock::New(b1));
+    host.Push(p1);
+    auto blk = host.ele.GetDataBlock();
+    EXPECT_EQ(std::get<0>(blk->GetIndexBox())[0], 2);
+    EXPECT_EQ(std::get<1>(blk->GetIndexBox())[0], 6);
+    host.ele.Sort();
+    EXPECT_EQ(host.ele.Count(Tag(3, 1, 1)), 3);
+    EXPECT_EQ(blk->GetNumberOfOutOfBox(), 2);
+
+    // a block with the same box keeps the particles sorted
+    host.Push(host.Pop());
+    EXPECT_TRUE(host.ele.GetDataBlock()->isSorted());
+    EXPECT_EQ(host.ele.Count(Tag(3, 1, 1)), 3);
+}
@@ -0,0 +1,60 @@
+//
+// Strong scaling of ParticleDepositCurrent: the same 4M particles in a 64^3 cell patch, deposited by 1 .. 64 threads.
+// Arguments are the number of threads.
+//
+#include <benchmark/benchmark.h>
+#include <random>
+#include "simpla/physics/particle/ParticleData.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace simpla;
+
+static constexpr index_type N = 64;
+static constexpr size_type NUMBER_OF_PARTICLES = 1ul << 22;
+
+static std::shared_ptr<ParticleData> make_particles() {
+    auto p = ParticleData::New(7);
+    p->SetIndexBox(index_box_type{{0, 0, 0}, {N, N, N}});
+    p->Reserve(NUMBER_OF_PARTICLES);
+    std::mt19937 gen(5489u);
+    std::uniform_real_distribution<Real> uniform(0, 1);
+    auto bucket = p->AddBucket(0, NUMBER_OF_PARTICLES);
+    for (size_type s = 0; s < NUMBER_OF_PARTICLES; ++s) {
+        EntityId id;
+        id.x = static_cast<int16_t>(uniform(gen) * N);
+        id.y = static_cast<int16_t>(uniform(gen) * N);
+        id.z = static_cast<int16_t>(uniform(gen) * N);
+        id.w = 0;
+        bucket->tag[s] = static_cast<id_type>(id.v);
+        // position after a push with dt = 1, displacement less than half a cell
+        for (int n = 0; n < 3; ++n) {
+            bucket->data[n + 3][s] = uniform(gen) - 0.5;
+            bucket->data[n][s] = uniform(gen) + bucket->data[n + 3][s];
+        }
+        bucket->data[6][s] = 1.0;
+    }
+    p->Sort();
+    return p;
+}
+
+static void BM_particle_deposit_current(benchmark::State &state) {
+    static auto p = make_particles();
+    index_box_type node_box{{-1, -1, -1}, {N + 2, N + 2, N + 2}};
+    Array<Real> J[3] = {Array<Real>{node_box}, Array<Real>{node_box}, Array<Real>{node_box}};
+    for (auto &a : J) { a.Fill(0); }
+    Real inv_dx[3] = {1, 1, 1};
+#ifdef _OPENMP
+    omp_set_num_threads(static_cast<int>(state.range(0)));
+#endif
+    while (state.KeepRunning()) {
+        ParticleDepositCurrent(*p, J, inv_dx, 1.0, 1.0);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * NUMBER_OF_PARTICLES);
+    state.counters["threads"] = state.range(0);
+}
+BENCHMARK(BM_particle_deposit_current)->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,107 @@
+//
+// Continuity equation and total current of ParticleDepositCurrent.
+//
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include "simpla/physics/particle/ParticleData.h"
+using namespace simpla;
+
+class TestParticleDeposit : public testing::Test {
+   public:
+    index_box_type box{{-3, 0, 2}, {15, 9, 10}};
+    index_box_type node_box{{-4, -1, 1}, {17, 11, 12}};
+    Array<Real> J[3] = {Array<Real>{node_box}, Array<Real>{node_box}, Array<Real>{node_box}};
+    Array<Real> rho0{node_box}, rho1{node_box};
+    Real inv_dx[3] = {1.0, 2.0, 0.5};
+    Real charge = -1.5, dt = 0.1;
+    std::shared_ptr<ParticleData> p;
+
+    void SetUp() override {
+        for (auto& a : J) { a.Fill(0); }
+        rho0.Fill(0);
+        rho1.Fill(0);
+
+        std::mt19937 gen(5489u);
+        std::uniform_real_distribution<Real> uniform(0, 1);
+        size_type num = 2000;
+        p = ParticleData::New(7);
+        p->SetIndexBox(box);
+        auto bucket = p->AddBucket(0, num);
+        for (size_type s = 0; s < num; ++s) {
+            EntityId id;
+            id.x = static_cast<int16_t>(std::get<0>(box)[0] + uniform(gen) * 18);
+            id.y = static_cast<int16_t>(std::get<0>(box)[1] + uniform(gen) * 9);
+            id.z = static_cast<int16_t>(std::get<0>(box)[2] + uniform(gen) * 8);
+            id.w = 0;
+            bucket->tag[s] = static_cast<id_type>(id.v);
+            for (int n = 0; n < 3; ++n) {
+                bucket->data[n][s] = uniform(gen);
+                // displacement less than one cell
+                bucket->data[n + 3][s] = (uniform(gen) * 1.8 - 0.9) / (dt * inv_dx[n]);
+            }
+            bucket->data[6][s] = 0.5 + uniform(gen);
+        }
+        p->Sort();
+        Deposit(rho0);
+        // same move as ParticleBorisPush, particles keep their cell until the next Sort
+        for (size_type s = 0; s < p->GetNumberOfSortedParticles(); ++s) {
+            for (int n = 0; n < 3; ++n) { p->GetData(n)[s] += p->GetData(n + 3)[s] * dt * inv_dx[n]; }
+        }
+        Deposit(rho1);
+    }
+    /** cloud-in-cell charge density on the nodes */
+    void Deposit(Array<Real>& rho) const {
+        Real inv_vol = inv_dx[0] * inv_dx[1] * inv_dx[2];
+        for (size_type s = 0; s < p->GetNumberOfSortedParticles(); ++s) {
+            EntityId id;
+            id.v = static_cast<int64_t>(p->GetTag()[s]);
+            Real x[3] = {id.x + p->GetData(0)[s], id.y + p->GetData(1)[s], id.z + p->GetData(2)[s]};
+            index_type i[3] = {static_cast<index_type>(std::floor(x[0])), static_cast<index_type>(std::floor(x[1])),
+                               static_cast<index_type>(std::floor(x[2]))};
+            for (int a = 0; a < 2; ++a)
+                for (int b = 0; b < 2; ++b)
+                    for (int c = 0; c < 2; ++c) {
+                        Real w = std::abs((1 - a - (x[0] - i[0])) * (1 - b - (x[1] - i[1])) * (1 - c - (x[2] - i[2])));
+                        rho(i[0] + a, i[1] + b, i[2] + c) += charge * p->GetData(6)[s] * w * inv_vol;
+                    }
+        }
+    }
+};
+
+/** discrete continuity equation (rho1-rho0)/dt + div J = 0 on every node */
+TEST_F(TestParticleDeposit, continuity) {
+    ParticleDepositCurrent(*p, J, inv_dx, charge, dt);
+    Real max_rho = 0;
+    for (index_type i = std::get<0>(node_box)[0] + 1; i < std::get<1>(node_box)[0]; ++i)
+        for (index_type j = std::get<0>(node_box)[1] + 1; j < std::get<1>(node_box)[1]; ++j)
+            for (index_type k = std::get<0>(node_box)[2] + 1; k < std::get<1>(node_box)[2]; ++k) {
+                Real div = (J[0](i, j, k) - J[0](i - 1, j, k)) * inv_dx[0] +
+                           (J[1](i, j, k) - J[1](i, j - 1, k)) * inv_dx[1] +
+                           (J[2](i, j, k) - J[2](i, j, k - 1)) * inv_dx[2];
+                EXPECT_NEAR((rho1(i, j, k) - rho0(i, j, k)) / dt + div, 0, 1.0e-10);
+                max_rho = std::max(max_rho, std::abs(rho1(i, j, k)));
+            }
+    EXPECT_GT(max_rho, 0);
+}
+
+/** the total current is the sum of charge times velocity */
+TEST_F(TestParticleDeposit, total_current) {
+    ParticleDepositCurrent(*p, J, inv_dx, charge, dt);
+    ParticleDepositCurrent(*p, J, inv_dx, charge, dt);
+    Real vol = 1.0 / (inv_dx[0] * inv_dx[1] * inv_dx[2]);
+    for (int n = 0; n < 3; ++n) {
+        Real expect = 0, res = 0;
+        for (size_type s = 0; s < p->GetNumberOfSortedParticles(); ++s) {
+            expect += 2 * charge * p->GetData(6)[s] * p->GetData(n + 3)[s];
+        }
+        for (index_type i = std::get<0>(node_box)[0]; i < std::get<1>(node_box)[0]; ++i)
+            for (index_type j = std::get<0>(node_box)[1]; j < std::get<1>(node_box)[1]; ++j)
+                for (index_type k = std::get<0>(node_box)[2]; k < std::get<1>(node_box)[2]; ++k) {
+                    res += J[n](i, j, k) * vol;
+                }
+        EXPECT_NEAR(res, expect, 1.0e-9 * std::abs(expect));
+    }
+}
@@ -0,0 +1,78 @@
+//
+// Philox random numbers, inverse CDF sampling and the reproducible initial loading of particles.
+//
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+#include "simpla/numeric/normal_distribution_icdf.h"
+#include "simpla/numeric/philox_engine.h"
+#include "simpla/physics/particle/ParticleData.h"
+using namespace simpla;
+
+TEST(ParticleInitialLoad, philox) {
+    // known answer of Random123
+    uint32_t ctr[4] = {0, 0, 0, 0};
+    uint32_t key[2] = {0, 0};
+    philox_engine::generate(ctr, key);
+    EXPECT_EQ(ctr[0], 0x6627e8d5u);
+    EXPECT_EQ(ctr[1], 0xe169c58du);
+    EXPECT_EQ(ctr[2], 0xbc57ac4cu);
+    EXPECT_EQ(ctr[3], 0x9b00dbd8u);
+
+    uint32_t ctr2[4] = {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u};
+    uint32_t key2[2] = {0xa4093822u, 0x299f31d0u};
+    philox_engine::generate(ctr2, key2);
+    EXPECT_EQ(ctr2[0], 0xd16cfe09u);
+    EXPECT_EQ(ctr2[1], 0x94fdccebu);
+    EXPECT_EQ(ctr2[2], 0x5001e420u);
+    EXPECT_EQ(ctr2[3], 0x24126ea1u);
+}
+
+TEST(ParticleInitialLoad, icdf) {
+    EXPECT_NEAR(normal_distribution_icdf::value(0.5), 0, 1e-12);
+    EXPECT_NEAR(normal_distribution_icdf::value(0.975), 1.959963984540054, 1e-8);
+    EXPECT_NEAR(normal_distribution_icdf::value(0.01), -2.326347874040841, 1e-8);
+    EXPECT_NEAR(normal_distribution_icdf::value(1e-10), -6.361340902404056, 1e-7);
+    for (double u = 0.001; u < 0.5; u += 0.0123) {
+        EXPECT_NEAR(normal_distribution_icdf::value(u), -normal_distribution_icdf::value(1 - u), 1e-12);
+    }
+}
+
+TEST(ParticleInitialLoad, reproducible) {
+    size_type num = 100000;
+    int dist[6] = {SP_RAND_UNIFORM, SP_RAND_UNIFORM, SP_RAND_UNIFORM, SP_RAND_NORMAL, SP_RAND_NORMAL, SP_RAND_NORMAL};
+    std::vector<Real> whole(6 * num), part(6 * num);
+    Real* a[6];
+    Real* b0[6];
+    Real* b1[6];
+    for (int n = 0; n < 6; ++n) {
+        a[n] = &whole[n * num];
+        b0[n] = &part[n * num];
+        b1[n] = &part[n * num + num / 3];
+    }
+    ParticleInitialLoad(a, num, 6, dist, 0, 7);
+    // same particles loaded by two "processes"
+    ParticleInitialLoad(b0, num / 3, 6, dist, 0, 7);
+    ParticleInitialLoad(b1, num - num / 3, 6, dist, num / 3, 7);
+    for (size_type s = 0; s < 6 * num; ++s) { EXPECT_EQ(whole[s], part[s]); }
+
+    for (int n = 0; n < 6; ++n) {
+        Real mean = 0, var = 0;
+        for (size_type s = 0; s < num; ++s) { mean += a[n][s]; }
+        mean /= num;
+        for (size_type s = 0; s < num; ++s) { var += (a[n][s] - mean) * (a[n][s] - mean); }
+        var /= num;
+        if (dist[n] == SP_RAND_UNIFORM) {
+            EXPECT_NEAR(mean, 0.5, 0.01);
+            EXPECT_NEAR(var, 1.0 / 12.0, 0.005);
+        } else {
+            EXPECT_NEAR(mean, 0, 0.02);
+            EXPECT_NEAR(var, 1, 0.02);
+        }
+    }
+    // other seed, other sample
+    ParticleInitialLoad(b0, num, 6, dist, 0, 8);
+    EXPECT_NE(whole[0], part[0]);
+}
@@ -0,0 +1,59 @@
+//
+// Particles pushed per second by ParticleBorisPush, in total and per core.
+// Arguments are the number of particles, in a 32^3 cell patch.
+//
+#include <benchmark/benchmark.h>
+#include <random>
+#include "simpla/physics/particle/ParticleData.h"
+
+using namespace simpla;
+
+static constexpr index_type N = 32;
+
+static void BM_particle_boris_push(benchmark::State &state) {
+    auto num = static_cast<size_type>(state.range(0));
+    index_box_type box{{0, 0, 0}, {N, N, N}};
+    index_box_type field_box{{-1, -1, -1}, {N + 1, N + 1, N + 1}};
+    std::mt19937 gen(5489u);
+    std::uniform_real_distribution<Real> uniform(0, 1);
+
+    Array<Real> E[3] = {Array<Real>{field_box}, Array<Real>{field_box}, Array<Real>{field_box}};
+    Array<Real> B[3] = {Array<Real>{field_box}, Array<Real>{field_box}, Array<Real>{field_box}};
+    for (auto &a : E) { a = [&](index_type i, index_type j, index_type k) { return uniform(gen); }; }
+    for (auto &a : B) { a = [&](index_type i, index_type j, index_type k) { return uniform(gen); }; }
+
+    auto p = ParticleData::New(6);
+    p->SetIndexBox(box);
+    p->Reserve(num);
+    auto bucket = p->AddBucket(0, num);
+    for (size_type s = 0; s < num; ++s) {
+        EntityId id;
+        id.x = static_cast<int16_t>(uniform(gen) * N);
+        id.y = static_cast<int16_t>(uniform(gen) * N);
+        id.z = static_cast<int16_t>(uniform(gen) * N);
+        id.w = 0;
+        bucket->tag[s] = static_cast<id_type>(id.v);
+        for (int n = 0; n < 6; ++n) { bucket->data[n][s] = uniform(gen); }
+    }
+    p->Sort();
+
+    int num_of_threads = 0;
+#pragma omp parallel
+    {
+#pragma omp atomic
+        ++num_of_threads;
+    }
+    Real inv_dx[3] = {1, 1, 1};
+    // small time step, particles stay in their cells and the sort order is kept
+    while (state.KeepRunning()) {
+        ParticleBorisPush(*p, E, B, inv_dx, 1.0, 1.0e-9);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * num);
+    state.counters["pushes_per_core"] =
+        benchmark::Counter(static_cast<double>(state.iterations() * num) / num_of_threads, benchmark::Counter::kIsRate);
+    state.counters["simd_width"] = SP_PARTICLE_SIMD_WIDTH;
+}
+BENCHMARK(BM_particle_boris_push)->RangeMultiplier(4)->Range(1 << 14, 1 << 24)->UseRealTime();
+
+BENCHMARK_MAIN();
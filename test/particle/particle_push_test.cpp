@@ -0,0 +1,94 @@
+//
+// Field interpolation and gyration of ParticleBorisPush.
+//
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include "simpla/physics/particle/ParticleData.h"
+using namespace simpla;
+
+class TestParticleBorisPush : public testing::Test {
+   public:
+    static constexpr index_type N = 4;
+    index_box_type box{{0, 0, 0}, {N, N, N}};
+    index_box_type field_box{{-1, -1, -1}, {N + 1, N + 1, N + 1}};
+    Array<Real> E[3] = {Array<Real>{field_box}, Array<Real>{field_box}, Array<Real>{field_box}};
+    Array<Real> B[3] = {Array<Real>{field_box}, Array<Real>{field_box}, Array<Real>{field_box}};
+    Real inv_dx[3] = {1, 1, 1};
+    std::shared_ptr<ParticleData> p;
+
+    void SetUp() override {
+        for (auto& a : E) { a.Fill(0); }
+        for (auto& a : B) { a.Fill(0); }
+        p = ParticleData::New(6);
+        p->SetIndexBox(box);
+    }
+    /** one particle per cell at r, velocity v */
+    void Load(Real const* r, Real const* v) {
+        auto bucket = p->AddBucket(0, N * N * N);
+        size_type s = 0;
+        for (index_type i = 0; i < N; ++i)
+            for (index_type j = 0; j < N; ++j)
+                for (index_type k = 0; k < N; ++k) {
+                    EntityId id;
+                    id.x = static_cast<int16_t>(i);
+                    id.y = static_cast<int16_t>(j);
+                    id.z = static_cast<int16_t>(k);
+                    id.w = 0;
+                    bucket->tag[s] = static_cast<id_type>(id.v);
+                    for (int n = 0; n < 3; ++n) {
+                        bucket->data[n][s] = r[n];
+                        bucket->data[n + 3][s] = v[n];
+                    }
+                    ++s;
+                }
+        p->Sort();
+    }
+};
+constexpr index_type TestParticleBorisPush::N;
+
+/** trilinear interpolation is exact for linear fields, B=0 gives dv = cmr*dt*E */
+TEST_F(TestParticleBorisPush, interpolate) {
+    // E_x at (i+1/2,j,k), E_y at (i,j+1/2,k), E_z at (i,j,k+1/2)
+    auto fun = [](Real x, Real y, Real z, int n) { return (n + 1) * x - 2 * y + 0.5 * n * z + 3; };
+    for (int n = 0; n < 3; ++n) {
+        E[n] = [&](index_type i, index_type j, index_type k) {
+            return fun(i + (n == 0 ? 0.5 : 0), j + (n == 1 ? 0.5 : 0), k + (n == 2 ? 0.5 : 0), n);
+        };
+    }
+    Real r[3] = {0.3, 0.85, 0.1};
+    Real v[3] = {0, 0, 0};
+    Load(r, v);
+    Real cmr = 2.0, dt = 1.0e-3;
+    ParticleBorisPush(*p, E, B, inv_dx, cmr, dt);
+    EXPECT_EQ(p->Count(), static_cast<size_type>(N * N * N));
+    for (size_type c = 0; c < p->GetNumberOfCells(); ++c) {
+        ASSERT_EQ(p->GetBucketCount(c), 1);
+        auto s = p->GetBucketStart(c);
+        EntityId id;
+        id.v = static_cast<int64_t>(p->GetTag()[s]);
+        for (int n = 0; n < 3; ++n) {
+            Real expect = fun(id.x + r[0], id.y + r[1], id.z + r[2], n);
+            EXPECT_NEAR(p->GetData(n + 3)[s], cmr * dt * expect, 1.0e-12);
+            EXPECT_NEAR(p->GetData(n)[s], r[n] + cmr * dt * expect * dt, 1.0e-12);
+        }
+    }
+}
+
+/** uniform B_z rotates the velocity by 2*atan(cmr*dt*B/2) per step, the speed is conserved */
+TEST_F(TestParticleBorisPush, gyration) {
+    Real Bz = 1.5, cmr = 1.0, dt = 0.05;
+    B[2].Fill(Bz);
+    Real r[3] = {0.5, 0.5, 0.5};
+    Real v[3] = {1.0e-3, 0, 2.0e-4};
+    Load(r, v);
+    int num_of_steps = 20;
+    for (int i = 0; i < num_of_steps; ++i) { ParticleBorisPush(*p, E, B, inv_dx, cmr, dt); }
+    Real theta = -2 * std::atan(0.5 * cmr * dt * Bz) * num_of_steps;
+    for (size_type s = 0; s < p->GetNumberOfSortedParticles(); ++s) {
+        EXPECT_NEAR(p->GetData(3)[s], v[0] * std::cos(theta), 1.0e-15);
+        EXPECT_NEAR(p->GetData(4)[s], v[0] * std::sin(theta), 1.0e-15);
+        EXPECT_DOUBLE_EQ(p->GetData(5)[s], v[2]);
+    }
+}
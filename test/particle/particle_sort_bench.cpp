@@ -0,0 +1,51 @@
+//
+// Particles sorted per second by ParticleData::Sort.
+// Arguments are the number of particles, in a 32^3 cell patch.
+//
+#include <benchmark/benchmark.h>
+#include <random>
+#include "simpla/physics/particle/ParticleData.h"
+
+using namespace simpla;
+
+static constexpr index_type N = 32;
+
+static std::shared_ptr<ParticleData> make_particles(size_type num) {
+    auto p = ParticleData::New(6);
+    p->SetIndexBox(index_box_type{{0, 0, 0}, {N, N, N}});
+    p->Reserve(num);
+    std::mt19937 gen(5489u);
+    std::uniform_real_distribution<Real> uniform(0, 1);
+    auto bucket = p->AddBucket(0, num);
+    for (size_type s = 0; s < num; ++s) {
+        EntityId id;
+        id.x = static_cast<int16_t>(uniform(gen) * N);
+        id.y = static_cast<int16_t>(uniform(gen) * N);
+        id.z = static_cast<int16_t>(uniform(gen) * N);
+        id.w = 0;
+        bucket->tag[s] = static_cast<id_type>(id.v);
+        for (int n = 0; n < 6; ++n) { bucket->data[n][s] = uniform(gen); }
+    }
+    p->Sort();
+    return p;
+}
+
+/** every step about 30% of particles move to the next cell, as after a push */
+static void BM_particle_sort(benchmark::State &state) {
+    auto num = static_cast<size_type>(state.range(0));
+    auto p = make_particles(num);
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        Real *rx = p->GetData(0);
+        Real const *vx = p->GetData(3);
+#pragma omp parallel for
+        for (size_type s = 0; s < num; ++s) { rx[s] += 0.3 * vx[s]; }
+        state.ResumeTiming();
+        p->Sort();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * num);
+}
+BENCHMARK(BM_particle_sort)->RangeMultiplier(4)->Range(1 << 14, 1 << 24)->UseRealTime();
+
+BENCHMARK_MAIN();
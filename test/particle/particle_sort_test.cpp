@@ -0,0 +1,172 @@
+//
+// Sort, tag update and buckets of ParticleData.
+//
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include "simpla/physics/particle/ParticleData.h"
+using namespace simpla;
+
+class TestParticleSort : public testing::Test {
+   public:
+    index_box_type box = {{-2, 3, 1}, {6, 9, 6}};
+    size_type num = 20000;
+    std::shared_ptr<ParticleData> p = ParticleData::New(4);
+
+    static id_type Tag(index_type i, index_type j, index_type k) {
+        EntityId id;
+        id.x = static_cast<int16_t>(i);
+        id.y = static_cast<int16_t>(j);
+        id.z = static_cast<int16_t>(k);
+        id.w = 0;
+        return static_cast<id_type>(id.v);
+    }
+    /** particles in the box and one cell around it, the last column is the particle id */
+    void SetUp() override {
+        p->SetIndexBox(box);
+        p->Reserve(num);
+        std::mt19937 gen(5489u);
+        std::uniform_real_distribution<Real> uniform(0, 1);
+        for (size_type s = 0; s < num; ++s) {
+            index_type idx[3];
+            for (int n = 0; n < 3; ++n) {
+                idx[n] = std::get<0>(box)[n] - 1 +
+                         static_cast<index_type>(uniform(gen) * (std::get<1>(box)[n] - std::get<0>(box)[n] + 2));
+            }
+            auto bucket = p->AddBucket(Tag(idx[0], idx[1], idx[2]), 1);
+            for (int n = 0; n < 3; ++n) { bucket->data[n][0] = uniform(gen); }
+            bucket->data[3][0] = s;
+        }
+    }
+    static bool InBox(index_box_type const& b, id_type t) {
+        EntityId id;
+        id.v = static_cast<int64_t>(t);
+        index_type idx[3] = {id.x, id.y, id.z};
+        for (int n = 0; n < 3; ++n) {
+            if (idx[n] < std::get<0>(b)[n] || idx[n] >= std::get<1>(b)[n]) { return false; }
+        }
+        return true;
+    }
+    std::map<id_type, size_type> Histogram() const {
+        std::map<id_type, size_type> res;
+        auto const* tag = p->GetTag();
+        for (size_type s = 0; s < p->size(); ++s) {
+            if (tag[s] != NULL_ID) { ++res[tag[s]]; }
+        }
+        return res;
+    }
+};
+
+TEST_F(TestParticleSort, sort) {
+    auto hist = Histogram();
+    size_type num_in_box = 0;
+    for (auto const& item : hist) { num_in_box += InBox(box, item.first) ? item.second : 0; }
+
+    p->Sort();
+    EXPECT_EQ(p->Count(), num);
+    EXPECT_EQ(p->GetNumberOfSortedParticles(), num);
+    EXPECT_EQ(p->GetNumberOfOutOfBox(), num - num_in_box);
+    for (auto const& item : hist) {
+        if (!InBox(box, item.first)) { continue; }
+        auto bucket = p->GetBucket(item.first);
+        ASSERT_TRUE(bucket != nullptr);
+        EXPECT_TRUE(bucket->next == nullptr);
+        EXPECT_EQ(bucket->count, item.second);
+        EXPECT_EQ(p->Count(item.first), item.second);
+        for (size_type s = 0; s < bucket->count; ++s) {
+            EXPECT_EQ(bucket->tag[s], item.first);
+            // stable
+            if (s > 0) { EXPECT_LT(bucket->data[3][s - 1], bucket->data[3][s]); }
+        }
+    }
+    for (size_type s = num_in_box; s < num; ++s) { EXPECT_FALSE(InBox(box, p->GetTag()[s])); }
+}
+
+TEST_F(TestParticleSort, update_tag) {
+    p->Sort();
+    auto* tag = p->GetTag();
+    auto** r = p->GetData();
+    std::map<Real, id_type> expect;
+    for (size_type s = 0; s < num; s += 7) {
+        EntityId id;
+        id.v = static_cast<int64_t>(tag[s]);
+        r[0][s] += 1.0;
+        r[2][s] -= 2.0;
+        expect[r[3][s]] = Tag(id.x + 1, id.y, id.z - 2);
+    }
+    p->Sort();
+    tag = p->GetTag();
+    r = p->GetData();
+    EXPECT_EQ(p->Count(), num);
+    for (size_type s = 0; s < num; ++s) {
+        for (int n = 0; n < 3; ++n) {
+            EXPECT_GE(r[n][s], 0);
+            EXPECT_LT(r[n][s], 1);
+        }
+        auto it = expect.find(r[3][s]);
+        if (it != expect.end()) { EXPECT_EQ(tag[s], it->second); }
+    }
+}
+
+TEST_F(TestParticleSort, bucket) {
+    p->Sort();
+    auto cell = Tag(0, 4, 2);
+    auto count = p->Count(cell);
+    auto page = p->AddBucket(cell, 10);
+    for (int n = 0; n < 3; ++n)
+        for (size_type s = 0; s < 10; ++s) { page->data[n][s] = 0.5; }
+    for (size_type s = 0; s < 10; ++s) { page->data[3][s] = num + s; }
+
+    EXPECT_EQ(p->Count(cell), count + 10);
+    auto bucket = p->GetBucket(cell);
+    ASSERT_TRUE(bucket != nullptr && bucket->next != nullptr);
+    EXPECT_EQ(bucket->next->count, 10);
+
+    p->Sort();
+    bucket = p->GetBucket(cell);
+    EXPECT_TRUE(bucket->next == nullptr);
+    EXPECT_EQ(bucket->count, count + 10);
+    EXPECT_EQ(bucket->data[3][bucket->count - 1], num + 9);
+
+    p->RemoveBucket(cell);
+    EXPECT_EQ(p->Count(cell), 0);
+    EXPECT_EQ(p->Count(), num - count);
+    p->Sort();
+    EXPECT_EQ(p->Count(cell), 0);
+    EXPECT_EQ(p->Count(), num - count);
+    EXPECT_TRUE(p->GetBucket(cell) == nullptr);
+}
+TEST_F(TestParticleSort, clear) {
+    p->Sort();
+    auto cell = Tag(0, 4, 2);
+    ASSERT_GT(p->Count(cell), 0);
+    // a removed cell and an extra page, both dropped by Clear
+    p->RemoveBucket(Tag(1, 4, 2));
+    auto page = p->AddBucket(cell, 3);
+    for (int n = 0; n < 4; ++n)
+        for (size_type s = 0; s < 3; ++s) { page->data[n][s] = 0.5; }
+
+    auto capacity = p->GetCapacity();
+    p->RemoveBucket(NULL_ID);
+    EXPECT_EQ(p->Count(), 0);
+    EXPECT_EQ(p->Count(cell), 0);
+    EXPECT_TRUE(p->GetBucket(cell) == nullptr);
+    EXPECT_TRUE(p->GetBucket() == nullptr);
+    EXPECT_TRUE(p->isSorted());
+    EXPECT_EQ(p->GetCapacity(), capacity);
+    p->Sort();
+    EXPECT_EQ(p->Count(), 0);
+    EXPECT_EQ(p->Count(cell), 0);
+
+    // the block is reused
+    page = p->AddBucket(cell, 2);
+    for (int n = 0; n < 4; ++n)
+        for (size_type s = 0; s < 2; ++s) { page->data[n][s] = 0.5; }
+    EXPECT_EQ(p->Count(), 2);
+    p->Sort();
+    EXPECT_EQ(p->Count(), 2);
+    EXPECT_EQ(p->Count(cell), 2);
+    EXPECT_EQ(p->GetNumberOfOutOfBox(), 0);
+}
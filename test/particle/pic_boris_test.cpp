@@ -0,0 +1,100 @@
+//
+// One PICBoris::DoAdvance of a species pushed from a patch: Boris push in a uniform E, then re-sort.
+//
+
+#include <gtest/gtest.h>
+
+#include "simpla/SIMPLA_config.h"
+
+#include "simpla/algebra/Algebra.h"
+#include "simpla/engine/Domain.h"
+#include "simpla/engine/Patch.h"
+#include "simpla/physics/Field.h"
+#include "simpla/predefine/physics/PICBoris.h"
+#include "simpla/predefine/physics/PredefineDomains.h"
+using namespace simpla;
+using namespace simpla::data;
+
+static id_type Tag(index_type i, index_type j, index_type k) {
+    EntityId id;
+    id.x = static_cast<int16_t>(i);
+    id.y = static_cast<int16_t>(j);
+    id.z = static_cast<int16_t>(k);
+    id.w = 0;
+    return static_cast<id_type>(id.v);
+}
+
+class TestPICBoris : public testing::Test {
+   public:
+    typedef PICBoris<CartesianFVM> domain_type;
+    Real dx = 0.01, dt = 1.0e-9, Ex = 1.0e5;
+    std::shared_ptr<domain_type> d = domain_type::New();
+    std::shared_ptr<Particle<CartesianFVM>> sp;
+
+    /** particles at rest, one of them at the upper x face of its cell */
+    void SetUp() override {
+        d->SetChart(geometry::csCartesian::New(point_type{0, 0, 0}, point_type{dx, dx, dx}));
+        auto cfg = DataEntry::New(DataEntry::DN_TABLE);
+        cfg->SetValue("mass", 1.0);
+        cfg->SetValue("Z", 1.0);
+        sp = d->AddSpecies("H", cfg);
+        d->SetUp();
+
+        auto patch = engine::Patch::New(engine::MeshBlock::New(index_box_type{{0, 0, 0}, {8, 8, 8}}));
+        patch->SetDataBlock("H", DataEntry::New(ParticleData::New(7)));
+        d->Push(patch);
+        d->PreInitialCondition(d.get(), 0);
+        d->E = [&](point_type const& x) { return point_type{Ex, 0, 0}; };
+        d->B.Clear();
+
+        auto bucket = sp->AddBucket(Tag(3, 3, 3), 4);
+        for (size_type s = 0; s < 4; ++s) {
+            for (int n = 0; n < 3; ++n) { bucket->data[n][s] = 0.5; }
+            for (int n = 3; n < 6; ++n) { bucket->data[n][s] = 0; }
+            bucket->data[6][s] = 1;
+        }
+        bucket->data[0][3] = 1 - 1.0e-6;
+        sp->Sort();
+    }
+};
+
+TEST_F(TestPICBoris, advance_moves_particles) {
+    ASSERT_EQ(sp->Count(), 4);
+    d->DoAdvance(0, dt);
+
+    Real cmr = sp->GetProperty<double>("charge") / sp->GetProperty<double>("mass");
+    auto blk = sp->GetDataBlock();
+    EXPECT_EQ(blk->GetNumberOfOutOfBox(), 0);
+    EXPECT_EQ(sp->Count(Tag(3, 3, 3)), 3);
+    EXPECT_EQ(sp->Count(Tag(4, 3, 3)), 1);
+    for (auto bucket = sp->GetBucket(Tag(3, 3, 3)); bucket != nullptr; bucket = bucket->next) {
+        for (size_type s = 0; s < bucket->count; ++s) {
+            EXPECT_NEAR(bucket->data[3][s], cmr * Ex * dt, 1.0e-6 * cmr * Ex * dt);
+            EXPECT_NEAR(bucket->data[0][s], 0.5 + cmr * Ex * dt * dt / dx, 1.0e-9);
+            EXPECT_GT(bucket->data[0][s], 0.5);
+            EXPECT_DOUBLE_EQ(bucket->data[1][s], 0.5);
+            EXPECT_DOUBLE_EQ(bucket->data[4][s], 0);
+        }
+    }
+}
+
+TEST_F(TestPICBoris, advance_deposits_current) {
+    d->J = [&](point_type const& x) { return point_type{1, 1, 1}; };
+    d->DoAdvance(0, dt);
+
+    // J is cleared first, the particles move along x only
+    Real sum[3] = {0, 0, 0};
+    for (int n = 0; n < 3; ++n) {
+        d->J.GetData(n).Foreach([&](Real const& v, index_type, index_type, index_type) { sum[n] += v; });
+    }
+    Real charge = sp->GetProperty<double>("charge");
+    Real vx = 0;
+    for (auto bucket = sp->GetBucket(); bucket != nullptr; bucket = bucket->next) {
+        for (size_type s = 0; s < bucket->count; ++s) { vx += bucket->data[6][s] * bucket->data[3][s]; }
+    }
+    EXPECT_GT(vx, 0);
+    // the current of a particle, summed over the edges, is q w v / cell volume
+    EXPECT_NEAR(sum[0], charge * vx / (dx * dx * dx), 1.0e-8 * std::abs(charge * vx / (dx * dx * dx)));
+    EXPECT_DOUBLE_EQ(sum[1], 0);
+    EXPECT_DOUBLE_EQ(sum[2], 0);
+}
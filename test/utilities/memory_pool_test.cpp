@@ -5,43 +5,97 @@
  *      Author: salmon
  */
 
-#include <iostream>
-#include <iomanip>
-#include "memory_pool.h"
-#include "log.h"
-#include "../io/DataStream.h"
-#include "../parallel/MPIComm.h"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "simpla/algebra/Array.h"
+#include "simpla/utilities/memory.h"
 
 using namespace simpla;
 
-/// TODO need a multithead test of memory pool
-
-int main(int argc, char **argv)
-{
-	LOGGER.init(argc, argv);
-	GLOBAL_COMM.init(argc,argv);
-	GLOBAL_DATA_STREAM.init(argc,argv);
-
-//	std::shared_ptr<double> p[10];
-//
-//	SingletonHolder<MemoryPool>::instance().max_size(4000);
-//	for (int i = 0; i < 10; ++i)
-//	{
-//		p[i] = sp_make_shared_array<double>(100);
-//
-//		std::cout << SingletonHolder<MemoryPool>::instance().size()
-//				<< std::endl;
-//	}
-//
-//	for (int i = 0; i < 10; ++i)
-//	{
-//		p[i].reset();
-//
-//		std::cout << SingletonHolder<MemoryPool>::instance().size()
-//				<< std::endl;
-//	}
-//
-//	std::cout << "  " << std::setw(25) << std::left << "hello" << " "
-//			<< std::left << "world!" << std::endl;
+TEST(MemoryPool, size_class) {
+    EXPECT_EQ(MemoryPool::BlockSize(1), MemoryPool::MIN_BLOCK_SIZE);
+    EXPECT_EQ(MemoryPool::BlockSize(256), 256);
+    EXPECT_EQ(MemoryPool::BlockSize(257), 320);
+    EXPECT_EQ(MemoryPool::BlockSize(1000), 1024);
+    EXPECT_EQ(MemoryPool::BlockSize(1025), 1280);
+    for (size_t s = 1; s < (1ul << 22); s = s * 3 / 2 + 1) {
+        EXPECT_GE(MemoryPool::BlockSize(s), s);
+        EXPECT_LE(MemoryPool::BlockSize(s), std::max(s + s / 4 + 1, MemoryPool::MIN_BLOCK_SIZE));
+    }
+}
+
+TEST(MemoryPool, reuse) {
+    auto& pool = MemoryPool::instance();
+    pool.clear();
+    pool.ResetStatistics();
+
+    void* p0 = pool.pop(1000);
+    void* p1 = pool.pop(3 * MemoryPool::HUGE_PAGE_SIZE);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p0) % MemoryPool::ALIGNMENT, 0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p1) % MemoryPool::ALIGNMENT, 0);
+    EXPECT_EQ(pool.GetNumberOfMisses(), 2);
+    EXPECT_EQ(pool.GetBytesInUse(), 1024 + 3 * MemoryPool::HUGE_PAGE_SIZE);
+
+    pool.push(p0, 1000);
+    pool.push(p1, 3 * MemoryPool::HUGE_PAGE_SIZE);
+    EXPECT_EQ(pool.GetBytesHeld(), 1024 + 3 * MemoryPool::HUGE_PAGE_SIZE);
+    EXPECT_EQ(pool.GetBytesInUse(), 0);
+
+    // same size class
+    EXPECT_EQ(pool.pop(900), p0);
+    EXPECT_EQ(pool.pop(3 * MemoryPool::HUGE_PAGE_SIZE - 100), p1);
+    EXPECT_EQ(pool.GetNumberOfHits(), 2);
+    EXPECT_EQ(pool.GetBytesHeld(), 0);
+    pool.push(p0, 900);
+    pool.push(p1, 3 * MemoryPool::HUGE_PAGE_SIZE - 100);
+
+    pool.clear();
+    EXPECT_EQ(pool.GetBytesHeld(), 0);
+}
+
+TEST(MemoryPool, max_size) {
+    auto& pool = MemoryPool::instance();
+    pool.clear();
+    size_t depth = pool.max_size();
+    pool.max_size(0);
+    void* p = pool.pop(4 * MemoryPool::MAX_THREAD_CACHE_BLOCK_SIZE);
+    pool.push(p, 4 * MemoryPool::MAX_THREAD_CACHE_BLOCK_SIZE);
+    EXPECT_EQ(pool.GetBytesHeld(), 0);
+    pool.max_size(depth);
+}
+
+TEST(MemoryPool, threads) {
+    auto& pool = MemoryPool::instance();
+    pool.clear();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < 100; ++i) {
+                std::vector<void*> blocks;
+                for (size_t s = 64; s < (1ul << 21); s *= 2) { blocks.push_back(pool.pop(s)); }
+                for (size_t s = 64, n = 0; s < (1ul << 21); s *= 2, ++n) { pool.push(blocks[n], s); }
+            }
+        });
+    }
+    for (auto& w : workers) { w.join(); }
+    EXPECT_EQ(pool.GetBytesInUse(), 0);
+    pool.clear();
+    EXPECT_EQ(pool.GetBytesHeld(), 0);
+}
 
+TEST(MemoryPool, array) {
+    auto& pool = MemoryPool::instance();
+    pool.clear();
+    pool.ResetStatistics();
+    index_box_type box{{0, 0, 0}, {16, 16, 16}};
+    for (int i = 0; i < 4; ++i) {
+        Array<Real> a{box};
+        a.Fill(1.0);
+    }
+    EXPECT_EQ(pool.GetNumberOfMisses(), 1);
+    EXPECT_EQ(pool.GetNumberOfHits(), 3);
+    EXPECT_EQ(pool.GetBytesInUse(), 0);
 }
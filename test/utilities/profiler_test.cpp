@@ -0,0 +1,66 @@
+//
+// Nested timers, threads and traces of Profiler.
+//
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include "simpla/utilities/Profiler.h"
+using namespace simpla;
+
+TEST(Profiler, nested) {
+    Profiler p;
+    p.Begin("Step");
+    for (int n = 0; n < 3; ++n) {
+        p.Begin("Advance");
+        EXPECT_EQ(p.GetPath(), "Step/Advance");
+        p.End();
+    }
+    p.End();
+    EXPECT_EQ(p.GetPath(), "");
+    auto records = p.GetRecords();
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0].path, "Step");
+    EXPECT_EQ(records[0].count, 1);
+    EXPECT_EQ(records[1].path, "Step/Advance");
+    EXPECT_EQ(records[1].count, 3);
+    EXPECT_LE(records[1].min, records[1].max);
+    EXPECT_LE(records[1].total, records[0].total);
+}
+TEST(Profiler, threads) {
+    Profiler p;
+    p.Begin("Step");
+    auto parent = p.GetPath();
+    std::thread t([&] {
+        p.Begin("Patch", parent, 42);
+        p.End();
+    });
+    t.join();
+    p.End();
+    auto records = p.GetRecords();
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[1].path, "Step/Patch");
+}
+TEST(Profiler, trace) {
+    Profiler p;
+    p.SetTrace(true);
+    p.Begin("Advance[\"EM\"]", "", 7);
+    p.End();
+    auto events = p.GetTraceEvents(3);
+    EXPECT_NE(events.find("\"name\":\"Advance[\\\"EM\\\"]\""), std::string::npos);
+    EXPECT_NE(events.find("\"pid\":3"), std::string::npos);
+    EXPECT_NE(events.find("\"id\":7"), std::string::npos);
+    p.Clear();
+    EXPECT_TRUE(p.GetTraceEvents().empty());
+    EXPECT_TRUE(p.GetRecords().empty());
+}
+TEST(Profiler, scope_disabled) {
+    Profiler::Global().SetEnable(false);
+    { SP_PROFILE_SCOPE("Off"); }
+    Profiler::Global().SetEnable(true);
+    { SP_PROFILE_SCOPE("On", "tag"); }
+    Profiler::Global().SetEnable(false);
+    auto records = Profiler::Global().GetRecords();
+    ASSERT_EQ(records.size(), 1);
+    EXPECT_EQ(records[0].path, "On[tag]");
+}
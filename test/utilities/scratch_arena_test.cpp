@@ -0,0 +1,54 @@
+//
+// Stack order and reuse of the memory of ScratchArena.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+#include "simpla/utilities/ScratchArena.h"
+using namespace simpla;
+
+TEST(ScratchArena, stack) {
+    auto arena = std::make_shared<ScratchArena>();
+    void* p0 = arena->Allocate(100);
+    void* p1 = arena->Allocate(1000);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p0) % ScratchArena::ALIGNMENT, 0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p1) % ScratchArena::ALIGNMENT, 0);
+    EXPECT_EQ(arena->GetBytesInUse(), 128 + 1024);
+
+    arena->Deallocate(p1);
+    void* p2 = arena->Allocate(1000);
+    EXPECT_EQ(p1, p2);
+
+    // out of order release, reclaimed with the block above it
+    arena->Deallocate(p0);
+    EXPECT_EQ(arena->GetBytesInUse(), 1024);
+    arena->Deallocate(p2);
+    EXPECT_EQ(arena->GetBytesInUse(), 0);
+    void* p3 = arena->Allocate(10);
+    EXPECT_EQ(p3, p0);
+    arena->Deallocate(p3);
+    EXPECT_EQ(arena->GetPeakBytes(), 128 + 1024);
+    EXPECT_EQ(arena->GetNumberOfChunkAllocations(), 1);
+}
+
+TEST(ScratchArena, reuse) {
+    auto arena = std::make_shared<ScratchArena>();
+    size_t n = SP_SCRATCH_CHUNK_SIZE / sizeof(double) / 3;
+    for (int step = 0; step < 10; ++step) {
+        std::vector<std::shared_ptr<double>> tmp;
+        for (int i = 0; i < 5; ++i) {
+            tmp.push_back(arena->MakeShared<double>(n));
+            tmp.back().get()[n - 1] = i;
+        }
+        while (!tmp.empty()) { tmp.pop_back(); }
+        EXPECT_EQ(arena->GetBytesInUse(), 0);
+    }
+    EXPECT_EQ(arena->GetNumberOfChunkAllocations(), 3);
+    EXPECT_GE(arena->GetPeakBytes(), 5 * n * sizeof(double));
+    EXPECT_GE(ScratchArena::GetTotalPeakBytes(), arena->GetPeakBytes());
+
+    arena->Shrink();
+    EXPECT_EQ(arena->GetBytesReserved(), 0);
+}